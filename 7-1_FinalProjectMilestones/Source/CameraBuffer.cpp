@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerabuffer.cpp
+// ============
+// uniform block with the camera matrices shared by every shader program
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CameraBuffer.h"
+
+#include <iostream>
+
+/***********************************************************
+ *  CameraBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CameraBuffer::CameraBuffer()
+{
+	m_buffer = 0;
+}
+
+/***********************************************************
+ *  ~CameraBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+CameraBuffer::~CameraBuffer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the uniform buffer.
+ *  It stays bound to the block binding point for the whole
+ *  run, so no program has to bind it before drawing.
+ ***********************************************************/
+bool CameraBuffer::Initialize()
+{
+	Destroy();
+
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(CAMERA_BLOCK), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	if (m_buffer == 0)
+	{
+		std::cout << "Could not create the camera uniform buffer" << std::endl;
+		return(false);
+	}
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, m_buffer);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the uniform buffer.
+ ***********************************************************/
+void CameraBuffer::Destroy()
+{
+	if (m_buffer != 0)
+	{
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = 0;
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for writing the camera into the
+ *  block. The inverses are computed here once rather than
+ *  by each shader that needs them.
+ ***********************************************************/
+void CameraBuffer::Update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition)
+{
+	if (m_buffer == 0)
+	{
+		return;
+	}
+
+	CAMERA_BLOCK block;
+	block.view = view;
+	block.projection = projection;
+	block.viewProjection = projection * view;
+	block.inverseView = glm::inverse(view);
+	block.inverseProjection = glm::inverse(projection);
+	block.inverseViewProjection = glm::inverse(block.viewProjection);
+	block.viewPosition = viewPosition;
+	block.padding = 0.0f;
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CAMERA_BLOCK), &block);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerabuffer.h
+// ============
+// uniform block with the camera matrices shared by every shader program
+//
+// The view and projection, their product and the inverses of all three are
+// written into one uniform buffer bound at a fixed binding point, so that
+// every program reads the same copy instead of receiving the values through
+// its own uniforms. The buffer is only written when the camera changed.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+class CameraBuffer
+{
+public:
+	// binding point of the CameraBlock in the shaders
+	static const GLuint CAMERA_BLOCK_BINDING = 0;
+
+	// constructor
+	CameraBuffer();
+	// destructor
+	~CameraBuffer();
+
+	// create the buffer and bind it to the block binding point
+	bool Initialize();
+	// free the buffer
+	void Destroy();
+
+	// write the matrices of a changed camera
+	void Update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition);
+
+	bool IsReady() const { return m_buffer != 0; }
+
+private:
+	// std140 layout of the CameraBlock in the shaders
+	struct CAMERA_BLOCK
+	{
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::mat4 viewProjection;
+		glm::mat4 inverseView;
+		glm::mat4 inverseProjection;
+		glm::mat4 inverseViewProjection;
+		glm::vec3 viewPosition;
+		float padding;
+	};
+
+	GLuint m_buffer;
+};
@@ -0,0 +1,295 @@
+///////////////////////////////////////////////////////////////////////////////
+// deferredrenderer.cpp
+// ============
+// render the opaque scene into a G-buffer and light it in one screen pass
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DeferredRenderer.h"
+#include "ShaderCache.h"
+#include "GLStateCache.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_GeometryVertexShaderFile = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/vertexShader.glsl";
+	const char* g_GeometryFragmentShaderFile = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/gBufferFragmentShader.glsl";
+	const char* g_LightingVertexShaderFile = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/screenVertexShader.glsl";
+	const char* g_LightingFragmentShaderFile = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/deferredLightingShader.glsl";
+
+	// the G-buffer targets use the slots after the scene textures
+	const int ALBEDO_TEXTURE_UNIT = 10;
+	const int NORMAL_TEXTURE_UNIT = 11;
+	const int DEPTH_TEXTURE_UNIT = 12;
+	// storage binding of the LightStorage block, after the
+	// blocks of the GPU culling
+	const GLuint LIGHT_STORAGE_BINDING = 6;
+
+	/***********************************************************
+	 *  CreateTarget()
+	 *
+	 *  Create one screen-sized texture for the G-buffer.
+	 ***********************************************************/
+	GLuint CreateTarget(GLint internalFormat, GLenum format, GLenum type, int width, int height)
+	{
+		GLuint textureID = 0;
+		glGenTextures(1, &textureID);
+		g_GLState.BindTexture(GLStateCache::UPLOAD_TEXTURE_UNIT, GL_TEXTURE_2D, textureID);
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		return(textureID);
+	}
+}
+
+/***********************************************************
+ *  DeferredRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DeferredRenderer::DeferredRenderer()
+{
+	m_pGeometryShader = NULL;
+	m_pLightingShader = NULL;
+	m_frameBuffer = 0;
+	m_albedoTexture = 0;
+	m_normalTexture = 0;
+	m_depthTexture = 0;
+	m_width = 0;
+	m_height = 0;
+	m_screenVAO = 0;
+	m_outputFrameBuffer = 0;
+	m_lightBuffer = 0;
+}
+
+/***********************************************************
+ *  ~DeferredRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DeferredRenderer::~DeferredRenderer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the shader programs of
+ *  the geometry and lighting passes through the program
+ *  binary cache. The geometry pass uses the same vertex
+ *  shader as the forward path.
+ ***********************************************************/
+bool DeferredRenderer::Initialize()
+{
+	m_pGeometryShader = new ShaderManager();
+	m_pGeometryShader->m_programID = LoadShaderProgram(g_GeometryVertexShaderFile, g_GeometryFragmentShaderFile);
+	if (m_pGeometryShader->m_programID == 0)
+	{
+		std::cout << "Could not load the G-buffer shaders" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	m_pLightingShader = new ShaderManager();
+	m_pLightingShader->m_programID = LoadShaderProgram(g_LightingVertexShaderFile, g_LightingFragmentShaderFile);
+	if (m_pLightingShader->m_programID == 0)
+	{
+		std::cout << "Could not load the deferred lighting shaders" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	// the samplers never change units
+	g_GLState.UseProgram(m_pLightingShader->m_programID);
+	m_pLightingShader->setSampler2DValue("gAlbedo", ALBEDO_TEXTURE_UNIT);
+	m_pLightingShader->setSampler2DValue("gNormal", NORMAL_TEXTURE_UNIT);
+	m_pLightingShader->setSampler2DValue("gDepth", DEPTH_TEXTURE_UNIT);
+
+	glGenVertexArrays(1, &m_screenVAO);
+	glGenBuffers(1, &m_lightBuffer);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the shaders, the targets
+ *  and the framebuffer.
+ ***********************************************************/
+void DeferredRenderer::Destroy()
+{
+	DestroyTargets();
+	if (m_screenVAO != 0)
+	{
+		g_GLState.DeleteVertexArray(m_screenVAO);
+		m_screenVAO = 0;
+	}
+	if (m_lightBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_lightBuffer);
+		m_lightBuffer = 0;
+	}
+	if (NULL != m_pGeometryShader)
+	{
+		glDeleteProgram(m_pGeometryShader->m_programID);
+		m_pGeometryShader->m_programID = 0;
+		delete m_pGeometryShader;
+		m_pGeometryShader = NULL;
+	}
+	if (NULL != m_pLightingShader)
+	{
+		glDeleteProgram(m_pLightingShader->m_programID);
+		m_pLightingShader->m_programID = 0;
+		delete m_pLightingShader;
+		m_pLightingShader = NULL;
+	}
+}
+
+/***********************************************************
+ *  CreateTargets()
+ *
+ *  This method is used for creating the G-buffer textures
+ *  and attaching them to the framebuffer. The normal target
+ *  keeps a flag in alpha for pixels that are already lit.
+ ***********************************************************/
+bool DeferredRenderer::CreateTargets(int width, int height)
+{
+	DestroyTargets();
+
+	m_albedoTexture = CreateTarget(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height);
+	m_normalTexture = CreateTarget(GL_RGBA16F, GL_RGBA, GL_FLOAT, width, height);
+	m_depthTexture = CreateTarget(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT, width, height);
+
+	glGenFramebuffers(1, &m_frameBuffer);
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_albedoTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_normalTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthTexture, 0);
+
+	GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, drawBuffers);
+
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (!bComplete)
+	{
+		std::cout << "The G-buffer framebuffer is not complete" << std::endl;
+		DestroyTargets();
+		return(false);
+	}
+
+	m_width = width;
+	m_height = height;
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyTargets()
+ *
+ *  This method is used for freeing the G-buffer textures.
+ ***********************************************************/
+void DeferredRenderer::DestroyTargets()
+{
+	if (m_frameBuffer != 0)
+	{
+		g_GLState.DeleteFramebuffer(m_frameBuffer);
+		m_frameBuffer = 0;
+	}
+
+	GLuint textures[3] = { m_albedoTexture, m_normalTexture, m_depthTexture };
+	for (int i = 0; i < 3; i++)
+	{
+		if (textures[i] != 0)
+		{
+			g_GLState.DeleteTextures(1, &textures[i]);
+		}
+	}
+	m_albedoTexture = 0;
+	m_normalTexture = 0;
+	m_depthTexture = 0;
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  BeginGeometryPass()
+ *
+ *  This method is used for binding and clearing the G-buffer.
+ *  The targets follow the size of the current viewport.
+ *  Blending is turned off so that the alpha channels keep
+ *  the values written by the shader.
+ ***********************************************************/
+void DeferredRenderer::BeginGeometryPass()
+{
+	GLint viewport[4];
+	g_GLState.GetViewport(viewport);
+	if ((viewport[2] != m_width) || (viewport[3] != m_height))
+	{
+		CreateTargets(viewport[2], viewport[3]);
+	}
+
+	// the scene may be drawn into an offscreen target
+	m_outputFrameBuffer = g_GLState.GetDrawFramebuffer();
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+	g_GLState.Disable(GL_BLEND);
+	g_GLState.Enable(GL_DEPTH_TEST);
+	g_GLState.DepthMask(GL_TRUE);
+	g_GLState.ClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	g_GLState.UseProgram(m_pGeometryShader->m_programID);
+}
+
+/***********************************************************
+ *  RenderLightingPass()
+ *
+ *  This method is used for lighting every covered pixel of
+ *  the G-buffer into the scene framebuffer. The pass also
+ *  writes the stored depth so that the forward objects drawn
+ *  afterwards are hidden behind the opaque scene.
+ ***********************************************************/
+void DeferredRenderer::RenderLightingPass()
+{
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, m_outputFrameBuffer);
+
+	g_GLState.UseProgram(m_pLightingShader->m_programID);
+
+	g_GLState.BindTexture(ALBEDO_TEXTURE_UNIT, GL_TEXTURE_2D, m_albedoTexture);
+	g_GLState.BindTexture(NORMAL_TEXTURE_UNIT, GL_TEXTURE_2D, m_normalTexture);
+	g_GLState.BindTexture(DEPTH_TEXTURE_UNIT, GL_TEXTURE_2D, m_depthTexture);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_STORAGE_BINDING, m_lightBuffer);
+
+	// every pixel is touched once, the shader replaces the
+	// depth with the G-buffer depth
+	g_GLState.DepthFunc(GL_ALWAYS);
+	g_GLState.BindVertexArray(m_screenVAO);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	g_GLState.DepthFunc(GL_LESS);
+
+	g_GLState.Enable(GL_BLEND);
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  This method is used for uploading the lights that the
+ *  lighting pass adds up for every pixel, and setting their
+ *  number into the lighting shader.
+ ***********************************************************/
+void DeferredRenderer::SetLights(const std::vector<DEFERRED_LIGHT>& lights)
+{
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_lightBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, lights.size() * sizeof(DEFERRED_LIGHT), lights.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	g_GLState.UseProgram(m_pLightingShader->m_programID);
+	m_pLightingShader->setIntValue("lightCount", static_cast<int>(lights.size()));
+}
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// deferredrenderer.h
+// ============
+// render the opaque scene into a G-buffer and light it in one screen pass
+//
+// The geometry pass writes the albedo, the normal and the depth of the
+// closest surface of every pixel. The lighting pass then evaluates the
+// scene lights once per pixel with a full-screen triangle, no matter how
+// many objects were drawn over each other. The lights are read from a
+// storage buffer, so the pass takes every light of the scene rather than
+// the fixed number of the forward shader. Transparent objects cannot be
+// stored in the G-buffer and are drawn with the forward shader afterwards.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// values of one light in the std430 layout of the LightStorage block of
+// the lighting shader
+struct DEFERRED_LIGHT
+{
+	glm::vec4 position;
+	glm::vec4 ambientColor;
+	glm::vec4 diffuseColor;
+	glm::vec4 specularColor;
+	float focalStrength;
+	float specularIntensity;
+	float padding[2];
+};
+
+class DeferredRenderer
+{
+public:
+	// constructor
+	DeferredRenderer();
+	// destructor
+	~DeferredRenderer();
+
+	// load the shaders of both passes
+	bool Initialize();
+	// free all OpenGL resources
+	void Destroy();
+
+	// bind the G-buffer, sized to the current viewport, and
+	// activate the geometry shader
+	void BeginGeometryPass();
+	// light the G-buffer into the framebuffer that was bound
+	// before the geometry pass with the lighting shader, keeping
+	// the scene depth for later passes
+	void RenderLightingPass();
+	// replace the lights of the lighting pass
+	void SetLights(const std::vector<DEFERRED_LIGHT>& lights);
+
+	ShaderManager* GetGeometryShader() { return m_pGeometryShader; }
+	ShaderManager* GetLightingShader() { return m_pLightingShader; }
+
+private:
+	ShaderManager* m_pGeometryShader;
+	ShaderManager* m_pLightingShader;
+
+	GLuint m_frameBuffer;
+	// albedo, normal and depth targets of the G-buffer
+	GLuint m_albedoTexture;
+	GLuint m_normalTexture;
+	GLuint m_depthTexture;
+	int m_width;
+	int m_height;
+	// empty vertex array for the full-screen triangle
+	GLuint m_screenVAO;
+	// framebuffer that the lit scene is written to
+	GLuint m_outputFrameBuffer;
+	// storage buffer of the lights
+	GLuint m_lightBuffer;
+
+	// create the G-buffer targets for the given size
+	bool CreateTargets(int width, int height);
+	void DestroyTargets();
+};
@@ -0,0 +1,250 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.cpp
+// ============
+// render the scene at a reduced resolution that follows the GPU frame time
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DynamicResolution.h"
+#include "GLStateCache.h"
+
+#include <cmath>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const float MIN_SCALE = 0.5f;
+	const float MAX_SCALE = 1.0f;
+	const float SCALE_STEP = 0.05f;
+	// the scale drops above this share of the budget and rises
+	// below the lower one
+	const double OVER_BUDGET = 1.0;
+	const double UNDER_BUDGET = 0.8;
+	// frames between changes, which leaves time for the timer
+	// queries of the new size to come back
+	const int SETTLE_FRAMES = 15;
+	// weight of the newest frame in the average GPU time
+	const double AVERAGE_WEIGHT = 0.1;
+}
+
+/***********************************************************
+ *  DynamicResolution()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DynamicResolution::DynamicResolution()
+{
+	m_frameBuffer = 0;
+	m_colorBuffer = 0;
+	m_depthBuffer = 0;
+	m_width = 0;
+	m_height = 0;
+	m_windowWidth = 0;
+	m_windowHeight = 0;
+	m_scale = MAX_SCALE;
+	m_averageGpuMs = 0.0;
+	m_framesSinceChange = 0;
+}
+
+/***********************************************************
+ *  ~DynamicResolution()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DynamicResolution::~DynamicResolution()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the offscreen target.
+ ***********************************************************/
+void DynamicResolution::Destroy()
+{
+	DestroyTargets();
+}
+
+/***********************************************************
+ *  CreateTargets()
+ *
+ *  This method is used for creating the offscreen color and
+ *  depth buffers. The depth format matches the default
+ *  framebuffer so that later passes can copy it.
+ ***********************************************************/
+bool DynamicResolution::CreateTargets(int width, int height)
+{
+	DestroyTargets();
+
+	glGenRenderbuffers(1, &m_colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_frameBuffer);
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (!bComplete)
+	{
+		std::cout << "The dynamic resolution framebuffer is not complete" << std::endl;
+		DestroyTargets();
+		return(false);
+	}
+
+	m_width = width;
+	m_height = height;
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyTargets()
+ *
+ *  This method is used for freeing the offscreen buffers.
+ ***********************************************************/
+void DynamicResolution::DestroyTargets()
+{
+	if (m_frameBuffer != 0)
+	{
+		g_GLState.DeleteFramebuffer(m_frameBuffer);
+		m_frameBuffer = 0;
+	}
+	if (m_colorBuffer != 0)
+	{
+		glDeleteRenderbuffers(1, &m_colorBuffer);
+		m_colorBuffer = 0;
+	}
+	if (m_depthBuffer != 0)
+	{
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+		m_depthBuffer = 0;
+	}
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  UpdateScale()
+ *
+ *  This method is used for moving the render scale toward
+ *  the budget. The pixel count goes with the square of the
+ *  scale, so the wanted scale is estimated from the square
+ *  root of the time ratio and reached one step at a time.
+ ***********************************************************/
+void DynamicResolution::UpdateScale(double gpuMs, double budgetMs)
+{
+	if ((gpuMs <= 0.0) || (budgetMs <= 0.0))
+	{
+		return;
+	}
+
+	if (m_averageGpuMs <= 0.0)
+	{
+		m_averageGpuMs = gpuMs;
+	}
+	m_averageGpuMs += (gpuMs - m_averageGpuMs) * AVERAGE_WEIGHT;
+
+	m_framesSinceChange++;
+	if (m_framesSinceChange < SETTLE_FRAMES)
+	{
+		return;
+	}
+
+	float scale = m_scale;
+	if (m_averageGpuMs > budgetMs * OVER_BUDGET)
+	{
+		float wanted = m_scale * static_cast<float>(sqrt(budgetMs / m_averageGpuMs));
+		float steps = ceilf((m_scale - wanted) / SCALE_STEP);
+		scale = m_scale - ((steps < 1.0f) ? 1.0f : steps) * SCALE_STEP;
+	}
+	else if (m_averageGpuMs < budgetMs * UNDER_BUDGET)
+	{
+		scale = m_scale + SCALE_STEP;
+	}
+
+	if (scale < MIN_SCALE)
+	{
+		scale = MIN_SCALE;
+	}
+	if (scale > MAX_SCALE)
+	{
+		scale = MAX_SCALE;
+	}
+
+	if (fabsf(scale - m_scale) > 0.001f)
+	{
+		m_scale = scale;
+		m_framesSinceChange = 0;
+		// the average still holds the old size
+		m_averageGpuMs = 0.0;
+		std::cout << "Render Scale " << static_cast<int>(m_scale * 100.0f + 0.5f) << "%\n";
+	}
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for binding the offscreen target at
+ *  the current render scale. Returns false when the target
+ *  could not be created, and the frame is then drawn to the
+ *  window directly.
+ ***********************************************************/
+bool DynamicResolution::BeginFrame(int windowWidth, int windowHeight, double gpuMs, double budgetMs)
+{
+	UpdateScale(gpuMs, budgetMs);
+
+	int width = static_cast<int>(windowWidth * m_scale + 0.5f);
+	int height = static_cast<int>(windowHeight * m_scale + 0.5f);
+	if (width < 1)
+	{
+		width = 1;
+	}
+	if (height < 1)
+	{
+		height = 1;
+	}
+
+	if ((width != m_width) || (height != m_height))
+	{
+		if (!CreateTargets(width, height))
+		{
+			return(false);
+		}
+	}
+
+	m_windowWidth = windowWidth;
+	m_windowHeight = windowHeight;
+
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+	g_GLState.Viewport(0, 0, m_width, m_height);
+
+	return(true);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for stretching the scene over the
+ *  window with bilinear filtering and restoring the window
+ *  viewport.
+ ***********************************************************/
+void DynamicResolution::EndFrame()
+{
+	g_GLState.BindFramebuffer(GL_READ_FRAMEBUFFER, m_frameBuffer);
+	g_GLState.BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(
+		0, 0, m_width, m_height,
+		0, 0, m_windowWidth, m_windowHeight,
+		GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, 0);
+	g_GLState.Viewport(0, 0, m_windowWidth, m_windowHeight);
+}
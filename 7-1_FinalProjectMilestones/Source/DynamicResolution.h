@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.h
+// ============
+// render the scene at a reduced resolution that follows the GPU frame time
+//
+// The scene is drawn into an offscreen target whose size is the window size
+// times a render scale, and the result is stretched over the window. After
+// every few frames the measured GPU time is compared with the frame budget.
+// The scale drops when the budget is exceeded and rises again when there is
+// clearly time left. The scale moves in fixed steps with a band between the
+// two thresholds, so the resolution does not flicker between two sizes and
+// the targets of the later passes are only rebuilt now and then.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+class DynamicResolution
+{
+public:
+	// constructor
+	DynamicResolution();
+	// destructor
+	~DynamicResolution();
+
+	// free the offscreen target
+	void Destroy();
+
+	// adjust the scale from the GPU time of a finished frame, then
+	// bind the offscreen target and set its viewport
+	bool BeginFrame(int windowWidth, int windowHeight, double gpuMs, double budgetMs);
+	// stretch the rendered scene over the default framebuffer
+	void EndFrame();
+
+	float GetScale() const { return m_scale; }
+
+private:
+	GLuint m_frameBuffer;
+	GLuint m_colorBuffer;
+	GLuint m_depthBuffer;
+	int m_width;
+	int m_height;
+	int m_windowWidth;
+	int m_windowHeight;
+
+	float m_scale;
+	// GPU time averaged over the recent frames
+	double m_averageGpuMs;
+	int m_framesSinceChange;
+
+	// choose the render scale for the measured time
+	void UpdateScale(double gpuMs, double budgetMs);
+	bool CreateTargets(int width, int height);
+	void DestroyTargets();
+};
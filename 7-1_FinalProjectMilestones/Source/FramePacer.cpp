@@ -0,0 +1,242 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacer.cpp
+// ============
+// pace the presented frames with the swap interval and a frame rate limit
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FramePacer.h"
+
+#include "GLFW/glfw3.h"
+
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+// declaration of global variables
+namespace
+{
+	// spin stretch used before any late wake-up was seen
+	const double INITIAL_SPIN_MS = 1.0;
+	// the spin stretch never grows past this
+	const double MAX_SPIN_MS = 4.0;
+	// slow decay of the spin stretch, so one late wake-up does
+	// not cost CPU time for the rest of the run
+	const double SPIN_DECAY = 0.995;
+}
+
+/***********************************************************
+ *  FramePacer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FramePacer::FramePacer()
+{
+	// no interval has been set by this class yet
+	m_swapInterval = -2;
+	m_bTimerPeriodSet = false;
+	m_bDeadlineValid = false;
+	m_spinMs = INITIAL_SPIN_MS;
+	m_bLastPresentValid = false;
+	m_intervalCount = 0;
+	m_intervalSumMs = 0.0;
+	m_intervalSquareSumMs = 0.0;
+	m_intervalMinMs = 0.0;
+	m_intervalMaxMs = 0.0;
+	m_lastIntervalMs = 0.0;
+	m_jitterSumMs = 0.0;
+	m_jitterCount = 0;
+}
+
+/***********************************************************
+ *  ~FramePacer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+	if (m_bTimerPeriodSet)
+	{
+		timeEndPeriod(1);
+	}
+#endif
+}
+
+/***********************************************************
+ *  SetSwapInterval()
+ *
+ *  This method is used for applying the swap interval. The
+ *  adaptive mode needs the swap control tear extension and
+ *  falls back to plain vsync without it.
+ ***********************************************************/
+void FramePacer::SetSwapInterval(int swapInterval)
+{
+	if (swapInterval == m_swapInterval)
+	{
+		return;
+	}
+	m_swapInterval = swapInterval;
+
+	if ((swapInterval < 0) &&
+		(!glfwExtensionSupported("WGL_EXT_swap_control_tear")) &&
+		(!glfwExtensionSupported("GLX_EXT_swap_control_tear")))
+	{
+		std::cout << "Adaptive vsync is not supported, using vsync" << std::endl;
+		swapInterval = 1;
+	}
+
+	glfwSwapInterval(swapInterval);
+}
+
+/***********************************************************
+ *  WaitForNextFrame()
+ *
+ *  This method is used for holding the frame until its
+ *  deadline. The deadlines are one period apart, so a
+ *  frame that finishes early does not move the later ones.
+ *  After a frame that missed its deadline by more than a
+ *  period, the grid starts again from now.
+ ***********************************************************/
+void FramePacer::WaitForNextFrame(double targetFps)
+{
+	if (targetFps <= 0.0)
+	{
+		m_bDeadlineValid = false;
+		return;
+	}
+
+#ifdef _WIN32
+	// the default scheduler tick is too coarse to sleep with
+	if (!m_bTimerPeriodSet)
+	{
+		timeBeginPeriod(1);
+		m_bTimerPeriodSet = true;
+	}
+#endif
+
+	Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+		std::chrono::duration<double>(1.0 / targetFps));
+	Clock::time_point now = Clock::now();
+	if ((!m_bDeadlineValid) || (now > m_nextDeadline + period))
+	{
+		m_nextDeadline = now + period;
+		m_bDeadlineValid = true;
+	}
+
+	// sleep in short slices while the deadline is far away
+	while (true)
+	{
+		std::chrono::duration<double, std::milli> remaining = m_nextDeadline - Clock::now();
+		if (remaining.count() <= m_spinMs + 1.0)
+		{
+			break;
+		}
+
+		Clock::time_point sleepStart = Clock::now();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		std::chrono::duration<double, std::milli> slept = Clock::now() - sleepStart;
+
+		// remember how late the sleep woke up
+		double lateMs = slept.count() - 1.0;
+		if (lateMs > m_spinMs)
+		{
+			m_spinMs = (lateMs < MAX_SPIN_MS) ? lateMs : MAX_SPIN_MS;
+		}
+	}
+
+	// spin the rest of the way
+	while (Clock::now() < m_nextDeadline)
+	{
+		std::this_thread::yield();
+	}
+
+	m_spinMs *= SPIN_DECAY;
+	if (m_spinMs < INITIAL_SPIN_MS)
+	{
+		m_spinMs = INITIAL_SPIN_MS;
+	}
+	m_nextDeadline += period;
+}
+
+/***********************************************************
+ *  FramePresented()
+ *
+ *  This method is used for adding the time since the last
+ *  presented frame to the statistics.
+ ***********************************************************/
+void FramePacer::FramePresented()
+{
+	Clock::time_point now = Clock::now();
+	if (m_bLastPresentValid)
+	{
+		std::chrono::duration<double, std::milli> interval = now - m_lastPresent;
+		double intervalMs = interval.count();
+
+		if (m_intervalCount == 0)
+		{
+			m_intervalMinMs = intervalMs;
+			m_intervalMaxMs = intervalMs;
+		}
+		else
+		{
+			m_jitterSumMs += fabs(intervalMs - m_lastIntervalMs);
+			m_jitterCount++;
+		}
+		m_intervalMinMs = (intervalMs < m_intervalMinMs) ? intervalMs : m_intervalMinMs;
+		m_intervalMaxMs = (intervalMs > m_intervalMaxMs) ? intervalMs : m_intervalMaxMs;
+		m_intervalSumMs += intervalMs;
+		m_intervalSquareSumMs += intervalMs * intervalMs;
+		m_intervalCount++;
+		m_lastIntervalMs = intervalMs;
+	}
+
+	m_lastPresent = now;
+	m_bLastPresentValid = true;
+}
+
+/***********************************************************
+ *  RestartInterval()
+ *
+ *  This method is used for leaving a pause out of the
+ *  statistics and the limiter grid.
+ ***********************************************************/
+void FramePacer::RestartInterval()
+{
+	m_bLastPresentValid = false;
+	m_bDeadlineValid = false;
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used for printing the frame intervals.
+ *  The jitter is the mean change between two successive
+ *  intervals.
+ ***********************************************************/
+void FramePacer::Report() const
+{
+	if (m_intervalCount == 0)
+	{
+		return;
+	}
+
+	double meanMs = m_intervalSumMs / m_intervalCount;
+	double variance = m_intervalSquareSumMs / m_intervalCount - meanMs * meanMs;
+	double jitterMs = (m_jitterCount > 0) ? (m_jitterSumMs / m_jitterCount) : 0.0;
+
+	std::cout << "PACING: frames=" << m_intervalCount
+		<< " interval_avg_ms=" << meanMs
+		<< " interval_stddev_ms=" << sqrt((variance > 0.0) ? variance : 0.0)
+		<< " interval_min_ms=" << m_intervalMinMs
+		<< " interval_max_ms=" << m_intervalMaxMs
+		<< " jitter_ms=" << jitterMs
+		<< std::endl;
+}
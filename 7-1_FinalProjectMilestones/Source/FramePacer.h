@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacer.h
+// ============
+// pace the presented frames with the swap interval and a frame rate limit
+//
+// The swap interval selects vsync on, off or adaptive, where adaptive only
+// tears when a frame misses the refresh. The limiter holds each frame until
+// its deadline on a fixed grid of the target rate. It sleeps while the
+// deadline is far away, which leaves the CPU to other processes, and spins
+// for the last stretch, because a sleep can wake up late. The spin stretch
+// follows the longest late wake-up seen so far. The time between presented
+// frames is collected to report how even the delivery was.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+
+class FramePacer
+{
+public:
+	// constructor
+	FramePacer();
+	// destructor
+	~FramePacer();
+
+	// set the swap interval of the current context, where -1 asks
+	// for adaptive vsync, only changing it when it differs
+	void SetSwapInterval(int swapInterval);
+	// wait for the deadline of the next frame, no wait for zero
+	void WaitForNextFrame(double targetFps);
+	// record the time since the last presented frame
+	void FramePresented();
+	// start the next interval fresh, such as after an idle wait
+	void RestartInterval();
+
+	// print the frame interval statistics
+	void Report() const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	int m_swapInterval;
+	bool m_bTimerPeriodSet;
+
+	// deadline of the next frame for the limiter
+	Clock::time_point m_nextDeadline;
+	bool m_bDeadlineValid;
+	// how late a sleep may return, the remaining wait is spun
+	double m_spinMs;
+
+	Clock::time_point m_lastPresent;
+	bool m_bLastPresentValid;
+	int m_intervalCount;
+	double m_intervalSumMs;
+	double m_intervalSquareSumMs;
+	double m_intervalMinMs;
+	double m_intervalMaxMs;
+	// change between successive intervals
+	double m_lastIntervalMs;
+	double m_jitterSumMs;
+	int m_jitterCount;
+};
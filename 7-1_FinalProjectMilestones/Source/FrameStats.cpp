@@ -0,0 +1,160 @@
+///////////////////////////////////////////////////////////////////////////////
+// framestats.cpp
+// ============
+// measure the CPU and GPU time spent on every rendered frame
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <iostream>
+
+/***********************************************************
+ *  FrameStats()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameStats::FrameStats()
+{
+	for (int i = 0; i < QUERY_COUNT; i++)
+	{
+		m_queries[i] = 0;
+		m_bQueryPending[i] = false;
+	}
+	m_queryIndex = 0;
+	m_bQueriesCreated = false;
+	m_lastGpuMs = 0.0;
+	Reset();
+}
+
+/***********************************************************
+ *  ~FrameStats()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameStats::~FrameStats()
+{
+	if (m_bQueriesCreated)
+	{
+		glDeleteQueries(QUERY_COUNT, m_queries);
+	}
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for clearing the collected times.
+ ***********************************************************/
+void FrameStats::Reset()
+{
+	m_frameCount = 0;
+	m_gpuFrameCount = 0;
+	m_cpuTotalMs = 0.0;
+	m_cpuMaxMs = 0.0;
+	m_gpuTotalMs = 0.0;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting the CPU timer and the
+ *  GPU timer query of a new frame. The query slot is read
+ *  back first if it is still holding an older frame.
+ ***********************************************************/
+void FrameStats::BeginFrame()
+{
+	// the queries need the OpenGL context, so they are
+	// created with the first frame
+	if (!m_bQueriesCreated)
+	{
+		glGenQueries(QUERY_COUNT, m_queries);
+		m_bQueriesCreated = true;
+	}
+
+	if (m_bQueryPending[m_queryIndex])
+	{
+		CollectQuery(m_queryIndex);
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, m_queries[m_queryIndex]);
+	m_frameStart = std::chrono::steady_clock::now();
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for stopping the timers of the frame.
+ ***********************************************************/
+void FrameStats::EndFrame()
+{
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_frameStart;
+	glEndQuery(GL_TIME_ELAPSED);
+
+	m_bQueryPending[m_queryIndex] = true;
+	m_queryIndex = (m_queryIndex + 1) % QUERY_COUNT;
+
+	m_frameCount++;
+	m_cpuTotalMs += elapsed.count();
+	m_cpuMaxMs = std::max(m_cpuMaxMs, elapsed.count());
+}
+
+/***********************************************************
+ *  CollectQuery()
+ *
+ *  This method is used for adding the GPU time of a query
+ *  to the totals. The query was issued several frames ago
+ *  so the result is normally available without waiting.
+ ***********************************************************/
+void FrameStats::CollectQuery(int index)
+{
+	GLuint64 nanoseconds = 0;
+	glGetQueryObjectui64v(m_queries[index], GL_QUERY_RESULT, &nanoseconds);
+	m_bQueryPending[index] = false;
+
+	m_lastGpuMs = nanoseconds / 1000000.0;
+	m_gpuTotalMs += m_lastGpuMs;
+	m_gpuFrameCount++;
+}
+
+/***********************************************************
+ *  GetAverageCpuMs()
+ *
+ *  This method is used for getting the average CPU time.
+ ***********************************************************/
+double FrameStats::GetAverageCpuMs() const
+{
+	if (m_frameCount == 0)
+	{
+		return(0.0);
+	}
+	return(m_cpuTotalMs / m_frameCount);
+}
+
+/***********************************************************
+ *  GetAverageGpuMs()
+ *
+ *  This method is used for getting the average GPU time.
+ ***********************************************************/
+double FrameStats::GetAverageGpuMs() const
+{
+	if (m_gpuFrameCount == 0)
+	{
+		return(0.0);
+	}
+	return(m_gpuTotalMs / m_gpuFrameCount);
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used for printing the collected averages.
+ ***********************************************************/
+void FrameStats::Report(const char* label) const
+{
+	std::cout << "BENCHMARK " << label
+		<< ": frames=" << m_frameCount
+		<< " cpu_avg_ms=" << GetAverageCpuMs()
+		<< " cpu_max_ms=" << m_cpuMaxMs
+		<< " gpu_avg_ms=" << GetAverageGpuMs()
+		<< std::endl;
+}
@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// framestats.h
+// ============
+// measure the CPU and GPU time spent on every rendered frame
+//
+// The GPU time is read from timer queries a few frames after they were
+// issued so that measuring never stalls the pipeline. The collected
+// averages are printed by the benchmark mode.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <chrono>
+
+class FrameStats
+{
+public:
+	// constructor
+	FrameStats();
+	// destructor
+	~FrameStats();
+
+	// call around all the rendering commands of one frame
+	void BeginFrame();
+	void EndFrame();
+
+	// forget the collected times, such as after the warm up frames
+	void Reset();
+
+	int GetFrameCount() const { return m_frameCount; }
+	double GetAverageCpuMs() const;
+	double GetAverageGpuMs() const;
+	// GPU time of the most recent frame that has finished
+	double GetLastGpuMs() const { return m_lastGpuMs; }
+
+	// print the averages under the given label
+	void Report(const char* label) const;
+
+private:
+	// frames between issuing a timer query and reading it back
+	static const int QUERY_COUNT = 4;
+
+	GLuint m_queries[QUERY_COUNT];
+	bool m_bQueryPending[QUERY_COUNT];
+	int m_queryIndex;
+	bool m_bQueriesCreated;
+
+	std::chrono::steady_clock::time_point m_frameStart;
+
+	int m_frameCount;
+	int m_gpuFrameCount;
+	double m_cpuTotalMs;
+	double m_cpuMaxMs;
+	double m_gpuTotalMs;
+	double m_lastGpuMs;
+
+	// read a finished query back into the totals
+	void CollectQuery(int index);
+};
@@ -0,0 +1,586 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.cpp
+// ============
+// shadow copy of the OpenGL state that drops redundant state calls
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLStateCache.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const GLenum g_TrackedCapabilities[] =
+	{
+		GL_BLEND,
+		GL_DEPTH_TEST,
+		GL_CULL_FACE,
+		GL_STENCIL_TEST,
+		GL_SCISSOR_TEST
+	};
+
+	/***********************************************************
+	 *  GetTargetSlot()
+	 *
+	 *  Map a texture target onto its remembered binding, or -1
+	 *  when the target is not tracked.
+	 ***********************************************************/
+	int GetTargetSlot(GLenum target)
+	{
+		if (target == GL_TEXTURE_2D)
+		{
+			return(0);
+		}
+		if (target == GL_TEXTURE_3D)
+		{
+			return(1);
+		}
+		return(-1);
+	}
+}
+
+/***********************************************************
+ *  GLStateCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GLStateCache::GLStateCache()
+{
+	m_issuedCalls = 0;
+	m_skippedCalls = 0;
+	m_totalIssued = 0;
+	m_totalSkipped = 0;
+	m_frameCount = 0;
+	m_lastIssued = 0;
+	m_lastSkipped = 0;
+
+	Invalidate();
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method is used for forgetting every remembered
+ *  value, so that the next call for each is forwarded.
+ ***********************************************************/
+void GLStateCache::Invalidate()
+{
+	for (int i = 0; i < CAPABILITY_COUNT; i++)
+	{
+		m_capabilities[i] = -1;
+	}
+
+	m_bBlendFuncKnown = false;
+	m_blendSource = GL_ONE;
+	m_blendDestination = GL_ZERO;
+	m_bDepthMaskKnown = false;
+	m_bDepthMask = GL_TRUE;
+	m_bDepthFuncKnown = false;
+	m_depthFunc = GL_LESS;
+	m_bClearColorKnown = false;
+	for (int i = 0; i < 4; i++)
+	{
+		m_clearColor[i] = 0.0f;
+		m_viewport[i] = 0;
+	}
+	m_bViewportKnown = false;
+
+	m_bProgramKnown = false;
+	m_program = 0;
+	InvalidateVertexArray();
+	m_bActiveUnitKnown = false;
+	m_activeUnit = 0;
+	for (int unit = 0; unit < TRACKED_TEXTURE_UNITS; unit++)
+	{
+		for (int slot = 0; slot < 2; slot++)
+		{
+			m_bTexturesKnown[unit][slot] = false;
+			m_textures[unit][slot] = 0;
+		}
+	}
+	m_bDrawFramebufferKnown = false;
+	m_drawFramebuffer = 0;
+	m_bReadFramebufferKnown = false;
+	m_readFramebuffer = 0;
+}
+
+/***********************************************************
+ *  Issue()
+ *
+ *  This method is used for counting a state call, returns
+ *  true when it has to reach the driver.
+ ***********************************************************/
+bool GLStateCache::Issue(bool bChanged)
+{
+	if (bChanged)
+	{
+		m_issuedCalls++;
+	}
+	else
+	{
+		m_skippedCalls++;
+	}
+	return(bChanged);
+}
+
+/***********************************************************
+ *  FindCapability()
+ *
+ *  This method is used for finding the remembered state of
+ *  a capability, -1 when it is not tracked.
+ ***********************************************************/
+int GLStateCache::FindCapability(GLenum capability) const
+{
+	for (int i = 0; i < CAPABILITY_COUNT; i++)
+	{
+		if (g_TrackedCapabilities[i] == capability)
+		{
+			return(i);
+		}
+	}
+	return(-1);
+}
+
+/***********************************************************
+ *  SetCapability()
+ *
+ *  This method is used for enabling or disabling a
+ *  capability when its state differs.
+ ***********************************************************/
+void GLStateCache::SetCapability(GLenum capability, bool bEnable)
+{
+	int index = FindCapability(capability);
+	int state = bEnable ? 1 : 0;
+	if (index >= 0)
+	{
+		if (!Issue(m_capabilities[index] != state))
+		{
+			return;
+		}
+		m_capabilities[index] = state;
+	}
+	else
+	{
+		Issue(true);
+	}
+
+	if (bEnable)
+	{
+		glEnable(capability);
+	}
+	else
+	{
+		glDisable(capability);
+	}
+}
+
+/***********************************************************
+ *  Enable()
+ *
+ *  This method is used for enabling a capability.
+ ***********************************************************/
+void GLStateCache::Enable(GLenum capability)
+{
+	SetCapability(capability, true);
+}
+
+/***********************************************************
+ *  Disable()
+ *
+ *  This method is used for disabling a capability.
+ ***********************************************************/
+void GLStateCache::Disable(GLenum capability)
+{
+	SetCapability(capability, false);
+}
+
+/***********************************************************
+ *  BlendFunc()
+ *
+ *  This method is used for setting the blend function of
+ *  all draw buffers.
+ ***********************************************************/
+void GLStateCache::BlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+	bool bChanged = (!m_bBlendFuncKnown) ||
+		(m_blendSource != sourceFactor) ||
+		(m_blendDestination != destinationFactor);
+	if (!Issue(bChanged))
+	{
+		return;
+	}
+
+	glBlendFunc(sourceFactor, destinationFactor);
+	m_bBlendFuncKnown = true;
+	m_blendSource = sourceFactor;
+	m_blendDestination = destinationFactor;
+}
+
+/***********************************************************
+ *  BlendFunci()
+ *
+ *  This method is used for setting the blend function of
+ *  one draw buffer. It is always forwarded.
+ ***********************************************************/
+void GLStateCache::BlendFunci(GLuint buffer, GLenum sourceFactor, GLenum destinationFactor)
+{
+	Issue(true);
+	glBlendFunci(buffer, sourceFactor, destinationFactor);
+	m_bBlendFuncKnown = false;
+}
+
+/***********************************************************
+ *  DepthMask()
+ *
+ *  This method is used for turning depth writes on or off.
+ ***********************************************************/
+void GLStateCache::DepthMask(GLboolean bWrite)
+{
+	if (!Issue((!m_bDepthMaskKnown) || (m_bDepthMask != bWrite)))
+	{
+		return;
+	}
+
+	glDepthMask(bWrite);
+	m_bDepthMaskKnown = true;
+	m_bDepthMask = bWrite;
+}
+
+/***********************************************************
+ *  DepthFunc()
+ *
+ *  This method is used for setting the depth comparison.
+ ***********************************************************/
+void GLStateCache::DepthFunc(GLenum function)
+{
+	if (!Issue((!m_bDepthFuncKnown) || (m_depthFunc != function)))
+	{
+		return;
+	}
+
+	glDepthFunc(function);
+	m_bDepthFuncKnown = true;
+	m_depthFunc = function;
+}
+
+/***********************************************************
+ *  ClearColor()
+ *
+ *  This method is used for setting the color of clears.
+ ***********************************************************/
+void GLStateCache::ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+	bool bChanged = (!m_bClearColorKnown) ||
+		(m_clearColor[0] != red) ||
+		(m_clearColor[1] != green) ||
+		(m_clearColor[2] != blue) ||
+		(m_clearColor[3] != alpha);
+	if (!Issue(bChanged))
+	{
+		return;
+	}
+
+	glClearColor(red, green, blue, alpha);
+	m_bClearColorKnown = true;
+	m_clearColor[0] = red;
+	m_clearColor[1] = green;
+	m_clearColor[2] = blue;
+	m_clearColor[3] = alpha;
+}
+
+/***********************************************************
+ *  Viewport()
+ *
+ *  This method is used for setting the viewport.
+ ***********************************************************/
+void GLStateCache::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	bool bChanged = (!m_bViewportKnown) ||
+		(m_viewport[0] != x) ||
+		(m_viewport[1] != y) ||
+		(m_viewport[2] != width) ||
+		(m_viewport[3] != height);
+	if (!Issue(bChanged))
+	{
+		return;
+	}
+
+	glViewport(x, y, width, height);
+	m_bViewportKnown = true;
+	m_viewport[0] = x;
+	m_viewport[1] = y;
+	m_viewport[2] = width;
+	m_viewport[3] = height;
+}
+
+/***********************************************************
+ *  UseProgram()
+ *
+ *  This method is used for making a shader program active.
+ ***********************************************************/
+void GLStateCache::UseProgram(GLuint program)
+{
+	if (!Issue((!m_bProgramKnown) || (m_program != program)))
+	{
+		return;
+	}
+
+	glUseProgram(program);
+	m_bProgramKnown = true;
+	m_program = program;
+}
+
+/***********************************************************
+ *  BindVertexArray()
+ *
+ *  This method is used for binding a vertex array.
+ ***********************************************************/
+void GLStateCache::BindVertexArray(GLuint vertexArray)
+{
+	if (!Issue((!m_bVertexArrayKnown) || (m_vertexArray != vertexArray)))
+	{
+		return;
+	}
+
+	glBindVertexArray(vertexArray);
+	m_bVertexArrayKnown = true;
+	m_vertexArray = vertexArray;
+}
+
+/***********************************************************
+ *  InvalidateVertexArray()
+ *
+ *  This method is used for forgetting the vertex array
+ *  after code outside the cache has bound one.
+ ***********************************************************/
+void GLStateCache::InvalidateVertexArray()
+{
+	m_bVertexArrayKnown = false;
+	m_vertexArray = 0;
+}
+
+/***********************************************************
+ *  ActiveTexture()
+ *
+ *  This method is used for selecting the texture unit that
+ *  the next binding applies to.
+ ***********************************************************/
+void GLStateCache::ActiveTexture(GLuint unit)
+{
+	if (!Issue((!m_bActiveUnitKnown) || (m_activeUnit != unit)))
+	{
+		return;
+	}
+
+	glActiveTexture(GL_TEXTURE0 + unit);
+	m_bActiveUnitKnown = true;
+	m_activeUnit = unit;
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method is used for binding a texture to a unit.
+ *  The unit is only selected when the binding changes, so
+ *  rebinding the same texture costs no calls at all.
+ ***********************************************************/
+void GLStateCache::BindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+	int slot = GetTargetSlot(target);
+	bool bTracked = (slot >= 0) && (unit < TRACKED_TEXTURE_UNITS);
+	if (bTracked)
+	{
+		bool bChanged = (!m_bTexturesKnown[unit][slot]) || (m_textures[unit][slot] != texture);
+		if (!Issue(bChanged))
+		{
+			return;
+		}
+		m_bTexturesKnown[unit][slot] = true;
+		m_textures[unit][slot] = texture;
+	}
+	else
+	{
+		Issue(true);
+	}
+
+	ActiveTexture(unit);
+	glBindTexture(target, texture);
+}
+
+/***********************************************************
+ *  BindFramebuffer()
+ *
+ *  This method is used for binding a framebuffer for
+ *  drawing, reading or both.
+ ***********************************************************/
+void GLStateCache::BindFramebuffer(GLenum target, GLuint frameBuffer)
+{
+	bool bDraw = (target == GL_FRAMEBUFFER) || (target == GL_DRAW_FRAMEBUFFER);
+	bool bRead = (target == GL_FRAMEBUFFER) || (target == GL_READ_FRAMEBUFFER);
+	bool bChanged =
+		(bDraw && ((!m_bDrawFramebufferKnown) || (m_drawFramebuffer != frameBuffer))) ||
+		(bRead && ((!m_bReadFramebufferKnown) || (m_readFramebuffer != frameBuffer)));
+	if (!Issue(bChanged))
+	{
+		return;
+	}
+
+	glBindFramebuffer(target, frameBuffer);
+	if (bDraw)
+	{
+		m_bDrawFramebufferKnown = true;
+		m_drawFramebuffer = frameBuffer;
+	}
+	if (bRead)
+	{
+		m_bReadFramebufferKnown = true;
+		m_readFramebuffer = frameBuffer;
+	}
+}
+
+/***********************************************************
+ *  DeleteTextures()
+ *
+ *  This method is used for deleting textures. OpenGL
+ *  unbinds a deleted texture from every unit, and the name
+ *  may be handed out again, so its bindings are forgotten.
+ ***********************************************************/
+void GLStateCache::DeleteTextures(GLsizei count, const GLuint* textures)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		for (int unit = 0; unit < TRACKED_TEXTURE_UNITS; unit++)
+		{
+			for (int slot = 0; slot < 2; slot++)
+			{
+				if ((m_textures[unit][slot] == textures[i]) && (textures[i] != 0))
+				{
+					m_textures[unit][slot] = 0;
+				}
+			}
+		}
+	}
+	glDeleteTextures(count, textures);
+}
+
+/***********************************************************
+ *  DeleteVertexArray()
+ *
+ *  This method is used for deleting a vertex array, which
+ *  reverts the binding to zero when it was bound.
+ ***********************************************************/
+void GLStateCache::DeleteVertexArray(GLuint vertexArray)
+{
+	if ((vertexArray != 0) && (m_vertexArray == vertexArray))
+	{
+		m_vertexArray = 0;
+	}
+	glDeleteVertexArrays(1, &vertexArray);
+}
+
+/***********************************************************
+ *  DeleteFramebuffer()
+ *
+ *  This method is used for deleting a framebuffer, which
+ *  reverts its bindings to the default framebuffer.
+ ***********************************************************/
+void GLStateCache::DeleteFramebuffer(GLuint frameBuffer)
+{
+	if (frameBuffer != 0)
+	{
+		if (m_drawFramebuffer == frameBuffer)
+		{
+			m_drawFramebuffer = 0;
+		}
+		if (m_readFramebuffer == frameBuffer)
+		{
+			m_readFramebuffer = 0;
+		}
+	}
+	glDeleteFramebuffers(1, &frameBuffer);
+}
+
+/***********************************************************
+ *  GetDrawFramebuffer()
+ *
+ *  This method is used for getting the framebuffer that is
+ *  drawn into. The driver is only asked while it is unknown.
+ ***********************************************************/
+GLuint GLStateCache::GetDrawFramebuffer()
+{
+	if (!m_bDrawFramebufferKnown)
+	{
+		GLint frameBuffer = 0;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &frameBuffer);
+		m_bDrawFramebufferKnown = true;
+		m_drawFramebuffer = static_cast<GLuint>(frameBuffer);
+	}
+	return(m_drawFramebuffer);
+}
+
+/***********************************************************
+ *  GetViewport()
+ *
+ *  This method is used for getting the viewport. The driver
+ *  is only asked while it is unknown.
+ ***********************************************************/
+void GLStateCache::GetViewport(GLint viewport[4])
+{
+	if (!m_bViewportKnown)
+	{
+		glGetIntegerv(GL_VIEWPORT, m_viewport);
+		m_bViewportKnown = true;
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		viewport[i] = m_viewport[i];
+	}
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting the counts of a frame.
+ ***********************************************************/
+void GLStateCache::BeginFrame()
+{
+	m_issuedCalls = 0;
+	m_skippedCalls = 0;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for adding the counts of the frame
+ *  to the totals.
+ ***********************************************************/
+void GLStateCache::EndFrame()
+{
+	m_lastIssued = m_issuedCalls;
+	m_lastSkipped = m_skippedCalls;
+	m_totalIssued += m_issuedCalls;
+	m_totalSkipped += m_skippedCalls;
+	m_frameCount++;
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used for printing the state call counts
+ *  in a single line that scripts can compare between runs.
+ ***********************************************************/
+void GLStateCache::Report() const
+{
+	if (m_frameCount == 0)
+	{
+		return;
+	}
+
+	double frames = static_cast<double>(m_frameCount);
+	std::cout << "GLSTATE: frames=" << m_frameCount
+		<< " issued_per_frame=" << (m_totalIssued / frames)
+		<< " skipped_per_frame=" << (m_totalSkipped / frames)
+		<< " last_issued=" << m_lastIssued
+		<< " last_skipped=" << m_lastSkipped << std::endl;
+}
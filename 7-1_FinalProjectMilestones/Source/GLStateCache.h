@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.h
+// ============
+// shadow copy of the OpenGL state that drops redundant state calls
+//
+// The renderers change state through this cache instead of calling OpenGL
+// directly. It remembers the last value of each tracked piece of state and
+// only forwards a call when the value differs, counting the calls that were
+// issued and the ones that were skipped each frame. Values start out as
+// unknown, so the first call for each always reaches the driver. Code that
+// changes state behind the cache has to invalidate what it touched.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+class GLStateCache
+{
+public:
+	// texture units whose bindings are remembered, higher units
+	// are always forwarded
+	static const int TRACKED_TEXTURE_UNITS = 16;
+	// unit that new textures are bound to while they are filled,
+	// so that creating a texture never replaces one in use
+	static const int UPLOAD_TEXTURE_UNIT = 13;
+
+	// constructor
+	GLStateCache();
+
+	// forget all values, for after state was changed directly
+	void Invalidate();
+
+	void Enable(GLenum capability);
+	void Disable(GLenum capability);
+	void BlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+	// set the blending of one draw buffer, which leaves the
+	// shared blend function unknown
+	void BlendFunci(GLuint buffer, GLenum sourceFactor, GLenum destinationFactor);
+	void DepthMask(GLboolean bWrite);
+	void DepthFunc(GLenum function);
+	void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+	void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+	void UseProgram(GLuint program);
+	void BindVertexArray(GLuint vertexArray);
+	// bind a 2D or 3D texture to a unit, selecting the unit only
+	// when the binding has to change
+	void BindTexture(GLuint unit, GLenum target, GLuint texture);
+	// target is GL_FRAMEBUFFER, GL_DRAW_FRAMEBUFFER or GL_READ_FRAMEBUFFER
+	void BindFramebuffer(GLenum target, GLuint frameBuffer);
+
+	// delete objects and clear the bindings that referred to them
+	void DeleteTextures(GLsizei count, const GLuint* textures);
+	void DeleteVertexArray(GLuint vertexArray);
+	void DeleteFramebuffer(GLuint frameBuffer);
+
+	// the vertex array binding was changed behind the cache
+	void InvalidateVertexArray();
+
+	// read back state without a round trip to the driver once
+	// the value is known
+	GLuint GetDrawFramebuffer();
+	void GetViewport(GLint viewport[4]);
+
+	// per-frame counting of the forwarded and dropped calls
+	void BeginFrame();
+	void EndFrame();
+	// print the average counts of the measured frames
+	void Report() const;
+
+private:
+	// enable state of the capabilities the renderers use
+	enum TRACKED_CAPABILITY
+	{
+		CAPABILITY_BLEND,
+		CAPABILITY_DEPTH_TEST,
+		CAPABILITY_CULL_FACE,
+		CAPABILITY_STENCIL_TEST,
+		CAPABILITY_SCISSOR_TEST,
+		CAPABILITY_COUNT
+	};
+
+	// -1 unknown, 0 disabled, 1 enabled
+	int m_capabilities[CAPABILITY_COUNT];
+
+	bool m_bBlendFuncKnown;
+	GLenum m_blendSource;
+	GLenum m_blendDestination;
+	bool m_bDepthMaskKnown;
+	GLboolean m_bDepthMask;
+	bool m_bDepthFuncKnown;
+	GLenum m_depthFunc;
+	bool m_bClearColorKnown;
+	GLfloat m_clearColor[4];
+	bool m_bViewportKnown;
+	GLint m_viewport[4];
+
+	bool m_bProgramKnown;
+	GLuint m_program;
+	bool m_bVertexArrayKnown;
+	GLuint m_vertexArray;
+	bool m_bActiveUnitKnown;
+	GLuint m_activeUnit;
+	bool m_bTexturesKnown[TRACKED_TEXTURE_UNITS][2];
+	GLuint m_textures[TRACKED_TEXTURE_UNITS][2];
+	bool m_bDrawFramebufferKnown;
+	GLuint m_drawFramebuffer;
+	bool m_bReadFramebufferKnown;
+	GLuint m_readFramebuffer;
+
+	// calls of the current frame
+	int m_issuedCalls;
+	int m_skippedCalls;
+	// totals of the measured frames
+	long long m_totalIssued;
+	long long m_totalSkipped;
+	int m_frameCount;
+	int m_lastIssued;
+	int m_lastSkipped;
+
+	int FindCapability(GLenum capability) const;
+	void SetCapability(GLenum capability, bool bEnable);
+	void ActiveTexture(GLuint unit);
+	// returns true when the call has to be forwarded
+	bool Issue(bool bChanged);
+};
+
+// the cache is defined in MainCode.cpp, all rendering shares
+// the one OpenGL context
+extern GLStateCache g_GLState;
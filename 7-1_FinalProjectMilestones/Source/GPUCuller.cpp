@@ -0,0 +1,329 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculler.cpp
+// ============
+// cull the objects on the GPU and draw the survivors with indirect calls
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GPUCuller.h"
+#include "ShaderCache.h"
+#include "GLStateCache.h"
+#include "HiZBuffer.h"
+
+#include <iostream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	const char* g_CullShaderFile = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/cullObjectsShader.glsl";
+
+	// storage buffer bindings shared with the scene shaders
+	const GLuint OBJECT_STORAGE_BINDING = 2;
+	const GLuint GROUP_STORAGE_BINDING = 3;
+	const GLuint COMMAND_STORAGE_BINDING = 4;
+	const GLuint COUNT_STORAGE_BINDING = 5;
+
+	// threads of one work group of the culling shader
+	const uint32_t CULL_GROUP_SIZE = 64;
+	// levels of detail the shader has thresholds for
+	const int MAX_LOD_THRESHOLDS = 3;
+
+	// layout of the commands read by glMultiDrawElementsIndirect
+	struct DRAW_ELEMENTS_COMMAND
+	{
+		uint32_t count;
+		uint32_t instanceCount;
+		uint32_t firstIndex;
+		int32_t baseVertex;
+		uint32_t baseInstance;
+	};
+
+	/***********************************************************
+	 *  ClearBuffer()
+	 *
+	 *  Fill a buffer with zeros on the GPU.
+	 ***********************************************************/
+	void ClearBuffer(GLuint buffer)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+		glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+	}
+}
+
+/***********************************************************
+ *  GPUCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GPUCuller::GPUCuller()
+{
+	m_pCullShader = NULL;
+	m_objectBuffer = 0;
+	m_groupBuffer = 0;
+	m_commandBuffer = 0;
+	m_countBuffer = 0;
+	m_objectCount = 0;
+	m_commandCount = 0;
+	m_bIndirectCount = false;
+	m_pyramidTexture = 0;
+	m_pyramidWidth = 0;
+	m_pyramidHeight = 0;
+	m_pyramidLevels = 0;
+}
+
+/***********************************************************
+ *  ~GPUCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GPUCuller::~GPUCuller()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the culling shader and
+ *  creating the buffers. Compute shaders are required, the
+ *  indirect count call is used when the driver has it.
+ ***********************************************************/
+bool GPUCuller::Initialize()
+{
+	if ((!GLEW_VERSION_4_3) && (!GLEW_ARB_compute_shader))
+	{
+		std::cout << "Compute shaders are not supported for the GPU culling" << std::endl;
+		return(false);
+	}
+
+	m_pCullShader = new ShaderManager();
+	m_pCullShader->m_programID = LoadComputeProgram(g_CullShaderFile);
+	if (m_pCullShader->m_programID == 0)
+	{
+		std::cout << "Could not load the culling shader" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	GLuint buffers[4];
+	glGenBuffers(4, buffers);
+	m_objectBuffer = buffers[0];
+	m_groupBuffer = buffers[1];
+	m_commandBuffer = buffers[2];
+	m_countBuffer = buffers[3];
+
+	m_bIndirectCount = ((GLEW_VERSION_4_6) || (GLEW_ARB_indirect_parameters));
+	std::cout << "GPU culling draws " << (m_bIndirectCount ? "the written commands" : "every command slot")
+		<< " of each group" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the shader and buffers.
+ ***********************************************************/
+void GPUCuller::Destroy()
+{
+	GLuint buffers[4] = { m_objectBuffer, m_groupBuffer, m_commandBuffer, m_countBuffer };
+	for (int i = 0; i < 4; i++)
+	{
+		if (buffers[i] != 0)
+		{
+			glDeleteBuffers(1, &buffers[i]);
+		}
+	}
+	m_objectBuffer = 0;
+	m_groupBuffer = 0;
+	m_commandBuffer = 0;
+	m_countBuffer = 0;
+	m_objectCount = 0;
+	m_commandCount = 0;
+	m_groups.clear();
+
+	if (NULL != m_pCullShader)
+	{
+		glDeleteProgram(m_pCullShader->m_programID);
+		m_pCullShader->m_programID = 0;
+		delete m_pCullShader;
+		m_pCullShader = NULL;
+	}
+}
+
+/***********************************************************
+ *  SetLodThresholds()
+ *
+ *  This method is used for setting the share of the screen
+ *  height below which the next coarser level is used.
+ ***********************************************************/
+void GPUCuller::SetLodThresholds(const float* coverage, int count, float hysteresis)
+{
+	if (NULL == m_pCullShader)
+	{
+		return;
+	}
+
+	g_GLState.UseProgram(m_pCullShader->m_programID);
+	for (int i = 0; i < MAX_LOD_THRESHOLDS; i++)
+	{
+		// levels past the given thresholds are never reached
+		float threshold = ((i < count) ? coverage[i] : 0.0f);
+		m_pCullShader->setFloatValue(("lodCoverage[" + std::to_string(i) + "]").c_str(), threshold);
+	}
+	m_pCullShader->setFloatValue("lodHysteresis", hysteresis);
+}
+
+/***********************************************************
+ *  SetScene()
+ *
+ *  This method is used for uploading the objects and the
+ *  draw groups, and sizing the command buffer.
+ ***********************************************************/
+void GPUCuller::SetScene(
+	const std::vector<GPU_OBJECT>& objects,
+	const std::vector<GPU_DRAW_GROUP>& groups,
+	uint32_t commandCount)
+{
+	m_objectCount = static_cast<uint32_t>(objects.size());
+	m_commandCount = commandCount;
+	m_groups = groups;
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_objectBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, objects.size() * sizeof(GPU_OBJECT), objects.data(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_groupBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, groups.size() * sizeof(GPU_DRAW_GROUP), groups.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, commandCount * sizeof(DRAW_ELEMENTS_COMMAND), NULL, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, groups.size() * sizeof(uint32_t), NULL, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	// the scene shaders read the objects through their storage
+	// block for the rest of the run
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_STORAGE_BINDING, m_objectBuffer);
+}
+
+/***********************************************************
+ *  UpdateObject()
+ *
+ *  This method is used for writing the values of a moved
+ *  object over its old ones.
+ ***********************************************************/
+void GPUCuller::UpdateObject(uint32_t index, const GPU_OBJECT& object)
+{
+	if (index >= m_objectCount)
+	{
+		return;
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_objectBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, index * sizeof(GPU_OBJECT), sizeof(GPU_OBJECT), &object);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  SetOcclusionPyramid()
+ *
+ *  This method is used for setting the depth pyramid that
+ *  the culling shader tests the objects against after the
+ *  frustum. The pyramid is owned by the caller.
+ ***********************************************************/
+void GPUCuller::SetOcclusionPyramid(GLuint texture, int width, int height, int levelCount)
+{
+	m_pyramidTexture = texture;
+	m_pyramidWidth = width;
+	m_pyramidHeight = height;
+	m_pyramidLevels = levelCount;
+}
+
+/***********************************************************
+ *  Cull()
+ *
+ *  This method is used for running the culling shader with
+ *  one thread per object. The counts start from zero every
+ *  frame, and without the indirect count the slots are
+ *  cleared too so the unused ones draw nothing.
+ ***********************************************************/
+void GPUCuller::Cull(bool bSelectLod, GLuint restoreProgram)
+{
+	if ((NULL == m_pCullShader) || (m_objectCount == 0))
+	{
+		return;
+	}
+
+	ClearBuffer(m_countBuffer);
+	if (!m_bIndirectCount)
+	{
+		ClearBuffer(m_commandBuffer);
+	}
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	g_GLState.UseProgram(m_pCullShader->m_programID);
+	m_pCullShader->setIntValue("objectCount", static_cast<int>(m_objectCount));
+	m_pCullShader->setBoolValue("bSelectLod", bSelectLod);
+	m_pCullShader->setBoolValue("bOcclusion", m_pyramidTexture != 0);
+	if (m_pyramidTexture != 0)
+	{
+		g_GLState.BindTexture(HiZBuffer::PYRAMID_TEXTURE_UNIT, GL_TEXTURE_2D, m_pyramidTexture);
+		m_pCullShader->setSampler2DValue("hiZTexture", HiZBuffer::PYRAMID_TEXTURE_UNIT);
+		m_pCullShader->setVec2Value("hiZSize", glm::vec2(m_pyramidWidth, m_pyramidHeight));
+		m_pCullShader->setIntValue("hiZLevelCount", m_pyramidLevels);
+	}
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_STORAGE_BINDING, m_objectBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GROUP_STORAGE_BINDING, m_groupBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_STORAGE_BINDING, m_commandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COUNT_STORAGE_BINDING, m_countBuffer);
+	glDispatchCompute((m_objectCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+	// the commands and counts are read as draw parameters, and
+	// the chosen levels by the vertex shaders of the frame
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+	g_GLState.UseProgram(restoreProgram);
+}
+
+/***********************************************************
+ *  DrawGroup()
+ *
+ *  This method is used for drawing the commands that the
+ *  culling shader wrote for a group.
+ ***********************************************************/
+void GPUCuller::DrawGroup(uint32_t group)
+{
+	if (group >= m_groups.size())
+	{
+		return;
+	}
+
+	uint32_t firstCommand = m_groups[group].firstCommand;
+	uint32_t endCommand = ((group + 1 < m_groups.size()) ? m_groups[group + 1].firstCommand : m_commandCount);
+	GLsizei slotCount = static_cast<GLsizei>(endCommand - firstCommand);
+	if (slotCount <= 0)
+	{
+		return;
+	}
+
+	const void* pCommands = reinterpret_cast<const void*>(
+		static_cast<uintptr_t>(firstCommand) * sizeof(DRAW_ELEMENTS_COMMAND));
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+	if (!m_bIndirectCount)
+	{
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, pCommands, slotCount, 0);
+	}
+	else
+	{
+		GLintptr countOffset = static_cast<GLintptr>(group * sizeof(uint32_t));
+		glBindBuffer(GL_PARAMETER_BUFFER, m_countBuffer);
+		if (GLEW_VERSION_4_6)
+		{
+			glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, pCommands, countOffset, slotCount, 0);
+		}
+		else
+		{
+			glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, pCommands, countOffset, slotCount, 0);
+		}
+		glBindBuffer(GL_PARAMETER_BUFFER, 0);
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
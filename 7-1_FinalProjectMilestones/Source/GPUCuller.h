@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculler.h
+// ============
+// cull the objects on the GPU and draw the survivors with indirect calls
+//
+// The objects live in a storage buffer with their transform, color, bounding
+// sphere and mesh box. Every frame a compute shader tests one object per thread
+// against the frustum of the camera block and, when one is set, the depth
+// pyramid of the occluders, picks its level of detail and appends a draw
+// command for it to the range of its draw group, counting the commands of
+// each group with an atomic. A draw group holds the objects
+// that share a mesh and an appearance, so the CPU only issues one indirect
+// call per group no matter how many objects the scene holds. The vertex
+// shader finds the values of an object through the base instance of its
+// command. Drivers without the indirect count call draw every slot of the
+// group, and the slots left over from the cull are cleared to empty draws.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// values of one object in the std430 layout of the ObjectStorage
+// block of the scene and culling shaders
+struct GPU_OBJECT
+{
+	glm::mat4 model;
+	glm::mat4 normalMatrix;
+	glm::vec4 color;
+	glm::vec4 lightmapScaleOffset;
+	// bounding sphere in world space, the radius in w
+	glm::vec4 bounds;
+	// center and half size of the box around the mesh before
+	// the model transform, for the occlusion test
+	glm::vec4 boxCenter;
+	glm::vec4 boxExtents;
+	// first draw group of the object, one per level of detail
+	uint32_t firstGroup;
+	uint32_t lodCount;
+	// level chosen in the last frame, written by the shader
+	uint32_t lodLevel;
+	uint32_t padding;
+};
+
+// meshes drawn by one indirect call
+struct GPU_DRAW_GROUP
+{
+	uint32_t indexCount;
+	// slots of the group in the command buffer
+	uint32_t firstCommand;
+};
+
+class GPUCuller
+{
+public:
+	// constructor
+	GPUCuller();
+	// destructor
+	~GPUCuller();
+
+	// load the culling shader and create the buffers
+	bool Initialize();
+	// free all OpenGL resources
+	void Destroy();
+
+	// set the coverage below which each coarser level is used
+	void SetLodThresholds(const float* coverage, int count, float hysteresis);
+
+	// replace the objects and groups, with one command slot for
+	// every object in the group of each of its levels
+	void SetScene(
+		const std::vector<GPU_OBJECT>& objects,
+		const std::vector<GPU_DRAW_GROUP>& groups,
+		uint32_t commandCount);
+	// write the new values of one object
+	void UpdateObject(uint32_t index, const GPU_OBJECT& object);
+
+	// test the objects against the depth pyramid of the occluders
+	// in the next culls, a texture of 0 turns the test off
+	void SetOcclusionPyramid(GLuint texture, int width, int height, int levelCount);
+
+	// run the culling shader for the camera in the camera block
+	// and the program that was active is made current again
+	void Cull(bool bSelectLod, GLuint restoreProgram);
+	// draw the visible objects of a group from the bound vertex
+	// array with the active shader
+	void DrawGroup(uint32_t group);
+
+	uint32_t GetObjectCount() const { return m_objectCount; }
+
+private:
+	ShaderManager* m_pCullShader;
+	// the objects, the groups, the draw commands and the count
+	// of commands written to each group
+	GLuint m_objectBuffer;
+	GLuint m_groupBuffer;
+	GLuint m_commandBuffer;
+	GLuint m_countBuffer;
+	uint32_t m_objectCount;
+	uint32_t m_commandCount;
+	std::vector<GPU_DRAW_GROUP> m_groups;
+	// the driver draws only the written commands of a group
+	bool m_bIndirectCount;
+	// depth pyramid the objects are tested against
+	GLuint m_pyramidTexture;
+	int m_pyramidWidth;
+	int m_pyramidHeight;
+	int m_pyramidLevels;
+};
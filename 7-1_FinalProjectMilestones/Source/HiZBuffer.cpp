@@ -0,0 +1,461 @@
+///////////////////////////////////////////////////////////////////////////////
+// hizbuffer.cpp
+// ============
+// depth pyramid of the large occluders for hierarchical-Z occlusion culling
+///////////////////////////////////////////////////////////////////////////////
+
+#include "HiZBuffer.h"
+#include "ShaderCache.h"
+#include "GLStateCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_OccluderVertexShaderFile = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/occluderVertexShader.glsl";
+	const char* g_OccluderFragmentShaderFile = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/occluderFragmentShader.glsl";
+	const char* g_ReduceShaderFile = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/hiZReduceShader.glsl";
+
+	// the occluders are drawn at a fixed size stretched over the
+	// view, which halves evenly down to the last levels
+	const int OCCLUDER_WIDTH = 512;
+	const int OCCLUDER_HEIGHT = 256;
+	// threads along each side of a work group of the reduction
+	const int REDUCE_GROUP_SIZE = 8;
+	// level of the pyramid that is copied back for the CPU
+	const int READBACK_LEVEL = 2;
+
+	/***********************************************************
+	 *  SelectTestLevel()
+	 *
+	 *  Get the first level on which a rectangle of the given
+	 *  size in first level texels is at most one texel wide.
+	 *  It can still straddle texel edges there, so it overlaps
+	 *  at most 2x2 texels.
+	 ***********************************************************/
+	int SelectTestLevel(float width, float height, int levelCount)
+	{
+		float extent = std::max(std::max(width, height), 1.0f);
+		int level = static_cast<int>(ceilf(log2f(extent)));
+		return(std::min(std::max(level, 0), levelCount - 1));
+	}
+}
+
+/***********************************************************
+ *  HiZBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+HiZBuffer::HiZBuffer()
+{
+	m_pOccluderShader = NULL;
+	m_pReduceShader = NULL;
+	m_frameBuffer = 0;
+	m_depthTexture = 0;
+	m_pyramidTexture = 0;
+	m_pyramidWidth = 0;
+	m_pyramidHeight = 0;
+	m_levelCount = 0;
+	m_sceneFrameBuffer = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		m_sceneViewport[i] = 0;
+	}
+	m_readbackBuffer = 0;
+	m_readbackFence = NULL;
+	m_readbackViewProjection = glm::mat4(1.0f);
+	m_cpuWidth = 0;
+	m_cpuHeight = 0;
+	m_cpuViewProjection = glm::mat4(1.0f);
+	m_bCpuPyramidReady = false;
+}
+
+/***********************************************************
+ *  ~HiZBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+HiZBuffer::~HiZBuffer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the occluder and the
+ *  reduction shaders and creating the depth target, the
+ *  pyramid and the buffer the copy is read back through.
+ ***********************************************************/
+bool HiZBuffer::Initialize()
+{
+	if ((!GLEW_VERSION_4_3) && (!GLEW_ARB_compute_shader))
+	{
+		std::cout << "Compute shaders are not supported for the occlusion culling" << std::endl;
+		return(false);
+	}
+
+	m_pOccluderShader = new ShaderManager();
+	m_pOccluderShader->m_programID = LoadShaderProgram(g_OccluderVertexShaderFile, g_OccluderFragmentShaderFile);
+	m_pReduceShader = new ShaderManager();
+	m_pReduceShader->m_programID = LoadComputeProgram(g_ReduceShaderFile);
+	if ((m_pOccluderShader->m_programID == 0) || (m_pReduceShader->m_programID == 0))
+	{
+		std::cout << "Could not load the occlusion culling shaders" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	m_pyramidWidth = OCCLUDER_WIDTH / 2;
+	m_pyramidHeight = OCCLUDER_HEIGHT / 2;
+	m_levelCount = 1;
+	while (((m_pyramidWidth >> (m_levelCount - 1)) > 1) ||
+		((m_pyramidHeight >> (m_levelCount - 1)) > 1))
+	{
+		m_levelCount++;
+	}
+
+	GLuint textures[2];
+	glGenTextures(2, textures);
+	m_depthTexture = textures[0];
+	m_pyramidTexture = textures[1];
+
+	g_GLState.BindTexture(GLStateCache::UPLOAD_TEXTURE_UNIT, GL_TEXTURE_2D, m_depthTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, OCCLUDER_WIDTH, OCCLUDER_HEIGHT, 0,
+		GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	g_GLState.BindTexture(GLStateCache::UPLOAD_TEXTURE_UNIT, GL_TEXTURE_2D, m_pyramidTexture);
+	glTexStorage2D(GL_TEXTURE_2D, m_levelCount, GL_R32F, m_pyramidWidth, m_pyramidHeight);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glGenFramebuffers(1, &m_frameBuffer);
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthTexture, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (!bComplete)
+	{
+		std::cout << "The occluder framebuffer is not complete" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	m_cpuWidth = std::max(1, m_pyramidWidth >> READBACK_LEVEL);
+	m_cpuHeight = std::max(1, m_pyramidHeight >> READBACK_LEVEL);
+	glGenBuffers(1, &m_readbackBuffer);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackBuffer);
+	glBufferData(GL_PIXEL_PACK_BUFFER, m_cpuWidth * m_cpuHeight * sizeof(float), NULL, GL_STREAM_READ);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	g_GLState.UseProgram(m_pReduceShader->m_programID);
+	m_pReduceShader->setSampler2DValue("sourceDepth", PYRAMID_TEXTURE_UNIT);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the shaders, the target,
+ *  the pyramid and the copy.
+ ***********************************************************/
+void HiZBuffer::Destroy()
+{
+	InvalidateReadback();
+	if (m_readbackBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_readbackBuffer);
+		m_readbackBuffer = 0;
+	}
+
+	if (m_frameBuffer != 0)
+	{
+		g_GLState.DeleteFramebuffer(m_frameBuffer);
+		m_frameBuffer = 0;
+	}
+
+	GLuint textures[2] = { m_depthTexture, m_pyramidTexture };
+	for (int i = 0; i < 2; i++)
+	{
+		if (textures[i] != 0)
+		{
+			g_GLState.DeleteTextures(1, &textures[i]);
+		}
+	}
+	m_depthTexture = 0;
+	m_pyramidTexture = 0;
+	m_levelCount = 0;
+
+	if (NULL != m_pOccluderShader)
+	{
+		glDeleteProgram(m_pOccluderShader->m_programID);
+		m_pOccluderShader->m_programID = 0;
+		delete m_pOccluderShader;
+		m_pOccluderShader = NULL;
+	}
+	if (NULL != m_pReduceShader)
+	{
+		glDeleteProgram(m_pReduceShader->m_programID);
+		m_pReduceShader->m_programID = 0;
+		delete m_pReduceShader;
+		m_pReduceShader = NULL;
+	}
+}
+
+/***********************************************************
+ *  BeginOccluderPass()
+ *
+ *  This method is used for preparing the depth target for
+ *  the occluders. The scene may be drawn into an offscreen
+ *  target, so its framebuffer and viewport are kept.
+ ***********************************************************/
+void HiZBuffer::BeginOccluderPass()
+{
+	m_sceneFrameBuffer = g_GLState.GetDrawFramebuffer();
+	g_GLState.GetViewport(m_sceneViewport);
+
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+	g_GLState.Viewport(0, 0, OCCLUDER_WIDTH, OCCLUDER_HEIGHT);
+	g_GLState.Enable(GL_DEPTH_TEST);
+	g_GLState.DepthMask(GL_TRUE);
+	glClear(GL_DEPTH_BUFFER_BIT);
+
+	g_GLState.UseProgram(m_pOccluderShader->m_programID);
+}
+
+/***********************************************************
+ *  EndOccluderPass()
+ *
+ *  This method is used for reducing the occluder depth into
+ *  the pyramid and handing a level of it to the CPU. A copy
+ *  that has arrived is taken first, and a new one is only
+ *  started once the last one was taken.
+ ***********************************************************/
+void HiZBuffer::EndOccluderPass(const glm::mat4& viewProjection, GLuint restoreProgram)
+{
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, m_sceneFrameBuffer);
+	g_GLState.Viewport(m_sceneViewport[0], m_sceneViewport[1], m_sceneViewport[2], m_sceneViewport[3]);
+
+	BuildPyramid();
+
+	FinishReadback();
+	if (NULL == m_readbackFence)
+	{
+		StartReadback(viewProjection);
+	}
+
+	g_GLState.UseProgram(restoreProgram);
+}
+
+/***********************************************************
+ *  BuildPyramid()
+ *
+ *  This method is used for filling every level of the
+ *  pyramid from the one above it, the first level from the
+ *  occluder depth.
+ ***********************************************************/
+void HiZBuffer::BuildPyramid()
+{
+	g_GLState.UseProgram(m_pReduceShader->m_programID);
+
+	for (int level = 0; level < m_levelCount; level++)
+	{
+		GLuint source = ((level == 0) ? m_depthTexture : m_pyramidTexture);
+		g_GLState.BindTexture(PYRAMID_TEXTURE_UNIT, GL_TEXTURE_2D, source);
+		m_pReduceShader->setIntValue("sourceLevel", std::max(level - 1, 0));
+		glBindImageTexture(0, m_pyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+		int width = std::max(1, m_pyramidWidth >> level);
+		int height = std::max(1, m_pyramidHeight >> level);
+		glDispatchCompute(
+			(width + REDUCE_GROUP_SIZE - 1) / REDUCE_GROUP_SIZE,
+			(height + REDUCE_GROUP_SIZE - 1) / REDUCE_GROUP_SIZE,
+			1);
+
+		// the next level reads the one just written
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	}
+
+	// the copy back reads the pyramid as a texture
+	glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+}
+
+/***********************************************************
+ *  StartReadback()
+ *
+ *  This method is used for queueing the copy of one level
+ *  into the pack buffer and fencing it, so that the copy is
+ *  taken in a later frame instead of waiting for it now.
+ ***********************************************************/
+void HiZBuffer::StartReadback(const glm::mat4& viewProjection)
+{
+	g_GLState.BindTexture(PYRAMID_TEXTURE_UNIT, GL_TEXTURE_2D, m_pyramidTexture);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackBuffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glGetTexImage(GL_TEXTURE_2D, READBACK_LEVEL, GL_RED, GL_FLOAT, NULL);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	m_readbackFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_readbackViewProjection = viewProjection;
+}
+
+/***********************************************************
+ *  FinishReadback()
+ *
+ *  This method is used for taking the copy when the GPU has
+ *  finished it and building the coarser levels from it.
+ *  Nothing happens while the copy is still on its way.
+ ***********************************************************/
+void HiZBuffer::FinishReadback()
+{
+	if (NULL == m_readbackFence)
+	{
+		return;
+	}
+
+	GLenum status = glClientWaitSync(m_readbackFence, 0, 0);
+	if ((status != GL_ALREADY_SIGNALED) && (status != GL_CONDITION_SATISFIED))
+	{
+		return;
+	}
+	glDeleteSync(m_readbackFence);
+	m_readbackFence = NULL;
+
+	size_t texelCount = static_cast<size_t>(m_cpuWidth) * m_cpuHeight;
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackBuffer);
+	const float* pDepth = static_cast<const float*>(glMapBufferRange(
+		GL_PIXEL_PACK_BUFFER, 0, texelCount * sizeof(float), GL_MAP_READ_BIT));
+	if (NULL == pDepth)
+	{
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		return;
+	}
+
+	m_cpuLevels.resize(1);
+	m_cpuLevels[0].assign(pDepth, pDepth + texelCount);
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	int width = m_cpuWidth;
+	int height = m_cpuHeight;
+	while ((width > 1) || (height > 1))
+	{
+		int levelWidth = std::max(1, width / 2);
+		int levelHeight = std::max(1, height / 2);
+		const std::vector<float>& source = m_cpuLevels.back();
+		std::vector<float> level(static_cast<size_t>(levelWidth) * levelHeight);
+		for (int y = 0; y < levelHeight; y++)
+		{
+			int y0 = std::min(y * 2, height - 1);
+			int y1 = std::min(y * 2 + 1, height - 1);
+			for (int x = 0; x < levelWidth; x++)
+			{
+				int x0 = std::min(x * 2, width - 1);
+				int x1 = std::min(x * 2 + 1, width - 1);
+				level[y * levelWidth + x] = std::max(
+					std::max(source[y0 * width + x0], source[y0 * width + x1]),
+					std::max(source[y1 * width + x0], source[y1 * width + x1]));
+			}
+		}
+		m_cpuLevels.push_back(level);
+		width = levelWidth;
+		height = levelHeight;
+	}
+
+	m_cpuViewProjection = m_readbackViewProjection;
+	m_bCpuPyramidReady = true;
+}
+
+/***********************************************************
+ *  InvalidateReadback()
+ *
+ *  This method is used for dropping the copy and any copy
+ *  still on its way, which no longer match the scene once
+ *  frames were drawn without the occluder pass.
+ ***********************************************************/
+void HiZBuffer::InvalidateReadback()
+{
+	if (NULL != m_readbackFence)
+	{
+		glDeleteSync(m_readbackFence);
+		m_readbackFence = NULL;
+	}
+	m_bCpuPyramidReady = false;
+}
+
+/***********************************************************
+ *  IsBoxHidden()
+ *
+ *  This method is used for testing a box against the copied
+ *  pyramid with the camera the copy was drawn from. The
+ *  projected corners give the screen rectangle and the
+ *  nearest depth, which is compared with the farthest
+ *  occluder depth of the four texels that cover the
+ *  rectangle on the chosen level. The corners of the real
+ *  box are used, since a cube around the bounding sphere of
+ *  a long, flat object reaches far past it and often
+ *  behind the camera.
+ ***********************************************************/
+bool HiZBuffer::IsBoxHidden(const glm::vec3 corners[8]) const
+{
+	if (!m_bCpuPyramidReady)
+	{
+		return(false);
+	}
+
+	glm::vec2 uvMin(1.0f);
+	glm::vec2 uvMax(0.0f);
+	float nearest = 1.0f;
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec4 clip = m_cpuViewProjection * glm::vec4(corners[i], 1.0f);
+		// bounds reaching behind the camera are never hidden
+		if (clip.w <= 0.0f)
+		{
+			return(false);
+		}
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		uvMin = glm::min(uvMin, glm::vec2(ndc) * 0.5f + 0.5f);
+		uvMax = glm::max(uvMax, glm::vec2(ndc) * 0.5f + 0.5f);
+		nearest = std::min(nearest, ndc.z * 0.5f + 0.5f);
+	}
+	if (nearest <= 0.0f)
+	{
+		return(false);
+	}
+
+	uvMin = glm::clamp(uvMin, 0.0f, 1.0f);
+	uvMax = glm::clamp(uvMax, 0.0f, 1.0f);
+	int level = SelectTestLevel(
+		(uvMax.x - uvMin.x) * m_cpuWidth,
+		(uvMax.y - uvMin.y) * m_cpuHeight,
+		static_cast<int>(m_cpuLevels.size()));
+
+	int width = std::max(1, m_cpuWidth >> level);
+	int height = std::max(1, m_cpuHeight >> level);
+	int x0 = std::min(static_cast<int>(uvMin.x * width), width - 1);
+	int x1 = std::min(static_cast<int>(uvMax.x * width), width - 1);
+	int y0 = std::min(static_cast<int>(uvMin.y * height), height - 1);
+	int y1 = std::min(static_cast<int>(uvMax.y * height), height - 1);
+
+	const std::vector<float>& depth = m_cpuLevels[level];
+	float farthest = std::max(
+		std::max(depth[y0 * width + x0], depth[y0 * width + x1]),
+		std::max(depth[y1 * width + x0], depth[y1 * width + x1]));
+
+	return(nearest > farthest);
+}
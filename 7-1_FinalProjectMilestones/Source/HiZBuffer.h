@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////////////
+// hizbuffer.h
+// ============
+// depth pyramid of the large occluders for hierarchical-Z occlusion culling
+//
+// The nearest large opaque static batches are drawn depth only into a small
+// target at the start of the frame. A compute shader then halves the depth again and again
+// into a mip pyramid where every texel holds the farthest depth beneath it.
+// An object is hidden when the nearest point of its bounds lies behind the
+// farthest occluder depth over its screen rectangle. That is read on the first
+// level where the rectangle is at most one texel wide, so it overlaps at most
+// 2x2 texels and four samples cover it. The GPU
+// culling tests against the pyramid of the frame itself. For the CPU one small
+// level is copied back without waiting, and the copy of an earlier frame is
+// used together with the camera it was drawn from, so the CPU never stalls.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+class HiZBuffer
+{
+public:
+	// unit the pyramid is read from by the compute shaders
+	static const int PYRAMID_TEXTURE_UNIT = 9;
+
+	// constructor
+	HiZBuffer();
+	// destructor
+	~HiZBuffer();
+
+	// load the shaders and create the depth target and pyramid
+	bool Initialize();
+	// free all OpenGL resources
+	void Destroy();
+
+	// bind and clear the depth target and make the occluder shader
+	// active, remembering the framebuffer and viewport of the scene
+	void BeginOccluderPass();
+	// build the pyramid from the occluders drawn with the camera,
+	// start copying it back and return to the scene framebuffer
+	// with the program that was active before the pass
+	void EndOccluderPass(const glm::mat4& viewProjection, GLuint restoreProgram);
+	// forget the copy, for after frames drawn without the pass
+	void InvalidateReadback();
+
+	// test the eight world space corners of a box against the
+	// last copied pyramid
+	bool IsBoxHidden(const glm::vec3 corners[8]) const;
+
+	ShaderManager* GetOccluderShader() const { return m_pOccluderShader; }
+	GLuint GetPyramidTexture() const { return m_pyramidTexture; }
+	int GetPyramidWidth() const { return m_pyramidWidth; }
+	int GetPyramidHeight() const { return m_pyramidHeight; }
+	int GetLevelCount() const { return m_levelCount; }
+
+private:
+	ShaderManager* m_pOccluderShader;
+	ShaderManager* m_pReduceShader;
+
+	GLuint m_frameBuffer;
+	GLuint m_depthTexture;
+	GLuint m_pyramidTexture;
+	int m_pyramidWidth;
+	int m_pyramidHeight;
+	int m_levelCount;
+	// framebuffer and viewport of the scene during the pass
+	GLuint m_sceneFrameBuffer;
+	GLint m_sceneViewport[4];
+
+	// copy of one level on its way back to the CPU
+	GLuint m_readbackBuffer;
+	GLsync m_readbackFence;
+	glm::mat4 m_readbackViewProjection;
+
+	// the copied level and the levels above it, built on the CPU,
+	// with the camera they were drawn from
+	std::vector<std::vector<float> > m_cpuLevels;
+	int m_cpuWidth;
+	int m_cpuHeight;
+	glm::mat4 m_cpuViewProjection;
+	bool m_bCpuPyramidReady;
+
+	void BuildPyramid();
+	void StartReadback(const glm::mat4& viewProjection);
+	void FinishReadback();
+};
@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////////
+// inputqueue.cpp
+// ============
+// hand window input events from the GLFW callbacks to the update step
+///////////////////////////////////////////////////////////////////////////////
+
+#include "InputQueue.h"
+
+/***********************************************************
+ *  InputQueue()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+InputQueue::InputQueue()
+	: m_head(0), m_tail(0)
+{
+	m_droppedCount = 0;
+}
+
+/***********************************************************
+ *  Push()
+ *
+ *  This method is used for adding an event on the producer
+ *  side. The event is written before the head is published,
+ *  so the consumer never reads a half written slot.
+ ***********************************************************/
+bool InputQueue::Push(const INPUT_EVENT& event)
+{
+	uint32_t head = m_head.load(std::memory_order_relaxed);
+	uint32_t tail = m_tail.load(std::memory_order_acquire);
+	if (head - tail >= CAPACITY)
+	{
+		m_droppedCount++;
+		return(false);
+	}
+
+	m_events[head & (CAPACITY - 1)] = event;
+	m_head.store(head + 1, std::memory_order_release);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Pop()
+ *
+ *  This method is used for taking the oldest event on the
+ *  consumer side. The slot is copied out before the tail is
+ *  published, so the producer never overwrites it early.
+ ***********************************************************/
+bool InputQueue::Pop(INPUT_EVENT& event)
+{
+	uint32_t tail = m_tail.load(std::memory_order_relaxed);
+	uint32_t head = m_head.load(std::memory_order_acquire);
+	if (tail == head)
+	{
+		return(false);
+	}
+
+	event = m_events[tail & (CAPACITY - 1)];
+	m_tail.store(tail + 1, std::memory_order_release);
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsEmpty()
+ *
+ *  This method is used for checking for waiting events.
+ ***********************************************************/
+bool InputQueue::IsEmpty() const
+{
+	return(m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire));
+}
@@ -0,0 +1,64 @@
+///////////////////////////////////////////////////////////////////////////////
+// inputqueue.h
+// ============
+// hand window input events from the GLFW callbacks to the update step
+//
+// The callbacks only copy each event into a fixed ring buffer. The update
+// step drains the ring and maps the events onto actions. One thread writes
+// and one thread reads, so the two positions are plain atomics and neither
+// side ever waits on a lock. Every event carries the time it was received,
+// which keeps the stream complete enough to be recorded and replayed.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// kinds of events passed through the queue
+enum INPUT_EVENT_TYPE
+{
+	INPUT_KEY,
+	INPUT_MOUSE_MOVE,
+	INPUT_SCROLL
+};
+
+// one window input event
+struct INPUT_EVENT
+{
+	INPUT_EVENT_TYPE type;
+	// GLFW key and action for key events
+	int key;
+	int action;
+	// cursor position or scroll offsets
+	double x;
+	double y;
+	double time;
+};
+
+class InputQueue
+{
+public:
+	// constructor
+	InputQueue();
+
+	// add an event, returns false and drops it when the queue is full
+	bool Push(const INPUT_EVENT& event);
+	// take the oldest event, returns false when the queue is empty
+	bool Pop(INPUT_EVENT& event);
+
+	bool IsEmpty() const;
+	// number of events lost because the queue was full
+	uint32_t GetDroppedCount() const { return m_droppedCount; }
+
+private:
+	// a power of two, so positions wrap with a mask
+	static const uint32_t CAPACITY = 1024;
+
+	INPUT_EVENT m_events[CAPACITY];
+	// next slot to write, only changed by the producer
+	std::atomic<uint32_t> m_head;
+	// next slot to read, only changed by the consumer
+	std::atomic<uint32_t> m_tail;
+	uint32_t m_droppedCount;
+};
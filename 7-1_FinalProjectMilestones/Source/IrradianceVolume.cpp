@@ -0,0 +1,461 @@
+///////////////////////////////////////////////////////////////////////////////
+// irradiancevolume.cpp
+// ============
+// bake a grid of L2 spherical harmonic irradiance probes on the CPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "IrradianceVolume.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+// the projection uses SSE when the compiler targets it
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IRRADIANCE_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	const float PI = 3.14159265358979f;
+
+	const float RAY_OFFSET = 0.01f;
+	const float RAY_MAX_DISTANCE = 1000.0f;
+
+	// probes that see more back faces than this are inside geometry
+	const float MAX_BACKFACE_RATIO = 0.25f;
+
+	// cosine lobe convolution weights for bands 0, 1 and 2
+	const float BAND_WEIGHTS[9] =
+	{
+		PI,
+		2.0f * PI / 3.0f, 2.0f * PI / 3.0f, 2.0f * PI / 3.0f,
+		PI / 4.0f, PI / 4.0f, PI / 4.0f, PI / 4.0f, PI / 4.0f
+	};
+
+	/***********************************************************
+	 *  EvaluateBasis()
+	 *
+	 *  Evaluate the nine real L2 spherical harmonic basis
+	 *  functions for a unit direction. The order must match
+	 *  EvaluateProbeIrradiance() in fragmentShader.glsl.
+	 ***********************************************************/
+	void EvaluateBasis(const glm::vec3& d, float basis[9])
+	{
+		basis[0] = 0.282095f;
+		basis[1] = 0.488603f * d.y;
+		basis[2] = 0.488603f * d.z;
+		basis[3] = 0.488603f * d.x;
+		basis[4] = 1.092548f * d.x * d.y;
+		basis[5] = 1.092548f * d.y * d.z;
+		basis[6] = 0.315392f * (3.0f * d.z * d.z - 1.0f);
+		basis[7] = 1.092548f * d.x * d.z;
+		basis[8] = 0.546274f * (d.x * d.x - d.y * d.y);
+	}
+
+	/***********************************************************
+	 *  DotProduct()
+	 *
+	 *  Sum of the products of two float arrays whose length is
+	 *  a multiple of four.
+	 ***********************************************************/
+	float DotProduct(const float* a, const float* b, int count)
+	{
+#ifdef IRRADIANCE_USE_SSE
+		__m128 sum = _mm_setzero_ps();
+		for (int i = 0; i < count; i += 4)
+		{
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+		}
+		float lanes[4];
+		_mm_storeu_ps(lanes, sum);
+		return(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+#else
+		float sum = 0.0f;
+		for (int i = 0; i < count; i++)
+		{
+			sum += a[i] * b[i];
+		}
+		return(sum);
+#endif
+	}
+}
+
+/***********************************************************
+ *  IrradianceVolume()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+IrradianceVolume::IrradianceVolume()
+{
+	m_dimensions = glm::ivec3(0, 0, 0);
+	m_boundsMin = glm::vec3(0.0f);
+	m_boundsMax = glm::vec3(0.0f);
+	m_rayCount = 0;
+}
+
+/***********************************************************
+ *  SetSettings()
+ *
+ *  This method is used for setting the bake quality.
+ ***********************************************************/
+void IrradianceVolume::SetSettings(const PROBE_SETTINGS& settings)
+{
+	m_settings = settings;
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all the scene data.
+ ***********************************************************/
+void IrradianceVolume::Clear()
+{
+	m_lights.clear();
+	m_objects.clear();
+	m_tracer.Clear();
+	m_coefficients.clear();
+	m_validProbes.clear();
+	m_dimensions = glm::ivec3(0, 0, 0);
+}
+
+/***********************************************************
+ *  AddLight()
+ *
+ *  This method is used for adding a light to the bake.
+ ***********************************************************/
+void IrradianceVolume::AddLight(const BAKE_LIGHT& light)
+{
+	m_lights.push_back(light);
+}
+
+/***********************************************************
+ *  AddObject()
+ *
+ *  This method is used for adding a static object that the
+ *  probe rays can hit and bounce light from.
+ ***********************************************************/
+void IrradianceVolume::AddObject(
+	const MESH_DATA* pMesh,
+	const glm::mat4& model,
+	const glm::vec3& albedo,
+	bool bCastsShadows)
+{
+	PROBE_OBJECT object;
+	object.albedo = albedo;
+	m_objects.push_back(object);
+
+	if (bCastsShadows)
+	{
+		m_tracer.AddMesh(*pMesh, model, static_cast<int>(m_objects.size() - 1));
+	}
+}
+
+/***********************************************************
+ *  PrepareDirections()
+ *
+ *  This method is used for spreading the ray directions
+ *  evenly over the sphere with a Fibonacci spiral and
+ *  evaluating the basis functions for each of them once.
+ ***********************************************************/
+void IrradianceVolume::PrepareDirections()
+{
+	int rayCount = std::max(4, m_settings.raysPerProbe);
+	m_rayCount = (rayCount + 3) & ~3;
+	const float goldenAngle = PI * (3.0f - sqrt(5.0f));
+
+	m_directions.assign(m_rayCount, glm::vec3(0.0f));
+	for (int j = 0; j < 9; j++)
+	{
+		m_basis[j].assign(m_rayCount, 0.0f);
+	}
+
+	// the padding directions keep a zero basis and add nothing
+	for (int i = 0; i < rayCount; i++)
+	{
+		float z = 1.0f - (2.0f * i + 1.0f) / rayCount;
+		float radius = sqrt(std::max(0.0f, 1.0f - z * z));
+		float angle = goldenAngle * i;
+		m_directions[i] = glm::vec3(radius * cos(angle), radius * sin(angle), z);
+
+		float basis[9];
+		EvaluateBasis(m_directions[i], basis);
+		for (int j = 0; j < 9; j++)
+		{
+			// include the solid angle of each sample
+			m_basis[j][i] = basis[j] * 4.0f * PI / rayCount;
+		}
+	}
+}
+
+/***********************************************************
+ *  ComputeDirectLight()
+ *
+ *  This method is used for summing the diffuse light of all
+ *  the scene lights that reach a surface point.
+ ***********************************************************/
+glm::vec3 IrradianceVolume::ComputeDirectLight(const glm::vec3& position, const glm::vec3& normal) const
+{
+	glm::vec3 irradiance(0.0f);
+	glm::vec3 origin = position + normal * RAY_OFFSET;
+
+	for (const BAKE_LIGHT& light : m_lights)
+	{
+		glm::vec3 toLight = light.position - position;
+		float distance = glm::length(toLight);
+		if (distance <= 0.0f)
+		{
+			continue;
+		}
+		glm::vec3 direction = toLight / distance;
+		float NdotL = glm::dot(normal, direction);
+		if ((NdotL > 0.0f) && (!m_tracer.IsOccluded(origin, direction, distance - RAY_OFFSET)))
+		{
+			irradiance += light.diffuseColor * NdotL;
+		}
+	}
+
+	return(irradiance);
+}
+
+/***********************************************************
+ *  BakeProbe()
+ *
+ *  This method is used for tracing all the directions from
+ *  one probe and projecting the incoming light. The light
+ *  ambient colors act as a uniform sky so that open space
+ *  keeps the old ambient level while corners and the space
+ *  under objects get darker and pick up bounce color.
+ ***********************************************************/
+void IrradianceVolume::BakeProbe(int probeIndex)
+{
+	int x = probeIndex % m_dimensions.x;
+	int y = (probeIndex / m_dimensions.x) % m_dimensions.y;
+	int z = probeIndex / (m_dimensions.x * m_dimensions.y);
+
+	glm::vec3 step = (m_boundsMax - m_boundsMin) / glm::vec3(
+		(float)std::max(1, m_dimensions.x - 1),
+		(float)std::max(1, m_dimensions.y - 1),
+		(float)std::max(1, m_dimensions.z - 1));
+	glm::vec3 position = m_boundsMin + glm::vec3((float)x, (float)y, (float)z) * step;
+
+	glm::vec3 ambient(0.0f);
+	for (const BAKE_LIGHT& light : m_lights)
+	{
+		ambient += light.ambientColor;
+	}
+
+	std::vector<float> radiance[3];
+	for (int channel = 0; channel < 3; channel++)
+	{
+		radiance[channel].assign(m_rayCount, 0.0f);
+	}
+
+	int backfaces = 0;
+	int rayCount = std::max(4, m_settings.raysPerProbe);
+	for (int i = 0; i < rayCount; i++)
+	{
+		const glm::vec3& direction = m_directions[i];
+		glm::vec3 incoming = ambient / PI;
+
+		RAY_HIT hit;
+		if (m_tracer.Intersect(position, direction, RAY_MAX_DISTANCE, hit))
+		{
+			if (glm::dot(hit.normal, direction) > 0.0f)
+			{
+				backfaces++;
+				incoming = glm::vec3(0.0f);
+			}
+			else
+			{
+				// diffuse light leaving the hit surface towards the probe
+				incoming = m_objects[hit.objectIndex].albedo
+					* (ComputeDirectLight(hit.position, hit.normal) + ambient) / PI;
+			}
+		}
+
+		radiance[0][i] = incoming.x;
+		radiance[1][i] = incoming.y;
+		radiance[2][i] = incoming.z;
+	}
+
+	float* pCoefficients = &m_coefficients[probeIndex * FLOATS_PER_PROBE];
+	for (int j = 0; j < 9; j++)
+	{
+		for (int channel = 0; channel < 3; channel++)
+		{
+			pCoefficients[j * 3 + channel] = BAND_WEIGHTS[j]
+				* DotProduct(m_basis[j].data(), radiance[channel].data(), m_rayCount);
+		}
+	}
+
+	m_validProbes[probeIndex] = (backfaces <= MAX_BACKFACE_RATIO * rayCount);
+}
+
+/***********************************************************
+ *  FillInvalidProbes()
+ *
+ *  This method is used for replacing the probes that ended
+ *  up inside walls or furniture, which would only see back
+ *  faces, with the average of their valid neighbors.
+ ***********************************************************/
+void IrradianceVolume::FillInvalidProbes()
+{
+	int probeCount = m_dimensions.x * m_dimensions.y * m_dimensions.z;
+	bool bChanged = true;
+
+	while (bChanged)
+	{
+		bChanged = false;
+		std::vector<bool> validProbes = m_validProbes;
+
+		for (int index = 0; index < probeCount; index++)
+		{
+			if (m_validProbes[index])
+			{
+				continue;
+			}
+
+			int x = index % m_dimensions.x;
+			int y = (index / m_dimensions.x) % m_dimensions.y;
+			int z = index / (m_dimensions.x * m_dimensions.y);
+			const int offsets[6][3] = { { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+
+			float sum[FLOATS_PER_PROBE] = { 0.0f };
+			int count = 0;
+			for (int n = 0; n < 6; n++)
+			{
+				int nx = x + offsets[n][0];
+				int ny = y + offsets[n][1];
+				int nz = z + offsets[n][2];
+				if ((nx < 0) || (ny < 0) || (nz < 0) ||
+					(nx >= m_dimensions.x) || (ny >= m_dimensions.y) || (nz >= m_dimensions.z))
+				{
+					continue;
+				}
+				int neighbor = (nz * m_dimensions.y + ny) * m_dimensions.x + nx;
+				if (m_validProbes[neighbor])
+				{
+					for (int i = 0; i < FLOATS_PER_PROBE; i++)
+					{
+						sum[i] += m_coefficients[neighbor * FLOATS_PER_PROBE + i];
+					}
+					count++;
+				}
+			}
+
+			if (count > 0)
+			{
+				for (int i = 0; i < FLOATS_PER_PROBE; i++)
+				{
+					m_coefficients[index * FLOATS_PER_PROBE + i] = sum[i] / count;
+				}
+				validProbes[index] = true;
+				bChanged = true;
+			}
+		}
+
+		m_validProbes = validProbes;
+	}
+}
+
+/***********************************************************
+ *  Bake()
+ *
+ *  This method is used for sizing the probe grid to the
+ *  scene bounds and baking all of its probes. The probes
+ *  are handed out to the worker threads through a shared
+ *  counter.
+ ***********************************************************/
+bool IrradianceVolume::Bake()
+{
+	auto startTime = std::chrono::steady_clock::now();
+
+	m_tracer.Build();
+	if (m_tracer.GetTriangleCount() == 0)
+	{
+		return(false);
+	}
+
+	m_boundsMin = m_tracer.GetBoundsMin();
+	m_boundsMax = m_tracer.GetBoundsMax();
+	glm::vec3 extent = m_boundsMax - m_boundsMin;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		int count = static_cast<int>(ceil(extent[axis] / m_settings.probeSpacing)) + 1;
+		count = std::max(2, std::min(m_settings.maxProbesPerAxis, count));
+		if (axis == 0) m_dimensions.x = count;
+		if (axis == 1) m_dimensions.y = count;
+		if (axis == 2) m_dimensions.z = count;
+	}
+
+	int probeCount = m_dimensions.x * m_dimensions.y * m_dimensions.z;
+	m_coefficients.assign(probeCount * FLOATS_PER_PROBE, 0.0f);
+	m_validProbes.assign(probeCount, false);
+	PrepareDirections();
+
+	int threadCount = m_settings.threadCount;
+	if (threadCount <= 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	std::cout << "Baking irradiance probes " << m_dimensions.x << "x" << m_dimensions.y << "x" << m_dimensions.z
+		<< ", " << m_settings.raysPerProbe << " rays each, " << threadCount << " threads" << std::endl;
+
+	std::atomic<int> nextProbe(0);
+	auto worker = [this, &nextProbe, probeCount]()
+	{
+		int probe = 0;
+		while ((probe = nextProbe.fetch_add(1)) < probeCount)
+		{
+			BakeProbe(probe);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 1; i < threadCount; i++)
+	{
+		threads.push_back(std::thread(worker));
+	}
+	worker();
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	FillInvalidProbes();
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+	std::cout << "Irradiance probes baked in " << elapsed.count() << " seconds" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetTextureData()
+ *
+ *  This method is used for packing the coefficients into
+ *  seven RGBA slabs stacked along the Z axis of a 3D
+ *  texture. Each slab holds four of the 27 floats of every
+ *  probe, so a lookup filters within a slab only.
+ ***********************************************************/
+void IrradianceVolume::GetTextureData(std::vector<float>& texels) const
+{
+	int probeCount = m_dimensions.x * m_dimensions.y * m_dimensions.z;
+	texels.assign(probeCount * TEXTURE_SLABS * 4, 0.0f);
+
+	for (int probe = 0; probe < probeCount; probe++)
+	{
+		for (int i = 0; i < FLOATS_PER_PROBE; i++)
+		{
+			int slab = i / 4;
+			texels[((slab * probeCount) + probe) * 4 + (i % 4)] = m_coefficients[probe * FLOATS_PER_PROBE + i];
+		}
+	}
+}
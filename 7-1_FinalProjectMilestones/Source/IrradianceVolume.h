@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////
+// irradiancevolume.h
+// ============
+// bake a grid of L2 spherical harmonic irradiance probes on the CPU
+//
+// Probes are placed on a regular grid over the scene bounds. Each probe
+// traces a fixed set of directions against the static scene, projects the
+// incoming light onto nine spherical harmonic coefficients per color and
+// convolves them with the cosine lobe so that the shader can read the
+// diffuse irradiance for any normal. The probes are baked in parallel and
+// the projection is vectorized with SSE when it is available.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "LightmapBaker.h"
+#include "SceneRayTracer.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// quality settings for the probe bake
+struct PROBE_SETTINGS
+{
+	// distance between probes before the grid is clamped
+	float probeSpacing = 3.0f;
+	int maxProbesPerAxis = 32;
+	// directions traced from every probe
+	int raysPerProbe = 256;
+	// zero uses all hardware threads
+	int threadCount = 0;
+};
+
+class IrradianceVolume
+{
+public:
+	// number of floats stored per probe (9 coefficients x RGB)
+	static const int FLOATS_PER_PROBE = 27;
+	// number of RGBA texture slabs needed for one probe
+	static const int TEXTURE_SLABS = 7;
+
+	// constructor
+	IrradianceVolume();
+
+	void SetSettings(const PROBE_SETTINGS& settings);
+	// remove all lights, objects and baked data
+	void Clear();
+	void AddLight(const BAKE_LIGHT& light);
+	void AddObject(
+		const MESH_DATA* pMesh,
+		const glm::mat4& model,
+		const glm::vec3& albedo,
+		bool bCastsShadows);
+
+	// bake all probes of the grid using all worker threads
+	bool Bake();
+
+	// pack the coefficients into RGBA texels of a 3D texture with
+	// the slabs stacked along Z (width x height x depth * 7)
+	void GetTextureData(std::vector<float>& texels) const;
+
+	glm::ivec3 GetDimensions() const { return m_dimensions; }
+	glm::vec3 GetBoundsMin() const { return m_boundsMin; }
+	glm::vec3 GetBoundsMax() const { return m_boundsMax; }
+
+private:
+	struct PROBE_OBJECT
+	{
+		glm::vec3 albedo;
+	};
+
+	PROBE_SETTINGS m_settings;
+	std::vector<BAKE_LIGHT> m_lights;
+	std::vector<PROBE_OBJECT> m_objects;
+	SceneRayTracer m_tracer;
+
+	glm::ivec3 m_dimensions;
+	glm::vec3 m_boundsMin;
+	glm::vec3 m_boundsMax;
+	// FLOATS_PER_PROBE floats for every probe
+	std::vector<float> m_coefficients;
+	std::vector<bool> m_validProbes;
+
+	// ray directions and their basis values, structure of arrays
+	// padded to a multiple of four for the vector code
+	int m_rayCount;
+	std::vector<glm::vec3> m_directions;
+	std::vector<float> m_basis[9];
+
+	// build the ray directions and evaluate the basis for them
+	void PrepareDirections();
+	// trace and project one probe
+	void BakeProbe(int probeIndex);
+	// light arriving at a surface point from the scene lights
+	glm::vec3 ComputeDirectLight(const glm::vec3& position, const glm::vec3& normal) const;
+	// replace probes buried inside geometry with valid neighbors
+	void FillInvalidProbes();
+};
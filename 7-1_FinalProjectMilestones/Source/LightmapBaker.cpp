@@ -0,0 +1,700 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightmapbaker.cpp
+// ============
+// bake the lighting of static objects into a lightmap atlas on the CPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightmapBaker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+// declaration of global variables
+namespace
+{
+	const float PI = 3.14159265358979f;
+
+	// identifies lightmap cache files and their layout version
+	const char LIGHTMAP_CACHE_MAGIC[4] = { 'L', 'M', 'A', 'P' };
+	const uint32_t LIGHTMAP_CACHE_VERSION = 1;
+
+	// offset for rays leaving a surface to avoid self intersection
+	const float RAY_OFFSET = 0.01f;
+	const float RAY_MAX_DISTANCE = 1000.0f;
+
+	struct LIGHTMAP_CACHE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t sceneHash;
+		int32_t width;
+		int32_t height;
+		int32_t objectCount;
+	};
+
+	/***********************************************************
+	 *  HashBytes()
+	 *
+	 *  FNV-1a hash, continued from the passed in hash value.
+	 ***********************************************************/
+	uint64_t HashBytes(uint64_t hash, const void* pData, size_t size)
+	{
+		const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= pBytes[i];
+			hash *= 1099511628211ull;
+		}
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  NextRandom()
+	 *
+	 *  Xorshift random number in [0, 1).
+	 ***********************************************************/
+	float NextRandom(uint32_t& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return((state >> 8) * (1.0f / 16777216.0f));
+	}
+
+	/***********************************************************
+	 *  SampleCosineHemisphere()
+	 *
+	 *  Get a direction around the normal distributed by the
+	 *  cosine of the angle to the normal.
+	 ***********************************************************/
+	glm::vec3 SampleCosineHemisphere(const glm::vec3& normal, uint32_t& seed)
+	{
+		float u1 = NextRandom(seed);
+		float u2 = NextRandom(seed);
+		float radius = sqrt(u1);
+		float angle = 2.0f * PI * u2;
+
+		glm::vec3 helper = fabs(normal.x) > 0.9f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+		glm::vec3 tangent = glm::normalize(glm::cross(helper, normal));
+		glm::vec3 bitangent = glm::cross(normal, tangent);
+
+		return(glm::normalize(
+			tangent * (radius * cos(angle))
+			+ bitangent * (radius * sin(angle))
+			+ normal * sqrt(std::max(0.0f, 1.0f - u1))));
+	}
+}
+
+/***********************************************************
+ *  LightmapBaker()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LightmapBaker::LightmapBaker()
+{
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  SetSettings()
+ *
+ *  This method is used for setting the bake quality.
+ ***********************************************************/
+void LightmapBaker::SetSettings(const BAKE_SETTINGS& settings)
+{
+	m_settings = settings;
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all the scene data.
+ ***********************************************************/
+void LightmapBaker::Clear()
+{
+	m_lights.clear();
+	m_objects.clear();
+	m_tracer.Clear();
+	m_texels.clear();
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  AddLight()
+ *
+ *  This method is used for adding a light to the bake.
+ ***********************************************************/
+void LightmapBaker::AddLight(const BAKE_LIGHT& light)
+{
+	m_lights.push_back(light);
+}
+
+/***********************************************************
+ *  AddObject()
+ *
+ *  This method is used for adding a static object to the
+ *  bake. Objects that do not cast shadows, like glass, are
+ *  still baked but are ignored by the rays.
+ ***********************************************************/
+int LightmapBaker::AddObject(
+	const MESH_DATA* pMesh,
+	const glm::mat4& model,
+	const glm::vec3& albedo,
+	bool bCastsShadows)
+{
+	BAKE_OBJECT object;
+	object.pMesh = pMesh;
+	object.model = model;
+	object.albedo = albedo;
+	object.bCastsShadows = bCastsShadows;
+	object.tileX = 0;
+	object.tileY = 0;
+	object.tileSize = 0;
+	m_objects.push_back(object);
+
+	return(static_cast<int>(m_objects.size() - 1));
+}
+
+/***********************************************************
+ *  ComputeSceneHash()
+ *
+ *  This method is used for getting a hash of the lights,
+ *  the objects and the settings so that a stale cache file
+ *  is detected.
+ ***********************************************************/
+uint64_t LightmapBaker::ComputeSceneHash() const
+{
+	uint64_t hash = 14695981039346656037ull;
+
+	hash = HashBytes(hash, &LIGHTMAP_CACHE_VERSION, sizeof(LIGHTMAP_CACHE_VERSION));
+	hash = HashBytes(hash, &m_settings.texelsPerUnit, sizeof(m_settings.texelsPerUnit));
+	hash = HashBytes(hash, &m_settings.minTileSize, sizeof(m_settings.minTileSize));
+	hash = HashBytes(hash, &m_settings.maxTileSize, sizeof(m_settings.maxTileSize));
+	hash = HashBytes(hash, &m_settings.atlasWidth, sizeof(m_settings.atlasWidth));
+	hash = HashBytes(hash, &m_settings.indirectSamples, sizeof(m_settings.indirectSamples));
+	hash = HashBytes(hash, &m_settings.bounces, sizeof(m_settings.bounces));
+
+	for (const BAKE_LIGHT& light : m_lights)
+	{
+		hash = HashBytes(hash, &light, sizeof(BAKE_LIGHT));
+	}
+	for (const BAKE_OBJECT& object : m_objects)
+	{
+		uint32_t vertexCount = static_cast<uint32_t>(object.pMesh->vertices.size());
+		uint32_t indexCount = static_cast<uint32_t>(object.pMesh->indices.size());
+		hash = HashBytes(hash, &object.model, sizeof(glm::mat4));
+		hash = HashBytes(hash, &object.albedo, sizeof(glm::vec3));
+		hash = HashBytes(hash, &object.bCastsShadows, sizeof(bool));
+		hash = HashBytes(hash, &vertexCount, sizeof(vertexCount));
+		hash = HashBytes(hash, &indexCount, sizeof(indexCount));
+	}
+
+	return(hash);
+}
+
+/***********************************************************
+ *  PackTiles()
+ *
+ *  This method is used for sizing each object tile by its
+ *  surface area and placing the tiles on shelves in the
+ *  atlas, largest first.
+ ***********************************************************/
+void LightmapBaker::PackTiles()
+{
+	std::vector<int> order;
+
+	for (size_t i = 0; i < m_objects.size(); i++)
+	{
+		BAKE_OBJECT& object = m_objects[i];
+		float area = ComputeSurfaceArea(*object.pMesh, object.model);
+		int size = static_cast<int>(ceil(sqrt(area) * m_settings.texelsPerUnit));
+		size = std::max(m_settings.minTileSize, std::min(m_settings.maxTileSize, size));
+		object.tileSize = std::min(size, m_settings.atlasWidth);
+		order.push_back(static_cast<int>(i));
+	}
+
+	std::sort(order.begin(), order.end(), [this](int a, int b)
+		{
+			return(m_objects[a].tileSize > m_objects[b].tileSize);
+		});
+
+	int shelfX = 0;
+	int shelfY = 0;
+	int shelfHeight = 0;
+	for (int index : order)
+	{
+		BAKE_OBJECT& object = m_objects[index];
+		if (shelfX + object.tileSize > m_settings.atlasWidth)
+		{
+			shelfY += shelfHeight;
+			shelfX = 0;
+			shelfHeight = 0;
+		}
+		object.tileX = shelfX;
+		object.tileY = shelfY;
+		shelfX += object.tileSize;
+		shelfHeight = std::max(shelfHeight, object.tileSize);
+	}
+
+	// round the atlas height up to a power of two
+	m_width = m_settings.atlasWidth;
+	m_height = 1;
+	while (m_height < shelfY + shelfHeight)
+	{
+		m_height *= 2;
+	}
+}
+
+/***********************************************************
+ *  RasterizeObject()
+ *
+ *  This method is used for drawing the triangles of the
+ *  object into its tile using the lightmap UVs, recording
+ *  the world position and normal at each texel center.
+ ***********************************************************/
+void LightmapBaker::RasterizeObject(const BAKE_OBJECT& object, std::vector<BAKE_TEXEL>& texels) const
+{
+	const MESH_DATA& mesh = *object.pMesh;
+	if (mesh.lightmapUVs.size() != mesh.vertices.size())
+	{
+		return;
+	}
+
+	glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(object.model)));
+
+	for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+	{
+		glm::vec2 pixels[3];
+		for (int corner = 0; corner < 3; corner++)
+		{
+			glm::vec2 uv = mesh.lightmapUVs[mesh.indices[i + corner]];
+			pixels[corner] = glm::vec2(
+				object.tileX + uv.x * object.tileSize,
+				object.tileY + uv.y * object.tileSize);
+		}
+
+		float area = (pixels[1].x - pixels[0].x) * (pixels[2].y - pixels[0].y)
+			- (pixels[2].x - pixels[0].x) * (pixels[1].y - pixels[0].y);
+		if (fabs(area) < 1e-8f)
+		{
+			continue;
+		}
+
+		int minX = std::max(object.tileX, (int)floor(std::min(pixels[0].x, std::min(pixels[1].x, pixels[2].x))));
+		int maxX = std::min(object.tileX + object.tileSize - 1, (int)ceil(std::max(pixels[0].x, std::max(pixels[1].x, pixels[2].x))));
+		int minY = std::max(object.tileY, (int)floor(std::min(pixels[0].y, std::min(pixels[1].y, pixels[2].y))));
+		int maxY = std::min(object.tileY + object.tileSize - 1, (int)ceil(std::max(pixels[0].y, std::max(pixels[1].y, pixels[2].y))));
+
+		for (int y = minY; y <= maxY; y++)
+		{
+			for (int x = minX; x <= maxX; x++)
+			{
+				// barycentric coordinates of the texel center
+				glm::vec2 p(x + 0.5f, y + 0.5f);
+				float w1 = ((p.x - pixels[0].x) * (pixels[2].y - pixels[0].y)
+					- (pixels[2].x - pixels[0].x) * (p.y - pixels[0].y)) / area;
+				float w2 = ((pixels[1].x - pixels[0].x) * (p.y - pixels[0].y)
+					- (p.x - pixels[0].x) * (pixels[1].y - pixels[0].y)) / area;
+				float w0 = 1.0f - w1 - w2;
+				if ((w0 < 0.0f) || (w1 < 0.0f) || (w2 < 0.0f))
+				{
+					continue;
+				}
+
+				const MESH_VERTEX& v0 = mesh.vertices[mesh.indices[i]];
+				const MESH_VERTEX& v1 = mesh.vertices[mesh.indices[i + 1]];
+				const MESH_VERTEX& v2 = mesh.vertices[mesh.indices[i + 2]];
+				glm::vec3 position = v0.position * w0 + v1.position * w1 + v2.position * w2;
+				glm::vec3 normal = v0.normal * w0 + v1.normal * w1 + v2.normal * w2;
+
+				BAKE_TEXEL& texel = texels[y * m_width + x];
+				texel.position = glm::vec3(object.model * glm::vec4(position, 1.0f));
+				texel.normal = glm::normalize(normalMatrix * normal);
+				texel.bCovered = true;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  ComputeDirectLight()
+ *
+ *  This method is used for summing the diffuse light of all
+ *  the scene lights that reach the point, matching the
+ *  ambient and diffuse terms of the fragment shader.
+ ***********************************************************/
+glm::vec3 LightmapBaker::ComputeDirectLight(const glm::vec3& position, const glm::vec3& normal, bool bAmbient) const
+{
+	glm::vec3 irradiance(0.0f);
+	glm::vec3 origin = position + normal * RAY_OFFSET;
+
+	for (const BAKE_LIGHT& light : m_lights)
+	{
+		if (bAmbient)
+		{
+			irradiance += light.ambientColor;
+		}
+
+		glm::vec3 toLight = light.position - position;
+		float distance = glm::length(toLight);
+		if (distance <= 0.0f)
+		{
+			continue;
+		}
+		glm::vec3 direction = toLight / distance;
+		float NdotL = glm::dot(normal, direction);
+		if (NdotL <= 0.0f)
+		{
+			continue;
+		}
+		if (!m_tracer.IsOccluded(origin, direction, distance - RAY_OFFSET))
+		{
+			irradiance += light.diffuseColor * NdotL;
+		}
+	}
+
+	return(irradiance);
+}
+
+/***********************************************************
+ *  ComputeIndirectLight()
+ *
+ *  This method is used for path tracing the diffuse light
+ *  that reaches the point from other surfaces. Paths are
+ *  cosine weighted, so the surface albedo is the only
+ *  throughput factor at each bounce.
+ ***********************************************************/
+glm::vec3 LightmapBaker::ComputeIndirectLight(const glm::vec3& position, const glm::vec3& normal, uint32_t& seed) const
+{
+	glm::vec3 sum(0.0f);
+
+	for (int sample = 0; sample < m_settings.indirectSamples; sample++)
+	{
+		glm::vec3 throughput(1.0f);
+		glm::vec3 origin = position + normal * RAY_OFFSET;
+		glm::vec3 direction = SampleCosineHemisphere(normal, seed);
+
+		for (int bounce = 0; bounce < m_settings.bounces; bounce++)
+		{
+			RAY_HIT hit;
+			if (!m_tracer.Intersect(origin, direction, RAY_MAX_DISTANCE, hit))
+			{
+				break;
+			}
+
+			// the primitives are closed, but treat them as two sided
+			glm::vec3 hitNormal = hit.normal;
+			if (glm::dot(hitNormal, direction) > 0.0f)
+			{
+				hitNormal = -hitNormal;
+			}
+
+			throughput *= m_objects[hit.objectIndex].albedo;
+			sum += throughput * ComputeDirectLight(hit.position, hitNormal, false);
+
+			origin = hit.position + hitNormal * RAY_OFFSET;
+			direction = SampleCosineHemisphere(hitNormal, seed);
+		}
+	}
+
+	return(sum / (float)std::max(1, m_settings.indirectSamples));
+}
+
+/***********************************************************
+ *  BakeRow()
+ *
+ *  This method is used for shading the covered texels of
+ *  one row of the atlas. Every texel has its own random
+ *  sequence so that the result does not depend on the
+ *  number of threads.
+ ***********************************************************/
+void LightmapBaker::BakeRow(int row, const std::vector<BAKE_TEXEL>& texels)
+{
+	for (int x = 0; x < m_width; x++)
+	{
+		int index = row * m_width + x;
+		const BAKE_TEXEL& texel = texels[index];
+		if (!texel.bCovered)
+		{
+			continue;
+		}
+
+		uint32_t seed = static_cast<uint32_t>(index) * 9781u + 6271u;
+		seed = seed ? seed : 1u;
+
+		glm::vec3 irradiance = ComputeDirectLight(texel.position, texel.normal, true);
+		if (m_settings.bounces > 0)
+		{
+			irradiance += ComputeIndirectLight(texel.position, texel.normal, seed);
+		}
+
+		m_texels[index * 3 + 0] = irradiance.x;
+		m_texels[index * 3 + 1] = irradiance.y;
+		m_texels[index * 3 + 2] = irradiance.z;
+	}
+}
+
+/***********************************************************
+ *  DilateTexels()
+ *
+ *  This method is used for copying the baked values into
+ *  the empty gutter texels around each chart so that the
+ *  filtered lookups at chart edges do not fade to black.
+ ***********************************************************/
+void LightmapBaker::DilateTexels(std::vector<BAKE_TEXEL>& texels)
+{
+	const int DILATE_PASSES = 4;
+
+	for (int pass = 0; pass < DILATE_PASSES; pass++)
+	{
+		std::vector<int> filled;
+
+		for (int y = 0; y < m_height; y++)
+		{
+			for (int x = 0; x < m_width; x++)
+			{
+				int index = y * m_width + x;
+				if (texels[index].bCovered)
+				{
+					continue;
+				}
+
+				glm::vec3 sum(0.0f);
+				int count = 0;
+				for (int dy = -1; dy <= 1; dy++)
+				{
+					for (int dx = -1; dx <= 1; dx++)
+					{
+						int nx = x + dx;
+						int ny = y + dy;
+						if ((nx < 0) || (ny < 0) || (nx >= m_width) || (ny >= m_height))
+						{
+							continue;
+						}
+						int neighbor = ny * m_width + nx;
+						if (texels[neighbor].bCovered)
+						{
+							sum += glm::vec3(m_texels[neighbor * 3], m_texels[neighbor * 3 + 1], m_texels[neighbor * 3 + 2]);
+							count++;
+						}
+					}
+				}
+
+				if (count > 0)
+				{
+					sum /= (float)count;
+					m_texels[index * 3 + 0] = sum.x;
+					m_texels[index * 3 + 1] = sum.y;
+					m_texels[index * 3 + 2] = sum.z;
+					filled.push_back(index);
+				}
+			}
+		}
+
+		// mark after the pass so each pass grows by one texel
+		for (int index : filled)
+		{
+			texels[index].bCovered = true;
+		}
+	}
+}
+
+/***********************************************************
+ *  Bake()
+ *
+ *  This method is used for baking the lightmap atlas. The
+ *  atlas rows are handed out to the worker threads through
+ *  a shared counter.
+ ***********************************************************/
+bool LightmapBaker::Bake()
+{
+	if (m_objects.empty())
+	{
+		return(false);
+	}
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	// build the ray tracing scene from the shadow casters
+	m_tracer.Clear();
+	for (size_t i = 0; i < m_objects.size(); i++)
+	{
+		if (m_objects[i].bCastsShadows)
+		{
+			m_tracer.AddMesh(*m_objects[i].pMesh, m_objects[i].model, static_cast<int>(i));
+		}
+	}
+	m_tracer.Build();
+
+	PackTiles();
+
+	std::vector<BAKE_TEXEL> texels(m_width * m_height);
+	for (BAKE_TEXEL& texel : texels)
+	{
+		texel.bCovered = false;
+	}
+	for (const BAKE_OBJECT& object : m_objects)
+	{
+		RasterizeObject(object, texels);
+	}
+	m_texels.assign(m_width * m_height * 3, 0.0f);
+
+	int threadCount = m_settings.threadCount;
+	if (threadCount <= 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	std::cout << "Baking lightmap " << m_width << "x" << m_height
+		<< " for " << m_objects.size() << " objects, "
+		<< m_tracer.GetTriangleCount() << " triangles, "
+		<< threadCount << " threads" << std::endl;
+
+	std::atomic<int> nextRow(0);
+	auto worker = [this, &nextRow, &texels]()
+	{
+		int row = 0;
+		while ((row = nextRow.fetch_add(1)) < m_height)
+		{
+			BakeRow(row, texels);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 1; i < threadCount; i++)
+	{
+		threads.push_back(std::thread(worker));
+	}
+	worker();
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	DilateTexels(texels);
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+	std::cout << "Lightmap baked in " << elapsed.count() << " seconds" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetScaleOffset()
+ *
+ *  This method is used for getting the transform from the
+ *  mesh lightmap UVs into the atlas for one object.
+ ***********************************************************/
+glm::vec4 LightmapBaker::GetScaleOffset(int objectIndex) const
+{
+	if ((objectIndex < 0) || (objectIndex >= (int)m_objects.size()) || (m_width == 0) || (m_height == 0))
+	{
+		return(glm::vec4(1.0f, 1.0f, 0.0f, 0.0f));
+	}
+
+	const BAKE_OBJECT& object = m_objects[objectIndex];
+	return(glm::vec4(
+		(float)object.tileSize / m_width,
+		(float)object.tileSize / m_height,
+		(float)object.tileX / m_width,
+		(float)object.tileY / m_height));
+}
+
+/***********************************************************
+ *  SaveCache()
+ *
+ *  This method is used for writing the baked atlas and the
+ *  tile placements to a binary cache file.
+ ***********************************************************/
+bool LightmapBaker::SaveCache(const char* filename) const
+{
+	if (m_texels.empty())
+	{
+		return(false);
+	}
+
+	std::ofstream file(filename, std::ios::binary);
+	if (!file)
+	{
+		std::cout << "Could not write lightmap cache:" << filename << std::endl;
+		return(false);
+	}
+
+	LIGHTMAP_CACHE_HEADER header;
+	memcpy(header.magic, LIGHTMAP_CACHE_MAGIC, sizeof(header.magic));
+	header.version = LIGHTMAP_CACHE_VERSION;
+	header.sceneHash = ComputeSceneHash();
+	header.width = m_width;
+	header.height = m_height;
+	header.objectCount = static_cast<int32_t>(m_objects.size());
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	for (const BAKE_OBJECT& object : m_objects)
+	{
+		int32_t tile[3] = { object.tileX, object.tileY, object.tileSize };
+		file.write(reinterpret_cast<const char*>(tile), sizeof(tile));
+	}
+	file.write(reinterpret_cast<const char*>(m_texels.data()), m_texels.size() * sizeof(float));
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  LoadCache()
+ *
+ *  This method is used for reading a previously baked atlas.
+ *  The cache is rejected when it was baked for a different
+ *  scene, lights or settings.
+ ***********************************************************/
+bool LightmapBaker::LoadCache(const char* filename)
+{
+	std::ifstream file(filename, std::ios::binary);
+	if (!file)
+	{
+		return(false);
+	}
+
+	LIGHTMAP_CACHE_HEADER header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if ((!file) ||
+		(memcmp(header.magic, LIGHTMAP_CACHE_MAGIC, sizeof(header.magic)) != 0) ||
+		(header.version != LIGHTMAP_CACHE_VERSION) ||
+		(header.sceneHash != ComputeSceneHash()) ||
+		(header.objectCount != (int32_t)m_objects.size()) ||
+		(header.width <= 0) || (header.height <= 0))
+	{
+		std::cout << "Lightmap cache is out of date:" << filename << std::endl;
+		return(false);
+	}
+
+	for (BAKE_OBJECT& object : m_objects)
+	{
+		int32_t tile[3] = { 0, 0, 0 };
+		file.read(reinterpret_cast<char*>(tile), sizeof(tile));
+		object.tileX = tile[0];
+		object.tileY = tile[1];
+		object.tileSize = tile[2];
+	}
+
+	m_width = header.width;
+	m_height = header.height;
+	m_texels.resize(m_width * m_height * 3);
+	file.read(reinterpret_cast<char*>(m_texels.data()), m_texels.size() * sizeof(float));
+	if (!file)
+	{
+		m_texels.clear();
+		return(false);
+	}
+
+	std::cout << "Loaded lightmap cache:" << filename << ", width:" << m_width << ", height:" << m_height << std::endl;
+
+	return(true);
+}
@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightmapbaker.h
+// ============
+// bake the lighting of static objects into a lightmap atlas on the CPU
+//
+// Each object gets a square tile of the atlas that is addressed with the
+// lightmap UVs of its mesh. Every covered texel is path traced against the
+// static scene for direct light with shadows plus diffuse interreflection.
+// The work is spread over all the available CPU cores and the result can be
+// written to and read back from a cache file.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshBuilder.h"
+#include "SceneRayTracer.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// point light as used by the fragment shader
+struct BAKE_LIGHT
+{
+	glm::vec3 position;
+	glm::vec3 ambientColor;
+	glm::vec3 diffuseColor;
+};
+
+// quality settings for the bake
+struct BAKE_SETTINGS
+{
+	// lightmap texels per world unit before clamping
+	float texelsPerUnit = 2.0f;
+	int minTileSize = 16;
+	int maxTileSize = 256;
+	int atlasWidth = 1024;
+	// hemisphere samples per texel for the indirect light
+	int indirectSamples = 64;
+	// number of diffuse bounces after the direct light
+	int bounces = 2;
+	// zero uses all hardware threads
+	int threadCount = 0;
+};
+
+class LightmapBaker
+{
+public:
+	// constructor
+	LightmapBaker();
+
+	// set the quality settings - must be called before adding objects
+	void SetSettings(const BAKE_SETTINGS& settings);
+	// remove all lights, objects and baked data
+	void Clear();
+	// add a light to the baked scene
+	void AddLight(const BAKE_LIGHT& light);
+	// add a static object and get its index in the atlas
+	int AddObject(
+		const MESH_DATA* pMesh,
+		const glm::mat4& model,
+		const glm::vec3& albedo,
+		bool bCastsShadows);
+
+	// get a hash of everything that affects the baked result
+	uint64_t ComputeSceneHash() const;
+	// bake the lightmap atlas using all worker threads
+	bool Bake();
+
+	// write the baked atlas to a cache file
+	bool SaveCache(const char* filename) const;
+	// read the baked atlas from a cache file if it matches the scene
+	bool LoadCache(const char* filename);
+
+	int GetWidth() const { return m_width; }
+	int GetHeight() const { return m_height; }
+	// RGB irradiance for every atlas texel
+	const std::vector<float>& GetTexels() const { return m_texels; }
+	// scale (xy) and offset (zw) of an object tile in the atlas
+	glm::vec4 GetScaleOffset(int objectIndex) const;
+
+private:
+	struct BAKE_OBJECT
+	{
+		const MESH_DATA* pMesh;
+		glm::mat4 model;
+		glm::vec3 albedo;
+		bool bCastsShadows;
+		// tile placement in the atlas
+		int tileX;
+		int tileY;
+		int tileSize;
+	};
+
+	// texel to be shaded, found by rasterizing the lightmap UVs
+	struct BAKE_TEXEL
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		bool bCovered;
+	};
+
+	BAKE_SETTINGS m_settings;
+	std::vector<BAKE_LIGHT> m_lights;
+	std::vector<BAKE_OBJECT> m_objects;
+	SceneRayTracer m_tracer;
+
+	int m_width;
+	int m_height;
+	std::vector<float> m_texels;
+
+	// assign each object a tile in the atlas
+	void PackTiles();
+	// find the surface point behind every covered texel
+	void RasterizeObject(const BAKE_OBJECT& object, std::vector<BAKE_TEXEL>& texels) const;
+	// shade all the covered texels of one atlas row
+	void BakeRow(int row, const std::vector<BAKE_TEXEL>& texels);
+	// light arriving at a point directly from the scene lights
+	glm::vec3 ComputeDirectLight(const glm::vec3& position, const glm::vec3& normal, bool bAmbient) const;
+	// light arriving at a point after bouncing off other surfaces
+	glm::vec3 ComputeIndirectLight(const glm::vec3& position, const glm::vec3& normal, uint32_t& seed) const;
+	// fill the uncovered texels from their covered neighbors
+	void DilateTexels(std::vector<BAKE_TEXEL>& texels);
+};
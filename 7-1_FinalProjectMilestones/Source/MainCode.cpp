@@ -1,205 +1,685 @@
-#include <iostream>         // error handling and output
-#include <cstdlib>          // EXIT_FAILURE
-
-#include <GL/glew.h>        // GLEW library
-#include "GLFW/glfw3.h"     // GLFW library
-
-// GLM Math Header inclusions
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
-#include "SceneManager.h"
-#include "ViewManager.h"
-#include "ShapeMeshes.h"
-#include "ShaderManager.h"
-
-
-
-
-// Namespace for declaring global variables
-namespace
-{
-	// Macro for window title
-	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
-
-	// Main GLFW window
-	GLFWwindow* g_Window = nullptr;
-
-	// scene manager object for managing the 3D scene prepare and render
-	SceneManager* g_SceneManager = nullptr;
-	// shader manager object for dynamic interaction with the shader code
-	ShaderManager* g_ShaderManager = nullptr;
-	// view manager object for managing the 3D view setup and projection to 2D
-	ViewManager* g_ViewManager = nullptr;
-}
-
-// Function declarations - all functions that are called manually
-// need to be pre-declared at the beginning of the source code.
-bool InitializeGLFW();
-bool InitializeGLEW();
-
-
-/***********************************************************
- *  main(int, char*)
- *
- *  This function gets called after the application has been
- *  launched.
- ***********************************************************/
-int main(int argc, char* argv[])
-{
-	// if GLFW fails initialization, then terminate the application
-	if (InitializeGLFW() == false)
-	{
-		return(EXIT_FAILURE);
-	}
-
-	// try to create a new shader manager object
-	g_ShaderManager = new ShaderManager();
-	// try to create a new view manager object
-	g_ViewManager = new ViewManager(
-		g_ShaderManager);
-
-	// try to create the main display window
-	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
-
-	// if GLEW fails initialization, then terminate the application
-	if (InitializeGLEW() == false)
-	{
-		return(EXIT_FAILURE);
-	}
-
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/vertexShader.glsl",
-		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
-
-	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
-	g_SceneManager->PrepareScene();
-
-	// Text to define keys and their functions
-	std::cout << "\n" << std::endl;
-	std::cout << "Below will define the movement functions of the camera" << std::endl;
-	std::cout << "W key = Move Forward" << std::endl;
-	std::cout << "S key = Move Backwards" << std::endl;
-	std::cout << "A key = Move Left" << std::endl;
-	std::cout << "D key = Move Right" << std::endl;
-	std::cout << "Q key = Move Down" << std::endl;
-	std::cout << "E key = Move Up\n" << std::endl;
-	std::cout << "Below will define the viewing functions of the camera" << std::endl;
-	std::cout << "UP Arrow key    = Look Down" << std::endl;
-	std::cout << "Down Arrow key  = Look Up" << std::endl;
-	std::cout << "Left Arrow key  = Look Left" << std::endl;
-	std::cout << "Right Arrow key = Look Right \n" << std::endl;
-	std::cout << "Below will define how to change between the Orthographic and Perspective views" << std::endl;
-	std::cout << "T key = Set view to Orthographic" << std::endl;
-	std::cout << "G key = Set view to Perspective" << std::endl;
-	std::cout << "View is set to Perspective by default at start of program\n" << std::endl;
-	std::cout << "Below will define a set of preset camera views" << std::endl;
-	std::cout << "Num 1 key = Look from home position" << std::endl;
-	std::cout << "Num 2 key = Look out the window" << std::endl;
-	std::cout << "Num 3 key = Look over desk" << std::endl;
-
-
-
-	// loop will keep running until the application is closed 
-	// or until an error has occurred
-	while (!glfwWindowShouldClose(g_Window))
-	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
-
-		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
-
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
-
-
-		// Flips the the back buffer with the front buffer every frame.
-		glfwSwapBuffers(g_Window);
-
-		// query the latest GLFW events
-		glfwPollEvents();
-	}
-
-	// clear the allocated manager objects from memory
-	if (NULL != g_SceneManager)
-	{
-		delete g_SceneManager;
-		g_SceneManager = NULL;
-	}
-	if (NULL != g_ViewManager)
-	{
-		delete g_ViewManager;
-		g_ViewManager = NULL;
-	}
-	if (NULL != g_ShaderManager)
-	{
-		delete g_ShaderManager;
-		g_ShaderManager = NULL;
-	}
-
-	// Terminates the program successfully
-	exit(EXIT_SUCCESS); 
-}
-
-/***********************************************************
- *	InitializeGLFW()
- * 
- *  This function is used to initialize the GLFW library.   
- ***********************************************************/
-bool InitializeGLFW()
-{
-	// GLFW: initialize and configure library
-	// --------------------------------------
-	glfwInit();
-
-#ifdef __APPLE__
-	// set the version of OpenGL and profile to use
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#else
-	// set the version of OpenGL and profile to use
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-#endif
-	// GLFW: end -------------------------------
-
-	return(true);
-}
-
-/***********************************************************
- *	InitializeGLEW()
- *
- *  This function is used to initialize the GLEW library.
- ***********************************************************/
-bool InitializeGLEW()
-{
-	// GLEW: initialize
-	// -----------------------------------------
-	GLenum GLEWInitResult = GLEW_OK;
-
-	// try to initialize the GLEW library
-	GLEWInitResult = glewInit();
-	if (GLEW_OK != GLEWInitResult)
-	{
-		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
-		return false;
-	}
-	// GLEW: end -------------------------------
-
-	// Displays a successful OpenGL initialization message
-	std::cout << "INFO: OpenGL Successfully Initialized\n";
-	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
-
-	return(true);
-}
\ No newline at end of file
+#include <iostream>         // error handling and output
+#include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // command line options
+#include <chrono>           // startup timing
+
+#include <GL/glew.h>        // GLEW library
+#include "GLFW/glfw3.h"     // GLFW library
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "ShapeMeshes.h"
+#include "ShaderManager.h"
+#include "RenderSettings.h"
+#include "FrameStats.h"
+#include "ShaderCache.h"
+#include "DynamicResolution.h"
+#include "FramePacer.h"
+#include "GLStateCache.h"
+
+
+
+
+// Namespace for declaring global variables
+namespace
+{
+	// Macro for window title
+	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
+
+	// Main GLFW window
+	GLFWwindow* g_Window = nullptr;
+
+	// scene manager object for managing the 3D scene prepare and render
+	SceneManager* g_SceneManager = nullptr;
+	// shader manager object for dynamic interaction with the shader code
+	ShaderManager* g_ShaderManager = nullptr;
+	// view manager object for managing the 3D view setup and projection to 2D
+	ViewManager* g_ViewManager = nullptr;
+	// frame timing used by the benchmark mode
+	FrameStats* g_FrameStats = nullptr;
+	// offscreen target scaled to the frame budget
+	DynamicResolution* g_DynamicResolution = nullptr;
+	// swap interval, frame rate limit and interval statistics
+	FramePacer* g_FramePacer = nullptr;
+
+	// frames rendered before the benchmark starts measuring,
+	// so that bakes and shader loading are not counted
+	const int BENCHMARK_WARMUP_FRAMES = 30;
+	// frames drawn before the occlusion check, enough for the
+	// depth pyramid of the walls to be copied back to the CPU
+	const int OCCLUSION_CHECK_FRAMES = 10;
+	// position and direction of the camera for the occlusion
+	// check, close enough to the left wall that only the wall
+	// fills the view while the garden backdrop lies behind it
+	const glm::vec3 OCCLUSION_CHECK_POSITION(-37.5f, 20.0f, -4.0f);
+	const glm::vec3 OCCLUSION_CHECK_FRONT(0.0f, 0.0f, -1.0f);
+
+	// returned when the program ends, a failed check ends it
+	// unsuccessfully
+	int g_ExitStatus = EXIT_SUCCESS;
+
+	// input and camera are updated at a fixed rate, independent
+	// of how often frames are rendered
+	const double UPDATE_TIMESTEP = 1.0 / 120.0;
+	// longest frame time that is caught up with update steps,
+	// so a stall does not cause a burst of updates
+	const double MAX_FRAME_TIME = 0.25;
+
+	// longest sleep of the render on demand mode before the
+	// loop checks the window again
+	const double ON_DEMAND_WAIT_TIMEOUT = 0.5;
+
+	// set by GLFW when the window contents were damaged
+	bool g_bWindowDamaged = false;
+
+	// frames drawn for each redraw reason
+	int g_RedrawCounts[REDRAW_REASON_COUNT] = { 0 };
+	int g_RedrawFrames = 0;
+	const char* const g_RedrawReasonNames[REDRAW_REASON_COUNT] =
+	{
+		"startup", "camera", "settings", "window"
+	};
+}
+
+// runtime rendering switches shared with the view and scene managers
+RENDER_SETTINGS g_RenderSettings;
+
+// shadow copy of the OpenGL state shared by all the renderers
+GLStateCache g_GLState;
+
+// Function declarations - all functions that are called manually
+// need to be pre-declared at the beginning of the source code.
+bool InitializeGLFW();
+bool InitializeGLEW();
+void ParseCommandLine(int argc, char* argv[]);
+bool UpdateBenchmark();
+bool UpdateOcclusionCheck();
+void Window_Refresh_Callback(GLFWwindow* window);
+void CountRedraw(unsigned int redrawReasons);
+void ReportRedraws();
+
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the application has been
+ *  launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	// apply any rendering options given at launch
+	ParseCommandLine(argc, argv);
+
+	// if GLFW fails initialization, then terminate the application
+	if (InitializeGLFW() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// try to create a new shader manager object
+	g_ShaderManager = new ShaderManager();
+	// try to create a new view manager object
+	g_ViewManager = new ViewManager(
+		g_ShaderManager);
+
+	// try to create the main display window
+	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+
+	// if GLEW fails initialization, then terminate the application
+	if (InitializeGLEW() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// load the shader code from the external GLSL files, using
+	// the program binary cached by an earlier launch if it matches
+	auto shaderStart = std::chrono::steady_clock::now();
+	g_ShaderManager->m_programID = LoadShaderProgram(
+		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/vertexShader.glsl",
+		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/fragmentShader.glsl");
+	if (g_ShaderManager->m_programID == 0)
+	{
+		g_ShaderManager->LoadShaders(
+			"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/vertexShader.glsl",
+			"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/fragmentShader.glsl");
+	}
+	std::chrono::duration<double, std::milli> shaderTime = std::chrono::steady_clock::now() - shaderStart;
+	int cacheHits = 0;
+	int cacheMisses = 0;
+	GetShaderCacheCounts(cacheHits, cacheMisses);
+	std::cout << "INFO: Shaders ready in " << shaderTime.count() << " ms"
+		<< (cacheHits > 0 ? " (program binary cache)" : " (compiled)") << "\n" << std::endl;
+	g_GLState.UseProgram(g_ShaderManager->m_programID);
+
+	// try to create a new scene manager object and prepare the 3D scene
+	g_SceneManager = new SceneManager(g_ShaderManager);
+	g_SceneManager->PrepareScene();
+	if (g_RenderSettings.bCheckOcclusion)
+	{
+		g_ViewManager->SetCamera(OCCLUSION_CHECK_POSITION, OCCLUSION_CHECK_FRONT);
+	}
+
+	// Text to define keys and their functions
+	std::cout << "\n" << std::endl;
+	std::cout << "Below will define the movement functions of the camera" << std::endl;
+	std::cout << "W key = Move Forward" << std::endl;
+	std::cout << "S key = Move Backwards" << std::endl;
+	std::cout << "A key = Move Left" << std::endl;
+	std::cout << "D key = Move Right" << std::endl;
+	std::cout << "Q key = Move Down" << std::endl;
+	std::cout << "E key = Move Up\n" << std::endl;
+	std::cout << "Below will define the viewing functions of the camera" << std::endl;
+	std::cout << "UP Arrow key    = Look Down" << std::endl;
+	std::cout << "Down Arrow key  = Look Up" << std::endl;
+	std::cout << "Left Arrow key  = Look Left" << std::endl;
+	std::cout << "Right Arrow key = Look Right \n" << std::endl;
+	std::cout << "Below will define how to change between the Orthographic and Perspective views" << std::endl;
+	std::cout << "T key = Set view to Orthographic" << std::endl;
+	std::cout << "G key = Set view to Perspective" << std::endl;
+	std::cout << "View is set to Perspective by default at start of program\n" << std::endl;
+	std::cout << "Below will define a set of preset camera views" << std::endl;
+	std::cout << "Num 1 key = Look from home position" << std::endl;
+	std::cout << "Num 2 key = Look out the window" << std::endl;
+	std::cout << "Num 3 key = Look over desk\n" << std::endl;
+	std::cout << "Below will define the rendering options" << std::endl;
+	std::cout << "L key = Toggle baked lightmaps for the static objects" << std::endl;
+	std::cout << "I key = Toggle irradiance probes for the ambient light" << std::endl;
+	std::cout << "R key = Toggle deferred shading" << std::endl;
+	std::cout << "P key = Toggle the specialized shader permutations" << std::endl;
+	std::cout << "O key = Toggle order-independent transparency" << std::endl;
+	std::cout << "F key = Toggle rendering only when the view changes" << std::endl;
+	std::cout << "U key = Toggle the mapped upload buffer for the object values" << std::endl;
+	std::cout << "K key = Toggle the distance-based levels of detail of the round shapes" << std::endl;
+	std::cout << "C key = Toggle the quantized vertex layout of the meshes" << std::endl;
+	std::cout << "B key = Toggle the merged draws of the static objects" << std::endl;
+	std::cout << "M key = Toggle the culling of the clusters of large models" << std::endl;
+	std::cout << "X key = Toggle the culling of the opaque objects on the GPU" << std::endl;
+	std::cout << "Z key = Toggle the culling of the objects hidden behind large ones" << std::endl;
+	std::cout << "H key = Toggle the render resolution that follows the frame budget" << std::endl;
+	std::cout << "V key = Switch vsync between on, off and adaptive" << std::endl;
+
+	g_FrameStats = new FrameStats();
+	g_DynamicResolution = new DynamicResolution();
+	g_FramePacer = new FramePacer();
+
+	// the window is drawn again when it is uncovered or resized
+	glfwSetWindowRefreshCallback(g_Window, Window_Refresh_Callback);
+
+	double previousTime = glfwGetTime();
+	double updateTime = 0.0;
+	unsigned int redrawReasons = (1u << REDRAW_STARTUP);
+
+	// loop will keep running until the application is closed 
+	// or until an error has occurred
+	while (!glfwWindowShouldClose(g_Window))
+	{
+		// run as many fixed update steps as the elapsed time holds
+		double currentTime = glfwGetTime();
+		double frameTime = currentTime - previousTime;
+		previousTime = currentTime;
+		if (frameTime > MAX_FRAME_TIME)
+		{
+			frameTime = MAX_FRAME_TIME;
+		}
+		updateTime += frameTime;
+		while (updateTime >= UPDATE_TIMESTEP)
+		{
+			redrawReasons |= g_ViewManager->UpdateView(static_cast<float>(UPDATE_TIMESTEP));
+			updateTime -= UPDATE_TIMESTEP;
+		}
+		if (g_bWindowDamaged)
+		{
+			redrawReasons |= (1u << REDRAW_WINDOW);
+			g_bWindowDamaged = false;
+		}
+
+		// the benchmark and the occlusion check always draw
+		// continuously
+		bool bOnDemand = g_RenderSettings.bRenderOnDemand &&
+			(g_RenderSettings.benchmarkFrames == 0) && (!g_RenderSettings.bCheckOcclusion);
+		if ((bOnDemand) && (redrawReasons == 0))
+		{
+			if ((g_ViewManager->IsAnyActionHeld()) || (g_ViewManager->HasPendingInput()))
+			{
+				// a held key moves the camera, so only wait for the
+				// next update step
+				glfwWaitEventsTimeout(UPDATE_TIMESTEP - updateTime);
+			}
+			else
+			{
+				// nothing is changing, sleep until an event arrives
+				// and start the next update step from there
+				glfwWaitEventsTimeout(ON_DEMAND_WAIT_TIMEOUT);
+				previousTime = glfwGetTime();
+				updateTime = UPDATE_TIMESTEP;
+			}
+			g_FramePacer->RestartInterval();
+			continue;
+		}
+		if (bOnDemand)
+		{
+			CountRedraw(redrawReasons);
+		}
+		redrawReasons = 0;
+
+		g_FrameStats->BeginFrame();
+		g_GLState.BeginFrame();
+
+		// draw into the scaled offscreen target when the
+		// resolution follows the frame budget
+		bool bScaled = false;
+		if (g_RenderSettings.bUseDynamicResolution)
+		{
+			int windowWidth = 0;
+			int windowHeight = 0;
+			glfwGetFramebufferSize(g_Window, &windowWidth, &windowHeight);
+			bScaled = g_DynamicResolution->BeginFrame(
+				windowWidth, windowHeight,
+				g_FrameStats->GetLastGpuMs(),
+				g_RenderSettings.frameBudgetMs);
+			if (!bScaled)
+			{
+				g_RenderSettings.bUseDynamicResolution = false;
+			}
+		}
+
+		// Enable z-depth
+		g_GLState.Enable(GL_DEPTH_TEST);
+
+		// Clear the frame and z buffers
+		g_GLState.ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// convert from 3D object space to 2D view, between the
+		// last two update steps, or at the latest step when the
+		// frame may be the last one for a while
+		float interpolation = (bOnDemand ? 1.0f : static_cast<float>(updateTime / UPDATE_TIMESTEP));
+		g_ViewManager->PrepareSceneView(interpolation);
+		g_SceneManager->SetViewTransform(
+			g_ViewManager->GetViewMatrix(),
+			g_ViewManager->GetProjectionMatrix(),
+			g_ViewManager->GetViewPosition());
+
+		// refresh the 3D scene
+		g_SceneManager->RenderScene();
+
+		if (bScaled)
+		{
+			g_DynamicResolution->EndFrame();
+		}
+
+		g_GLState.EndFrame();
+		g_FrameStats->EndFrame();
+		if ((g_RenderSettings.benchmarkFrames > 0) && (!UpdateBenchmark()))
+		{
+			glfwSetWindowShouldClose(g_Window, true);
+		}
+		if ((g_RenderSettings.bCheckOcclusion) && (!UpdateOcclusionCheck()))
+		{
+			glfwSetWindowShouldClose(g_Window, true);
+		}
+
+		// the benchmark measures the rendering rather than the
+		// display refresh, so it never waits
+		if (g_RenderSettings.benchmarkFrames > 0)
+		{
+			g_FramePacer->SetSwapInterval(0);
+		}
+		else
+		{
+			g_FramePacer->SetSwapInterval(g_RenderSettings.swapInterval);
+			g_FramePacer->WaitForNextFrame(g_RenderSettings.targetFps);
+		}
+
+		// Flips the the back buffer with the front buffer every frame.
+		glfwSwapBuffers(g_Window);
+		g_FramePacer->FramePresented();
+
+		// query the latest GLFW events
+		glfwPollEvents();
+	}
+
+	ReportRedraws();
+	g_FramePacer->Report();
+	g_GLState.Report();
+
+	// clear the allocated manager objects from memory
+	if (NULL != g_FramePacer)
+	{
+		delete g_FramePacer;
+		g_FramePacer = NULL;
+	}
+	if (NULL != g_DynamicResolution)
+	{
+		delete g_DynamicResolution;
+		g_DynamicResolution = NULL;
+	}
+	if (NULL != g_FrameStats)
+	{
+		delete g_FrameStats;
+		g_FrameStats = NULL;
+	}
+	if (NULL != g_SceneManager)
+	{
+		delete g_SceneManager;
+		g_SceneManager = NULL;
+	}
+	if (NULL != g_ViewManager)
+	{
+		delete g_ViewManager;
+		g_ViewManager = NULL;
+	}
+	if (NULL != g_ShaderManager)
+	{
+		delete g_ShaderManager;
+		g_ShaderManager = NULL;
+	}
+
+	// Terminates the program, unsuccessfully after a failed check
+	exit(g_ExitStatus); 
+}
+
+/***********************************************************
+ *	InitializeGLFW()
+ * 
+ *  This function is used to initialize the GLFW library.   
+ ***********************************************************/
+bool InitializeGLFW()
+{
+	// GLFW: initialize and configure library
+	// --------------------------------------
+	glfwInit();
+
+#ifdef __APPLE__
+	// set the version of OpenGL and profile to use
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#else
+	// set the version of OpenGL and profile to use
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
+	// GLFW: end -------------------------------
+
+	return(true);
+}
+
+/***********************************************************
+ *	InitializeGLEW()
+ *
+ *  This function is used to initialize the GLEW library.
+ ***********************************************************/
+bool InitializeGLEW()
+{
+	// GLEW: initialize
+	// -----------------------------------------
+	GLenum GLEWInitResult = GLEW_OK;
+
+	// try to initialize the GLEW library
+	GLEWInitResult = glewInit();
+	if (GLEW_OK != GLEWInitResult)
+	{
+		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
+		return false;
+	}
+	// GLEW: end -------------------------------
+
+	// Displays a successful OpenGL initialization message
+	std::cout << "INFO: OpenGL Successfully Initialized\n";
+	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *	ParseCommandLine()
+ *
+ *  This function is used to apply the rendering options
+ *  passed in on the command line.
+ ***********************************************************/
+void ParseCommandLine(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--baked-lighting") == 0)
+		{
+			g_RenderSettings.bUseBakedLighting = true;
+		}
+		else if (strcmp(argv[i], "--probe-lighting") == 0)
+		{
+			g_RenderSettings.bUseProbeLighting = true;
+		}
+		else if (strcmp(argv[i], "--deferred") == 0)
+		{
+			g_RenderSettings.bUseDeferredShading = true;
+		}
+		else if (strcmp(argv[i], "--no-permutations") == 0)
+		{
+			g_RenderSettings.bUseShaderPermutations = false;
+		}
+		else if (strcmp(argv[i], "--oit") == 0)
+		{
+			g_RenderSettings.bUseOIT = true;
+		}
+		else if (strcmp(argv[i], "--on-demand") == 0)
+		{
+			g_RenderSettings.bRenderOnDemand = true;
+		}
+		else if (strcmp(argv[i], "--no-upload-ring") == 0)
+		{
+			g_RenderSettings.bUseUploadRing = false;
+		}
+		else if (strcmp(argv[i], "--no-lod") == 0)
+		{
+			g_RenderSettings.bUseLod = false;
+		}
+		else if (strcmp(argv[i], "--float-vertices") == 0)
+		{
+			g_RenderSettings.bUseCompactVertices = false;
+		}
+		else if (strcmp(argv[i], "--no-batching") == 0)
+		{
+			g_RenderSettings.bUseStaticBatching = false;
+		}
+		else if (strcmp(argv[i], "--no-meshlets") == 0)
+		{
+			g_RenderSettings.bUseMeshletCulling = false;
+		}
+		else if (strcmp(argv[i], "--gpu-culling") == 0)
+		{
+			g_RenderSettings.bUseGPUCulling = true;
+		}
+		else if (strcmp(argv[i], "--no-occlusion") == 0)
+		{
+			g_RenderSettings.bUseOcclusionCulling = false;
+		}
+		else if (strcmp(argv[i], "--dynamic-resolution") == 0)
+		{
+			g_RenderSettings.bUseDynamicResolution = true;
+		}
+		else if ((strcmp(argv[i], "--frame-budget") == 0) && (i + 1 < argc))
+		{
+			g_RenderSettings.frameBudgetMs = static_cast<float>(atof(argv[++i]));
+		}
+		else if ((strcmp(argv[i], "--vsync") == 0) && (i + 1 < argc))
+		{
+			i++;
+			if (strcmp(argv[i], "off") == 0)
+			{
+				g_RenderSettings.swapInterval = 0;
+			}
+			else if (strcmp(argv[i], "adaptive") == 0)
+			{
+				g_RenderSettings.swapInterval = -1;
+			}
+			else
+			{
+				g_RenderSettings.swapInterval = 1;
+			}
+		}
+		else if ((strcmp(argv[i], "--fps-limit") == 0) && (i + 1 < argc))
+		{
+			g_RenderSettings.targetFps = static_cast<float>(atof(argv[++i]));
+		}
+		else if ((strcmp(argv[i], "--benchmark") == 0) && (i + 1 < argc))
+		{
+			g_RenderSettings.benchmarkFrames = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--check-occlusion") == 0)
+		{
+			g_RenderSettings.bCheckOcclusion = true;
+			g_RenderSettings.bUseOcclusionCulling = true;
+		}
+		else if ((strcmp(argv[i], "--stress-scene") == 0) && (i + 1 < argc))
+		{
+			g_RenderSettings.stressObjects = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--stress-lights") == 0) && (i + 1 < argc))
+		{
+			g_RenderSettings.stressLights = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--seed") == 0) && (i + 1 < argc))
+		{
+			g_RenderSettings.stressSeed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+		}
+		else
+		{
+			std::cout << "Unknown option: " << argv[i] << std::endl;
+		}
+	}
+}
+
+/***********************************************************
+ *	UpdateBenchmark()
+ *
+ *  This function is used to count the benchmark frames. The
+ *  forward and deferred render paths are measured one after
+ *  the other, starting with the one chosen at launch, and a
+ *  line is printed for each. Returns false when done.
+ ***********************************************************/
+bool UpdateBenchmark()
+{
+	static int frameCount = 0;
+	static int measuredPaths = 0;
+
+	frameCount++;
+	if (frameCount == BENCHMARK_WARMUP_FRAMES)
+	{
+		g_FrameStats->Reset();
+	}
+	if (frameCount < BENCHMARK_WARMUP_FRAMES + g_RenderSettings.benchmarkFrames)
+	{
+		return(true);
+	}
+
+	// the size of the scene goes with the timings, so runs of
+	// several stress scenes can be put on one curve, and the
+	// forward path only shades its first lights
+	if (measuredPaths == 0)
+	{
+		std::cout << "BENCHMARK scene: objects=" << g_SceneManager->GetObjectCount()
+			<< " lights=" << g_SceneManager->GetLightCount()
+			<< " forward_lights=" << g_SceneManager->GetForwardLightCount() << std::endl;
+	}
+	g_FrameStats->Report(g_RenderSettings.bUseDeferredShading ? "deferred" : "forward");
+
+	frameCount = 0;
+	measuredPaths++;
+	if (measuredPaths >= 2)
+	{
+		return(false);
+	}
+
+	g_RenderSettings.bUseDeferredShading = !g_RenderSettings.bUseDeferredShading;
+
+	return(true);
+}
+
+/***********************************************************
+ *	UpdateOcclusionCheck()
+ *
+ *  This function is used to count the frames of the
+ *  occlusion check. Once the depth pyramid of the walls has
+ *  reached the CPU, the garden backdrop behind the left
+ *  wall has to be culled, and a line with the result is
+ *  printed. Returns false when done.
+ ***********************************************************/
+bool UpdateOcclusionCheck()
+{
+	static int frameCount = 0;
+
+	frameCount++;
+	if (frameCount < OCCLUSION_CHECK_FRAMES)
+	{
+		return(true);
+	}
+
+	if (g_SceneManager->IsObjectOccluded("Outside"))
+	{
+		std::cout << "OCCLUSION CHECK passed: Outside is culled behind the wall" << std::endl;
+	}
+	else
+	{
+		std::cout << "OCCLUSION CHECK failed: Outside is drawn behind the wall" << std::endl;
+		g_ExitStatus = EXIT_FAILURE;
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *	Window_Refresh_Callback()
+ *
+ *  This function is called from GLFW whenever the window
+ *  contents need to be drawn again.
+ ***********************************************************/
+void Window_Refresh_Callback(GLFWwindow* /*window*/)
+{
+	g_bWindowDamaged = true;
+}
+
+/***********************************************************
+ *	CountRedraw()
+ *
+ *  This function is used to count a frame drawn in render
+ *  on demand mode under each of its redraw reasons.
+ ***********************************************************/
+void CountRedraw(unsigned int redrawReasons)
+{
+	g_RedrawFrames++;
+	for (int i = 0; i < REDRAW_REASON_COUNT; i++)
+	{
+		if (redrawReasons & (1u << i))
+		{
+			g_RedrawCounts[i]++;
+		}
+	}
+}
+
+/***********************************************************
+ *	ReportRedraws()
+ *
+ *  This function is used to print why the frames of the
+ *  render on demand mode were drawn.
+ ***********************************************************/
+void ReportRedraws()
+{
+	if (g_RedrawFrames == 0)
+	{
+		return;
+	}
+
+	std::cout << "REDRAW: frames=" << g_RedrawFrames;
+	for (int i = 0; i < REDRAW_REASON_COUNT; i++)
+	{
+		std::cout << " " << g_RedrawReasonNames[i] << "=" << g_RedrawCounts[i];
+	}
+	std::cout << std::endl;
+}
@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.cpp
+// ============
+// read-only view of a whole file mapped into memory
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/***********************************************************
+ *  MappedFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MappedFile::MappedFile()
+{
+	m_pData = NULL;
+	m_size = 0;
+}
+
+/***********************************************************
+ *  ~MappedFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a whole file read-only.
+ *  The handles are closed at once, the view keeps the
+ *  mapping alive.
+ ***********************************************************/
+bool MappedFile::Open(const char* filename)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return(false);
+	}
+	LARGE_INTEGER fileSize;
+	if ((!GetFileSizeEx(file, &fileSize)) || (fileSize.QuadPart <= 0))
+	{
+		CloseHandle(file);
+		return(false);
+	}
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	void* pView = NULL;
+	if (NULL != mapping)
+	{
+		pView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+	}
+	CloseHandle(file);
+	if (NULL == pView)
+	{
+		return(false);
+	}
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	int file = open(filename, O_RDONLY);
+	if (file < 0)
+	{
+		return(false);
+	}
+	struct stat fileStat;
+	if ((fstat(file, &fileStat) != 0) || (fileStat.st_size <= 0))
+	{
+		close(file);
+		return(false);
+	}
+	void* pView = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (pView == MAP_FAILED)
+	{
+		return(false);
+	}
+	m_size = static_cast<size_t>(fileStat.st_size);
+#endif
+
+	m_pData = static_cast<const unsigned char*>(pView);
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for releasing the view.
+ ***********************************************************/
+void MappedFile::Close()
+{
+	if (NULL != m_pData)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_pData);
+#else
+		munmap(const_cast<unsigned char*>(m_pData), m_size);
+#endif
+		m_pData = NULL;
+	}
+	m_size = 0;
+}
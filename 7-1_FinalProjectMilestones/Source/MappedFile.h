@@ -0,0 +1,34 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.h
+// ============
+// read-only view of a whole file mapped into memory
+//
+// The operating system pages the file in as it is read, so large files are
+// used in place without first copying them into a buffer, and the pages are
+// shared with the file cache instead of taking memory of their own.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+class MappedFile
+{
+public:
+	// constructor
+	MappedFile();
+	// destructor
+	~MappedFile();
+
+	// map a file, returns false when it is missing or empty
+	bool Open(const char* filename);
+	// unmap the file, which ends all pointers into it
+	void Close();
+
+	const unsigned char* GetData() const { return m_pData; }
+	size_t GetSize() const { return m_size; }
+
+private:
+	const unsigned char* m_pData;
+	size_t m_size;
+};
@@ -0,0 +1,686 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshbuilder.cpp
+// ============
+// build CPU-side copies of the basic shape meshes and upload them to OpenGL
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshBuilder.h"
+#include "GLStateCache.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	const float PI = 3.14159265358979f;
+
+	// fraction of each lightmap chart that is kept empty around
+	// the border so that bilinear filtering does not bleed
+	const float LIGHTMAP_GUTTER = 0.06f;
+
+	static_assert(sizeof(COMPACT_VERTEX) == 16, "the compact vertex has to stay packed");
+
+	/***********************************************************
+	 *  ToChart()
+	 *
+	 *  Map a local [0,1] coordinate into a chart rectangle
+	 *  (xmin, ymin, xmax, ymax) of the lightmap layout.
+	 ***********************************************************/
+	glm::vec2 ToChart(const glm::vec4& rect, glm::vec2 uv)
+	{
+		float width = rect.z - rect.x;
+		float height = rect.w - rect.y;
+		float insetX = width * LIGHTMAP_GUTTER;
+		float insetY = height * LIGHTMAP_GUTTER;
+
+		return glm::vec2(
+			rect.x + insetX + uv.x * (width - 2.0f * insetX),
+			rect.y + insetY + uv.y * (height - 2.0f * insetY));
+	}
+
+	/***********************************************************
+	 *  AddVertex()
+	 *
+	 *  Append one vertex with its lightmap coordinate.
+	 ***********************************************************/
+	uint32_t AddVertex(
+		MESH_DATA& mesh,
+		glm::vec3 position,
+		glm::vec3 normal,
+		glm::vec2 texCoord,
+		glm::vec2 lightmapUV)
+	{
+		MESH_VERTEX vertex;
+		vertex.position = position;
+		vertex.normal = normal;
+		vertex.texCoord = texCoord;
+		mesh.vertices.push_back(vertex);
+		mesh.lightmapUVs.push_back(lightmapUV);
+
+		return(static_cast<uint32_t>(mesh.vertices.size() - 1));
+	}
+
+	/***********************************************************
+	 *  AddGrid()
+	 *
+	 *  Append the triangles of a (columns x rows) vertex grid
+	 *  that starts at the passed in base vertex index. The
+	 *  winding is reversed for grids whose rows and columns
+	 *  run the other way around the surface.
+	 ***********************************************************/
+	void AddGrid(MESH_DATA& mesh, uint32_t base, int columns, int rows, bool bReverse)
+	{
+		for (int row = 0; row < rows - 1; row++)
+		{
+			for (int column = 0; column < columns - 1; column++)
+			{
+				uint32_t i0 = base + row * columns + column;
+				uint32_t i1 = i0 + 1;
+				uint32_t i2 = i0 + columns;
+				uint32_t i3 = i2 + 1;
+
+				mesh.indices.push_back(i0);
+				mesh.indices.push_back(bReverse ? i1 : i2);
+				mesh.indices.push_back(bReverse ? i2 : i1);
+				mesh.indices.push_back(i1);
+				mesh.indices.push_back(bReverse ? i3 : i2);
+				mesh.indices.push_back(bReverse ? i2 : i3);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  AddDisc()
+	 *
+	 *  Append a flat disc of radius 1 at the passed in height,
+	 *  facing up or down, as a triangle fan.
+	 ***********************************************************/
+	void AddDisc(MESH_DATA& mesh, float height, bool bFacingUp, int slices, const glm::vec4& chart)
+	{
+		glm::vec3 normal(0.0f, bFacingUp ? 1.0f : -1.0f, 0.0f);
+		uint32_t center = AddVertex(
+			mesh,
+			glm::vec3(0.0f, height, 0.0f),
+			normal,
+			glm::vec2(0.5f, 0.5f),
+			ToChart(chart, glm::vec2(0.5f, 0.5f)));
+
+		for (int i = 0; i <= slices; i++)
+		{
+			float angle = 2.0f * PI * i / slices;
+			glm::vec2 local(0.5f + 0.5f * cos(angle), 0.5f + 0.5f * sin(angle));
+			AddVertex(
+				mesh,
+				glm::vec3(cos(angle), height, sin(angle)),
+				normal,
+				local,
+				ToChart(chart, local));
+		}
+
+		for (int i = 0; i < slices; i++)
+		{
+			uint32_t a = center + 1 + i;
+			uint32_t b = a + 1;
+			mesh.indices.push_back(center);
+			mesh.indices.push_back(bFacingUp ? b : a);
+			mesh.indices.push_back(bFacingUp ? a : b);
+		}
+	}
+
+	/***********************************************************
+	 *  FloatToHalf()
+	 *
+	 *  Convert a float to a half float, rounding to the nearest
+	 *  value and flushing values too small for it to zero.
+	 ***********************************************************/
+	uint16_t FloatToHalf(float value)
+	{
+		uint32_t bits = 0;
+		memcpy(&bits, &value, sizeof(bits));
+
+		uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+		int exponent = static_cast<int>((bits >> 23) & 0xFFu) - 127 + 15;
+		uint32_t mantissa = bits & 0x007FFFFFu;
+
+		if (exponent <= 0)
+		{
+			return(sign);
+		}
+		if (exponent >= 31)
+		{
+			return(static_cast<uint16_t>(sign | 0x7C00u));
+		}
+
+		// the carry of the rounding may move into the exponent,
+		// which is still the nearest half float
+		uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+		if (mantissa & 0x00001000u)
+		{
+			half++;
+		}
+		return(static_cast<uint16_t>(sign | half));
+	}
+
+	/***********************************************************
+	 *  PackNormal()
+	 *
+	 *  Pack a unit vector into signed normalized 10-bit values.
+	 ***********************************************************/
+	uint32_t PackNormal(const glm::vec3& normal)
+	{
+		uint32_t packed = 0;
+		for (int i = 0; i < 3; i++)
+		{
+			float value = normal[i];
+			value = (value < -1.0f) ? -1.0f : ((value > 1.0f) ? 1.0f : value);
+			int component = static_cast<int>(std::lround(value * 511.0f));
+			packed |= (static_cast<uint32_t>(component) & 0x3FFu) << (i * 10);
+		}
+		return(packed);
+	}
+
+	/***********************************************************
+	 *  QuantizeVertices()
+	 *
+	 *  Convert the vertices into the compact layout and return
+	 *  how the positions are decoded.
+	 ***********************************************************/
+	void QuantizeVertices(
+		const MESH_VIEW& mesh,
+		std::vector<COMPACT_VERTEX>& vertices,
+		glm::vec3& decodeOffset,
+		glm::vec3& decodeScale)
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		ComputeMeshBounds(mesh, boundsMin, boundsMax);
+		decodeOffset = boundsMin;
+		decodeScale = boundsMax - boundsMin;
+
+		vertices.resize(mesh.vertexCount);
+		for (uint32_t i = 0; i < mesh.vertexCount; i++)
+		{
+			const MESH_VERTEX& source = mesh.vertices[i];
+			COMPACT_VERTEX& vertex = vertices[i];
+			for (int axis = 0; axis < 3; axis++)
+			{
+				// flat axes keep a zero scale and decode to the offset
+				float t = 0.0f;
+				if (decodeScale[axis] > 0.0f)
+				{
+					t = (source.position[axis] - boundsMin[axis]) / decodeScale[axis];
+				}
+				vertex.position[axis] = static_cast<uint16_t>(std::lround(t * 65535.0f));
+			}
+			vertex.position[3] = 0;
+			vertex.normal = PackNormal(source.normal);
+			vertex.texCoord[0] = FloatToHalf(source.texCoord.x);
+			vertex.texCoord[1] = FloatToHalf(source.texCoord.y);
+		}
+	}
+
+	/***********************************************************
+	 *  ClearMesh()
+	 *
+	 *  Remove all the data from a mesh before it is rebuilt.
+	 ***********************************************************/
+	void ClearMesh(MESH_DATA& mesh)
+	{
+		mesh.vertices.clear();
+		mesh.indices.clear();
+		mesh.lightmapUVs.clear();
+	}
+}
+
+/***********************************************************
+ *  BuildPlaneMesh()
+ *
+ *  This method is used for building a flat plane that spans
+ *  -1 to 1 on the X and Z axes, facing up.
+ ***********************************************************/
+void BuildPlaneMesh(MESH_DATA& mesh)
+{
+	ClearMesh(mesh);
+
+	glm::vec4 chart(0.0f, 0.0f, 1.0f, 1.0f);
+	glm::vec3 normal(0.0f, 1.0f, 0.0f);
+
+	for (int row = 0; row < 2; row++)
+	{
+		for (int column = 0; column < 2; column++)
+		{
+			glm::vec2 uv((float)column, (float)row);
+			AddVertex(
+				mesh,
+				glm::vec3(-1.0f + 2.0f * column, 0.0f, 1.0f - 2.0f * row),
+				normal,
+				uv,
+				ToChart(chart, uv));
+		}
+	}
+	AddGrid(mesh, 0, 2, 2, true);
+}
+
+/***********************************************************
+ *  BuildBoxMesh()
+ *
+ *  This method is used for building a unit box centered on
+ *  the origin. Every face is mapped to the full texture and
+ *  gets its own cell of a 3x2 lightmap layout.
+ ***********************************************************/
+void BuildBoxMesh(MESH_DATA& mesh)
+{
+	ClearMesh(mesh);
+
+	// face normal, U direction and V direction for all six faces
+	const glm::vec3 faces[6][3] =
+	{
+		{ glm::vec3(0.0f, 0.0f, 1.0f),  glm::vec3(1.0f, 0.0f, 0.0f),  glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(1.0f, 0.0f, 0.0f),  glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f),  glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(0.0f, 1.0f, 0.0f),  glm::vec3(1.0f, 0.0f, 0.0f),  glm::vec3(0.0f, 0.0f, -1.0f) },
+		{ glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f),  glm::vec3(0.0f, 0.0f, 1.0f) },
+	};
+
+	for (int face = 0; face < 6; face++)
+	{
+		glm::vec4 chart(
+			(face % 3) / 3.0f,
+			(face / 3) / 2.0f,
+			(face % 3 + 1) / 3.0f,
+			(face / 3 + 1) / 2.0f);
+		uint32_t base = static_cast<uint32_t>(mesh.vertices.size());
+
+		for (int row = 0; row < 2; row++)
+		{
+			for (int column = 0; column < 2; column++)
+			{
+				glm::vec2 uv((float)column, (float)row);
+				glm::vec3 position = 0.5f * faces[face][0]
+					+ (uv.x - 0.5f) * faces[face][1]
+					+ (uv.y - 0.5f) * faces[face][2];
+				AddVertex(mesh, position, faces[face][0], uv, ToChart(chart, uv));
+			}
+		}
+		// counter-clockwise when seen from outside the box
+		mesh.indices.push_back(base + 0);
+		mesh.indices.push_back(base + 1);
+		mesh.indices.push_back(base + 2);
+		mesh.indices.push_back(base + 1);
+		mesh.indices.push_back(base + 3);
+		mesh.indices.push_back(base + 2);
+	}
+}
+
+/***********************************************************
+ *  BuildCylinderMesh()
+ *
+ *  This method is used for building a cylinder of radius 1
+ *  from y = 0 to y = 1 with both caps closed.
+ ***********************************************************/
+void BuildCylinderMesh(MESH_DATA& mesh, int slices)
+{
+	ClearMesh(mesh);
+
+	glm::vec4 sideChart(0.0f, 0.5f, 1.0f, 1.0f);
+	glm::vec4 bottomChart(0.0f, 0.0f, 0.5f, 0.5f);
+	glm::vec4 topChart(0.5f, 0.0f, 1.0f, 0.5f);
+
+	uint32_t base = static_cast<uint32_t>(mesh.vertices.size());
+	for (int row = 0; row < 2; row++)
+	{
+		for (int i = 0; i <= slices; i++)
+		{
+			float angle = 2.0f * PI * i / slices;
+			glm::vec2 uv((float)i / slices, (float)row);
+			AddVertex(
+				mesh,
+				glm::vec3(cos(angle), (float)row, sin(angle)),
+				glm::vec3(cos(angle), 0.0f, sin(angle)),
+				uv,
+				ToChart(sideChart, uv));
+		}
+	}
+	AddGrid(mesh, base, slices + 1, 2, false);
+
+	AddDisc(mesh, 0.0f, false, slices, bottomChart);
+	AddDisc(mesh, 1.0f, true, slices, topChart);
+}
+
+/***********************************************************
+ *  BuildSphereMesh()
+ *
+ *  This method is used for building a sphere of radius 1
+ *  centered on the origin.
+ ***********************************************************/
+void BuildSphereMesh(MESH_DATA& mesh, int stacks, int slices)
+{
+	ClearMesh(mesh);
+
+	glm::vec4 chart(0.0f, 0.0f, 1.0f, 1.0f);
+
+	for (int stack = 0; stack <= stacks; stack++)
+	{
+		float phi = PI * stack / stacks;
+		for (int slice = 0; slice <= slices; slice++)
+		{
+			float theta = 2.0f * PI * slice / slices;
+			glm::vec3 normal(sin(phi) * cos(theta), cos(phi), sin(phi) * sin(theta));
+			glm::vec2 uv((float)slice / slices, 1.0f - (float)stack / stacks);
+			AddVertex(mesh, normal, normal, uv, ToChart(chart, uv));
+		}
+	}
+	AddGrid(mesh, 0, slices + 1, stacks + 1, true);
+}
+
+/***********************************************************
+ *  BuildHalfSphereMesh()
+ *
+ *  This method is used for building the upper half of a
+ *  sphere of radius 1 with a closed bottom at y = 0.
+ ***********************************************************/
+void BuildHalfSphereMesh(MESH_DATA& mesh, int stacks, int slices)
+{
+	ClearMesh(mesh);
+
+	glm::vec4 domeChart(0.0f, 0.34f, 1.0f, 1.0f);
+	glm::vec4 capChart(0.0f, 0.0f, 0.33f, 0.33f);
+
+	for (int stack = 0; stack <= stacks; stack++)
+	{
+		float phi = 0.5f * PI * stack / stacks;
+		for (int slice = 0; slice <= slices; slice++)
+		{
+			float theta = 2.0f * PI * slice / slices;
+			glm::vec3 normal(sin(phi) * cos(theta), cos(phi), sin(phi) * sin(theta));
+			glm::vec2 uv((float)slice / slices, 1.0f - (float)stack / stacks);
+			AddVertex(mesh, normal, normal, uv, ToChart(domeChart, uv));
+		}
+	}
+	AddGrid(mesh, 0, slices + 1, stacks + 1, true);
+
+	AddDisc(mesh, 0.0f, false, slices, capChart);
+}
+
+/***********************************************************
+ *  BuildTorusMesh()
+ *
+ *  This method is used for building a torus with a main
+ *  radius of 1 lying in the XY plane.
+ ***********************************************************/
+void BuildTorusMesh(MESH_DATA& mesh, int mainSegments, int tubeSegments, float tubeRadius)
+{
+	ClearMesh(mesh);
+
+	glm::vec4 chart(0.0f, 0.0f, 1.0f, 1.0f);
+
+	for (int tube = 0; tube <= tubeSegments; tube++)
+	{
+		float phi = 2.0f * PI * tube / tubeSegments;
+		for (int segment = 0; segment <= mainSegments; segment++)
+		{
+			float theta = 2.0f * PI * segment / mainSegments;
+			glm::vec3 normal(cos(phi) * cos(theta), cos(phi) * sin(theta), sin(phi));
+			glm::vec3 position(cos(theta), sin(theta), 0.0f);
+			position += tubeRadius * normal;
+			glm::vec2 uv((float)segment / mainSegments, (float)tube / tubeSegments);
+			AddVertex(mesh, position, normal, uv, ToChart(chart, uv));
+		}
+	}
+	AddGrid(mesh, 0, mainSegments + 1, tubeSegments + 1, true);
+}
+
+/***********************************************************
+ *  AppendTransformedMesh()
+ *
+ *  This method is used for merging a mesh into a larger one
+ *  in the space of the model matrix. Mirroring transforms
+ *  have their triangles flipped so the winding stays the
+ *  same, and meshes without lightmap UVs add zeros so that
+ *  the stream stays as long as the vertices.
+ ***********************************************************/
+void AppendTransformedMesh(
+	const MESH_VIEW& source,
+	const glm::mat4& model,
+	const glm::vec4& lightmapScaleOffset,
+	MESH_DATA& target)
+{
+	uint32_t baseVertex = static_cast<uint32_t>(target.vertices.size());
+	glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+	bool bMirrored = (glm::determinant(glm::mat3(model)) < 0.0f);
+
+	target.vertices.reserve(target.vertices.size() + source.vertexCount);
+	target.lightmapUVs.resize(target.vertices.size(), glm::vec2(0.0f));
+	for (uint32_t i = 0; i < source.vertexCount; i++)
+	{
+		MESH_VERTEX vertex = source.vertices[i];
+		vertex.position = glm::vec3(model * glm::vec4(vertex.position, 1.0f));
+		vertex.normal = glm::normalize(normalMatrix * vertex.normal);
+		target.vertices.push_back(vertex);
+
+		glm::vec2 lightmapUV(0.0f);
+		if (NULL != source.lightmapUVs)
+		{
+			lightmapUV = source.lightmapUVs[i] * glm::vec2(lightmapScaleOffset.x, lightmapScaleOffset.y) +
+				glm::vec2(lightmapScaleOffset.z, lightmapScaleOffset.w);
+		}
+		target.lightmapUVs.push_back(lightmapUV);
+	}
+
+	target.indices.reserve(target.indices.size() + source.indexCount);
+	for (uint32_t i = 0; i + 2 < source.indexCount; i += 3)
+	{
+		target.indices.push_back(baseVertex + source.indices[i]);
+		target.indices.push_back(baseVertex + source.indices[bMirrored ? i + 2 : i + 1]);
+		target.indices.push_back(baseVertex + source.indices[bMirrored ? i + 1 : i + 2]);
+	}
+}
+
+/***********************************************************
+ *  ComputeSurfaceArea()
+ *
+ *  This method is used for getting the total area of all
+ *  the triangles after the model transform is applied.
+ ***********************************************************/
+float ComputeSurfaceArea(const MESH_DATA& mesh, const glm::mat4& model)
+{
+	float area = 0.0f;
+
+	for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+	{
+		glm::vec3 a = glm::vec3(model * glm::vec4(mesh.vertices[mesh.indices[i]].position, 1.0f));
+		glm::vec3 b = glm::vec3(model * glm::vec4(mesh.vertices[mesh.indices[i + 1]].position, 1.0f));
+		glm::vec3 c = glm::vec3(model * glm::vec4(mesh.vertices[mesh.indices[i + 2]].position, 1.0f));
+		area += 0.5f * glm::length(glm::cross(b - a, c - a));
+	}
+
+	return(area);
+}
+
+/***********************************************************
+ *  ComputeMeshBounds()
+ *
+ *  This method is used for getting the axis-aligned box
+ *  around all the vertices of the untransformed mesh.
+ ***********************************************************/
+void ComputeMeshBounds(const MESH_VIEW& mesh, glm::vec3& boundsMin, glm::vec3& boundsMax)
+{
+	if (mesh.vertexCount == 0)
+	{
+		boundsMin = glm::vec3(0.0f);
+		boundsMax = glm::vec3(0.0f);
+		return;
+	}
+
+	boundsMin = mesh.vertices[0].position;
+	boundsMax = mesh.vertices[0].position;
+	for (uint32_t i = 0; i < mesh.vertexCount; i++)
+	{
+		boundsMin = glm::min(boundsMin, mesh.vertices[i].position);
+		boundsMax = glm::max(boundsMax, mesh.vertices[i].position);
+	}
+}
+
+/***********************************************************
+ *  GetMeshView()
+ *
+ *  This method is used for viewing the contents of a mesh.
+ *  The view is only valid while the mesh is unchanged.
+ ***********************************************************/
+MESH_VIEW GetMeshView(const MESH_DATA& mesh)
+{
+	MESH_VIEW view;
+	view.vertices = mesh.vertices.data();
+	view.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+	view.indices = mesh.indices.data();
+	view.indexCount = static_cast<uint32_t>(mesh.indices.size());
+	if (mesh.lightmapUVs.size() == mesh.vertices.size())
+	{
+		view.lightmapUVs = mesh.lightmapUVs.data();
+	}
+	return(view);
+}
+
+/***********************************************************
+ *  CopyMeshView()
+ *
+ *  This method is used for copying viewed data into a mesh,
+ *  for the code that keeps its own copy of the shapes.
+ ***********************************************************/
+void CopyMeshView(const MESH_VIEW& view, MESH_DATA& mesh)
+{
+	mesh.vertices.assign(view.vertices, view.vertices + view.vertexCount);
+	mesh.indices.assign(view.indices, view.indices + view.indexCount);
+	mesh.lightmapUVs.clear();
+	if (NULL != view.lightmapUVs)
+	{
+		mesh.lightmapUVs.assign(view.lightmapUVs, view.lightmapUVs + view.vertexCount);
+	}
+}
+
+/***********************************************************
+ *  UploadGLMesh()
+ *
+ *  This method is used for creating the vertex array and
+ *  buffers for the mesh and copying the data to OpenGL. The
+ *  compact layout stores the positions as 16-bit fractions
+ *  of the bounds, the normals as 10-bit values and the UVs
+ *  as half floats, which the vertex shader reads as floats.
+ ***********************************************************/
+bool UploadGLMesh(const MESH_VIEW& mesh, GL_MESH& glMesh, bool bCompact)
+{
+	if ((mesh.vertexCount == 0) || (mesh.indexCount == 0))
+	{
+		return(false);
+	}
+
+	DestroyGLMesh(glMesh);
+
+	glGenVertexArrays(1, &glMesh.vao);
+	g_GLState.BindVertexArray(glMesh.vao);
+
+	// interleaved position, normal and texture coordinate
+	glGenBuffers(1, &glMesh.vbos[0]);
+	glBindBuffer(GL_ARRAY_BUFFER, glMesh.vbos[0]);
+	if (bCompact)
+	{
+		std::vector<COMPACT_VERTEX> vertices;
+		QuantizeVertices(mesh, vertices, glMesh.decodeOffset, glMesh.decodeScale);
+		glMesh.vertexBytes = vertices.size() * sizeof(COMPACT_VERTEX);
+		glBufferData(GL_ARRAY_BUFFER, glMesh.vertexBytes, vertices.data(), GL_STATIC_DRAW);
+
+		GLsizei stride = sizeof(COMPACT_VERTEX);
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)offsetof(COMPACT_VERTEX, position));
+		glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(COMPACT_VERTEX, normal));
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(COMPACT_VERTEX, texCoord));
+	}
+	else
+	{
+		glMesh.decodeOffset = glm::vec3(0.0f);
+		glMesh.decodeScale = glm::vec3(1.0f);
+		glMesh.vertexBytes = mesh.vertexCount * sizeof(MESH_VERTEX);
+		glBufferData(GL_ARRAY_BUFFER, glMesh.vertexBytes, mesh.vertices, GL_STATIC_DRAW);
+
+		GLsizei stride = sizeof(MESH_VERTEX);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MESH_VERTEX, position));
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MESH_VERTEX, normal));
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MESH_VERTEX, texCoord));
+	}
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+
+	// the lightmap coordinates are kept in their own stream
+	if (NULL != mesh.lightmapUVs)
+	{
+		glGenBuffers(1, &glMesh.vbos[1]);
+		glBindBuffer(GL_ARRAY_BUFFER, glMesh.vbos[1]);
+		glBufferData(
+			GL_ARRAY_BUFFER,
+			mesh.vertexCount * sizeof(glm::vec2),
+			mesh.lightmapUVs,
+			GL_STATIC_DRAW);
+		glMesh.vertexBytes += mesh.vertexCount * sizeof(glm::vec2);
+		glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+		glEnableVertexAttribArray(3);
+	}
+
+	glGenBuffers(1, &glMesh.vbos[2]);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, glMesh.vbos[2]);
+	glBufferData(
+		GL_ELEMENT_ARRAY_BUFFER,
+		mesh.indexCount * sizeof(uint32_t),
+		mesh.indices,
+		GL_STATIC_DRAW);
+
+	g_GLState.BindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glMesh.nIndices = static_cast<GLsizei>(mesh.indexCount);
+
+	return(true);
+}
+
+/***********************************************************
+ *  DrawGLMesh()
+ *
+ *  This method is used for drawing an uploaded mesh.
+ ***********************************************************/
+void DrawGLMesh(const GL_MESH& glMesh)
+{
+	if (glMesh.vao == 0)
+	{
+		return;
+	}
+
+	// consecutive draws of the same shape keep the binding
+	g_GLState.BindVertexArray(glMesh.vao);
+	glDrawElements(GL_TRIANGLES, glMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+}
+
+/***********************************************************
+ *  DestroyGLMesh()
+ *
+ *  This method is used for freeing the OpenGL buffers.
+ ***********************************************************/
+void DestroyGLMesh(GL_MESH& glMesh)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		if (glMesh.vbos[i] != 0)
+		{
+			glDeleteBuffers(1, &glMesh.vbos[i]);
+			glMesh.vbos[i] = 0;
+		}
+	}
+	if (glMesh.vao != 0)
+	{
+		g_GLState.DeleteVertexArray(glMesh.vao);
+		glMesh.vao = 0;
+	}
+	glMesh.nIndices = 0;
+	glMesh.vertexBytes = 0;
+}
@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshbuilder.h
+// ============
+// build CPU-side copies of the basic shape meshes and upload them to OpenGL
+//
+// The generated shapes use the same unit dimensions and vertex layout as the
+// ShapeMeshes primitives so that they can be drawn with the same shaders and
+// the same transformations. Unlike ShapeMeshes, the vertex data stays
+// available on the CPU for baking, caching and batching.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// vertex layout consumed by vertexShader.glsl (locations 0, 1 and 2)
+struct MESH_VERTEX
+{
+	glm::vec3 position;
+	glm::vec3 normal;
+	glm::vec2 texCoord;
+};
+
+// compact vertex layout for the same locations, 16 bytes instead of 32
+struct COMPACT_VERTEX
+{
+	// normalized within the mesh bounds, the fourth is padding
+	uint16_t position[4];
+	// signed normalized 10-bit components, GL_INT_2_10_10_10_REV
+	uint32_t normal;
+	// half floats
+	uint16_t texCoord[2];
+};
+
+// indexed triangle list with an optional second UV set
+struct MESH_DATA
+{
+	std::vector<MESH_VERTEX> vertices;
+	std::vector<uint32_t> indices;
+	// unique, non-overlapping UV layout used for lightmaps (location 3)
+	std::vector<glm::vec2> lightmapUVs;
+};
+
+// read-only view of mesh data that may be held elsewhere, such as in a
+// mapped cache file
+struct MESH_VIEW
+{
+	const MESH_VERTEX* vertices = NULL;
+	uint32_t vertexCount = 0;
+	const uint32_t* indices = NULL;
+	uint32_t indexCount = 0;
+	// NULL when the mesh has no lightmap UVs
+	const glm::vec2* lightmapUVs = NULL;
+};
+
+// OpenGL buffers for one uploaded mesh
+struct GL_MESH
+{
+	GLuint vao = 0;
+	GLuint vbos[3] = { 0, 0, 0 };
+	GLsizei nIndices = 0;
+	// bytes of the vertex and lightmap UV buffers
+	GLsizeiptr vertexBytes = 0;
+	// maps the stored positions back into the mesh space, zero and
+	// one for the float layout
+	glm::vec3 decodeOffset = glm::vec3(0.0f);
+	glm::vec3 decodeScale = glm::vec3(1.0f);
+};
+
+// build the basic shapes - all generators replace the mesh contents
+void BuildPlaneMesh(MESH_DATA& mesh);
+void BuildBoxMesh(MESH_DATA& mesh);
+void BuildCylinderMesh(MESH_DATA& mesh, int slices = 36);
+void BuildSphereMesh(MESH_DATA& mesh, int stacks = 18, int slices = 36);
+void BuildHalfSphereMesh(MESH_DATA& mesh, int stacks = 9, int slices = 36);
+void BuildTorusMesh(MESH_DATA& mesh, int mainSegments = 30, int tubeSegments = 30, float tubeRadius = 0.1f);
+
+// add a mesh to the end of another with its vertices transformed by the
+// model matrix and its lightmap UVs moved into an atlas tile
+void AppendTransformedMesh(
+	const MESH_VIEW& source,
+	const glm::mat4& model,
+	const glm::vec4& lightmapScaleOffset,
+	MESH_DATA& target);
+
+// get the surface area of the mesh after it has been transformed
+float ComputeSurfaceArea(const MESH_DATA& mesh, const glm::mat4& model);
+// get the box around the untransformed mesh
+void ComputeMeshBounds(const MESH_VIEW& mesh, glm::vec3& boundsMin, glm::vec3& boundsMax);
+
+// view the contents of a mesh without copying them
+MESH_VIEW GetMeshView(const MESH_DATA& mesh);
+// copy viewed data into a mesh that owns it
+void CopyMeshView(const MESH_VIEW& view, MESH_DATA& mesh);
+
+// upload the mesh data into OpenGL buffers, straight from the view or
+// quantized into the compact layout
+bool UploadGLMesh(const MESH_VIEW& mesh, GL_MESH& glMesh, bool bCompact = false);
+// draw an uploaded mesh with the currently active shader
+void DrawGLMesh(const GL_MESH& glMesh);
+// free the OpenGL buffers of an uploaded mesh
+void DestroyGLMesh(GL_MESH& glMesh);
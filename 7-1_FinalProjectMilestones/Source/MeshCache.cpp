@@ -0,0 +1,283 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.cpp
+// ============
+// binary container of generated meshes that is mapped straight into memory
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	const char MESH_CACHE_MAGIC[4] = { 'M', 'E', 'S', 'H' };
+	const uint32_t MESH_CACHE_VERSION = 1;
+	// start of every blob, at least the alignment of the vertex
+	// attributes and a whole cache line
+	const uint64_t BLOB_ALIGNMENT = 64;
+
+	// the blobs are the memory layout of these types
+	static_assert(sizeof(MESH_VERTEX) == 32, "the mesh cache stores 32-byte vertices");
+	static_assert(sizeof(glm::vec2) == 8, "the mesh cache stores 8-byte lightmap UVs");
+
+	struct MESH_CACHE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t generatorKey;
+		uint32_t meshCount;
+	};
+
+	struct MESH_CACHE_ENTRY
+	{
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+		// zero when the mesh has no lightmap UVs
+		uint64_t lightmapUVOffset;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+	};
+
+	/***********************************************************
+	 *  AlignOffset()
+	 *
+	 *  Round a file offset up to the blob alignment.
+	 ***********************************************************/
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return((offset + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1));
+	}
+
+	/***********************************************************
+	 *  IsBlobInside()
+	 *
+	 *  Check that an aligned blob lies within the file.
+	 ***********************************************************/
+	bool IsBlobInside(uint64_t offset, uint64_t length, size_t fileSize)
+	{
+		return(((offset % BLOB_ALIGNMENT) == 0) &&
+			(offset <= fileSize) &&
+			(length <= fileSize - offset));
+	}
+
+	/***********************************************************
+	 *  AreIndicesInside()
+	 *
+	 *  Check that every index of a mesh names one of its
+	 *  vertices. This reads the whole index blob once, when
+	 *  the file is opened, so a damaged cache is regenerated
+	 *  instead of drawing past the vertex buffer.
+	 ***********************************************************/
+	bool AreIndicesInside(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount)
+	{
+		uint32_t largest = 0;
+		for (uint32_t i = 0; i < indexCount; i++)
+		{
+			largest = std::max(largest, pIndices[i]);
+		}
+		return((indexCount == 0) || (largest < vertexCount));
+	}
+
+	/***********************************************************
+	 *  WriteBlob()
+	 *
+	 *  Pad the file up to the blob offset and write the blob.
+	 ***********************************************************/
+	void WriteBlob(std::ofstream& file, uint64_t& position, uint64_t offset, const void* pData, uint64_t length)
+	{
+		static const char padding[BLOB_ALIGNMENT] = { 0 };
+		file.write(padding, static_cast<std::streamsize>(offset - position));
+		file.write(static_cast<const char*>(pData), static_cast<std::streamsize>(length));
+		position = offset + length;
+	}
+}
+
+/***********************************************************
+ *  MeshCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshCache::MeshCache()
+{
+	m_meshCount = 0;
+}
+
+/***********************************************************
+ *  ~MeshCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshCache::~MeshCache()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a cache file. The header
+ *  and the table are checked here, so that GetMesh() only
+ *  has to hand out pointers.
+ ***********************************************************/
+bool MeshCache::Open(const char* filename, uint32_t generatorKey)
+{
+	Close();
+
+	if (!m_file.Open(filename))
+	{
+		return(false);
+	}
+	const unsigned char* pData = m_file.GetData();
+	size_t size = m_file.GetSize();
+	if (size < sizeof(MESH_CACHE_HEADER))
+	{
+		m_file.Close();
+		return(false);
+	}
+
+	MESH_CACHE_HEADER header;
+	memcpy(&header, pData, sizeof(header));
+	bool bValid =
+		(memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic)) == 0) &&
+		(header.version == MESH_CACHE_VERSION) &&
+		(header.generatorKey == generatorKey) &&
+		(header.meshCount > 0) &&
+		(sizeof(header) + (uint64_t)header.meshCount * sizeof(MESH_CACHE_ENTRY) <= size);
+
+	const MESH_CACHE_ENTRY* pEntries = reinterpret_cast<const MESH_CACHE_ENTRY*>(pData + sizeof(header));
+	for (uint32_t i = 0; (bValid) && (i < header.meshCount); i++)
+	{
+		const MESH_CACHE_ENTRY& entry = pEntries[i];
+		bValid =
+			IsBlobInside(entry.vertexOffset, entry.vertexCount * (uint64_t)sizeof(MESH_VERTEX), size) &&
+			IsBlobInside(entry.indexOffset, entry.indexCount * (uint64_t)sizeof(uint32_t), size) &&
+			((entry.lightmapUVOffset == 0) ||
+				IsBlobInside(entry.lightmapUVOffset, entry.vertexCount * (uint64_t)sizeof(glm::vec2), size)) &&
+			AreIndicesInside(reinterpret_cast<const uint32_t*>(pData + entry.indexOffset), entry.indexCount, entry.vertexCount);
+	}
+
+	if (!bValid)
+	{
+		std::cout << "Mesh cache is out of date:" << filename << std::endl;
+		m_file.Close();
+		return(false);
+	}
+
+	m_meshCount = static_cast<int>(header.meshCount);
+
+	std::cout << "Mapped mesh cache:" << filename << ", meshes:" << m_meshCount << ", bytes:" << size << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the cache file.
+ ***********************************************************/
+void MeshCache::Close()
+{
+	m_file.Close();
+	m_meshCount = 0;
+}
+
+/***********************************************************
+ *  GetMesh()
+ *
+ *  This method is used for viewing one mesh of the mapped
+ *  file. The view stays valid until the cache is closed.
+ ***********************************************************/
+bool MeshCache::GetMesh(int index, MESH_VIEW& view) const
+{
+	const unsigned char* pData = m_file.GetData();
+	if ((NULL == pData) || (index < 0) || (index >= m_meshCount))
+	{
+		return(false);
+	}
+
+	const MESH_CACHE_ENTRY* pEntries = reinterpret_cast<const MESH_CACHE_ENTRY*>(pData + sizeof(MESH_CACHE_HEADER));
+	const MESH_CACHE_ENTRY& entry = pEntries[index];
+
+	view.vertices = reinterpret_cast<const MESH_VERTEX*>(pData + entry.vertexOffset);
+	view.vertexCount = entry.vertexCount;
+	view.indices = reinterpret_cast<const uint32_t*>(pData + entry.indexOffset);
+	view.indexCount = entry.indexCount;
+	view.lightmapUVs = NULL;
+	if (entry.lightmapUVOffset != 0)
+	{
+		view.lightmapUVs = reinterpret_cast<const glm::vec2*>(pData + entry.lightmapUVOffset);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used for writing meshes into a new cache
+ *  file. The offsets of all blobs are laid out first so the
+ *  file is written front to back in one pass.
+ ***********************************************************/
+bool MeshCache::Write(const char* filename, uint32_t generatorKey, const MESH_DATA* meshes, int meshCount)
+{
+	if ((NULL == meshes) || (meshCount <= 0))
+	{
+		return(false);
+	}
+
+	std::vector<MESH_CACHE_ENTRY> entries(meshCount);
+	uint64_t offset = sizeof(MESH_CACHE_HEADER) + meshCount * sizeof(MESH_CACHE_ENTRY);
+	for (int i = 0; i < meshCount; i++)
+	{
+		const MESH_DATA& mesh = meshes[i];
+		MESH_CACHE_ENTRY& entry = entries[i];
+		entry.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+		entry.indexCount = static_cast<uint32_t>(mesh.indices.size());
+
+		entry.vertexOffset = AlignOffset(offset);
+		offset = entry.vertexOffset + entry.vertexCount * sizeof(MESH_VERTEX);
+		entry.indexOffset = AlignOffset(offset);
+		offset = entry.indexOffset + entry.indexCount * sizeof(uint32_t);
+		entry.lightmapUVOffset = 0;
+		if ((!mesh.lightmapUVs.empty()) && (mesh.lightmapUVs.size() == mesh.vertices.size()))
+		{
+			entry.lightmapUVOffset = AlignOffset(offset);
+			offset = entry.lightmapUVOffset + entry.vertexCount * sizeof(glm::vec2);
+		}
+	}
+
+	std::ofstream file(filename, std::ios::binary);
+	if (!file)
+	{
+		std::cout << "Could not write mesh cache:" << filename << std::endl;
+		return(false);
+	}
+
+	MESH_CACHE_HEADER header;
+	memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic));
+	header.version = MESH_CACHE_VERSION;
+	header.generatorKey = generatorKey;
+	header.meshCount = static_cast<uint32_t>(meshCount);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(entries.data()), meshCount * sizeof(MESH_CACHE_ENTRY));
+
+	uint64_t position = sizeof(MESH_CACHE_HEADER) + meshCount * sizeof(MESH_CACHE_ENTRY);
+	for (int i = 0; i < meshCount; i++)
+	{
+		const MESH_DATA& mesh = meshes[i];
+		const MESH_CACHE_ENTRY& entry = entries[i];
+		WriteBlob(file, position, entry.vertexOffset, mesh.vertices.data(), entry.vertexCount * sizeof(MESH_VERTEX));
+		WriteBlob(file, position, entry.indexOffset, mesh.indices.data(), entry.indexCount * sizeof(uint32_t));
+		if (entry.lightmapUVOffset != 0)
+		{
+			WriteBlob(file, position, entry.lightmapUVOffset, mesh.lightmapUVs.data(), entry.vertexCount * sizeof(glm::vec2));
+		}
+	}
+
+	return(file.good());
+}
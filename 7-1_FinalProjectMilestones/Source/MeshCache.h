@@ -0,0 +1,46 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.h
+// ============
+// binary container of generated meshes that is mapped straight into memory
+//
+// The file starts with a versioned header and a table of the meshes, followed
+// by their vertex, index and lightmap UV blobs. Every blob starts on a 64-byte
+// boundary and is stored in the layout that UploadGLMesh hands to OpenGL, so
+// a mapped file is uploaded without parsing or copying it first. The header
+// carries a key of the generator settings, and a file written by other
+// settings is rejected and written again.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshBuilder.h"
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+
+class MeshCache
+{
+public:
+	// constructor
+	MeshCache();
+	// destructor
+	~MeshCache();
+
+	// map a cache file, returns false when it is missing, damaged
+	// or was written for other generator settings
+	bool Open(const char* filename, uint32_t generatorKey);
+	// unmap the file, which ends all views into it
+	void Close();
+
+	int GetMeshCount() const { return m_meshCount; }
+	// view one mesh inside the mapped file
+	bool GetMesh(int index, MESH_VIEW& view) const;
+
+	// write the meshes into a new cache file
+	static bool Write(const char* filename, uint32_t generatorKey, const MESH_DATA* meshes, int meshCount);
+
+private:
+	MappedFile m_file;
+	int m_meshCount;
+};
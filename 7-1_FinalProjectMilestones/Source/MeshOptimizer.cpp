@@ -0,0 +1,397 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.cpp
+// ============
+// reorder the triangles and vertices of a mesh for faster drawing
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+
+// declaration of global variables
+namespace
+{
+	// entries of the simulated post-transform cache, a size most
+	// hardware reaches or beats
+	const uint32_t VERTEX_CACHE_SIZE = 16;
+	const uint32_t UNUSED_VERTEX = 0xFFFFFFFFu;
+
+	/***********************************************************
+	 *  IsCacheMiss()
+	 *
+	 *  Check a vertex against the FIFO cache and add it when it
+	 *  is missing. Each vertex keeps the time it was added, so
+	 *  it has been pushed out once the cache size has passed.
+	 ***********************************************************/
+	bool IsCacheMiss(std::vector<uint32_t>& cacheTimes, uint32_t& time, uint32_t vertex)
+	{
+		if (time - cacheTimes[vertex] > VERTEX_CACHE_SIZE)
+		{
+			cacheTimes[vertex] = time;
+			time++;
+			return(true);
+		}
+		return(false);
+	}
+
+	/***********************************************************
+	 *  SkipDeadEnd()
+	 *
+	 *  Find a vertex to continue from when the last fan has no
+	 *  cached neighbours left, first from the recently used
+	 *  vertices and then in input order.
+	 ***********************************************************/
+	int SkipDeadEnd(
+		const std::vector<uint32_t>& liveCounts,
+		std::vector<uint32_t>& deadEnds,
+		uint32_t& cursor)
+	{
+		while (!deadEnds.empty())
+		{
+			uint32_t vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if (liveCounts[vertex] > 0)
+			{
+				return(static_cast<int>(vertex));
+			}
+		}
+
+		while (cursor < liveCounts.size())
+		{
+			if (liveCounts[cursor] > 0)
+			{
+				return(static_cast<int>(cursor));
+			}
+			cursor++;
+		}
+
+		return(-1);
+	}
+}
+
+/***********************************************************
+ *  AnalyzeVertexCache()
+ *
+ *  This method is used for counting the vertices a FIFO
+ *  cache would transform for the index buffer.
+ ***********************************************************/
+VERTEX_CACHE_STATS AnalyzeVertexCache(
+	const uint32_t* indices,
+	uint32_t indexCount,
+	uint32_t vertexCount)
+{
+	VERTEX_CACHE_STATS stats;
+	if ((NULL == indices) || (indexCount < 3) || (vertexCount == 0))
+	{
+		return(stats);
+	}
+
+	std::vector<uint32_t> cacheTimes(vertexCount, 0);
+	std::vector<bool> bUsed(vertexCount, false);
+	uint32_t time = VERTEX_CACHE_SIZE + 1;
+	uint32_t misses = 0;
+	uint32_t usedCount = 0;
+
+	for (uint32_t i = 0; i < indexCount; i++)
+	{
+		uint32_t vertex = indices[i];
+		if (IsCacheMiss(cacheTimes, time, vertex))
+		{
+			misses++;
+		}
+		if (!bUsed[vertex])
+		{
+			bUsed[vertex] = true;
+			usedCount++;
+		}
+	}
+
+	stats.acmr = static_cast<float>(misses) / static_cast<float>(indexCount / 3);
+	stats.atvr = static_cast<float>(misses) / static_cast<float>(usedCount);
+	return(stats);
+}
+
+/***********************************************************
+ *  OptimizeVertexCache()
+ *
+ *  This method is used for reordering the triangles with
+ *  Tipsify. All the remaining triangles around a fanning
+ *  vertex are emitted together, and the next fanning vertex
+ *  is the neighbour that has been cached the longest while
+ *  still staying in the cache for all of its own triangles.
+ ***********************************************************/
+void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount)
+{
+	uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+	if ((triangleCount == 0) || (vertexCount == 0))
+	{
+		return;
+	}
+
+	// the triangles around each vertex, and how many of them
+	// are still waiting to be emitted
+	std::vector<uint32_t> liveCounts(vertexCount, 0);
+	for (uint32_t i = 0; i < triangleCount * 3; i++)
+	{
+		liveCounts[indices[i]]++;
+	}
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (uint32_t v = 0; v < vertexCount; v++)
+	{
+		adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveCounts[v];
+	}
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for (uint32_t t = 0; t < triangleCount; t++)
+	{
+		for (int corner = 0; corner < 3; corner++)
+		{
+			adjacency[fill[indices[t * 3 + corner]]++] = t;
+		}
+	}
+
+	std::vector<uint32_t> cacheTimes(vertexCount, 0);
+	std::vector<bool> bEmitted(triangleCount, false);
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> output;
+	output.reserve(triangleCount * 3);
+	uint32_t time = VERTEX_CACHE_SIZE + 1;
+	uint32_t cursor = 0;
+	int fanning = 0;
+
+	while (fanning >= 0)
+	{
+		candidates.clear();
+		for (uint32_t a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++)
+		{
+			uint32_t t = adjacency[a];
+			if (bEmitted[t])
+			{
+				continue;
+			}
+			for (int corner = 0; corner < 3; corner++)
+			{
+				uint32_t vertex = indices[t * 3 + corner];
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveCounts[vertex]--;
+				IsCacheMiss(cacheTimes, time, vertex);
+			}
+			bEmitted[t] = true;
+		}
+
+		// prefer the neighbour that is oldest in the cache but
+		// will not be pushed out before its fan is complete
+		fanning = -1;
+		int bestPriority = -1;
+		for (uint32_t vertex : candidates)
+		{
+			if (liveCounts[vertex] == 0)
+			{
+				continue;
+			}
+			int priority = 0;
+			int age = static_cast<int>(time - cacheTimes[vertex]);
+			if (age + 2 * static_cast<int>(liveCounts[vertex]) <= static_cast<int>(VERTEX_CACHE_SIZE))
+			{
+				priority = age;
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				fanning = static_cast<int>(vertex);
+			}
+		}
+
+		if (fanning < 0)
+		{
+			fanning = SkipDeadEnd(liveCounts, deadEnds, cursor);
+		}
+	}
+
+	indices.swap(output);
+}
+
+/***********************************************************
+ *  OptimizeOverdraw()
+ *
+ *  This method is used for reordering the triangles so that
+ *  the outward facing parts of the mesh are drawn first.
+ *  The cache-optimized order is split wherever a triangle
+ *  misses the cache with all three vertices, so moving the
+ *  clusters costs few extra transforms. The new order is
+ *  only kept when the cache miss ratio stays in bounds.
+ ***********************************************************/
+void OptimizeOverdraw(MESH_DATA& mesh, float threshold)
+{
+	uint32_t triangleCount = static_cast<uint32_t>(mesh.indices.size() / 3);
+	uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+	if ((triangleCount < 2) || (vertexCount == 0))
+	{
+		return;
+	}
+
+	std::vector<uint32_t> clusterStarts;
+	std::vector<uint32_t> cacheTimes(vertexCount, 0);
+	uint32_t time = VERTEX_CACHE_SIZE + 1;
+	for (uint32_t t = 0; t < triangleCount; t++)
+	{
+		int misses = 0;
+		for (int corner = 0; corner < 3; corner++)
+		{
+			if (IsCacheMiss(cacheTimes, time, mesh.indices[t * 3 + corner]))
+			{
+				misses++;
+			}
+		}
+		if ((t == 0) || (misses == 3))
+		{
+			clusterStarts.push_back(t);
+		}
+	}
+	if (clusterStarts.size() < 2)
+	{
+		return;
+	}
+	clusterStarts.push_back(triangleCount);
+	size_t clusterCount = clusterStarts.size() - 1;
+
+	// the area weighted center and direction of each cluster
+	std::vector<glm::vec3> clusterCenters(clusterCount, glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+	std::vector<float> clusterAreas(clusterCount, 0.0f);
+	glm::vec3 meshCenter(0.0f);
+	float meshArea = 0.0f;
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		for (uint32_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+		{
+			const glm::vec3& p0 = mesh.vertices[mesh.indices[t * 3 + 0]].position;
+			const glm::vec3& p1 = mesh.vertices[mesh.indices[t * 3 + 1]].position;
+			const glm::vec3& p2 = mesh.vertices[mesh.indices[t * 3 + 2]].position;
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float area = glm::length(normal);
+			glm::vec3 center = (p0 + p1 + p2) / 3.0f;
+
+			clusterCenters[c] += center * area;
+			clusterNormals[c] += normal;
+			clusterAreas[c] += area;
+			meshCenter += center * area;
+			meshArea += area;
+		}
+	}
+	if (meshArea <= 0.0f)
+	{
+		return;
+	}
+	meshCenter /= meshArea;
+
+	// clusters further out along their own normal come first
+	std::vector<float> sortKeys(clusterCount, 0.0f);
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		float normalLength = glm::length(clusterNormals[c]);
+		if ((clusterAreas[c] > 0.0f) && (normalLength > 0.0f))
+		{
+			glm::vec3 center = clusterCenters[c] / clusterAreas[c];
+			sortKeys[c] = glm::dot(center - meshCenter, clusterNormals[c] / normalLength);
+		}
+	}
+
+	std::vector<uint32_t> order(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		order[c] = static_cast<uint32_t>(c);
+	}
+	std::stable_sort(order.begin(), order.end(),
+		[&sortKeys](uint32_t a, uint32_t b) { return(sortKeys[a] > sortKeys[b]); });
+
+	std::vector<uint32_t> indices;
+	indices.reserve(mesh.indices.size());
+	for (uint32_t c : order)
+	{
+		indices.insert(
+			indices.end(),
+			mesh.indices.begin() + clusterStarts[c] * 3,
+			mesh.indices.begin() + clusterStarts[c + 1] * 3);
+	}
+
+	VERTEX_CACHE_STATS current = AnalyzeVertexCache(
+		mesh.indices.data(), static_cast<uint32_t>(mesh.indices.size()), vertexCount);
+	VERTEX_CACHE_STATS sorted = AnalyzeVertexCache(
+		indices.data(), static_cast<uint32_t>(indices.size()), vertexCount);
+	if (sorted.acmr <= current.acmr * threshold)
+	{
+		mesh.indices.swap(indices);
+	}
+}
+
+/***********************************************************
+ *  OptimizeVertexFetch()
+ *
+ *  This method is used for storing the vertices in the order
+ *  the index buffer first uses them and renumbering the
+ *  indices to match.
+ ***********************************************************/
+void OptimizeVertexFetch(MESH_DATA& mesh)
+{
+	uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+	if ((vertexCount == 0) || (mesh.indices.empty()))
+	{
+		return;
+	}
+	bool bLightmapUVs = (mesh.lightmapUVs.size() == mesh.vertices.size());
+
+	std::vector<uint32_t> remap(vertexCount, UNUSED_VERTEX);
+	std::vector<MESH_VERTEX> vertices;
+	std::vector<glm::vec2> lightmapUVs;
+	vertices.reserve(vertexCount);
+	if (bLightmapUVs)
+	{
+		lightmapUVs.reserve(vertexCount);
+	}
+
+	for (uint32_t& index : mesh.indices)
+	{
+		if (remap[index] == UNUSED_VERTEX)
+		{
+			remap[index] = static_cast<uint32_t>(vertices.size());
+			vertices.push_back(mesh.vertices[index]);
+			if (bLightmapUVs)
+			{
+				lightmapUVs.push_back(mesh.lightmapUVs[index]);
+			}
+		}
+		index = remap[index];
+	}
+
+	mesh.vertices.swap(vertices);
+	if (bLightmapUVs)
+	{
+		mesh.lightmapUVs.swap(lightmapUVs);
+	}
+}
+
+/***********************************************************
+ *  OptimizeMesh()
+ *
+ *  This method is used for running the vertex cache,
+ *  overdraw and vertex fetch passes on a mesh in order.
+ ***********************************************************/
+void OptimizeMesh(MESH_DATA& mesh, VERTEX_CACHE_STATS& before, VERTEX_CACHE_STATS& after)
+{
+	uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+	before = AnalyzeVertexCache(
+		mesh.indices.data(), static_cast<uint32_t>(mesh.indices.size()), vertexCount);
+
+	OptimizeVertexCache(mesh.indices, vertexCount);
+	OptimizeOverdraw(mesh);
+	OptimizeVertexFetch(mesh);
+
+	after = AnalyzeVertexCache(
+		mesh.indices.data(),
+		static_cast<uint32_t>(mesh.indices.size()),
+		static_cast<uint32_t>(mesh.vertices.size()));
+}
@@ -0,0 +1,47 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.h
+// ============
+// reorder the triangles and vertices of a mesh for faster drawing
+//
+// The triangles are first ordered for the post-transform vertex cache with
+// the Tipsify algorithm, which fans around recently used vertices so that
+// most of them are still cached when they are referenced again. The cache
+// friendly order is then split into clusters, and the clusters are sorted
+// so that the ones facing outward are drawn first, which lets the depth
+// test reject more of the hidden fragments. Finally the vertices are stored
+// in the order the indices first reference them, so that vertex fetching
+// reads the buffer front to back.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshBuilder.h"
+
+#include <cstdint>
+
+// efficiency of an index buffer on a simulated FIFO vertex cache
+struct VERTEX_CACHE_STATS
+{
+	// average cache miss ratio, transformed vertices per triangle
+	float acmr = 0.0f;
+	// average transform to vertex ratio, 1.0 is the best possible
+	float atvr = 0.0f;
+};
+
+// simulate the vertex cache for an index buffer
+VERTEX_CACHE_STATS AnalyzeVertexCache(
+	const uint32_t* indices,
+	uint32_t indexCount,
+	uint32_t vertexCount);
+
+// reorder the triangles for the vertex cache
+void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount);
+// reorder clusters of cache-optimized triangles to reduce overdraw, as long
+// as the cache miss ratio grows by no more than the threshold factor
+void OptimizeOverdraw(MESH_DATA& mesh, float threshold = 1.05f);
+// store the vertices in the order they are first used, dropping any that
+// are never referenced
+void OptimizeVertexFetch(MESH_DATA& mesh);
+
+// run all the passes on a mesh and measure the cache before and after
+void OptimizeMesh(MESH_DATA& mesh, VERTEX_CACHE_STATS& before, VERTEX_CACHE_STATS& after);
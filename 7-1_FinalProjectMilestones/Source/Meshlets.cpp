@@ -0,0 +1,355 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshlets.cpp
+// ============
+// split large meshes into small clusters and cull them on the CPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Meshlets.h"
+#include "GLStateCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+// declaration of global variables
+namespace
+{
+	// meshlets tested by one task
+	const uint32_t MESHLET_TASK_SIZE = 256;
+	// below this many meshlets in a frame starting the worker
+	// threads costs more than it saves
+	const size_t MESHLET_PARALLEL_MIN = 2048;
+	// normal cones wider than this are never culled
+	const float MESHLET_MIN_CONE_DOT = 0.1f;
+
+	// a range of the meshlets of one job
+	struct MESHLET_TASK
+	{
+		size_t job;
+		uint32_t begin;
+		uint32_t end;
+	};
+
+	/***********************************************************
+	 *  ComputeMeshletBounds()
+	 *
+	 *  Fit the bounding sphere around the vertices and the
+	 *  normal cone around the triangles of a meshlet.
+	 ***********************************************************/
+	void ComputeMeshletBounds(const MESH_DATA& mesh, MESHLET& meshlet)
+	{
+		const uint32_t* indices = &mesh.indices[meshlet.firstIndex];
+
+		glm::vec3 boundsMin = mesh.vertices[indices[0]].position;
+		glm::vec3 boundsMax = boundsMin;
+		for (uint32_t i = 1; i < meshlet.indexCount; i++)
+		{
+			boundsMin = glm::min(boundsMin, mesh.vertices[indices[i]].position);
+			boundsMax = glm::max(boundsMax, mesh.vertices[indices[i]].position);
+		}
+		meshlet.center = (boundsMin + boundsMax) * 0.5f;
+		meshlet.radius = 0.0f;
+		for (uint32_t i = 0; i < meshlet.indexCount; i++)
+		{
+			meshlet.radius = std::max(meshlet.radius,
+				glm::length(mesh.vertices[indices[i]].position - meshlet.center));
+		}
+
+		// the axis is the average direction of the faces, and
+		// the widest face decides the opening of the cone
+		std::vector<glm::vec3> normals;
+		glm::vec3 sum(0.0f);
+		for (uint32_t i = 0; i + 2 < meshlet.indexCount; i += 3)
+		{
+			const glm::vec3& a = mesh.vertices[indices[i]].position;
+			glm::vec3 normal = glm::cross(
+				mesh.vertices[indices[i + 1]].position - a,
+				mesh.vertices[indices[i + 2]].position - a);
+			float length = glm::length(normal);
+			if (length > 0.0f)
+			{
+				normals.push_back(normal / length);
+				sum += normals.back();
+			}
+		}
+
+		meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+		meshlet.coneCutoff = 1.0f;
+		float sumLength = glm::length(sum);
+		if ((normals.empty()) || (sumLength <= 0.0f))
+		{
+			return;
+		}
+		meshlet.coneAxis = sum / sumLength;
+
+		float minDot = 1.0f;
+		for (const glm::vec3& normal : normals)
+		{
+			minDot = std::min(minDot, glm::dot(normal, meshlet.coneAxis));
+		}
+		if (minDot > MESHLET_MIN_CONE_DOT)
+		{
+			// the cone of view directions that see only back
+			// faces is the normal cone turned by 90 degrees
+			meshlet.coneCutoff = sqrtf(1.0f - minDot * minDot);
+		}
+	}
+
+	/***********************************************************
+	 *  IsMeshletVisible()
+	 *
+	 *  Test a meshlet against the frustum planes and then the
+	 *  camera against its normal cone.
+	 ***********************************************************/
+	bool IsMeshletVisible(const MESHLET& meshlet, const MESHLET_CULL_VIEW& view)
+	{
+		// the planes are not normalized in mesh space, so the
+		// radius is scaled by their length
+		for (int i = 0; i < 6; i++)
+		{
+			glm::vec3 normal(view.planes[i]);
+			if (glm::dot(normal, meshlet.center) + view.planes[i].w < -meshlet.radius * glm::length(normal))
+			{
+				return(false);
+			}
+		}
+
+		if (view.bConeCulling)
+		{
+			glm::vec3 toCenter = meshlet.center - view.cameraPosition;
+			if (glm::dot(toCenter, meshlet.coneAxis) >=
+				meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius)
+			{
+				return(false);
+			}
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  BuildDrawList()
+	 *
+	 *  Turn the visible meshlets into index ranges, joining
+	 *  the ones that follow each other in the index buffer.
+	 ***********************************************************/
+	void BuildDrawList(const std::vector<MESHLET>& meshlets, MESHLET_DRAW_LIST& drawList)
+	{
+		drawList.counts.clear();
+		drawList.offsets.clear();
+		drawList.visibleTriangles = 0;
+
+		uint32_t rangeEnd = UINT32_MAX;
+		for (size_t i = 0; i < meshlets.size(); i++)
+		{
+			if (!drawList.visible[i])
+			{
+				continue;
+			}
+
+			const MESHLET& meshlet = meshlets[i];
+			if (meshlet.firstIndex == rangeEnd)
+			{
+				drawList.counts.back() += static_cast<GLsizei>(meshlet.indexCount);
+			}
+			else
+			{
+				drawList.counts.push_back(static_cast<GLsizei>(meshlet.indexCount));
+				drawList.offsets.push_back(reinterpret_cast<const void*>(
+					static_cast<uintptr_t>(meshlet.firstIndex) * sizeof(uint32_t)));
+			}
+			rangeEnd = meshlet.firstIndex + meshlet.indexCount;
+			drawList.visibleTriangles += meshlet.indexCount / 3;
+		}
+	}
+}
+
+/***********************************************************
+ *  BuildMeshlets()
+ *
+ *  This function is used for splitting the triangles of a
+ *  mesh into meshlets. A meshlet is closed when the next
+ *  triangle would take it past the vertex or the triangle
+ *  limit, so the order of the triangles is kept.
+ ***********************************************************/
+void BuildMeshlets(
+	const MESH_DATA& mesh,
+	std::vector<MESHLET>& meshlets,
+	uint32_t maxVertices,
+	uint32_t maxTriangles)
+{
+	meshlets.clear();
+	uint32_t indexCount = static_cast<uint32_t>(mesh.indices.size() / 3) * 3;
+	if (indexCount == 0)
+	{
+		return;
+	}
+
+	// the meshlet that last used each vertex
+	std::vector<uint32_t> vertexMeshlet(mesh.vertices.size(), UINT32_MAX);
+	uint32_t meshletVertices = 0;
+
+	MESHLET meshlet;
+	meshlet.firstIndex = 0;
+	meshlet.indexCount = 0;
+	for (uint32_t i = 0; i < indexCount; i += 3)
+	{
+		uint32_t current = static_cast<uint32_t>(meshlets.size());
+		uint32_t newVertices = 0;
+		for (int c = 0; c < 3; c++)
+		{
+			uint32_t vertex = mesh.indices[i + c];
+			// a vertex used twice by one triangle is counted once
+			bool bRepeated = ((c > 0) && (vertex == mesh.indices[i])) ||
+				((c > 1) && (vertex == mesh.indices[i + 1]));
+			newVertices += (((vertexMeshlet[vertex] != current) && (!bRepeated)) ? 1 : 0);
+		}
+
+		if ((meshlet.indexCount > 0) &&
+			((meshletVertices + newVertices > maxVertices) ||
+				(meshlet.indexCount / 3 >= maxTriangles)))
+		{
+			meshlets.push_back(meshlet);
+			meshlet.firstIndex = i;
+			meshlet.indexCount = 0;
+			meshletVertices = 0;
+			current++;
+		}
+
+		for (int c = 0; c < 3; c++)
+		{
+			uint32_t vertex = mesh.indices[i + c];
+			if (vertexMeshlet[vertex] != current)
+			{
+				vertexMeshlet[vertex] = current;
+				meshletVertices++;
+			}
+		}
+		meshlet.indexCount += 3;
+	}
+	meshlets.push_back(meshlet);
+
+	for (MESHLET& bounded : meshlets)
+	{
+		ComputeMeshletBounds(mesh, bounded);
+	}
+}
+
+/***********************************************************
+ *  SetupMeshletCullView()
+ *
+ *  This function is used for moving the camera into the
+ *  space of a mesh. The frustum planes are read from the
+ *  rows of the combined matrix, so the meshlet bounds never
+ *  have to be transformed.
+ ***********************************************************/
+void SetupMeshletCullView(
+	const glm::mat4& viewProjection,
+	const glm::mat4& model,
+	const glm::vec3& viewPosition,
+	bool bConeCulling,
+	MESHLET_CULL_VIEW& view)
+{
+	glm::mat4 clip = viewProjection * model;
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+	{
+		rows[i] = glm::vec4(clip[0][i], clip[1][i], clip[2][i], clip[3][i]);
+	}
+	view.planes[0] = rows[3] + rows[0];
+	view.planes[1] = rows[3] - rows[0];
+	view.planes[2] = rows[3] + rows[1];
+	view.planes[3] = rows[3] - rows[1];
+	view.planes[4] = rows[3] + rows[2];
+	view.planes[5] = rows[3] - rows[2];
+
+	view.cameraPosition = glm::vec3(glm::inverse(model) * glm::vec4(viewPosition, 1.0f));
+	view.bConeCulling = ((bConeCulling) && (glm::determinant(glm::mat3(model)) > 0.0f));
+}
+
+/***********************************************************
+ *  CullMeshlets()
+ *
+ *  This function is used for testing the meshlets of every
+ *  job in ranges that the threads take from a shared
+ *  counter, then collecting the visible ranges of each job.
+ ***********************************************************/
+void CullMeshlets(std::vector<MESHLET_CULL_JOB>& jobs, int threadCount)
+{
+	std::vector<MESHLET_TASK> tasks;
+	size_t meshletCount = 0;
+	for (size_t j = 0; j < jobs.size(); j++)
+	{
+		uint32_t count = static_cast<uint32_t>(jobs[j].pMeshlets->size());
+		jobs[j].pDrawList->visible.resize(count);
+		for (uint32_t begin = 0; begin < count; begin += MESHLET_TASK_SIZE)
+		{
+			MESHLET_TASK task = { j, begin, std::min(count, begin + MESHLET_TASK_SIZE) };
+			tasks.push_back(task);
+		}
+		meshletCount += count;
+	}
+
+	if (meshletCount < MESHLET_PARALLEL_MIN)
+	{
+		threadCount = 1;
+	}
+	else if (threadCount <= 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	std::atomic<int> nextTask(0);
+	auto worker = [&nextTask, &tasks, &jobs]()
+	{
+		int index = 0;
+		while ((index = nextTask.fetch_add(1)) < static_cast<int>(tasks.size()))
+		{
+			const MESHLET_TASK& task = tasks[index];
+			const MESHLET_CULL_JOB& job = jobs[task.job];
+			for (uint32_t i = task.begin; i < task.end; i++)
+			{
+				job.pDrawList->visible[i] = (IsMeshletVisible((*job.pMeshlets)[i], job.view) ? 1 : 0);
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 1; (i < threadCount) && (i < static_cast<int>(tasks.size())); i++)
+	{
+		threads.push_back(std::thread(worker));
+	}
+	worker();
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	for (MESHLET_CULL_JOB& job : jobs)
+	{
+		BuildDrawList(*job.pMeshlets, *job.pDrawList);
+	}
+}
+
+/***********************************************************
+ *  DrawMeshletList()
+ *
+ *  This function is used for drawing the visible ranges of
+ *  a mesh with the currently active shader.
+ ***********************************************************/
+void DrawMeshletList(const GL_MESH& glMesh, const MESHLET_DRAW_LIST& drawList)
+{
+	if ((glMesh.vao == 0) || (drawList.counts.empty()))
+	{
+		return;
+	}
+
+	g_GLState.BindVertexArray(glMesh.vao);
+	glMultiDrawElements(
+		GL_TRIANGLES,
+		drawList.counts.data(),
+		GL_UNSIGNED_INT,
+		drawList.offsets.data(),
+		static_cast<GLsizei>(drawList.counts.size()));
+}
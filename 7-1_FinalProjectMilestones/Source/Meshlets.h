@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshlets.h
+// ============
+// split large meshes into small clusters and cull them on the CPU
+//
+// A meshlet is a run of up to 124 consecutive triangles of the index buffer
+// that touches no more than 64 vertices. The triangles of an optimized mesh
+// are already in a cache friendly order, so consecutive triangles lie close
+// together and a run makes a compact cluster. Every meshlet keeps a bounding
+// sphere and a cone around the normals of its triangles. Each frame the
+// clusters outside the view frustum, and the ones whose triangles all face
+// away from the camera, are dropped on the worker threads. The runs that
+// remain are merged where they touch and drawn with one multi-draw call.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshBuilder.h"
+
+#include <cstdint>
+#include <vector>
+
+// one cluster of consecutive triangles in the index buffer
+struct MESHLET
+{
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	// bounding sphere in mesh space
+	glm::vec3 center;
+	float radius;
+	// the triangles all face away from a camera inside the cone
+	// behind the cluster, a cutoff of 1 never culls
+	glm::vec3 coneAxis;
+	float coneCutoff;
+};
+
+// the camera moved into the space of one drawn mesh
+struct MESHLET_CULL_VIEW
+{
+	glm::vec4 planes[6];
+	glm::vec3 cameraPosition;
+	// back facing clusters are only culled for opaque meshes in
+	// a perspective view that are not mirrored by their transform
+	bool bConeCulling;
+};
+
+// index ranges of the visible meshlets of one mesh
+struct MESHLET_DRAW_LIST
+{
+	std::vector<GLsizei> counts;
+	std::vector<const void*> offsets;
+	// visibility of every meshlet, kept to reuse its memory
+	std::vector<uint8_t> visible;
+	uint32_t visibleTriangles = 0;
+};
+
+// the meshlets of one drawn object to be culled in a frame
+struct MESHLET_CULL_JOB
+{
+	const std::vector<MESHLET>* pMeshlets;
+	MESHLET_CULL_VIEW view;
+	MESHLET_DRAW_LIST* pDrawList;
+};
+
+// split the triangles of a mesh into meshlets in their current order
+void BuildMeshlets(
+	const MESH_DATA& mesh,
+	std::vector<MESHLET>& meshlets,
+	uint32_t maxVertices = 64,
+	uint32_t maxTriangles = 124);
+
+// move the camera into the space of a mesh drawn with the model matrix
+void SetupMeshletCullView(
+	const glm::mat4& viewProjection,
+	const glm::mat4& model,
+	const glm::vec3& viewPosition,
+	bool bConeCulling,
+	MESHLET_CULL_VIEW& view);
+
+// cull the meshlets of every job and fill their draw lists, using the
+// worker threads when there are enough meshlets, or all CPU cores when
+// the thread count is zero
+void CullMeshlets(std::vector<MESHLET_CULL_JOB>& jobs, int threadCount = 0);
+
+// draw the visible ranges of an uploaded mesh
+void DrawMeshletList(const GL_MESH& glMesh, const MESHLET_DRAW_LIST& drawList);
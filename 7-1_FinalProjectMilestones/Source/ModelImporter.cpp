@@ -0,0 +1,1788 @@
+///////////////////////////////////////////////////////////////////////////////
+// modelimporter.cpp
+// ============
+// import triangle meshes from OBJ and glTF 2.0 model files
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ModelImporter.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// an OBJ file is cut into this many chunks per thread, so a
+	// thread that finishes early picks up more of the work
+	const int OBJ_CHUNKS_PER_THREAD = 4;
+	// glTF vertices or triangles converted by one task
+	const uint32_t GLTF_TASK_SIZE = 65536;
+	// nesting limit of the JSON values and the glTF nodes
+	const int MAX_DEPTH = 64;
+
+	// marks an OBJ index that is missing or out of range
+	const int32_t NO_INDEX = INT32_MIN;
+
+	// glTF component types
+	const int GLTF_BYTE = 5120;
+	const int GLTF_UNSIGNED_BYTE = 5121;
+	const int GLTF_SHORT = 5122;
+	const int GLTF_UNSIGNED_SHORT = 5123;
+	const int GLTF_UNSIGNED_INT = 5125;
+	const int GLTF_FLOAT = 5126;
+	const int GLTF_TRIANGLES = 4;
+
+	const uint32_t GLB_MAGIC = 0x46546C67;
+	const uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+	const uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+	/***********************************************************
+	 *  RunParallel()
+	 *
+	 *  Run the tasks on the worker threads and the calling
+	 *  thread, which hand them out through a shared counter.
+	 ***********************************************************/
+	void RunParallel(int taskCount, int threadCount, const std::function<void(int)>& task)
+	{
+		std::atomic<int> nextTask(0);
+		auto worker = [&nextTask, taskCount, &task]()
+		{
+			int index = 0;
+			while ((index = nextTask.fetch_add(1)) < taskCount)
+			{
+				task(index);
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (int i = 1; (i < threadCount) && (i < taskCount); i++)
+		{
+			threads.push_back(std::thread(worker));
+		}
+		worker();
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	/***********************************************************
+	 *  HasExtension()
+	 *
+	 *  Check the extension of a filename, ignoring the case.
+	 ***********************************************************/
+	bool HasExtension(const std::string& filename, const char* extension)
+	{
+		size_t length = strlen(extension);
+		if (filename.size() < length)
+		{
+			return(false);
+		}
+		for (size_t i = 0; i < length; i++)
+		{
+			char c = filename[filename.size() - length + i];
+			if (tolower(static_cast<unsigned char>(c)) != extension[i])
+			{
+				return(false);
+			}
+		}
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ComputeMissingNormals()
+	 *
+	 *  Give the vertices that were stored without a normal the
+	 *  area weighted average of the faces around them.
+	 ***********************************************************/
+	void ComputeMissingNormals(MESH_DATA& mesh)
+	{
+		std::vector<bool> bMissing(mesh.vertices.size(), false);
+		bool bAnyMissing = false;
+		for (size_t i = 0; i < mesh.vertices.size(); i++)
+		{
+			if (glm::dot(mesh.vertices[i].normal, mesh.vertices[i].normal) == 0.0f)
+			{
+				bMissing[i] = true;
+				bAnyMissing = true;
+			}
+		}
+		if (!bAnyMissing)
+		{
+			return;
+		}
+
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+		{
+			uint32_t a = mesh.indices[i];
+			uint32_t b = mesh.indices[i + 1];
+			uint32_t c = mesh.indices[i + 2];
+			glm::vec3 normal = glm::cross(
+				mesh.vertices[b].position - mesh.vertices[a].position,
+				mesh.vertices[c].position - mesh.vertices[a].position);
+			for (uint32_t vertex : { a, b, c })
+			{
+				if (bMissing[vertex])
+				{
+					mesh.vertices[vertex].normal += normal;
+				}
+			}
+		}
+
+		for (size_t i = 0; i < mesh.vertices.size(); i++)
+		{
+			float length = glm::length(mesh.vertices[i].normal);
+			if ((bMissing[i]) && (length > 0.0f))
+			{
+				mesh.vertices[i].normal /= length;
+			}
+			else if (bMissing[i])
+			{
+				mesh.vertices[i].normal = glm::vec3(0.0f, 1.0f, 0.0f);
+			}
+		}
+	}
+
+	///////////////////////////////////////////////////////////////////////
+	// OBJ
+	///////////////////////////////////////////////////////////////////////
+
+	// one corner of a face, indices are zero-based, relative ones
+	// count from the start of the chunk until the bases are known
+	struct OBJ_CORNER
+	{
+		int32_t position;
+		int32_t texCoord;
+		int32_t normal;
+		// bit 0 position, bit 1 texture coordinate, bit 2 normal
+		uint8_t relativeMask;
+	};
+
+	struct OBJ_CHUNK
+	{
+		const char* pBegin;
+		const char* pEnd;
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec2> texCoords;
+		std::vector<glm::vec3> normals;
+		// three corners for every triangle
+		std::vector<OBJ_CORNER> corners;
+		// first global index of the attributes of the chunk
+		size_t positionBase;
+		size_t texCoordBase;
+		size_t normalBase;
+		// the deduplicated vertices of the chunk
+		std::vector<MESH_VERTEX> vertices;
+		std::vector<uint32_t> indices;
+		size_t vertexBase;
+		size_t indexBase;
+	};
+
+	struct OBJ_VERTEX_KEY
+	{
+		int32_t position;
+		int32_t texCoord;
+		int32_t normal;
+
+		bool operator==(const OBJ_VERTEX_KEY& other) const
+		{
+			return((position == other.position) && (texCoord == other.texCoord) && (normal == other.normal));
+		}
+	};
+
+	struct OBJ_VERTEX_KEY_HASH
+	{
+		size_t operator()(const OBJ_VERTEX_KEY& key) const
+		{
+			uint64_t hash = static_cast<uint32_t>(key.position);
+			hash = hash * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(key.texCoord);
+			hash = hash * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(key.normal);
+			return(static_cast<size_t>(hash ^ (hash >> 29)));
+		}
+	};
+
+	/***********************************************************
+	 *  SkipSpaces()
+	 *
+	 *  Move past the blanks inside a line.
+	 ***********************************************************/
+	void SkipSpaces(const char*& p, const char* pEnd)
+	{
+		while ((p < pEnd) && ((*p == ' ') || (*p == '\t') || (*p == '\r')))
+		{
+			p++;
+		}
+	}
+
+	/***********************************************************
+	 *  ParseInt()
+	 *
+	 *  Read a signed integer, returns false when there is none.
+	 ***********************************************************/
+	bool ParseInt(const char*& p, const char* pEnd, int& value)
+	{
+		bool bNegative = false;
+		if ((p < pEnd) && ((*p == '-') || (*p == '+')))
+		{
+			bNegative = (*p == '-');
+			p++;
+		}
+		if ((p >= pEnd) || (*p < '0') || (*p > '9'))
+		{
+			return(false);
+		}
+
+		long long number = 0;
+		while ((p < pEnd) && (*p >= '0') && (*p <= '9'))
+		{
+			if (number < INT_MAX)
+			{
+				number = number * 10 + (*p - '0');
+			}
+			p++;
+		}
+		number = std::min<long long>(number, INT_MAX);
+		value = static_cast<int>(bNegative ? -number : number);
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ParseDouble()
+	 *
+	 *  Read a decimal number with an optional exponent. The
+	 *  text is not terminated, so strtod cannot be used on the
+	 *  mapped file.
+	 ***********************************************************/
+	double ParseDouble(const char*& p, const char* pEnd)
+	{
+		SkipSpaces(p, pEnd);
+
+		bool bNegative = false;
+		if ((p < pEnd) && ((*p == '-') || (*p == '+')))
+		{
+			bNegative = (*p == '-');
+			p++;
+		}
+
+		// the digits past the precision of a double only move
+		// the decimal exponent
+		uint64_t mantissa = 0;
+		int exponent = 0;
+		while ((p < pEnd) && (*p >= '0') && (*p <= '9'))
+		{
+			if (mantissa < 100000000000000000ull)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+			}
+			else
+			{
+				exponent++;
+			}
+			p++;
+		}
+		if ((p < pEnd) && (*p == '.'))
+		{
+			p++;
+			while ((p < pEnd) && (*p >= '0') && (*p <= '9'))
+			{
+				if (mantissa < 100000000000000000ull)
+				{
+					mantissa = mantissa * 10 + (*p - '0');
+					exponent--;
+				}
+				p++;
+			}
+		}
+		if ((p < pEnd) && ((*p == 'e') || (*p == 'E')))
+		{
+			p++;
+			int power = 0;
+			if (ParseInt(p, pEnd, power))
+			{
+				exponent += std::max(-400, std::min(400, power));
+			}
+		}
+
+		double value = static_cast<double>(mantissa);
+		if (exponent != 0)
+		{
+			value *= pow(10.0, exponent);
+		}
+		return(bNegative ? -value : value);
+	}
+
+	/***********************************************************
+	 *  ParseFloat()
+	 *
+	 *  Read a decimal number into a float for the attributes of
+	 *  an OBJ file.
+	 ***********************************************************/
+	float ParseFloat(const char*& p, const char* pEnd)
+	{
+		return(static_cast<float>(ParseDouble(p, pEnd)));
+	}
+
+	/***********************************************************
+	 *  ParseObjIndex()
+	 *
+	 *  Read one index of a face corner. Negative indices count
+	 *  back from the attributes read so far, which for now is
+	 *  only known within the chunk.
+	 ***********************************************************/
+	int32_t ParseObjIndex(const char*& p, const char* pEnd, size_t localCount, uint8_t relativeBit, uint8_t& relativeMask)
+	{
+		int value = 0;
+		if (!ParseInt(p, pEnd, value))
+		{
+			return(NO_INDEX);
+		}
+		if (value > 0)
+		{
+			return(value - 1);
+		}
+		if (value < 0)
+		{
+			relativeMask |= relativeBit;
+			return(static_cast<int32_t>(static_cast<long long>(localCount) + value));
+		}
+		return(NO_INDEX);
+	}
+
+	/***********************************************************
+	 *  ParseObjChunk()
+	 *
+	 *  Read the vertex attributes and faces of a range of
+	 *  whole lines. Polygons are split into triangle fans.
+	 ***********************************************************/
+	void ParseObjChunk(OBJ_CHUNK& chunk)
+	{
+		std::vector<OBJ_CORNER> polygon;
+		const char* p = chunk.pBegin;
+
+		while (p < chunk.pEnd)
+		{
+			const char* pLineEnd = static_cast<const char*>(memchr(p, '\n', chunk.pEnd - p));
+			if (NULL == pLineEnd)
+			{
+				pLineEnd = chunk.pEnd;
+			}
+
+			SkipSpaces(p, pLineEnd);
+			if ((pLineEnd - p >= 2) && (p[0] == 'v') && ((p[1] == ' ') || (p[1] == '\t')))
+			{
+				p += 2;
+				glm::vec3 position;
+				position.x = ParseFloat(p, pLineEnd);
+				position.y = ParseFloat(p, pLineEnd);
+				position.z = ParseFloat(p, pLineEnd);
+				chunk.positions.push_back(position);
+			}
+			else if ((pLineEnd - p >= 3) && (p[0] == 'v') && (p[1] == 't') && ((p[2] == ' ') || (p[2] == '\t')))
+			{
+				p += 3;
+				glm::vec2 texCoord;
+				texCoord.x = ParseFloat(p, pLineEnd);
+				texCoord.y = ParseFloat(p, pLineEnd);
+				chunk.texCoords.push_back(texCoord);
+			}
+			else if ((pLineEnd - p >= 3) && (p[0] == 'v') && (p[1] == 'n') && ((p[2] == ' ') || (p[2] == '\t')))
+			{
+				p += 3;
+				glm::vec3 normal;
+				normal.x = ParseFloat(p, pLineEnd);
+				normal.y = ParseFloat(p, pLineEnd);
+				normal.z = ParseFloat(p, pLineEnd);
+				chunk.normals.push_back(normal);
+			}
+			else if ((pLineEnd - p >= 2) && (p[0] == 'f') && ((p[1] == ' ') || (p[1] == '\t')))
+			{
+				p += 2;
+				polygon.clear();
+				for (;;)
+				{
+					SkipSpaces(p, pLineEnd);
+					if (p >= pLineEnd)
+					{
+						break;
+					}
+
+					OBJ_CORNER corner;
+					corner.relativeMask = 0;
+					corner.position = ParseObjIndex(p, pLineEnd, chunk.positions.size(), 1, corner.relativeMask);
+					corner.texCoord = NO_INDEX;
+					corner.normal = NO_INDEX;
+					if ((p < pLineEnd) && (*p == '/'))
+					{
+						p++;
+						if ((p < pLineEnd) && (*p != '/'))
+						{
+							corner.texCoord = ParseObjIndex(p, pLineEnd, chunk.texCoords.size(), 2, corner.relativeMask);
+						}
+						if ((p < pLineEnd) && (*p == '/'))
+						{
+							p++;
+							corner.normal = ParseObjIndex(p, pLineEnd, chunk.normals.size(), 4, corner.relativeMask);
+						}
+					}
+					// anything else up to the next blank is ignored
+					while ((p < pLineEnd) && (*p != ' ') && (*p != '\t') && (*p != '\r'))
+					{
+						p++;
+					}
+					polygon.push_back(corner);
+				}
+
+				for (size_t i = 2; i < polygon.size(); i++)
+				{
+					chunk.corners.push_back(polygon[0]);
+					chunk.corners.push_back(polygon[i - 1]);
+					chunk.corners.push_back(polygon[i]);
+				}
+			}
+
+			p = pLineEnd + 1;
+		}
+	}
+
+	/***********************************************************
+	 *  ResolveObjIndex()
+	 *
+	 *  Turn a chunk index into an index of the whole file,
+	 *  returns NO_INDEX when it is out of range.
+	 ***********************************************************/
+	int32_t ResolveObjIndex(int32_t index, bool bRelative, size_t base, size_t count)
+	{
+		if (index == NO_INDEX)
+		{
+			return(NO_INDEX);
+		}
+		long long resolved = index;
+		if (bRelative)
+		{
+			resolved += static_cast<long long>(base);
+		}
+		if ((resolved < 0) || (resolved >= static_cast<long long>(count)))
+		{
+			return(NO_INDEX);
+		}
+		return(static_cast<int32_t>(resolved));
+	}
+
+	/***********************************************************
+	 *  BuildObjChunkVertices()
+	 *
+	 *  Create one vertex for each distinct combination of
+	 *  position, texture coordinate and normal in the chunk.
+	 *  Vertices shared across chunks are kept once per chunk.
+	 ***********************************************************/
+	void BuildObjChunkVertices(
+		OBJ_CHUNK& chunk,
+		const std::vector<glm::vec3>& positions,
+		const std::vector<glm::vec2>& texCoords,
+		const std::vector<glm::vec3>& normals)
+	{
+		std::unordered_map<OBJ_VERTEX_KEY, uint32_t, OBJ_VERTEX_KEY_HASH> vertexMap;
+		vertexMap.reserve(chunk.corners.size());
+		chunk.indices.reserve(chunk.corners.size());
+
+		for (size_t i = 0; i + 2 < chunk.corners.size(); i += 3)
+		{
+			uint32_t triangle[3];
+			bool bValid = true;
+			for (int c = 0; (c < 3) && (bValid); c++)
+			{
+				const OBJ_CORNER& corner = chunk.corners[i + c];
+				OBJ_VERTEX_KEY key;
+				key.position = ResolveObjIndex(corner.position, (corner.relativeMask & 1) != 0, chunk.positionBase, positions.size());
+				key.texCoord = ResolveObjIndex(corner.texCoord, (corner.relativeMask & 2) != 0, chunk.texCoordBase, texCoords.size());
+				key.normal = ResolveObjIndex(corner.normal, (corner.relativeMask & 4) != 0, chunk.normalBase, normals.size());
+				if (key.position == NO_INDEX)
+				{
+					bValid = false;
+					break;
+				}
+
+				auto found = vertexMap.find(key);
+				if (found != vertexMap.end())
+				{
+					triangle[c] = found->second;
+					continue;
+				}
+
+				// a missing normal stays zero until it is computed
+				MESH_VERTEX vertex;
+				vertex.position = positions[key.position];
+				vertex.normal = ((key.normal != NO_INDEX) ? normals[key.normal] : glm::vec3(0.0f));
+				vertex.texCoord = ((key.texCoord != NO_INDEX) ? texCoords[key.texCoord] : glm::vec2(0.0f));
+				triangle[c] = static_cast<uint32_t>(chunk.vertices.size());
+				chunk.vertices.push_back(vertex);
+				vertexMap[key] = triangle[c];
+			}
+
+			if (bValid)
+			{
+				chunk.indices.insert(chunk.indices.end(), triangle, triangle + 3);
+			}
+		}
+
+		chunk.corners.clear();
+		chunk.corners.shrink_to_fit();
+	}
+
+	/***********************************************************
+	 *  ImportObj()
+	 *
+	 *  Parse the chunks, share out the global attribute bases,
+	 *  build the vertices of every chunk and join them, each
+	 *  step on all threads.
+	 ***********************************************************/
+	bool ImportObj(const MappedFile& file, MESH_DATA& mesh, int threadCount)
+	{
+		const char* pText = reinterpret_cast<const char*>(file.GetData());
+		const char* pTextEnd = pText + file.GetSize();
+
+		// cut at line breaks near evenly spaced offsets
+		size_t chunkCount = static_cast<size_t>(threadCount * OBJ_CHUNKS_PER_THREAD);
+		std::vector<OBJ_CHUNK> chunks;
+		const char* pBegin = pText;
+		for (size_t i = 1; (i <= chunkCount) && (pBegin < pTextEnd); i++)
+		{
+			const char* pEnd = pTextEnd;
+			if (i < chunkCount)
+			{
+				pEnd = pText + (file.GetSize() * i) / chunkCount;
+				if (pEnd <= pBegin)
+				{
+					continue;
+				}
+				const char* pBreak = static_cast<const char*>(memchr(pEnd, '\n', pTextEnd - pEnd));
+				pEnd = ((NULL != pBreak) ? pBreak + 1 : pTextEnd);
+			}
+			OBJ_CHUNK chunk;
+			chunk.pBegin = pBegin;
+			chunk.pEnd = pEnd;
+			chunks.push_back(chunk);
+			pBegin = pEnd;
+		}
+
+		RunParallel(static_cast<int>(chunks.size()), threadCount,
+			[&chunks](int index) { ParseObjChunk(chunks[index]); });
+
+		size_t positionCount = 0;
+		size_t texCoordCount = 0;
+		size_t normalCount = 0;
+		for (OBJ_CHUNK& chunk : chunks)
+		{
+			chunk.positionBase = positionCount;
+			chunk.texCoordBase = texCoordCount;
+			chunk.normalBase = normalCount;
+			positionCount += chunk.positions.size();
+			texCoordCount += chunk.texCoords.size();
+			normalCount += chunk.normals.size();
+		}
+		if ((positionCount == 0) || (positionCount >= static_cast<size_t>(INT32_MAX)))
+		{
+			return(false);
+		}
+
+		std::vector<glm::vec3> positions(positionCount);
+		std::vector<glm::vec2> texCoords(texCoordCount);
+		std::vector<glm::vec3> normals(normalCount);
+		RunParallel(static_cast<int>(chunks.size()), threadCount,
+			[&chunks, &positions, &texCoords, &normals](int index)
+			{
+				OBJ_CHUNK& chunk = chunks[index];
+				std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionBase);
+				std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), texCoords.begin() + chunk.texCoordBase);
+				std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalBase);
+				std::vector<glm::vec3>().swap(chunk.positions);
+				std::vector<glm::vec2>().swap(chunk.texCoords);
+				std::vector<glm::vec3>().swap(chunk.normals);
+			});
+
+		RunParallel(static_cast<int>(chunks.size()), threadCount,
+			[&chunks, &positions, &texCoords, &normals](int index)
+			{
+				BuildObjChunkVertices(chunks[index], positions, texCoords, normals);
+			});
+
+		size_t vertexCount = 0;
+		size_t indexCount = 0;
+		for (OBJ_CHUNK& chunk : chunks)
+		{
+			chunk.vertexBase = vertexCount;
+			chunk.indexBase = indexCount;
+			vertexCount += chunk.vertices.size();
+			indexCount += chunk.indices.size();
+		}
+		if ((indexCount == 0) || (vertexCount > UINT32_MAX))
+		{
+			return(false);
+		}
+
+		mesh.vertices.resize(vertexCount);
+		mesh.indices.resize(indexCount);
+		RunParallel(static_cast<int>(chunks.size()), threadCount,
+			[&chunks, &mesh](int index)
+			{
+				const OBJ_CHUNK& chunk = chunks[index];
+				std::copy(chunk.vertices.begin(), chunk.vertices.end(), mesh.vertices.begin() + chunk.vertexBase);
+				uint32_t base = static_cast<uint32_t>(chunk.vertexBase);
+				for (size_t i = 0; i < chunk.indices.size(); i++)
+				{
+					mesh.indices[chunk.indexBase + i] = base + chunk.indices[i];
+				}
+			});
+
+		return(true);
+	}
+
+	///////////////////////////////////////////////////////////////////////
+	// glTF
+	///////////////////////////////////////////////////////////////////////
+
+	struct JSON_VALUE
+	{
+		enum JSON_TYPE
+		{
+			JSON_NULL,
+			JSON_BOOL,
+			JSON_NUMBER,
+			JSON_STRING,
+			JSON_ARRAY,
+			JSON_OBJECT
+		};
+
+		JSON_TYPE type = JSON_NULL;
+		double number = 0.0;
+		std::string text;
+		// elements of an array or the values of an object
+		std::vector<JSON_VALUE> items;
+		// names of the object values
+		std::vector<std::string> keys;
+	};
+
+	bool ParseJsonValue(const char*& p, const char* pEnd, JSON_VALUE& value, int depth);
+
+	/***********************************************************
+	 *  SkipJsonSpaces()
+	 *
+	 *  Move past the white space between JSON tokens.
+	 ***********************************************************/
+	void SkipJsonSpaces(const char*& p, const char* pEnd)
+	{
+		while ((p < pEnd) && ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n')))
+		{
+			p++;
+		}
+	}
+
+	/***********************************************************
+	 *  AppendUtf8()
+	 *
+	 *  Encode a code point of a \u escape as UTF-8.
+	 ***********************************************************/
+	void AppendUtf8(std::string& text, uint32_t code)
+	{
+		if (code < 0x80)
+		{
+			text += static_cast<char>(code);
+		}
+		else if (code < 0x800)
+		{
+			text += static_cast<char>(0xC0 | (code >> 6));
+			text += static_cast<char>(0x80 | (code & 0x3F));
+		}
+		else
+		{
+			text += static_cast<char>(0xE0 | (code >> 12));
+			text += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+			text += static_cast<char>(0x80 | (code & 0x3F));
+		}
+	}
+
+	/***********************************************************
+	 *  ParseJsonString()
+	 *
+	 *  Read a quoted string and resolve its escapes.
+	 ***********************************************************/
+	bool ParseJsonString(const char*& p, const char* pEnd, std::string& text)
+	{
+		if ((p >= pEnd) || (*p != '"'))
+		{
+			return(false);
+		}
+		p++;
+
+		text.clear();
+		while (p < pEnd)
+		{
+			char c = *p++;
+			if (c == '"')
+			{
+				return(true);
+			}
+			if (c != '\\')
+			{
+				text += c;
+				continue;
+			}
+			if (p >= pEnd)
+			{
+				return(false);
+			}
+
+			c = *p++;
+			switch (c)
+			{
+			case 'b': text += '\b'; break;
+			case 'f': text += '\f'; break;
+			case 'n': text += '\n'; break;
+			case 'r': text += '\r'; break;
+			case 't': text += '\t'; break;
+			case 'u':
+			{
+				if (pEnd - p < 4)
+				{
+					return(false);
+				}
+				uint32_t code = 0;
+				for (int i = 0; i < 4; i++)
+				{
+					char digit = *p++;
+					code <<= 4;
+					if ((digit >= '0') && (digit <= '9')) code |= digit - '0';
+					else if ((digit >= 'a') && (digit <= 'f')) code |= digit - 'a' + 10;
+					else if ((digit >= 'A') && (digit <= 'F')) code |= digit - 'A' + 10;
+					else return(false);
+				}
+				AppendUtf8(text, code);
+				break;
+			}
+			default: text += c; break;
+			}
+		}
+
+		return(false);
+	}
+
+	/***********************************************************
+	 *  ParseJsonValue()
+	 *
+	 *  Read one JSON value and everything nested inside it.
+	 ***********************************************************/
+	bool ParseJsonValue(const char*& p, const char* pEnd, JSON_VALUE& value, int depth)
+	{
+		if (depth > MAX_DEPTH)
+		{
+			return(false);
+		}
+
+		SkipJsonSpaces(p, pEnd);
+		if (p >= pEnd)
+		{
+			return(false);
+		}
+
+		if (*p == '{')
+		{
+			value.type = JSON_VALUE::JSON_OBJECT;
+			p++;
+			SkipJsonSpaces(p, pEnd);
+			if ((p < pEnd) && (*p == '}'))
+			{
+				p++;
+				return(true);
+			}
+			for (;;)
+			{
+				std::string key;
+				SkipJsonSpaces(p, pEnd);
+				if (!ParseJsonString(p, pEnd, key))
+				{
+					return(false);
+				}
+				SkipJsonSpaces(p, pEnd);
+				if ((p >= pEnd) || (*p != ':'))
+				{
+					return(false);
+				}
+				p++;
+				value.keys.push_back(key);
+				value.items.push_back(JSON_VALUE());
+				if (!ParseJsonValue(p, pEnd, value.items.back(), depth + 1))
+				{
+					return(false);
+				}
+				SkipJsonSpaces(p, pEnd);
+				if ((p < pEnd) && (*p == ','))
+				{
+					p++;
+					continue;
+				}
+				if ((p < pEnd) && (*p == '}'))
+				{
+					p++;
+					return(true);
+				}
+				return(false);
+			}
+		}
+
+		if (*p == '[')
+		{
+			value.type = JSON_VALUE::JSON_ARRAY;
+			p++;
+			SkipJsonSpaces(p, pEnd);
+			if ((p < pEnd) && (*p == ']'))
+			{
+				p++;
+				return(true);
+			}
+			for (;;)
+			{
+				value.items.push_back(JSON_VALUE());
+				if (!ParseJsonValue(p, pEnd, value.items.back(), depth + 1))
+				{
+					return(false);
+				}
+				SkipJsonSpaces(p, pEnd);
+				if ((p < pEnd) && (*p == ','))
+				{
+					p++;
+					continue;
+				}
+				if ((p < pEnd) && (*p == ']'))
+				{
+					p++;
+					return(true);
+				}
+				return(false);
+			}
+		}
+
+		if (*p == '"')
+		{
+			value.type = JSON_VALUE::JSON_STRING;
+			return(ParseJsonString(p, pEnd, value.text));
+		}
+
+		if ((pEnd - p >= 4) && (strncmp(p, "true", 4) == 0))
+		{
+			value.type = JSON_VALUE::JSON_BOOL;
+			value.number = 1.0;
+			p += 4;
+			return(true);
+		}
+		if ((pEnd - p >= 5) && (strncmp(p, "false", 5) == 0))
+		{
+			value.type = JSON_VALUE::JSON_BOOL;
+			p += 5;
+			return(true);
+		}
+		if ((pEnd - p >= 4) && (strncmp(p, "null", 4) == 0))
+		{
+			p += 4;
+			return(true);
+		}
+
+		if ((*p == '-') || ((*p >= '0') && (*p <= '9')))
+		{
+			value.type = JSON_VALUE::JSON_NUMBER;
+			value.number = ParseDouble(p, pEnd);
+			return(true);
+		}
+
+		return(false);
+	}
+
+	/***********************************************************
+	 *  FindMember()
+	 *
+	 *  Look up a value of a JSON object by its name.
+	 ***********************************************************/
+	const JSON_VALUE* FindMember(const JSON_VALUE* pObject, const char* key)
+	{
+		if ((NULL == pObject) || (pObject->type != JSON_VALUE::JSON_OBJECT))
+		{
+			return(NULL);
+		}
+		for (size_t i = 0; i < pObject->keys.size(); i++)
+		{
+			if (pObject->keys[i] == key)
+			{
+				return(&pObject->items[i]);
+			}
+		}
+		return(NULL);
+	}
+
+	/***********************************************************
+	 *  GetElement()
+	 *
+	 *  Get an element of a JSON array by its position.
+	 ***********************************************************/
+	const JSON_VALUE* GetElement(const JSON_VALUE* pArray, long long index)
+	{
+		if ((NULL == pArray) || (pArray->type != JSON_VALUE::JSON_ARRAY) ||
+			(index < 0) || (index >= static_cast<long long>(pArray->items.size())))
+		{
+			return(NULL);
+		}
+		return(&pArray->items[static_cast<size_t>(index)]);
+	}
+
+	/***********************************************************
+	 *  GetNumber()
+	 *
+	 *  Get a number member of a JSON object or the default.
+	 ***********************************************************/
+	double GetNumber(const JSON_VALUE* pObject, const char* key, double defaultValue)
+	{
+		const JSON_VALUE* pValue = FindMember(pObject, key);
+		if ((NULL == pValue) || (pValue->type != JSON_VALUE::JSON_NUMBER))
+		{
+			return(defaultValue);
+		}
+		return(pValue->number);
+	}
+
+	/***********************************************************
+	 *  GetCount()
+	 *
+	 *  Read a JSON number that is used as an index, a count or
+	 *  a byte size. It must be a whole number that is neither
+	 *  negative nor past the integers a double holds exactly.
+	 ***********************************************************/
+	bool GetCount(const JSON_VALUE* pValue, uint64_t& value)
+	{
+		if ((NULL == pValue) || (pValue->type != JSON_VALUE::JSON_NUMBER) ||
+			(pValue->number < 0.0) || (pValue->number > 9007199254740992.0) ||
+			(floor(pValue->number) != pValue->number))
+		{
+			return(false);
+		}
+		value = static_cast<uint64_t>(pValue->number);
+		return(true);
+	}
+
+	/***********************************************************
+	 *  GetCount()
+	 *
+	 *  Read a count member of a JSON object, or the default
+	 *  when the member is missing.
+	 ***********************************************************/
+	bool GetCount(const JSON_VALUE* pObject, const char* key, uint64_t defaultValue, uint64_t& value)
+	{
+		const JSON_VALUE* pValue = FindMember(pObject, key);
+		if (NULL == pValue)
+		{
+			value = defaultValue;
+			return(true);
+		}
+		return(GetCount(pValue, value));
+	}
+
+	// a buffer of a glTF file, inside the mapped .glb, a mapped
+	// .bin file or a decoded data URI
+	struct GLTF_BUFFER
+	{
+		const unsigned char* pData = NULL;
+		size_t size = 0;
+	};
+
+	struct GLTF_FILE
+	{
+		JSON_VALUE root;
+		std::vector<GLTF_BUFFER> buffers;
+		// storage of the external and embedded buffers
+		std::vector<std::unique_ptr<MappedFile>> mappedFiles;
+		std::vector<std::vector<unsigned char>> decodedBuffers;
+	};
+
+	// the elements of an accessor inside a buffer
+	struct GLTF_ACCESSOR
+	{
+		const unsigned char* pData = NULL;
+		size_t stride = 0;
+		uint32_t count = 0;
+		int componentType = 0;
+		int components = 0;
+		bool bNormalized = false;
+	};
+
+	/***********************************************************
+	 *  DecodeBase64()
+	 *
+	 *  Decode the base64 payload of a data URI.
+	 ***********************************************************/
+	void DecodeBase64(const std::string& text, size_t start, std::vector<unsigned char>& bytes)
+	{
+		uint32_t bits = 0;
+		int bitCount = 0;
+		for (size_t i = start; i < text.size(); i++)
+		{
+			char c = text[i];
+			int value = -1;
+			if ((c >= 'A') && (c <= 'Z')) value = c - 'A';
+			else if ((c >= 'a') && (c <= 'z')) value = c - 'a' + 26;
+			else if ((c >= '0') && (c <= '9')) value = c - '0' + 52;
+			else if (c == '+') value = 62;
+			else if (c == '/') value = 63;
+			else continue;
+
+			bits = (bits << 6) | static_cast<uint32_t>(value);
+			bitCount += 6;
+			if (bitCount >= 8)
+			{
+				bitCount -= 8;
+				bytes.push_back(static_cast<unsigned char>((bits >> bitCount) & 0xFF));
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  DecodeUri()
+	 *
+	 *  Resolve the percent escapes of a relative file URI.
+	 ***********************************************************/
+	std::string DecodeUri(const std::string& uri)
+	{
+		std::string path;
+		for (size_t i = 0; i < uri.size(); i++)
+		{
+			if ((uri[i] == '%') && (i + 2 < uri.size()))
+			{
+				path += static_cast<char>(strtol(uri.substr(i + 1, 2).c_str(), NULL, 16));
+				i += 2;
+			}
+			else
+			{
+				path += uri[i];
+			}
+		}
+		return(path);
+	}
+
+	/***********************************************************
+	 *  LoadGltfBuffers()
+	 *
+	 *  Find the bytes of every buffer the file lists. External
+	 *  buffers are mapped next to the model file.
+	 ***********************************************************/
+	bool LoadGltfBuffers(GLTF_FILE& gltf, const std::string& filename, const GLTF_BUFFER& binChunk)
+	{
+		std::string directory;
+		size_t slash = filename.find_last_of("/\\");
+		if (slash != std::string::npos)
+		{
+			directory = filename.substr(0, slash + 1);
+		}
+
+		const JSON_VALUE* pBuffers = FindMember(&gltf.root, "buffers");
+		if ((NULL == pBuffers) || (pBuffers->type != JSON_VALUE::JSON_ARRAY))
+		{
+			return(false);
+		}
+
+		for (const JSON_VALUE& buffer : pBuffers->items)
+		{
+			GLTF_BUFFER data;
+			const JSON_VALUE* pUri = FindMember(&buffer, "uri");
+			if ((NULL == pUri) || (pUri->type != JSON_VALUE::JSON_STRING))
+			{
+				// the first buffer of a .glb without a URI is its
+				// binary chunk
+				data = binChunk;
+			}
+			else if (pUri->text.compare(0, 5, "data:") == 0)
+			{
+				size_t comma = pUri->text.find(',');
+				if ((comma == std::string::npos) ||
+					(pUri->text.find(";base64") == std::string::npos))
+				{
+					return(false);
+				}
+				gltf.decodedBuffers.push_back(std::vector<unsigned char>());
+				DecodeBase64(pUri->text, comma + 1, gltf.decodedBuffers.back());
+				data.pData = gltf.decodedBuffers.back().data();
+				data.size = gltf.decodedBuffers.back().size();
+			}
+			else
+			{
+				std::unique_ptr<MappedFile> pFile(new MappedFile());
+				std::string path = directory + DecodeUri(pUri->text);
+				if (!pFile->Open(path.c_str()))
+				{
+					std::cout << "Could not open model buffer:" << path << std::endl;
+					return(false);
+				}
+				data.pData = pFile->GetData();
+				data.size = pFile->GetSize();
+				gltf.mappedFiles.push_back(std::move(pFile));
+			}
+
+			// the declared length must fit in what was found
+			double byteLength = GetNumber(&buffer, "byteLength", 0.0);
+			if ((NULL == data.pData) || (byteLength > static_cast<double>(data.size)))
+			{
+				return(false);
+			}
+			gltf.buffers.push_back(data);
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  GetAccessor()
+	 *
+	 *  Locate the elements of an accessor and check that they
+	 *  lie inside their buffer view. Sparse accessors are not
+	 *  supported.
+	 ***********************************************************/
+	bool GetAccessor(const GLTF_FILE& gltf, const JSON_VALUE* pIndex, GLTF_ACCESSOR& accessor)
+	{
+		uint64_t accessorIndex = 0;
+		if (!GetCount(pIndex, accessorIndex))
+		{
+			return(false);
+		}
+		const JSON_VALUE* pAccessor = GetElement(FindMember(&gltf.root, "accessors"), static_cast<long long>(accessorIndex));
+		if ((NULL == pAccessor) || (NULL != FindMember(pAccessor, "sparse")))
+		{
+			return(false);
+		}
+		uint64_t viewIndex = 0;
+		if (!GetCount(FindMember(pAccessor, "bufferView"), viewIndex))
+		{
+			return(false);
+		}
+		const JSON_VALUE* pView = GetElement(FindMember(&gltf.root, "bufferViews"), static_cast<long long>(viewIndex));
+		uint64_t bufferIndex = 0;
+		if ((NULL == pView) || !GetCount(FindMember(pView, "buffer"), bufferIndex) ||
+			(bufferIndex >= gltf.buffers.size()))
+		{
+			return(false);
+		}
+		const GLTF_BUFFER& buffer = gltf.buffers[static_cast<size_t>(bufferIndex)];
+
+		const JSON_VALUE* pType = FindMember(pAccessor, "type");
+		if (NULL == pType)
+		{
+			return(false);
+		}
+		accessor.components =
+			(pType->text == "SCALAR") ? 1 :
+			(pType->text == "VEC2") ? 2 :
+			(pType->text == "VEC3") ? 3 :
+			(pType->text == "VEC4") ? 4 : 0;
+		uint64_t componentType = 0;
+		if (!GetCount(pAccessor, "componentType", 0, componentType) || (componentType > INT_MAX))
+		{
+			return(false);
+		}
+		accessor.componentType = static_cast<int>(componentType);
+		size_t componentSize =
+			((accessor.componentType == GLTF_BYTE) || (accessor.componentType == GLTF_UNSIGNED_BYTE)) ? 1 :
+			((accessor.componentType == GLTF_SHORT) || (accessor.componentType == GLTF_UNSIGNED_SHORT)) ? 2 :
+			((accessor.componentType == GLTF_UNSIGNED_INT) || (accessor.componentType == GLTF_FLOAT)) ? 4 : 0;
+		if ((accessor.components == 0) || (componentSize == 0))
+		{
+			return(false);
+		}
+
+		// the sizes are checked in integer math, with each bound
+		// subtracted from the space left so nothing can overflow
+		uint64_t elementSize = componentSize * accessor.components;
+		uint64_t count = 0;
+		uint64_t viewOffset = 0;
+		uint64_t viewLength = 0;
+		uint64_t accessorOffset = 0;
+		uint64_t stride = 0;
+		if (!GetCount(pAccessor, "count", 0, count) ||
+			!GetCount(pView, "byteOffset", 0, viewOffset) ||
+			!GetCount(pView, "byteLength", 0, viewLength) ||
+			!GetCount(pAccessor, "byteOffset", 0, accessorOffset) ||
+			!GetCount(pView, "byteStride", elementSize, stride))
+		{
+			return(false);
+		}
+		if ((count < 1) || (count > UINT32_MAX) || (stride < elementSize) ||
+			(viewOffset > buffer.size) || (viewLength > buffer.size - viewOffset) ||
+			(accessorOffset > viewLength) || (elementSize > viewLength - accessorOffset) ||
+			(count - 1 > (viewLength - accessorOffset - elementSize) / stride))
+		{
+			return(false);
+		}
+
+		accessor.pData = buffer.pData + static_cast<size_t>(viewOffset) + static_cast<size_t>(accessorOffset);
+		accessor.stride = static_cast<size_t>(stride);
+		accessor.count = static_cast<uint32_t>(count);
+		const JSON_VALUE* pNormalized = FindMember(pAccessor, "normalized");
+		accessor.bNormalized = ((NULL != pNormalized) && (pNormalized->number != 0.0));
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ReadComponent()
+	 *
+	 *  Read one component of an accessor element as a float.
+	 ***********************************************************/
+	float ReadComponent(const GLTF_ACCESSOR& accessor, uint32_t element, int component)
+	{
+		const unsigned char* p = accessor.pData + accessor.stride * element;
+		switch (accessor.componentType)
+		{
+		case GLTF_FLOAT:
+		{
+			float value = 0.0f;
+			memcpy(&value, p + component * 4, 4);
+			return(value);
+		}
+		case GLTF_UNSIGNED_BYTE:
+		{
+			float value = static_cast<float>(p[component]);
+			return(accessor.bNormalized ? value / 255.0f : value);
+		}
+		case GLTF_BYTE:
+		{
+			float value = static_cast<float>(static_cast<int8_t>(p[component]));
+			return(accessor.bNormalized ? std::max(value / 127.0f, -1.0f) : value);
+		}
+		case GLTF_UNSIGNED_SHORT:
+		{
+			uint16_t raw = 0;
+			memcpy(&raw, p + component * 2, 2);
+			float value = static_cast<float>(raw);
+			return(accessor.bNormalized ? value / 65535.0f : value);
+		}
+		case GLTF_SHORT:
+		{
+			int16_t raw = 0;
+			memcpy(&raw, p + component * 2, 2);
+			float value = static_cast<float>(raw);
+			return(accessor.bNormalized ? std::max(value / 32767.0f, -1.0f) : value);
+		}
+		default:
+			return(0.0f);
+		}
+	}
+
+	/***********************************************************
+	 *  ReadIndex()
+	 *
+	 *  Read one element of an index accessor.
+	 ***********************************************************/
+	uint32_t ReadIndex(const GLTF_ACCESSOR& accessor, uint32_t element)
+	{
+		const unsigned char* p = accessor.pData + accessor.stride * element;
+		switch (accessor.componentType)
+		{
+		case GLTF_UNSIGNED_BYTE:
+			return(p[0]);
+		case GLTF_UNSIGNED_SHORT:
+		{
+			uint16_t value = 0;
+			memcpy(&value, p, 2);
+			return(value);
+		}
+		case GLTF_UNSIGNED_INT:
+		{
+			uint32_t value = 0;
+			memcpy(&value, p, 4);
+			return(value);
+		}
+		default:
+			return(0);
+		}
+	}
+
+	/***********************************************************
+	 *  GetNodeMatrix()
+	 *
+	 *  Get the local transform of a node from its matrix, or
+	 *  from its translation, rotation and scale.
+	 ***********************************************************/
+	glm::mat4 GetNodeMatrix(const JSON_VALUE& node)
+	{
+		glm::mat4 local(1.0f);
+
+		const JSON_VALUE* pMatrix = FindMember(&node, "matrix");
+		if ((NULL != pMatrix) && (pMatrix->items.size() == 16))
+		{
+			// stored column by column like glm
+			for (int column = 0; column < 4; column++)
+			{
+				for (int row = 0; row < 4; row++)
+				{
+					local[column][row] = static_cast<float>(pMatrix->items[column * 4 + row].number);
+				}
+			}
+			return(local);
+		}
+
+		float t[3] = { 0.0f, 0.0f, 0.0f };
+		float q[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		float s[3] = { 1.0f, 1.0f, 1.0f };
+		const JSON_VALUE* pTranslation = FindMember(&node, "translation");
+		const JSON_VALUE* pRotation = FindMember(&node, "rotation");
+		const JSON_VALUE* pScale = FindMember(&node, "scale");
+		for (int i = 0; i < 3; i++)
+		{
+			if ((NULL != pTranslation) && (pTranslation->items.size() == 3))
+			{
+				t[i] = static_cast<float>(pTranslation->items[i].number);
+			}
+			if ((NULL != pScale) && (pScale->items.size() == 3))
+			{
+				s[i] = static_cast<float>(pScale->items[i].number);
+			}
+		}
+		if ((NULL != pRotation) && (pRotation->items.size() == 4))
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				q[i] = static_cast<float>(pRotation->items[i].number);
+			}
+		}
+
+		// the rotation of the unit quaternion (x, y, z, w), with
+		// the scale applied to its columns
+		float x = q[0];
+		float y = q[1];
+		float z = q[2];
+		float w = q[3];
+		local[0] = glm::vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w), 0.0f) * s[0];
+		local[1] = glm::vec4(2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w), 0.0f) * s[1];
+		local[2] = glm::vec4(2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y), 0.0f) * s[2];
+		local[3] = glm::vec4(t[0], t[1], t[2], 1.0f);
+		return(local);
+	}
+
+	// one drawn mesh of the glTF scene with its world transform
+	struct GLTF_INSTANCE
+	{
+		const JSON_VALUE* pMesh;
+		glm::mat4 model;
+	};
+
+	/***********************************************************
+	 *  CollectNodeMeshes()
+	 *
+	 *  Walk a node and its children, collecting the meshes
+	 *  they place.
+	 ***********************************************************/
+	void CollectNodeMeshes(
+		const GLTF_FILE& gltf,
+		long long nodeIndex,
+		const glm::mat4& parent,
+		std::vector<GLTF_INSTANCE>& instances,
+		int depth)
+	{
+		const JSON_VALUE* pNode = GetElement(FindMember(&gltf.root, "nodes"), nodeIndex);
+		if ((NULL == pNode) || (depth > MAX_DEPTH))
+		{
+			return;
+		}
+
+		glm::mat4 world = parent * GetNodeMatrix(*pNode);
+		const JSON_VALUE* pMesh = GetElement(
+			FindMember(&gltf.root, "meshes"),
+			static_cast<long long>(GetNumber(pNode, "mesh", -1.0)));
+		if (NULL != pMesh)
+		{
+			GLTF_INSTANCE instance;
+			instance.pMesh = pMesh;
+			instance.model = world;
+			instances.push_back(instance);
+		}
+
+		const JSON_VALUE* pChildren = FindMember(pNode, "children");
+		if (NULL != pChildren)
+		{
+			for (const JSON_VALUE& child : pChildren->items)
+			{
+				CollectNodeMeshes(gltf, static_cast<long long>(child.number), world, instances, depth + 1);
+			}
+		}
+	}
+
+	// one triangle primitive placed in the output mesh
+	struct GLTF_PRIMITIVE
+	{
+		GLTF_ACCESSOR positions;
+		GLTF_ACCESSOR normals;
+		GLTF_ACCESSOR texCoords;
+		GLTF_ACCESSOR indices;
+		bool bHasNormals;
+		bool bHasTexCoords;
+		bool bHasIndices;
+		glm::mat4 model;
+		glm::mat3 normalMatrix;
+		bool bMirrored;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		size_t vertexBase;
+		size_t indexBase;
+	};
+
+	// a range of the vertices or triangles of a primitive
+	struct GLTF_TASK
+	{
+		size_t primitive;
+		bool bTriangles;
+		uint32_t begin;
+		uint32_t end;
+	};
+
+	/***********************************************************
+	 *  ConvertGltfVertices()
+	 *
+	 *  Transform a range of primitive vertices into the mesh.
+	 *  glTF puts the texture origin at the top of the image,
+	 *  and the textures here are flipped when loaded.
+	 ***********************************************************/
+	void ConvertGltfVertices(const GLTF_PRIMITIVE& primitive, uint32_t begin, uint32_t end, MESH_DATA& mesh)
+	{
+		for (uint32_t i = begin; i < end; i++)
+		{
+			MESH_VERTEX& vertex = mesh.vertices[primitive.vertexBase + i];
+			glm::vec3 position(
+				ReadComponent(primitive.positions, i, 0),
+				ReadComponent(primitive.positions, i, 1),
+				ReadComponent(primitive.positions, i, 2));
+			vertex.position = glm::vec3(primitive.model * glm::vec4(position, 1.0f));
+
+			vertex.normal = glm::vec3(0.0f);
+			if (primitive.bHasNormals)
+			{
+				glm::vec3 normal = primitive.normalMatrix * glm::vec3(
+					ReadComponent(primitive.normals, i, 0),
+					ReadComponent(primitive.normals, i, 1),
+					ReadComponent(primitive.normals, i, 2));
+				float length = glm::length(normal);
+				if (length > 0.0f)
+				{
+					vertex.normal = normal / length;
+				}
+			}
+
+			vertex.texCoord = glm::vec2(0.0f);
+			if (primitive.bHasTexCoords)
+			{
+				vertex.texCoord = glm::vec2(
+					ReadComponent(primitive.texCoords, i, 0),
+					1.0f - ReadComponent(primitive.texCoords, i, 1));
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  ConvertGltfTriangles()
+	 *
+	 *  Copy a range of primitive triangles into the mesh.
+	 *  Triangles with an index past the primitive collapse to
+	 *  its first vertex and draw nothing.
+	 ***********************************************************/
+	void ConvertGltfTriangles(const GLTF_PRIMITIVE& primitive, uint32_t begin, uint32_t end, MESH_DATA& mesh)
+	{
+		uint32_t base = static_cast<uint32_t>(primitive.vertexBase);
+		for (uint32_t t = begin; t < end; t++)
+		{
+			uint32_t corners[3];
+			bool bValid = true;
+			for (int c = 0; c < 3; c++)
+			{
+				uint32_t element = t * 3 + c;
+				corners[c] = (primitive.bHasIndices ? ReadIndex(primitive.indices, element) : element);
+				bValid = (bValid && (corners[c] < primitive.vertexCount));
+			}
+			if (!bValid)
+			{
+				corners[0] = corners[1] = corners[2] = 0;
+			}
+			if (primitive.bMirrored)
+			{
+				std::swap(corners[1], corners[2]);
+			}
+
+			uint32_t* pTarget = &mesh.indices[primitive.indexBase + t * 3];
+			pTarget[0] = base + corners[0];
+			pTarget[1] = base + corners[1];
+			pTarget[2] = base + corners[2];
+		}
+	}
+
+	/***********************************************************
+	 *  ReadGlbChunks()
+	 *
+	 *  Find the JSON and binary chunks of a .glb container.
+	 ***********************************************************/
+	bool ReadGlbChunks(const MappedFile& file, const char*& pJson, const char*& pJsonEnd, GLTF_BUFFER& binChunk)
+	{
+		const unsigned char* pData = file.GetData();
+		size_t size = file.GetSize();
+		uint32_t header[3];
+		if (size < sizeof(header))
+		{
+			return(false);
+		}
+		memcpy(header, pData, sizeof(header));
+		if ((header[0] != GLB_MAGIC) || (header[1] != 2) || (header[2] > size))
+		{
+			return(false);
+		}
+
+		pJson = NULL;
+		size_t offset = sizeof(header);
+		while (offset + 8 <= header[2])
+		{
+			uint32_t chunk[2];
+			memcpy(chunk, pData + offset, sizeof(chunk));
+			offset += sizeof(chunk);
+			if (chunk[0] > header[2] - offset)
+			{
+				return(false);
+			}
+			if ((chunk[1] == GLB_CHUNK_JSON) && (NULL == pJson))
+			{
+				pJson = reinterpret_cast<const char*>(pData + offset);
+				pJsonEnd = pJson + chunk[0];
+			}
+			else if ((chunk[1] == GLB_CHUNK_BIN) && (NULL == binChunk.pData))
+			{
+				binChunk.pData = pData + offset;
+				binChunk.size = chunk[0];
+			}
+			offset += (chunk[0] + 3) & ~3u;
+		}
+
+		return(NULL != pJson);
+	}
+
+	/***********************************************************
+	 *  ImportGltf()
+	 *
+	 *  Read the scene description, size the mesh for all the
+	 *  triangle primitives the scene places and convert them
+	 *  in ranges on all threads.
+	 ***********************************************************/
+	bool ImportGltf(const MappedFile& file, const std::string& filename, MESH_DATA& mesh, int threadCount)
+	{
+		const char* pJson = reinterpret_cast<const char*>(file.GetData());
+		const char* pJsonEnd = pJson + file.GetSize();
+		GLTF_BUFFER binChunk;
+		if ((file.GetSize() >= 4) && (memcmp(file.GetData(), "glTF", 4) == 0))
+		{
+			if (!ReadGlbChunks(file, pJson, pJsonEnd, binChunk))
+			{
+				return(false);
+			}
+		}
+
+		GLTF_FILE gltf;
+		if ((!ParseJsonValue(pJson, pJsonEnd, gltf.root, 0)) ||
+			(gltf.root.type != JSON_VALUE::JSON_OBJECT) ||
+			(!LoadGltfBuffers(gltf, filename, binChunk)))
+		{
+			return(false);
+		}
+
+		// the meshes placed by the default scene, or every mesh
+		// once when the file has no scenes
+		std::vector<GLTF_INSTANCE> instances;
+		const JSON_VALUE* pScene = GetElement(
+			FindMember(&gltf.root, "scenes"),
+			static_cast<long long>(GetNumber(&gltf.root, "scene", 0.0)));
+		if (NULL != pScene)
+		{
+			const JSON_VALUE* pNodes = FindMember(pScene, "nodes");
+			if (NULL != pNodes)
+			{
+				for (const JSON_VALUE& node : pNodes->items)
+				{
+					CollectNodeMeshes(gltf, static_cast<long long>(node.number), glm::mat4(1.0f), instances, 0);
+				}
+			}
+		}
+		else
+		{
+			const JSON_VALUE* pMeshes = FindMember(&gltf.root, "meshes");
+			if (NULL != pMeshes)
+			{
+				for (const JSON_VALUE& meshValue : pMeshes->items)
+				{
+					GLTF_INSTANCE instance;
+					instance.pMesh = &meshValue;
+					instance.model = glm::mat4(1.0f);
+					instances.push_back(instance);
+				}
+			}
+		}
+
+		std::vector<GLTF_PRIMITIVE> primitives;
+		size_t vertexCount = 0;
+		size_t indexCount = 0;
+		int skipped = 0;
+		for (const GLTF_INSTANCE& instance : instances)
+		{
+			const JSON_VALUE* pPrimitives = FindMember(instance.pMesh, "primitives");
+			if (NULL == pPrimitives)
+			{
+				continue;
+			}
+			for (const JSON_VALUE& value : pPrimitives->items)
+			{
+				GLTF_PRIMITIVE primitive;
+				const JSON_VALUE* pAttributes = FindMember(&value, "attributes");
+				if ((static_cast<int>(GetNumber(&value, "mode", GLTF_TRIANGLES)) != GLTF_TRIANGLES) ||
+					(!GetAccessor(gltf, FindMember(pAttributes, "POSITION"), primitive.positions)) ||
+					(primitive.positions.components != 3) ||
+					(primitive.positions.componentType != GLTF_FLOAT))
+				{
+					skipped++;
+					continue;
+				}
+				primitive.bHasNormals =
+					(GetAccessor(gltf, FindMember(pAttributes, "NORMAL"), primitive.normals)) &&
+					(primitive.normals.components == 3) &&
+					(primitive.normals.count >= primitive.positions.count);
+				primitive.bHasTexCoords =
+					(GetAccessor(gltf, FindMember(pAttributes, "TEXCOORD_0"), primitive.texCoords)) &&
+					(primitive.texCoords.components == 2) &&
+					(primitive.texCoords.count >= primitive.positions.count);
+				primitive.bHasIndices = (NULL != FindMember(&value, "indices"));
+				if ((primitive.bHasIndices) &&
+					((!GetAccessor(gltf, FindMember(&value, "indices"), primitive.indices)) ||
+						(primitive.indices.components != 1)))
+				{
+					skipped++;
+					continue;
+				}
+
+				primitive.model = instance.model;
+				primitive.normalMatrix = glm::transpose(glm::inverse(glm::mat3(instance.model)));
+				primitive.bMirrored = (glm::determinant(glm::mat3(instance.model)) < 0.0f);
+				primitive.vertexCount = primitive.positions.count;
+				primitive.indexCount = ((primitive.bHasIndices ? primitive.indices.count : primitive.vertexCount) / 3) * 3;
+				primitive.vertexBase = vertexCount;
+				primitive.indexBase = indexCount;
+				vertexCount += primitive.vertexCount;
+				indexCount += primitive.indexCount;
+				primitives.push_back(primitive);
+			}
+		}
+		if (skipped > 0)
+		{
+			std::cout << "Skipped " << skipped << " model primitives that are not plain triangle lists" << std::endl;
+		}
+		if ((indexCount == 0) || (vertexCount > UINT32_MAX))
+		{
+			return(false);
+		}
+
+		std::vector<GLTF_TASK> tasks;
+		for (size_t i = 0; i < primitives.size(); i++)
+		{
+			uint32_t triangleCount = primitives[i].indexCount / 3;
+			for (uint32_t begin = 0; begin < primitives[i].vertexCount; begin += GLTF_TASK_SIZE)
+			{
+				GLTF_TASK task = { i, false, begin, std::min(primitives[i].vertexCount, begin + GLTF_TASK_SIZE) };
+				tasks.push_back(task);
+			}
+			for (uint32_t begin = 0; begin < triangleCount; begin += GLTF_TASK_SIZE)
+			{
+				GLTF_TASK task = { i, true, begin, std::min(triangleCount, begin + GLTF_TASK_SIZE) };
+				tasks.push_back(task);
+			}
+		}
+
+		mesh.vertices.resize(vertexCount);
+		mesh.indices.resize(indexCount);
+		RunParallel(static_cast<int>(tasks.size()), threadCount,
+			[&tasks, &primitives, &mesh](int index)
+			{
+				const GLTF_TASK& task = tasks[index];
+				if (task.bTriangles)
+				{
+					ConvertGltfTriangles(primitives[task.primitive], task.begin, task.end, mesh);
+				}
+				else
+				{
+					ConvertGltfVertices(primitives[task.primitive], task.begin, task.end, mesh);
+				}
+			});
+
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  ImportModel()
+ *
+ *  This function is used for reading a model file into a
+ *  mesh. The format is chosen by the file extension, and
+ *  normals the file does not provide are computed from the
+ *  faces.
+ ***********************************************************/
+bool ImportModel(const char* filename, MESH_DATA& mesh, int threadCount)
+{
+	auto startTime = std::chrono::steady_clock::now();
+
+	mesh.vertices.clear();
+	mesh.indices.clear();
+	mesh.lightmapUVs.clear();
+
+	MappedFile file;
+	if (!file.Open(filename))
+	{
+		std::cout << "Could not open model:" << filename << std::endl;
+		return(false);
+	}
+
+	if (threadCount <= 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	bool bImported = false;
+	std::string name(filename);
+	if (HasExtension(name, ".obj"))
+	{
+		bImported = ImportObj(file, mesh, threadCount);
+	}
+	else if ((HasExtension(name, ".gltf")) || (HasExtension(name, ".glb")))
+	{
+		bImported = ImportGltf(file, name, mesh, threadCount);
+	}
+
+	if (!bImported)
+	{
+		std::cout << "Could not import model:" << filename << std::endl;
+		mesh.vertices.clear();
+		mesh.indices.clear();
+		return(false);
+	}
+
+	ComputeMissingNormals(mesh);
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+	std::cout << "Imported model:" << filename << ", vertices:" << mesh.vertices.size()
+		<< ", triangles:" << (mesh.indices.size() / 3) << ", seconds:" << elapsed.count()
+		<< ", threads:" << threadCount << std::endl;
+
+	return(true);
+}
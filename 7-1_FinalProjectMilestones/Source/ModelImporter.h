@@ -0,0 +1,21 @@
+///////////////////////////////////////////////////////////////////////////////
+// modelimporter.h
+// ============
+// import triangle meshes from OBJ and glTF 2.0 model files
+//
+// The files are mapped into memory and parsed in place. An OBJ file is split
+// at line breaks into chunks that worker threads parse at the same time, and
+// the vertices of the chunks are joined at the end. A glTF file is read from
+// its JSON description, then the vertex and index data of its primitives is
+// converted in parallel ranges straight out of the binary buffers, with the
+// node transforms of the scene applied. Both produce the MESH_VERTEX layout
+// of the basic shapes, so an imported model is drawn like any other shape.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshBuilder.h"
+
+// read a .obj, .gltf or .glb file into the mesh, which gets no lightmap
+// UVs, using all CPU cores when the thread count is zero
+bool ImportModel(const char* filename, MESH_DATA& mesh, int threadCount = 0);
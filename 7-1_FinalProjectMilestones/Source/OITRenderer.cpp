@@ -0,0 +1,250 @@
+///////////////////////////////////////////////////////////////////////////////
+// oitrenderer.cpp
+// ============
+// weighted blended order-independent transparency
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OITRenderer.h"
+#include "ShaderCache.h"
+#include "GLStateCache.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_CompositeVertexShaderFile = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/screenVertexShader.glsl";
+	const char* g_CompositeFragmentShaderFile = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/oitCompositeShader.glsl";
+
+	// the composite runs after the G-buffer has been used, so it
+	// can share its texture slots
+	const int ACCUM_TEXTURE_UNIT = 10;
+	const int REVEAL_TEXTURE_UNIT = 11;
+}
+
+/***********************************************************
+ *  OITRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+OITRenderer::OITRenderer()
+{
+	m_pCompositeShader = NULL;
+	m_frameBuffer = 0;
+	m_accumTexture = 0;
+	m_revealTexture = 0;
+	m_depthTexture = 0;
+	m_width = 0;
+	m_height = 0;
+	m_screenVAO = 0;
+	m_sceneFrameBuffer = 0;
+}
+
+/***********************************************************
+ *  ~OITRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+OITRenderer::~OITRenderer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the composite shader.
+ ***********************************************************/
+bool OITRenderer::Initialize()
+{
+	m_pCompositeShader = new ShaderManager();
+	m_pCompositeShader->m_programID = LoadShaderProgram(g_CompositeVertexShaderFile, g_CompositeFragmentShaderFile);
+	if (m_pCompositeShader->m_programID == 0)
+	{
+		std::cout << "Could not load the transparency composite shaders" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	g_GLState.UseProgram(m_pCompositeShader->m_programID);
+	m_pCompositeShader->setSampler2DValue("accumTexture", ACCUM_TEXTURE_UNIT);
+	m_pCompositeShader->setSampler2DValue("revealTexture", REVEAL_TEXTURE_UNIT);
+
+	glGenVertexArrays(1, &m_screenVAO);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the shader and targets.
+ ***********************************************************/
+void OITRenderer::Destroy()
+{
+	DestroyTargets();
+	if (m_screenVAO != 0)
+	{
+		g_GLState.DeleteVertexArray(m_screenVAO);
+		m_screenVAO = 0;
+	}
+	if (NULL != m_pCompositeShader)
+	{
+		glDeleteProgram(m_pCompositeShader->m_programID);
+		m_pCompositeShader->m_programID = 0;
+		delete m_pCompositeShader;
+		m_pCompositeShader = NULL;
+	}
+}
+
+/***********************************************************
+ *  CreateTargets()
+ *
+ *  This method is used for creating the accumulation,
+ *  revealage and depth textures. The depth format matches
+ *  the default framebuffer so that its depth can be copied.
+ ***********************************************************/
+bool OITRenderer::CreateTargets(int width, int height)
+{
+	DestroyTargets();
+
+	GLuint textures[3];
+	glGenTextures(3, textures);
+	m_accumTexture = textures[0];
+	m_revealTexture = textures[1];
+	m_depthTexture = textures[2];
+
+	const GLint internalFormats[3] = { GL_RGBA16F, GL_R16F, GL_DEPTH24_STENCIL8 };
+	const GLenum formats[3] = { GL_RGBA, GL_RED, GL_DEPTH_STENCIL };
+	const GLenum types[3] = { GL_FLOAT, GL_FLOAT, GL_UNSIGNED_INT_24_8 };
+	for (int i = 0; i < 3; i++)
+	{
+		g_GLState.BindTexture(GLStateCache::UPLOAD_TEXTURE_UNIT, GL_TEXTURE_2D, textures[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormats[i], width, height, 0, formats[i], types[i], NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+
+	glGenFramebuffers(1, &m_frameBuffer);
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_accumTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_revealTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_depthTexture, 0);
+
+	GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, drawBuffers);
+
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (!bComplete)
+	{
+		std::cout << "The transparency framebuffer is not complete" << std::endl;
+		DestroyTargets();
+		return(false);
+	}
+
+	m_width = width;
+	m_height = height;
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyTargets()
+ *
+ *  This method is used for freeing the target textures.
+ ***********************************************************/
+void OITRenderer::DestroyTargets()
+{
+	if (m_frameBuffer != 0)
+	{
+		g_GLState.DeleteFramebuffer(m_frameBuffer);
+		m_frameBuffer = 0;
+	}
+
+	GLuint textures[3] = { m_accumTexture, m_revealTexture, m_depthTexture };
+	for (int i = 0; i < 3; i++)
+	{
+		if (textures[i] != 0)
+		{
+			g_GLState.DeleteTextures(1, &textures[i]);
+		}
+	}
+	m_accumTexture = 0;
+	m_revealTexture = 0;
+	m_depthTexture = 0;
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  BeginTransparentPass()
+ *
+ *  This method is used for preparing the targets for the
+ *  transparent objects. The accumulation adds up and the
+ *  revealage is multiplied by one minus each alpha, so the
+ *  order of the objects does not matter. Returns false if
+ *  the targets could not be created.
+ ***********************************************************/
+bool OITRenderer::BeginTransparentPass()
+{
+	GLint viewport[4];
+	g_GLState.GetViewport(viewport);
+	if ((viewport[2] != m_width) || (viewport[3] != m_height))
+	{
+		if (!CreateTargets(viewport[2], viewport[3]))
+		{
+			return(false);
+		}
+	}
+
+	// bring over the depth of the opaque scene, which may be
+	// drawn into an offscreen target
+	m_sceneFrameBuffer = g_GLState.GetDrawFramebuffer();
+	g_GLState.BindFramebuffer(GL_READ_FRAMEBUFFER, m_sceneFrameBuffer);
+	g_GLState.BindFramebuffer(GL_DRAW_FRAMEBUFFER, m_frameBuffer);
+	glBlitFramebuffer(
+		0, 0, m_width, m_height,
+		0, 0, m_width, m_height,
+		GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+
+	const GLfloat clearAccum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const GLfloat clearReveal[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	glClearBufferfv(GL_COLOR, 0, clearAccum);
+	glClearBufferfv(GL_COLOR, 1, clearReveal);
+
+	g_GLState.Enable(GL_DEPTH_TEST);
+	g_GLState.DepthMask(GL_FALSE);
+	g_GLState.Enable(GL_BLEND);
+	g_GLState.BlendFunci(0, GL_ONE, GL_ONE);
+	g_GLState.BlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Composite()
+ *
+ *  This method is used for blending the averaged color of
+ *  the transparent objects over the scene framebuffer.
+ ***********************************************************/
+void OITRenderer::Composite()
+{
+	g_GLState.BindFramebuffer(GL_FRAMEBUFFER, m_sceneFrameBuffer);
+	g_GLState.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	g_GLState.Disable(GL_DEPTH_TEST);
+
+	g_GLState.UseProgram(m_pCompositeShader->m_programID);
+	g_GLState.BindTexture(ACCUM_TEXTURE_UNIT, GL_TEXTURE_2D, m_accumTexture);
+	g_GLState.BindTexture(REVEAL_TEXTURE_UNIT, GL_TEXTURE_2D, m_revealTexture);
+
+	g_GLState.BindVertexArray(m_screenVAO);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	g_GLState.Enable(GL_DEPTH_TEST);
+	g_GLState.DepthMask(GL_TRUE);
+}
@@ -0,0 +1,57 @@
+///////////////////////////////////////////////////////////////////////////////
+// oitrenderer.h
+// ============
+// weighted blended order-independent transparency
+//
+// Transparent objects are drawn in any order into an accumulation target,
+// which sums their weighted premultiplied colors, and a revealage target,
+// which multiplies their transparencies. A full-screen composite pass then
+// blends the averaged color over the opaque scene. The depth of the scene
+// is copied in first so that transparent fragments behind opaque objects
+// are still rejected.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+#include <GL/glew.h>
+
+class OITRenderer
+{
+public:
+	// constructor
+	OITRenderer();
+	// destructor
+	~OITRenderer();
+
+	// load the composite shader
+	bool Initialize();
+	// free all OpenGL resources
+	void Destroy();
+
+	// bind and clear the targets, sized to the current viewport,
+	// and set the blending used while drawing transparent objects
+	bool BeginTransparentPass();
+	// blend the resolved transparency over the framebuffer that was
+	// bound before the pass, which leaves the composite shader active
+	void Composite();
+
+private:
+	ShaderManager* m_pCompositeShader;
+
+	GLuint m_frameBuffer;
+	GLuint m_accumTexture;
+	GLuint m_revealTexture;
+	// copy of the scene depth for testing against opaque objects
+	GLuint m_depthTexture;
+	int m_width;
+	int m_height;
+	// empty vertex array for the full-screen triangle
+	GLuint m_screenVAO;
+	// framebuffer holding the opaque scene
+	GLuint m_sceneFrameBuffer;
+
+	bool CreateTargets(int width, int height);
+	void DestroyTargets();
+};
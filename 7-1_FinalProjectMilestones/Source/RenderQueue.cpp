@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.cpp
+// ============
+// collect the objects of a render pass and sort them into draw order
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderQueue.h"
+
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	const int RADIX_BITS = 8;
+	const int RADIX_BUCKETS = 1 << RADIX_BITS;
+	const int RADIX_PASSES = 32 / RADIX_BITS;
+
+	/***********************************************************
+	 *  FloatToSortKey()
+	 *
+	 *  Map a float onto an unsigned integer with the same
+	 *  order, so that negative distances sort before positive.
+	 ***********************************************************/
+	uint32_t FloatToSortKey(float value)
+	{
+		uint32_t bits = 0;
+		memcpy(&bits, &value, sizeof(bits));
+		if (bits & 0x80000000u)
+		{
+			return(~bits);
+		}
+		return(bits | 0x80000000u);
+	}
+}
+
+/***********************************************************
+ *  RenderQueue()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderQueue::RenderQueue()
+{
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing the queued objects
+ *  while keeping the memory for the next frame.
+ ***********************************************************/
+void RenderQueue::Clear()
+{
+	m_items.clear();
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  This method is used for queueing an object.
+ ***********************************************************/
+void RenderQueue::Add(uint32_t objectIndex, float viewDistance)
+{
+	DRAW_ITEM item;
+	item.sortKey = FloatToSortKey(viewDistance);
+	item.objectIndex = objectIndex;
+	m_items.push_back(item);
+}
+
+/***********************************************************
+ *  Sort()
+ *
+ *  This method is used for sorting the queued objects with
+ *  a radix sort on the key, eight bits per pass. Passes
+ *  where every key has the same digit are skipped. Back to
+ *  front order sorts the inverted keys.
+ ***********************************************************/
+void RenderQueue::Sort(SORT_ORDER order)
+{
+	size_t count = m_items.size();
+	if (count < 2)
+	{
+		return;
+	}
+
+	if (order == SORT_BACK_TO_FRONT)
+	{
+		for (DRAW_ITEM& item : m_items)
+		{
+			item.sortKey = ~item.sortKey;
+		}
+	}
+
+	m_scratch.resize(count);
+	for (int pass = 0; pass < RADIX_PASSES; pass++)
+	{
+		int shift = pass * RADIX_BITS;
+
+		size_t offsets[RADIX_BUCKETS] = { 0 };
+		for (const DRAW_ITEM& item : m_items)
+		{
+			offsets[(item.sortKey >> shift) & (RADIX_BUCKETS - 1)]++;
+		}
+
+		// all keys share this digit, the order stays the same
+		if (offsets[(m_items[0].sortKey >> shift) & (RADIX_BUCKETS - 1)] == count)
+		{
+			continue;
+		}
+
+		size_t total = 0;
+		for (int bucket = 0; bucket < RADIX_BUCKETS; bucket++)
+		{
+			size_t bucketCount = offsets[bucket];
+			offsets[bucket] = total;
+			total += bucketCount;
+		}
+
+		for (const DRAW_ITEM& item : m_items)
+		{
+			m_scratch[offsets[(item.sortKey >> shift) & (RADIX_BUCKETS - 1)]++] = item;
+		}
+		m_items.swap(m_scratch);
+	}
+}
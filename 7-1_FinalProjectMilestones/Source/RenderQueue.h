@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.h
+// ============
+// collect the objects of a render pass and sort them into draw order
+//
+// Every queued object carries a 32-bit sort key built from its distance to
+// the camera. The keys are ordered with a stable least-significant-digit
+// radix sort, which costs the same few passes over the list no matter how
+// the objects were ordered in the previous frame.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// one object to be drawn in a pass
+struct DRAW_ITEM
+{
+	uint32_t sortKey;
+	uint32_t objectIndex;
+};
+
+class RenderQueue
+{
+public:
+	// order in which the distances are sorted
+	enum SORT_ORDER
+	{
+		SORT_FRONT_TO_BACK,
+		SORT_BACK_TO_FRONT
+	};
+
+	// constructor
+	RenderQueue();
+
+	void Clear();
+	// queue an object at its distance along the view direction
+	void Add(uint32_t objectIndex, float viewDistance);
+	// sort the queued objects into the requested order
+	void Sort(SORT_ORDER order);
+
+	const std::vector<DRAW_ITEM>& GetItems() const { return m_items; }
+	bool IsEmpty() const { return m_items.empty(); }
+
+private:
+	std::vector<DRAW_ITEM> m_items;
+	// second buffer the radix passes scatter into
+	std::vector<DRAW_ITEM> m_scratch;
+};
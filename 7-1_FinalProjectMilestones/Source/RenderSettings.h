@@ -0,0 +1,91 @@
+///////////////////////////////////////////////////////////////////////////////
+// rendersettings.h
+// ============
+// runtime rendering switches shared by the main loop, view and scene
+//
+// The settings start from their defaults, can be changed on the command
+// line at launch and are toggled with keys while the program is running.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+struct RENDER_SETTINGS
+{
+	// draw the static objects with their baked lightmaps
+	// instead of evaluating the scene lights per fragment
+	bool bUseBakedLighting = false;
+	// light the ambient term from the baked irradiance probes
+	bool bUseProbeLighting = false;
+	// light the opaque objects from a G-buffer instead of
+	// while they are drawn
+	bool bUseDeferredShading = false;
+	// draw with shader variants compiled for the features of
+	// each object instead of branching on uniforms
+	bool bUseShaderPermutations = true;
+	// blend the transparent objects with weighted blended
+	// order-independent transparency instead of sorting them
+	bool bUseOIT = false;
+	// write the per-object values into a persistently mapped
+	// buffer instead of setting them as uniforms
+	bool bUseUploadRing = true;
+	// draw the round shapes with fewer triangles as they cover
+	// less of the screen
+	bool bUseLod = true;
+	// store the meshes in the 16-byte quantized vertex layout
+	// instead of 32 bytes of floats
+	bool bUseCompactVertices = true;
+	// draw the opaque static objects from merged buffers that
+	// already hold their world positions
+	bool bUseStaticBatching = true;
+	// draw only the clusters of the large models that are in
+	// view and face the camera
+	bool bUseMeshletCulling = true;
+	// cull the opaque objects in a compute shader that writes
+	// their draws for one indirect call per mesh
+	bool bUseGPUCulling = false;
+	// skip the objects hidden behind the walls and other large
+	// opaque objects
+	bool bUseOcclusionCulling = true;
+	// lower the render resolution when the GPU time of a frame
+	// exceeds the budget and stretch the result over the window
+	bool bUseDynamicResolution = false;
+	float frameBudgetMs = 16.6f;
+
+	// 1 waits for the display refresh, 0 does not wait and -1
+	// only tears when a frame misses the refresh
+	int swapInterval = 1;
+	// highest presented frame rate, zero for no limit
+	float targetFps = 0.0f;
+	// only draw a new frame when something visible changed,
+	// and sleep until the next window event otherwise
+	bool bRenderOnDemand = false;
+
+	// number of frames measured for each render path by the
+	// benchmark mode, zero runs normally
+	int benchmarkFrames = 0;
+	// look at a wall of the room for a few frames, report
+	// whether the garden behind it was culled and exit
+	bool bCheckOcclusion = false;
+	// about this many objects in a generated grid of desks
+	// instead of the desk scene, zero draws the desk scene
+	int stressObjects = 0;
+	// lamp lights of the generated desks, the nearest ones
+	// first, -1 lights every desk
+	int stressLights = -1;
+	// start of the random numbers of the generated desks
+	unsigned int stressSeed = 1;
+};
+
+// reasons a frame is drawn in render on demand mode, used as
+// bit positions of a mask
+enum REDRAW_REASON
+{
+	REDRAW_STARTUP,
+	REDRAW_CAMERA,
+	REDRAW_SETTINGS,
+	REDRAW_WINDOW,
+	REDRAW_REASON_COUNT
+};
+
+// the settings object is defined in MainCode.cpp
+extern RENDER_SETTINGS g_RenderSettings;
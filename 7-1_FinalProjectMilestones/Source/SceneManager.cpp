@@ -1,952 +1,3187 @@
-///////////////////////////////////////////////////////////////////////////////
-// shadermanager.cpp
-// ============
-// manage the loading and rendering of 3D scenes
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include "SceneManager.h"
-
-#ifndef STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-#endif
-
-#include <glm/gtx/transform.hpp>
-
-// declaration of global variables
-namespace
-{
-	const char* g_ModelName = "model";
-	const char* g_ColorValueName = "objectColor";
-	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
-	const char* g_UseLightingName = "bUseLighting";
-}
-
-/***********************************************************
- *  SceneManager()
- *
- *  The constructor for the class
- ***********************************************************/
-SceneManager::SceneManager(ShaderManager *pShaderManager)
-{
-	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
-}
-
-/***********************************************************
- *  ~SceneManager()
- *
- *  The destructor for the class
- ***********************************************************/
-SceneManager::~SceneManager()
-{
-	m_pShaderManager = NULL;
-	delete m_basicMeshes;
-	m_basicMeshes = NULL;
-}
-
-/***********************************************************
- *  CreateGLTexture()
- *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
- ***********************************************************/
-bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
-{
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
-
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
-
-		return true;
-	}
-
-	std::cout << "Could not load image:" << filename << std::endl;
-
-	// Error loading the image
-	return false;
-}
-
-/***********************************************************
- *  BindGLTextures()
- *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
- ***********************************************************/
-void SceneManager::BindGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  DestroyGLTextures()
- *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
- ***********************************************************/
-void SceneManager::DestroyGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		glGenTextures(1, &m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  FindTextureID()
- *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
-{
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureID);
-}
-
-/***********************************************************
- *  FindTextureSlot()
- *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
-{
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureSlot = index;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureSlot);
-}
-
-/***********************************************************
- *  FindMaterial()
- *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
- ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
-{
-	if (m_objectMaterials.size() == 0)
-	{
-		return(false);
-	}
-
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
-	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.ambientColor = m_objectMaterials[index].ambientColor;
-			material.ambientStrength = m_objectMaterials[index].ambientStrength;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
-		}
-	}
-
-	return(true);
-}
-
-/***********************************************************
- *  SetTransformations()
- *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
- ***********************************************************/
-void SceneManager::SetTransformations(
-	glm::vec3 scaleXYZ,
-	float XrotationDegrees,
-	float YrotationDegrees,
-	float ZrotationDegrees,
-	glm::vec3 positionXYZ)
-{
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
-	}
-}
-
-/***********************************************************
- *  SetShaderColor()
- *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
- ***********************************************************/
-void SceneManager::SetShaderColor(float r, float g, float b, float a)
-{
-    if (m_pShaderManager)
-    {
-        m_pShaderManager->setBoolValue("bUseTexture", false);   // was setIntValue(...)
-        m_pShaderManager->setVec4Value("objectColor", r, g, b, a); // was setVec4Value(...)
-    }
-}
-
-
-/***********************************************************
- *  SetShaderTexture()
- *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
- ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
-	}
-}
-
-/***********************************************************
- *  SetTextureUVScale()
- *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
- ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
-}
-
-/***********************************************************
- *  SetShaderMaterial()
- *
- *  This method is used for passing the material values
- *  into the shader.
- ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
-{
-	if (m_objectMaterials.size() > 0)
-	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
-
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
-	}
-}
-
-/**************************************************************/
-/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
-/*** preparing and rendering their own 3D replicated scenes.***/
-/*** Please refer to the code in the OpenGL sample project  ***/
-/*** for assistance.                                        ***/
-/**************************************************************/
-
-/***********************************************************
-  *  LoadSceneTextures()
-  *
-  *  This method is used for preparing the 3D scene by loading
-  *  the shapes, textures in memory to support the 3D scene
-  *  rendering
-  ***********************************************************/
-void SceneManager::LoadSceneTextures()
-{
-	/*** STUDENTS - add the code BELOW for loading the textures that ***/
-	/*** will be used for mapping to objects in the 3D scene. Up to  ***/
-	/*** 16 textures can be loaded per scene. Refer to the code in   ***/
-	/*** the OpenGL Sample for help.                                 ***/
-
-	bool bReturn = false;
-
-	// Keyboard
-	bReturn = CreateGLTexture(
-		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/keyboard_black.jpg", "keyboard"
-	);
-
-	// Background 1
-	bReturn = CreateGLTexture(
-		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/background.jpg", "screen"
-	);
-
-	// Background 2
-	bReturn = CreateGLTexture(
-		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/Background-1.jpg", "screen1"
-	);
-
-	// Background 3
-	bReturn = CreateGLTexture(
-		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/Background-2.jpg", "screen2"
-	);
-
-	// Desktop
-	bReturn = CreateGLTexture(
-		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/wood.jpeg", "desk"
-	);
-
-	// Outside
-	bReturn = CreateGLTexture(
-		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/Garden3.jpg", "outside"
-	);
-
-	// Cube
-	bReturn = CreateGLTexture(
-		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/Cube3.jpg", "Cube3"
-	);
-	// Cube
-	bReturn = CreateGLTexture(
-		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/Cube2.jpg", "Cube2"
-	);
-
-	// MousePad
-	bReturn = CreateGLTexture(
-		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/Garden2.jpeg", "Pad"
-	);
-
-	BindGLTextures();
-}
-
-/***********************************************************
- *  PrepareScene()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
- ***********************************************************/
-void SceneManager::PrepareScene()
-{
-	// only one instance of a particular mesh needs to be
-	// loaded in memory no matter how many times it is drawn
-	// in the rendered 3D scene
-
-	
-
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadTorusMesh();
-	m_basicMeshes->LoadSphereMesh();
-
-	LoadSceneTextures();
-	SetupSceneLights();
-}
-
-/***********************************************************
- *  SetupSceneLights()
- *
- *  This method is used for setting up the scene lights
- ***********************************************************/
-void SceneManager::SetupSceneLights()
-{
-
-	m_pShaderManager->setIntValue("lightCount", 3);
-
-	m_pShaderManager->setBoolValue("bUseLighting", true);
-
-	// Lighting Main
-	m_pShaderManager->setVec3Value("lightSources[0].position", -5.0f, 14.0f, 20.0f);
-	m_pShaderManager->setVec3Value("lightSources[0].ambientColor", 0.30f, 0.30f, 0.30f);
-	m_pShaderManager->setVec3Value("lightSources[0].diffuseColor", 0.60f, 0.60f, 0.60f);
-	m_pShaderManager->setVec3Value("lightSources[0].specularColor", 0.30f, 0.30f, 0.30f);
-	m_pShaderManager->setFloatValue("lightSources[0].focalStrength", 64.0f);
-	m_pShaderManager->setFloatValue("lightSources[0].specularIntensity", 0.2f);
-	 
-	// Lighting Lamp
-	m_pShaderManager->setVec3Value("lightSources[1].position", 17.0f, 8.8f, 1.5f);
-	m_pShaderManager->setVec3Value("lightSources[1].ambientColor", 0.03f, 0.025f, 0.015f);
-	m_pShaderManager->setVec3Value("lightSources[1].diffuseColor", 0.7f, 0.6f, 0.2f);
-	m_pShaderManager->setVec3Value("lightSources[1].specularColor", 0.7f, 0.6f, 0.3f);
-	m_pShaderManager->setFloatValue("lightSources[1].focalStrength", 0.5f);
-	m_pShaderManager->setFloatValue("lightSources[1].specularIntensity", 0.3f);
-
-	// Lighting Garden
-	m_pShaderManager->setVec3Value("lightSources[2].position", -25.0f, 50.0f, -14.0f);
-	m_pShaderManager->setVec3Value("lightSources[2].diffuseColor", 0.3f, 0.3f, 0.3f);
-	m_pShaderManager->setVec3Value("lightSources[2].specularColor", 1.0f, 0.5f, 0.2f);
-	m_pShaderManager->setFloatValue("lightSources[2].focalStrength", 12.0f);
-	m_pShaderManager->setFloatValue("lightSources[2].specularIntensity", 0.5f);
-
-
-}
-
-/***********************************************************
- *  RenderScene()
- *
- *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
- ***********************************************************/
-void SceneManager::RenderScene()
-{
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(50.0f, 1.0f, 10.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(1, 1, 1, 1);
-
-	// draw the mesh with transformation values
-	//m_basicMeshes->DrawPlaneMesh();
-	/****************************************************************/
-
-	// ===== Desk Top =====
-	// transform for the desktop
-	scaleXYZ = glm::vec3(40.0f, 1.0f, 12.0f);         // size of the box
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(0.0f, 0.0f, 4.0f);
-
-	// set transforms & appearance
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.65f, 0.16f, 0.16f, 1.0f);         
-	SetShaderTexture("desk");
-
-	// draw it
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===== Plate =====
-	// transform for the plate
-	scaleXYZ = glm::vec3(3.0f, 0.3f, 3.0f);         // size of the plate
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-14.0f, 0.5f, 6.0f);
-
-	// set transforms & appearance
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(1.0f, 1.0f, 1.0f, 0.5f);
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	// ===== Donut =====
-	// transform for the donut
-	scaleXYZ = glm::vec3(1.3f, 1.2f, 1.3f);         // size of the donut
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-14.0f, 1.3f, 6.0f);
-
-	// set transforms & appearance
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.80f, 0.80f, 0.0f, 1.0f);
-
-	// draw it
-	m_basicMeshes->DrawTorusMesh();
-
-	// ===== Monitor 1 (L) =====
-	// transform for the monitor
-	scaleXYZ = glm::vec3(13.0f, 8.0f, 0.5f);   // size of monitor
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 10.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-7.0f, 8.0f, 2.0f);
-
-	// apply transforms
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.2f, 0.2f, 0.2f, 1.0f);
-
-	// draw it
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===== Screen 1 (L) =====
-	// transform for the monitor
-	scaleXYZ = glm::vec3(12.0f, 7.0f, 0.2f);   // size of screen
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 10.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-6.8f, 8.0f, 2.3f);
-
-	// apply transforms
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 0.2f);
-	SetShaderTexture("screen1");
-
-	// draw it
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===== Monitor 2 (R) =====
-	// transform for the monitor
-	scaleXYZ = glm::vec3(13.0f, 8.0f, 0.5f);   // size of monitor
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = -10.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(7.0f, 8.0f, 2.0f);
-
-	// apply transforms
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.2f, 0.2f, 0.2f, 1.0f);
-
-	// draw it
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===== Screen 2 (R) =====
-	// transform for the monitor
-	scaleXYZ = glm::vec3(12.0f, 7.0f, 0.2f);   // size of screen
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = -10.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(6.8f, 8.0f, 2.3f);
-
-	// apply transforms
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 0.2f);
-	SetShaderTexture("screen2");
-
-	// draw it
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===== Stand 1 (L) =====
-	// transform for the stand
-	scaleXYZ = glm::vec3(1.0f, 10.0f, 1.0f);         // size of the stand
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-8.0f, 0.0f, 1.0f);
-
-	// set transforms & appearance
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.9f, 0.9f, 0.9f, 1.0f);
-
-	// draw it
-	m_basicMeshes->DrawCylinderMesh();
-
-	// ===== Stand 2 (R) =====
-	// transform for the stand
-	scaleXYZ = glm::vec3(1.0f, 10.0f, 1.0f);         // size of the stand
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(8.0f, 0.0f, 1.0f);
-
-	// set transforms & appearance
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.9f, 0.9f, 0.9f, 1.0f);
-
-	// draw it
-	m_basicMeshes->DrawCylinderMesh();
-
-	// ===== Keyboard =====
-	// transform for the keyboard
-	scaleXYZ = glm::vec3(13.0f, 1.0f, 6.0f);   // size of keyboard
-	XrotationDegrees = 15.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(1.5f, 1.0f, 6.5f);
-
-	glm::mat4 scale;
-	glm::mat4 rotaton;
-	glm::mat4 rotaton2;
-	glm::mat4 translaton;
-	glm::mat4 model;
-
-	// apply transforms
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(0.3f, 0.3f, 0.3f, 1.0f);
-	SetShaderTexture("keyboard");
-
-	// draw it
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===== Mouse Pad =====
-	// transform for the mouse pad
-	scaleXYZ = glm::vec3(5.0f, 0.5f, 5.0f);   // size of mouse pad
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(11.8f, 0.8f, 7.0f);
-
-	// apply transforms
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(0.6f, 0.6f, 0.6f, 1.0f);
-	SetShaderTexture("Pad");
-
-	// draw it
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===== Mouse =====
-	// transform for the mouse
-	scaleXYZ = glm::vec3(1.2f, 1.0f, 2.0f);         // size of the mouse
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(11.8f, 1.05f, 7.0f);
-
-	// set transforms & appearance
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);
-
-	// draw it
-	m_basicMeshes->DrawHalfSphereMesh();
-
-	// ===== Coffee =====
-	// transform for the coffee
-	scaleXYZ = glm::vec3(1.0f, 2.5f, 1.0f);         // size of the coffee
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-7.2f, 0.7f, 7.0f);
-
-	// set transforms & appearance
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.23f, 0.16f, 0.05f, 1.0f);
-
-	// draw it
-	m_basicMeshes->DrawCylinderMesh();
-
-
-	// ===== Coffee Cup =====
-	// transform for the coffee cup
-	scaleXYZ = glm::vec3(1.2f, 3.0f, 1.2f);         // size of the coffee cup
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-7.2f, 0.5f, 7.0f);
-
-	// set transforms & appearance
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(1.0f, 1.0f, 1.0f, 0.3f);
-
-	// draw it
-	m_basicMeshes->DrawCylinderMesh();
-
-	// ===== Outside =====
-	// transform for the garden
-	scaleXYZ = glm::vec3(100.0f, 58.0f, 0.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(0.0f, 20.0f, -25.0f);
-
-	// apply transforms
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(0.2f, 0.2f, 0.2f, 1.0f);
-	SetShaderTexture("outside");
-
-	// draw it
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===== Light Base =====
-	// transform for the light base
-	scaleXYZ = glm::vec3(1.5f, 8.0f, 1.5f);         // size light base
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(17.5f, 0.5f, 2.0f);
-
-	// set transforms & appearance
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.2f, 0.2f, 0.2f, 1.0f);
-
-	// draw it
-	m_basicMeshes->DrawHalfSphereMesh();
-
-	// ===== Light Bulb =====
-	// transform for the light bulb
-	scaleXYZ = glm::vec3(1.4f, 1.1f, 1.4f);         // size of the light bulb
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(17.5f, 8.5f, 2.0f);
-
-	// set transforms & appearance
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(1.0f, 0.9f, 0.2f, 1.0f);
-
-	// draw it
-	m_basicMeshes->DrawSphereMesh();
-
-	// ===== Window =====
-	// transform for the window
-	scaleXYZ = glm::vec3(52.0f, 30.0f, 1.0f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(0.0f, 20.0f, -12.0f);
-
-	// apply transforms
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(1.0f, 1.0f, 1.0f, 0.1f);
-
-	// draw it
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===== Wall 1 =====
-	// transform for the wall segment lower
-	scaleXYZ = glm::vec3(100.0f, 15.0f, 2.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(0.0f, -1.5f, -12.0f);
-
-	// apply transforms
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(0.7f, 0.7f, 0.7f, 1.0f);
-	SetShaderTexture("Cube3");
-
-	// draw it
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===== Wall 2 =====
-	// transform for the segment upper
-	scaleXYZ = glm::vec3(100.0f, 15.0f, 2.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(0.0f, 41.5f, -12.0f);
-
-	// apply transforms
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(0.7f, 0.7f, 0.7f, 1.0f);
-	SetShaderTexture("Cube3");
-
-	// draw it
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===== Wall 3 =====
-	// transform for the segment left
-	scaleXYZ = glm::vec3(25.0f, 28.0f, 2.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-37.5f, 20.0f, -12.0f);
-
-	// apply transforms
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(0.7f, 0.7f, 0.7f, 1.0f);
-	SetShaderTexture("Cube2");
-
-	// draw it
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===== Wall 4 =====
-	// transform for the segment right
-	scaleXYZ = glm::vec3(25.0f, 28.0f, 2.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(37.5f, 20.0f, -12.0f);
-
-	// apply transforms
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(0.7f, 0.7f, 0.7f, 1.0f);
-	SetShaderTexture("Cube2");
-
-	// draw it
-	m_basicMeshes->DrawBoxMesh();
-
-
-}
+///////////////////////////////////////////////////////////////////////////////
+// shadermanager.cpp
+// ============
+// manage the loading and rendering of 3D scenes
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneManager.h"
+#include "RenderSettings.h"
+#include "GLStateCache.h"
+#include "MeshOptimizer.h"
+#include "ModelImporter.h"
+
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#endif
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <tuple>
+
+// declaration of global variables
+namespace
+{
+	const char* g_ModelName = "model";
+	const char* g_ColorValueName = "objectColor";
+	const char* g_TextureValueName = "objectTexture";
+	const char* g_UseTextureName = "bUseTexture";
+	const char* g_UseLightingName = "bUseLighting";
+	const char* g_UseLightmapName = "bUseLightmap";
+	const char* g_LightmapTextureName = "lightmapTexture";
+	const char* g_LightmapScaleOffsetName = "lightmapScaleOffset";
+	const char* g_UseProbeLightingName = "bUseProbeLighting";
+	const char* g_UseOITName = "bUseOIT";
+	const char* g_UseObjectBufferName = "bUseObjectBuffer";
+	const char* g_UseObjectStorageName = "bUseObjectStorage";
+	const char* g_PositionDecodeOffsetName = "positionDecodeOffset";
+	const char* g_PositionDecodeScaleName = "positionDecodeScale";
+	const char* g_ProbeTextureName = "probeTexture";
+	const char* g_ProbeGridMinName = "probeGridMin";
+	const char* g_ProbeGridMaxName = "probeGridMax";
+	const char* g_ProbeGridDimsName = "probeGridDims";
+
+	// the lightmap uses the last of the 16 texture slots
+	const int LIGHTMAP_TEXTURE_UNIT = 15;
+	// the irradiance probe volume uses the slot below it
+	const int PROBE_TEXTURE_UNIT = 14;
+	// uniform buffer binding of the ObjectBlock
+	const GLuint OBJECT_BLOCK_BINDING = 1;
+	// sources of the forward shader variants
+	const char* g_VertexShaderFile = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/vertexShader.glsl";
+	const char* g_FragmentShaderFile = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/Source/Utilities/shaders/fragmentShader.glsl";
+
+	// baked lightmaps are reused until the scene or lights change
+	const char* g_LightmapCacheFile = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/lightmap.cache";
+	const char* g_MeshCacheFile = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/meshes.cache";
+	// model that replaces the half sphere of the mouse when it
+	// can be loaded
+	const char* g_MouseModelFile = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/Models/mouse.gltf";
+
+	// changed whenever the shape generators or their settings
+	// change, so that an older mesh cache is written again
+	const uint32_t MESH_GENERATOR_KEY = 3;
+	// names of the shapes for the optimization report
+	const char* g_MeshTypeNames[SceneManager::MESH_TYPE_COUNT] =
+		{ "plane", "box", "cylinder", "torus", "sphere", "half sphere" };
+
+	// tessellation of each level of detail of the round shapes
+	const int LOD_SLICES[SceneManager::MESH_LOD_COUNT] = { 36, 24, 16, 10 };
+	const int LOD_STACKS[SceneManager::MESH_LOD_COUNT] = { 18, 12, 8, 5 };
+	const int LOD_HALF_STACKS[SceneManager::MESH_LOD_COUNT] = { 9, 6, 4, 3 };
+	const int LOD_TORUS_SEGMENTS[SceneManager::MESH_LOD_COUNT] = { 30, 20, 12, 8 };
+	// share of the screen height covered by an object below
+	// which the next coarser level is used
+	const float LOD_COVERAGE[SceneManager::MESH_LOD_COUNT - 1] = { 0.25f, 0.1f, 0.04f };
+	// a level only changes once the coverage is this far past
+	// the threshold, so that objects near it do not flicker
+	const float LOD_HYSTERESIS = 0.15f;
+	// models with fewer triangles are drawn in one piece
+	const size_t MESHLET_MIN_TRIANGLES = 4096;
+	// the static batches are split into cells of this size, so
+	// the compact positions of a merged mesh stay fine enough and
+	// the batches out of view can be skipped
+	const float STATIC_BATCH_CELL_SIZE = 256.0f;
+	// smaller batches hide too little of the scene to be worth
+	// drawing a second time into the depth pyramid
+	const float OCCLUDER_MIN_RADIUS = 5.0f;
+	// most batches drawn into the depth pyramid, the nearest
+	// ones in view first
+	const size_t OCCLUDER_BUDGET = 8;
+	// size of the light arrays of the forward shader, which
+	// leaves out the lights after these, while the deferred
+	// pass reads every light from storage
+	const int MAX_FORWARD_LIGHTS = 8;
+
+	// one object of a desk of the stress scene, placed like
+	// the desk of the scene
+	struct STRESS_PART
+	{
+		const char* tag;
+		SceneManager::MESH_TYPE mesh;
+		glm::vec3 scaleXYZ;
+		float XrotationDegrees;
+		float YrotationDegrees;
+		float ZrotationDegrees;
+		glm::vec3 positionXYZ;
+		glm::vec4 color;
+		const char* textureTag;
+	};
+	const STRESS_PART g_StressDeskParts[] =
+	{
+		{ "Desk Top", SceneManager::MESH_BOX, glm::vec3(40.0f, 1.0f, 12.0f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, 0.0f, 4.0f), glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "desk" },
+		{ "Plate", SceneManager::MESH_CYLINDER, glm::vec3(3.0f, 0.3f, 3.0f), 0.0f, 0.0f, 0.0f, glm::vec3(-14.0f, 0.5f, 6.0f), glm::vec4(1.0f, 1.0f, 1.0f, 0.5f), "" },
+		{ "Donut", SceneManager::MESH_TORUS, glm::vec3(1.3f, 1.2f, 1.3f), 90.0f, 0.0f, 0.0f, glm::vec3(-14.0f, 1.3f, 6.0f), glm::vec4(0.80f, 0.80f, 0.0f, 1.0f), "" },
+		{ "Monitor 1", SceneManager::MESH_BOX, glm::vec3(13.0f, 8.0f, 0.5f), 0.0f, 10.0f, 0.0f, glm::vec3(-7.0f, 8.0f, 2.0f), glm::vec4(0.2f, 0.2f, 0.2f, 1.0f), "" },
+		{ "Screen 1", SceneManager::MESH_BOX, glm::vec3(12.0f, 7.0f, 0.2f), 0.0f, 10.0f, 0.0f, glm::vec3(-6.8f, 8.0f, 2.3f), glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "screen1" },
+		{ "Monitor 2", SceneManager::MESH_BOX, glm::vec3(13.0f, 8.0f, 0.5f), 0.0f, -10.0f, 0.0f, glm::vec3(7.0f, 8.0f, 2.0f), glm::vec4(0.2f, 0.2f, 0.2f, 1.0f), "" },
+		{ "Screen 2", SceneManager::MESH_BOX, glm::vec3(12.0f, 7.0f, 0.2f), 0.0f, -10.0f, 0.0f, glm::vec3(6.8f, 8.0f, 2.3f), glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "screen2" },
+		{ "Stand 1", SceneManager::MESH_CYLINDER, glm::vec3(1.0f, 10.0f, 1.0f), 0.0f, 0.0f, 0.0f, glm::vec3(-8.0f, 0.0f, 1.0f), glm::vec4(0.9f, 0.9f, 0.9f, 1.0f), "" },
+		{ "Stand 2", SceneManager::MESH_CYLINDER, glm::vec3(1.0f, 10.0f, 1.0f), 0.0f, 0.0f, 0.0f, glm::vec3(8.0f, 0.0f, 1.0f), glm::vec4(0.9f, 0.9f, 0.9f, 1.0f), "" },
+		{ "Keyboard", SceneManager::MESH_BOX, glm::vec3(13.0f, 1.0f, 6.0f), 15.0f, 0.0f, 0.0f, glm::vec3(1.5f, 1.0f, 6.5f), glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "keyboard" },
+		{ "Mouse Pad", SceneManager::MESH_BOX, glm::vec3(5.0f, 0.5f, 5.0f), 0.0f, 0.0f, 0.0f, glm::vec3(11.8f, 0.8f, 7.0f), glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "Pad" },
+		{ "Mouse", SceneManager::MESH_HALF_SPHERE, glm::vec3(1.2f, 1.0f, 2.0f), 0.0f, 0.0f, 0.0f, glm::vec3(11.8f, 1.05f, 7.0f), glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "" },
+		{ "Coffee", SceneManager::MESH_CYLINDER, glm::vec3(1.0f, 2.5f, 1.0f), 0.0f, 0.0f, 0.0f, glm::vec3(-7.2f, 0.7f, 7.0f), glm::vec4(0.23f, 0.16f, 0.05f, 1.0f), "" },
+		{ "Coffee Cup", SceneManager::MESH_CYLINDER, glm::vec3(1.2f, 3.0f, 1.2f), 0.0f, 0.0f, 0.0f, glm::vec3(-7.2f, 0.5f, 7.0f), glm::vec4(1.0f, 1.0f, 1.0f, 0.3f), "" },
+		{ "Light Base", SceneManager::MESH_HALF_SPHERE, glm::vec3(1.5f, 8.0f, 1.5f), 0.0f, 0.0f, 0.0f, glm::vec3(17.5f, 0.5f, 2.0f), glm::vec4(0.2f, 0.2f, 0.2f, 1.0f), "" },
+		{ "Light Bulb", SceneManager::MESH_SPHERE, glm::vec3(1.4f, 1.1f, 1.4f), 0.0f, 0.0f, 0.0f, glm::vec3(17.5f, 8.5f, 2.0f), glm::vec4(1.0f, 0.9f, 0.2f, 1.0f), "" },
+	};
+	const int STRESS_DESK_PART_COUNT = sizeof(g_StressDeskParts) / sizeof(g_StressDeskParts[0]);
+	// parts with their own handling
+	const int STRESS_MOUSE_PART = 11;
+	const int STRESS_BULB_PART = 15;
+	// position of the lamp light relative to the desk, as in
+	// the lights of the scene
+	const glm::vec3 STRESS_LAMP_POSITION(17.0f, 8.8f, 1.5f);
+	// distance between the desks along X and Z, with room for
+	// the jitter and rotation
+	const float STRESS_DESK_SPACING_X = 56.0f;
+	const float STRESS_DESK_SPACING_Z = 36.0f;
+	// largest random change of each desk
+	const float STRESS_MAX_OFFSET = 3.0f;
+	const float STRESS_MAX_YAW_DEGREES = 20.0f;
+	const float STRESS_MAX_SCALE_CHANGE = 0.1f;
+	// the plain colored parts are tinted with one of a few
+	// colors, so the static batches stay few
+	const glm::vec4 STRESS_TINTS[] =
+	{
+		glm::vec4(1.0f, 1.0f, 1.0f, 1.0f),
+		glm::vec4(0.8f, 0.85f, 1.0f, 1.0f),
+		glm::vec4(1.0f, 0.85f, 0.7f, 1.0f),
+		glm::vec4(0.7f, 0.7f, 0.7f, 1.0f),
+	};
+	const int STRESS_TINT_COUNT = sizeof(STRESS_TINTS) / sizeof(STRESS_TINTS[0]);
+
+	/***********************************************************
+	 *  NextRandom()
+	 *
+	 *  Xorshift random number in [0, 1), the same sequence on
+	 *  every platform for a given seed.
+	 ***********************************************************/
+	float NextRandom(uint32_t& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return((state >> 8) * (1.0f / 16777216.0f));
+	}
+
+	/***********************************************************
+	 *  BuildModelMatrix()
+	 *
+	 *  Combine the scale, rotations and translation into one
+	 *  model matrix in the order used by all scene objects.
+	 ***********************************************************/
+	glm::mat4 BuildModelMatrix(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ)
+	{
+		glm::mat4 scale = glm::scale(scaleXYZ);
+		glm::mat4 rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
+		glm::mat4 rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
+		glm::mat4 translation = glm::translate(positionXYZ);
+
+		return(translation * rotationX * rotationY * rotationZ * scale);
+	}
+
+	/***********************************************************
+	 *  GetBoxCorners()
+	 *
+	 *  Get the eight corners of a box from its lowest and
+	 *  highest corner.
+	 ***********************************************************/
+	void GetBoxCorners(const glm::vec3& boxMin, const glm::vec3& boxMax, glm::vec3 corners[8])
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			corners[i] = glm::vec3(
+				((i & 1) != 0) ? boxMax.x : boxMin.x,
+				((i & 2) != 0) ? boxMax.y : boxMin.y,
+				((i & 4) != 0) ? boxMax.z : boxMin.z);
+		}
+	}
+
+	/***********************************************************
+	 *  IsBoxOutsideFrustum()
+	 *
+	 *  Test a world space box against the planes of the view
+	 *  frustum, with the corner farthest along each plane. The
+	 *  planes are the sums and differences of the rows of the
+	 *  view-projection matrix.
+	 ***********************************************************/
+	bool IsBoxOutsideFrustum(
+		const glm::mat4& viewProjection,
+		const glm::vec3& boxMin,
+		const glm::vec3& boxMax)
+	{
+		glm::mat4 rows = glm::transpose(viewProjection);
+		glm::vec4 planes[6] =
+		{
+			rows[3] + rows[0], rows[3] - rows[0],
+			rows[3] + rows[1], rows[3] - rows[1],
+			rows[3] + rows[2], rows[3] - rows[2]
+		};
+
+		for (int i = 0; i < 6; i++)
+		{
+			glm::vec3 corner(
+				(planes[i].x >= 0.0f) ? boxMax.x : boxMin.x,
+				(planes[i].y >= 0.0f) ? boxMax.y : boxMin.y,
+				(planes[i].z >= 0.0f) ? boxMax.z : boxMin.z);
+			if (glm::dot(glm::vec3(planes[i]), corner) + planes[i].w < 0.0f)
+			{
+				return(true);
+			}
+		}
+
+		return(false);
+	}
+}
+
+/***********************************************************
+ *  SceneManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneManager::SceneManager(ShaderManager *pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+	m_pForwardShader = pShaderManager;
+	m_loadedTextures = 0;
+	m_bMeshDataReady = false;
+	m_bCompactMeshes = false;
+	m_lightmapTextureID = 0;
+	m_bLightmapReady = false;
+	m_bLightmapFailed = false;
+	m_probeTextureID = 0;
+	m_bProbesReady = false;
+	m_bProbesFailed = false;
+	m_bDeferredReady = false;
+	m_bDeferredFailed = false;
+	m_bPermutationsReady = false;
+	m_bPermutationsFailed = false;
+	m_bSelectVariants = false;
+	m_bOITReady = false;
+	m_bOITFailed = false;
+	m_bOITPass = false;
+	m_bUploadRingReady = false;
+	m_bUploadRingFailed = false;
+	m_bUseObjectBuffer = false;
+	m_bGPUCullingReady = false;
+	m_bGPUCullingFailed = false;
+	m_bGPUSceneDirty = true;
+	m_bGPUSceneBatched = false;
+	m_bIndirectDraws = false;
+	m_bHiZReady = false;
+	m_bHiZFailed = false;
+	m_bOcclusionCulling = false;
+	m_frameFeatures = 0;
+	m_frameIndex = 0;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	m_viewPosition = glm::vec3(0.0f);
+
+	for (int i = 0; i < MESH_TYPE_COUNT; i++)
+	{
+		m_meshLodCounts[i] = 0;
+		m_meshCenters[i] = glm::vec3(0.0f);
+		m_meshRadii[i] = 0.0f;
+		m_meshExtents[i] = glm::vec3(0.0f);
+	}
+}
+
+/***********************************************************
+ *  ~SceneManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneManager::~SceneManager()
+{
+	m_pShaderManager = NULL;
+	m_pForwardShader = NULL;
+
+	DestroyBakedLighting();
+	DestroyProbeLighting();
+	DestroyStaticBatches();
+	DestroyModels();
+	for (int i = 0; i < MESH_TYPE_COUNT; i++)
+	{
+		for (int lod = 0; lod < MESH_LOD_COUNT; lod++)
+		{
+			DestroyGLMesh(m_glMeshes[i][lod]);
+		}
+	}
+}
+
+/***********************************************************
+ *  CreateGLTexture()
+ *
+ *  This method is used for loading textures from image files,
+ *  configuring the texture mapping parameters in OpenGL,
+ *  generating the mipmaps, and loading the read texture into
+ *  the next available texture slot in memory.
+ ***********************************************************/
+bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
+{
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+	GLuint textureID = 0;
+
+	// indicate to always flip images vertically when loaded
+	stbi_set_flip_vertically_on_load(true);
+
+	// try to parse the image data from the specified image file
+	unsigned char* image = stbi_load(
+		filename,
+		&width,
+		&height,
+		&colorChannels,
+		0);
+
+	// if the image was successfully read from the image file
+	if (image)
+	{
+		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
+
+		glGenTextures(1, &textureID);
+		g_GLState.BindTexture(GLStateCache::UPLOAD_TEXTURE_UNIT, GL_TEXTURE_2D, textureID);
+
+		// set the texture wrapping parameters
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		// set texture filtering parameters
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		// if the loaded image is in RGB format
+		if (colorChannels == 3)
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
+		// if the loaded image is in RGBA format - it supports transparency
+		else if (colorChannels == 4)
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+		else
+		{
+			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
+			return false;
+		}
+
+		// generate the texture mipmaps for mapping textures to lower resolutions
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		// average the image color so baked bounce light picks up the texture tint
+		glm::vec3 averageColor(0.0f);
+		int pixelCount = width * height;
+		for (int i = 0; i < pixelCount; i++)
+		{
+			averageColor += glm::vec3(
+				image[i * colorChannels + 0],
+				image[i * colorChannels + 1],
+				image[i * colorChannels + 2]);
+		}
+		averageColor /= (255.0f * (float)pixelCount);
+
+		// free the image data from local memory
+		stbi_image_free(image);
+
+		// register the loaded texture and associate it with the special tag string
+		m_textureIDs[m_loadedTextures].ID = textureID;
+		m_textureIDs[m_loadedTextures].tag = tag;
+		m_textureIDs[m_loadedTextures].averageColor = averageColor;
+		m_loadedTextures++;
+
+		return true;
+	}
+
+	std::cout << "Could not load image:" << filename << std::endl;
+
+	// Error loading the image
+	return false;
+}
+
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method is used for binding the loaded textures to
+ *  OpenGL texture memory slots.  There are up to 16 slots.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
+{
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		// bind textures on corresponding texture units
+		g_GLState.BindTexture(i, GL_TEXTURE_2D, m_textureIDs[i].ID);
+	}
+}
+
+/***********************************************************
+ *  DestroyGLTextures()
+ *
+ *  This method is used for freeing the memory in all the
+ *  used texture memory slots.
+ ***********************************************************/
+void SceneManager::DestroyGLTextures()
+{
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		glGenTextures(1, &m_textureIDs[i].ID);
+	}
+}
+
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for getting an ID for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureID(std::string tag)
+{
+	int textureID = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < m_loadedTextures) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureID = m_textureIDs[index].ID;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for getting a slot index for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureSlot(std::string tag)
+{
+	int textureSlot = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < m_loadedTextures) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureSlot = index;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureSlot);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for getting a material from the previously
+ *  defined materials list that is associated with the passed in tag.
+ ***********************************************************/
+bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+{
+	if (m_objectMaterials.size() == 0)
+	{
+		return(false);
+	}
+
+	int index = 0;
+	bool bFound = false;
+	while ((index < m_objectMaterials.size()) && (bFound == false))
+	{
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			bFound = true;
+			material.ambientColor = m_objectMaterials[index].ambientColor;
+			material.ambientStrength = m_objectMaterials[index].ambientStrength;
+			material.diffuseColor = m_objectMaterials[index].diffuseColor;
+			material.specularColor = m_objectMaterials[index].specularColor;
+			material.shininess = m_objectMaterials[index].shininess;
+		}
+		else
+		{
+			index++;
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	// variables for this method
+	glm::mat4 modelView;
+
+	// combine the scale, rotation and translation values
+	modelView = BuildModelMatrix(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setMat4Value(g_ModelName, modelView);
+	}
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  into the shader for the next draw command
+ ***********************************************************/
+void SceneManager::SetShaderColor(float r, float g, float b, float a)
+{
+    if (m_pShaderManager)
+    {
+        m_pShaderManager->setBoolValue("bUseTexture", false);   // was setIntValue(...)
+        m_pShaderManager->setVec4Value("objectColor", r, g, b, a); // was setVec4Value(...)
+    }
+}
+
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in ID into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	std::string textureTag)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setIntValue(g_UseTextureName, true);
+
+		int textureID = -1;
+		textureID = FindTextureSlot(textureTag);
+		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+	}
+}
+
+/***********************************************************
+ *  SetTextureUVScale()
+ *
+ *  This method is used for setting the texture UV scale
+ *  values into the shader.
+ ***********************************************************/
+void SceneManager::SetTextureUVScale(float u, float v)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
+	}
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the material values
+ *  into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	std::string materialTag)
+{
+	if (m_objectMaterials.size() > 0)
+	{
+		OBJECT_MATERIAL material;
+		bool bReturn = false;
+
+		bReturn = FindMaterial(materialTag, material);
+		if (bReturn == true)
+		{
+			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
+			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
+			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
+			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
+			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+		}
+	}
+}
+
+/***********************************************************
+ *  AddSceneObject()
+ *
+ *  This method is used for adding an object to the list of
+ *  objects that are drawn in the 3D scene. Objects with a
+ *  texture tag are textured, all others use the color.
+ ***********************************************************/
+int SceneManager::AddSceneObject(
+	std::string tag,
+	MESH_TYPE mesh,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ,
+	glm::vec4 color,
+	std::string textureTag)
+{
+	SCENE_OBJECT object;
+
+	object.tag = tag;
+	object.mesh = mesh;
+	object.scaleXYZ = scaleXYZ;
+	object.XrotationDegrees = XrotationDegrees;
+	object.YrotationDegrees = YrotationDegrees;
+	object.ZrotationDegrees = ZrotationDegrees;
+	object.positionXYZ = positionXYZ;
+	object.color = color;
+	object.textureTag = textureTag;
+	object.bStatic = true;
+	// see-through objects let the light pass when baking
+	object.bCastsShadows = (color.a >= 1.0f);
+	object.bTransparent = (color.a < 1.0f);
+	object.bUseLighting = true;
+	object.lightmapIndex = -1;
+	object.lodLevel = 0;
+	object.batchIndex = -1;
+	object.modelIndex = -1;
+	object.meshletList = -1;
+	object.gpuRecord = -1;
+	object.gpuGroup = -1;
+
+	m_sceneObjects.push_back(object);
+	m_bGPUSceneDirty = true;
+
+	return(static_cast<int>(m_sceneObjects.size() - 1));
+}
+
+/***********************************************************
+ *  AddModelObject()
+ *
+ *  This method is used for adding an object that is drawn
+ *  with an imported model instead of a basic shape.
+ ***********************************************************/
+int SceneManager::AddModelObject(
+	std::string tag,
+	int modelIndex,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ,
+	glm::vec4 color,
+	std::string textureTag)
+{
+	// the box stands in for the model in the shape tables
+	int index = AddSceneObject(tag, MESH_BOX, scaleXYZ,
+		XrotationDegrees, YrotationDegrees, ZrotationDegrees,
+		positionXYZ, color, textureTag);
+	m_sceneObjects[index].modelIndex = modelIndex;
+
+	return(index);
+}
+
+/***********************************************************
+ *  LoadModel()
+ *
+ *  This method is used for importing a model file. The mesh
+ *  is moved to stand centered on the origin and scaled so
+ *  its largest side is 2 units, the extents of the basic
+ *  shapes, then it is optimized and uploaded. A file that
+ *  is already loaded is not read again.
+ ***********************************************************/
+int SceneManager::LoadModel(const char* filename)
+{
+	for (size_t i = 0; i < m_models.size(); i++)
+	{
+		if (m_models[i].filename == filename)
+		{
+			return(static_cast<int>(i));
+		}
+	}
+
+	IMPORTED_MODEL model;
+	model.filename = filename;
+	if (!ImportModel(filename, model.meshData))
+	{
+		return(-1);
+	}
+
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+	ComputeMeshBounds(GetMeshView(model.meshData), boundsMin, boundsMax);
+	glm::vec3 size = boundsMax - boundsMin;
+	float largest = glm::max(size.x, glm::max(size.y, size.z));
+	float scale = ((largest > 0.0f) ? 2.0f / largest : 1.0f);
+	glm::vec3 base((boundsMin.x + boundsMax.x) * 0.5f, boundsMin.y, (boundsMin.z + boundsMax.z) * 0.5f);
+	for (MESH_VERTEX& vertex : model.meshData.vertices)
+	{
+		vertex.position = (vertex.position - base) * scale;
+	}
+
+	VERTEX_CACHE_STATS before;
+	VERTEX_CACHE_STATS after;
+	OptimizeMesh(model.meshData, before, after);
+	std::cout << "Optimized model " << filename
+		<< ": ACMR " << before.acmr << " -> " << after.acmr
+		<< ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+
+	if (!UploadGLMesh(GetMeshView(model.meshData), model.glMesh, m_bCompactMeshes))
+	{
+		return(-1);
+	}
+	model.center = glm::vec3(0.0f, size.y * scale * 0.5f, 0.0f);
+	model.radius = glm::length(size) * scale * 0.5f;
+	model.extents = size * (scale * 0.5f);
+
+	// the clusters follow the optimized triangle order
+	if (model.meshData.indices.size() / 3 >= MESHLET_MIN_TRIANGLES)
+	{
+		BuildMeshlets(model.meshData, model.meshlets);
+		std::cout << "Built " << model.meshlets.size() << " meshlets for model " << filename << std::endl;
+	}
+
+	m_models.push_back(model);
+
+	return(static_cast<int>(m_models.size() - 1));
+}
+
+/***********************************************************
+ *  DestroyModels()
+ *
+ *  This method is used for freeing the imported models.
+ ***********************************************************/
+void SceneManager::DestroyModels()
+{
+	for (IMPORTED_MODEL& model : m_models)
+	{
+		DestroyGLMesh(model.glMesh);
+	}
+	m_models.clear();
+}
+
+/***********************************************************
+ *  GetObjectMeshData()
+ *
+ *  This method is used for getting the CPU copy of the mesh
+ *  of an object. The basic shapes are only filled after
+ *  PrepareMeshData() was called.
+ ***********************************************************/
+const MESH_DATA& SceneManager::GetObjectMeshData(const SCENE_OBJECT& object) const
+{
+	if (object.modelIndex >= 0)
+	{
+		return(m_models[object.modelIndex].meshData);
+	}
+	return(m_meshData[object.mesh][0]);
+}
+
+/***********************************************************
+ *  GetObjectGLMesh()
+ *
+ *  This method is used for getting the OpenGL mesh of an
+ *  object at a level of detail. Models have only one.
+ ***********************************************************/
+const GL_MESH& SceneManager::GetObjectGLMesh(const SCENE_OBJECT& object, int lod) const
+{
+	if (object.modelIndex >= 0)
+	{
+		return(m_models[object.modelIndex].glMesh);
+	}
+	return(m_glMeshes[object.mesh][lod]);
+}
+
+/***********************************************************
+ *  GetObjectMeshCenter()
+ *
+ *  This method is used for getting the center of the mesh
+ *  of an object before it is transformed.
+ ***********************************************************/
+glm::vec3 SceneManager::GetObjectMeshCenter(const SCENE_OBJECT& object) const
+{
+	if (object.modelIndex >= 0)
+	{
+		return(m_models[object.modelIndex].center);
+	}
+	return(m_meshCenters[object.mesh]);
+}
+
+/***********************************************************
+ *  GetObjectMeshExtents()
+ *
+ *  This method is used for getting half the size of the box
+ *  around the mesh of an object before it is transformed.
+ ***********************************************************/
+glm::vec3 SceneManager::GetObjectMeshExtents(const SCENE_OBJECT& object) const
+{
+	if (object.modelIndex >= 0)
+	{
+		return(m_models[object.modelIndex].extents);
+	}
+	return(m_meshExtents[object.mesh]);
+}
+
+/***********************************************************
+ *  GetObjectRadius()
+ *
+ *  This method is used for getting the radius of a sphere
+ *  around the mesh of an object after it is scaled.
+ ***********************************************************/
+float SceneManager::GetObjectRadius(const SCENE_OBJECT& object) const
+{
+	float scale = glm::max(
+		glm::abs(object.scaleXYZ.x),
+		glm::max(glm::abs(object.scaleXYZ.y), glm::abs(object.scaleXYZ.z)));
+
+	return(((object.modelIndex >= 0) ?
+		m_models[object.modelIndex].radius : m_meshRadii[object.mesh]) * scale);
+}
+
+/***********************************************************
+ *  GetObjectCorners()
+ *
+ *  This method is used for getting the world positions of
+ *  the eight corners of the box around the mesh of an
+ *  object, which follows its rotation and scale.
+ ***********************************************************/
+void SceneManager::GetObjectCorners(const SCENE_OBJECT& object, glm::vec3 corners[8]) const
+{
+	glm::mat4 model = BuildModelMatrix(
+		object.scaleXYZ,
+		object.XrotationDegrees,
+		object.YrotationDegrees,
+		object.ZrotationDegrees,
+		object.positionXYZ);
+	glm::vec3 center = GetObjectMeshCenter(object);
+	glm::vec3 extents = GetObjectMeshExtents(object);
+
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec3 corner = center + extents * glm::vec3(
+			((i & 1) != 0) ? 1.0f : -1.0f,
+			((i & 2) != 0) ? 1.0f : -1.0f,
+			((i & 4) != 0) ? 1.0f : -1.0f);
+		corners[i] = glm::vec3(model * glm::vec4(corner, 1.0f));
+	}
+}
+
+/***********************************************************
+ *  DrawSceneObject()
+ *
+ *  This method is used for setting the transformations and
+ *  the appearance of a scene object and then drawing it.
+ *  Static objects are drawn with their baked lightmap when
+ *  baked lighting is active.
+ ***********************************************************/
+void SceneManager::DrawSceneObject(const SCENE_OBJECT& object, bool bBakedLighting)
+{
+	bool bLightmapped = ((bBakedLighting) && (object.lightmapIndex >= 0));
+	// every level shares the lightmap UV layout of the first
+	int lod = (g_RenderSettings.bUseLod ? object.lodLevel : 0);
+	glm::vec4 lightmapScaleOffset = (bLightmapped ?
+		m_lightmapBaker.GetScaleOffset(object.lightmapIndex) : glm::vec4(1.0f, 1.0f, 0.0f, 0.0f));
+
+	const MESHLET_DRAW_LIST* pMeshlets = ((object.meshletList >= 0) ?
+		&m_meshletDrawLists[object.meshletList] : NULL);
+
+	DrawObjectMesh(object, GetObjectGLMesh(object, lod), bLightmapped, lightmapScaleOffset, pMeshlets);
+}
+
+/***********************************************************
+ *  DrawObjectMesh()
+ *
+ *  This method is used for selecting the shader values of
+ *  an object and drawing a mesh with them, which is either
+ *  the shape of the object or a merged static batch.
+ ***********************************************************/
+void SceneManager::DrawObjectMesh(
+	const SCENE_OBJECT& object,
+	const GL_MESH& glMesh,
+	bool bLightmapped,
+	const glm::vec4& lightmapScaleOffset,
+	const MESHLET_DRAW_LIST* pMeshlets)
+{
+	if (m_bSelectVariants)
+	{
+		SelectObjectVariant(object, bLightmapped);
+	}
+	m_pShaderManager->setBoolValue(g_UseLightingName, object.bUseLighting);
+	m_pShaderManager->setBoolValue(g_UseOITName, m_bOITPass);
+
+	// the transform, color and lightmap tile are read from the
+	// upload ring, or set as uniforms when it has no room
+	bool bObjectBuffer = ((m_bUseObjectBuffer) && (WriteObjectBlock(object, lightmapScaleOffset)));
+	if ((m_bUseObjectBuffer) && (!bObjectBuffer))
+	{
+		m_pShaderManager->setBoolValue(g_UseObjectBufferName, false);
+	}
+
+	if (!bObjectBuffer)
+	{
+		SetTransformations(
+			object.scaleXYZ,
+			object.XrotationDegrees,
+			object.YrotationDegrees,
+			object.ZrotationDegrees,
+			object.positionXYZ);
+	}
+
+	if (!object.textureTag.empty())
+	{
+		SetShaderTexture(object.textureTag);
+	}
+	else if (bObjectBuffer)
+	{
+		m_pShaderManager->setBoolValue(g_UseTextureName, false);
+	}
+	else
+	{
+		SetShaderColor(object.color.r, object.color.g, object.color.b, object.color.a);
+	}
+
+	m_pShaderManager->setVec3Value(g_PositionDecodeOffsetName, glMesh.decodeOffset);
+	m_pShaderManager->setVec3Value(g_PositionDecodeScaleName, glMesh.decodeScale);
+
+	if (bLightmapped)
+	{
+		// every shape carries its lightmap UVs in a second stream
+		m_pShaderManager->setBoolValue(g_UseLightmapName, true);
+		if (!bObjectBuffer)
+		{
+			m_pShaderManager->setVec4Value(g_LightmapScaleOffsetName, lightmapScaleOffset);
+		}
+	}
+
+	if (NULL != pMeshlets)
+	{
+		DrawMeshletList(glMesh, *pMeshlets);
+	}
+	else
+	{
+		DrawGLMesh(glMesh);
+	}
+
+	if (bLightmapped)
+	{
+		m_pShaderManager->setBoolValue(g_UseLightmapName, false);
+	}
+
+	if ((m_bUseObjectBuffer) && (!bObjectBuffer))
+	{
+		m_pShaderManager->setBoolValue(g_UseObjectBufferName, true);
+	}
+}
+
+/***********************************************************
+ *  SelectObjectVariant()
+ *
+ *  This method is used for switching to the shader variant
+ *  with the features that the appearance of an object uses.
+ ***********************************************************/
+void SceneManager::SelectObjectVariant(const SCENE_OBJECT& object, bool bLightmapped)
+{
+	unsigned int features = 0;
+	if (!object.textureTag.empty())
+	{
+		features |= FEATURE_TEXTURE;
+	}
+	// unlit and lightmapped objects never read the probes
+	if (object.bUseLighting)
+	{
+		features |= FEATURE_LIGHTING;
+		features |= (bLightmapped ? static_cast<unsigned int>(FEATURE_LIGHTMAP) : (m_frameFeatures & FEATURE_PROBES));
+	}
+	if (m_bOITPass)
+	{
+		features |= FEATURE_OIT;
+	}
+	SelectShaderVariant(features);
+}
+
+/***********************************************************
+ *  WriteObjectBlock()
+ *
+ *  This method is used for writing the values of an object
+ *  straight into the mapped region of this frame and binding
+ *  them for the next draw. The normal matrix is computed
+ *  here once instead of for every vertex.
+ ***********************************************************/
+bool SceneManager::WriteObjectBlock(const SCENE_OBJECT& object, const glm::vec4& lightmapScaleOffset)
+{
+	GLintptr offset = 0;
+	OBJECT_BLOCK* pBlock = static_cast<OBJECT_BLOCK*>(
+		m_uploadRing.Allocate(sizeof(OBJECT_BLOCK), offset));
+	if (NULL == pBlock)
+	{
+		return(false);
+	}
+
+	glm::mat4 model = BuildModelMatrix(
+		object.scaleXYZ,
+		object.XrotationDegrees,
+		object.YrotationDegrees,
+		object.ZrotationDegrees,
+		object.positionXYZ);
+
+	OBJECT_BLOCK block;
+	block.model = model;
+	block.normalMatrix = glm::transpose(glm::inverse(model));
+	block.color = object.color;
+	block.lightmapScaleOffset = lightmapScaleOffset;
+	*pBlock = block;
+
+	glBindBufferRange(GL_UNIFORM_BUFFER, OBJECT_BLOCK_BINDING,
+		m_uploadRing.GetBuffer(), offset, sizeof(OBJECT_BLOCK));
+
+	return(true);
+}
+
+/***********************************************************
+ *  PrepareUploadRing()
+ *
+ *  This method is used for creating the upload ring the
+ *  first time it is needed. Every object is drawn once per
+ *  frame, and the regions keep room for twice that many.
+ ***********************************************************/
+bool SceneManager::PrepareUploadRing()
+{
+	if (m_bUploadRingFailed)
+	{
+		return(false);
+	}
+
+	GLsizeiptr objectCount = static_cast<GLsizeiptr>(m_sceneObjects.size());
+	if (objectCount < 1)
+	{
+		objectCount = 1;
+	}
+	GLsizeiptr regionSize = m_uploadRing.GetAlignedSize(sizeof(OBJECT_BLOCK)) * objectCount * 2;
+
+	// objects added after the first frame grow the regions
+	bool bReady = (m_bUploadRingReady ?
+		m_uploadRing.Reserve(regionSize) : m_uploadRing.Initialize(regionSize));
+	if (!bReady)
+	{
+		m_bUploadRingReady = false;
+		m_bUploadRingFailed = true;
+		return(false);
+	}
+	m_bUploadRingReady = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetObjectAlbedo()
+ *
+ *  This method is used for getting the color that a scene
+ *  object reflects when light bounces off it, which is the
+ *  mean color of its texture or else its object color.
+ ***********************************************************/
+glm::vec3 SceneManager::GetObjectAlbedo(const SCENE_OBJECT& object)
+{
+	glm::vec3 albedo = glm::vec3(object.color);
+	int slot = FindTextureSlot(object.textureTag);
+	if ((!object.textureTag.empty()) && (slot >= 0))
+	{
+		albedo = m_textureIDs[slot].averageColor;
+	}
+
+	return(albedo);
+}
+
+/***********************************************************
+ *  BuildRenderQueues()
+ *
+ *  This method is used for sorting the scene objects by
+ *  their distance along the view direction. Opaque objects
+ *  are drawn front to back so that hidden fragments fail
+ *  the depth test early, and transparent objects back to
+ *  front so that they blend in the right order.
+ ***********************************************************/
+void SceneManager::BuildRenderQueues()
+{
+	m_opaqueQueue.Clear();
+	m_transparentQueue.Clear();
+	CullModelMeshlets();
+
+	// the GPU culls the opaque objects when it draws them
+	size_t objectCount = (m_bIndirectDraws ? m_cpuDrawnObjects.size() : m_sceneObjects.size());
+	for (size_t n = 0; n < objectCount; n++)
+	{
+		size_t i = (m_bIndirectDraws ? static_cast<size_t>(m_cpuDrawnObjects[n]) : n);
+		SCENE_OBJECT& object = m_sceneObjects[i];
+		// batched objects are drawn with their batch
+		if ((g_RenderSettings.bUseStaticBatching) && (object.batchIndex >= 0))
+		{
+			continue;
+		}
+		// a model with no visible meshlets is left out
+		if ((object.meshletList >= 0) && (m_meshletDrawLists[object.meshletList].counts.empty()))
+		{
+			continue;
+		}
+
+		glm::mat4 model = BuildModelMatrix(
+			object.scaleXYZ,
+			object.XrotationDegrees,
+			object.YrotationDegrees,
+			object.ZrotationDegrees,
+			object.positionXYZ);
+		glm::vec3 worldCenter = glm::vec3(model * glm::vec4(GetObjectMeshCenter(object), 1.0f));
+		// an object behind the occluders of a recent frame is
+		// left out before any of it is shaded, unless it is
+		// drawn into the pyramid itself
+		bool bOccluder = ((object.batchIndex >= 0) && (m_staticBatches[object.batchIndex].bOccluder));
+		if ((m_bOcclusionCulling) && (!bOccluder))
+		{
+			glm::vec3 corners[8];
+			GetObjectCorners(object, corners);
+			if (m_hiZBuffer.IsBoxHidden(corners))
+			{
+				continue;
+			}
+		}
+		glm::vec4 center = m_viewMatrix * glm::vec4(worldCenter, 1.0f);
+
+		if (g_RenderSettings.bUseLod)
+		{
+			object.lodLevel = SelectLodLevel(object, glm::length(glm::vec3(center)));
+		}
+
+		// the camera looks down the negative Z axis
+		if (object.bTransparent)
+		{
+			m_transparentQueue.Add(static_cast<uint32_t>(i), -center.z);
+		}
+		else
+		{
+			m_opaqueQueue.Add(static_cast<uint32_t>(i), -center.z);
+		}
+	}
+
+	m_opaqueQueue.Sort(RenderQueue::SORT_FRONT_TO_BACK);
+	// the weighted blended mode does not depend on the order
+	if (!g_RenderSettings.bUseOIT)
+	{
+		m_transparentQueue.Sort(RenderQueue::SORT_BACK_TO_FRONT);
+	}
+}
+
+/***********************************************************
+ *  CullModelMeshlets()
+ *
+ *  This method is used for finding the meshlets of the
+ *  drawn models that are inside the view and face the
+ *  camera. The lists are only kept for the models that
+ *  have meshlets, the other objects draw the whole mesh.
+ ***********************************************************/
+void SceneManager::CullModelMeshlets()
+{
+	m_meshletJobs.clear();
+	glm::mat4 viewProjection = m_projectionMatrix * m_viewMatrix;
+	// back faces are hidden behind the front faces of opaque
+	// models, and the cone test needs a camera position
+	bool bPerspective = (m_projectionMatrix[2][3] != 0.0f);
+
+	// the objects drawn indirectly are never drawn in ranges
+	size_t objectCount = (m_bIndirectDraws ? m_cpuDrawnObjects.size() : m_sceneObjects.size());
+	for (size_t n = 0; n < objectCount; n++)
+	{
+		SCENE_OBJECT& object = m_sceneObjects[m_bIndirectDraws ? m_cpuDrawnObjects[n] : n];
+		object.meshletList = -1;
+		if ((!g_RenderSettings.bUseMeshletCulling) ||
+			(object.modelIndex < 0) ||
+			(m_models[object.modelIndex].meshlets.empty()))
+		{
+			continue;
+		}
+
+		object.meshletList = static_cast<int>(m_meshletJobs.size());
+
+		MESHLET_CULL_JOB job;
+		job.pMeshlets = &m_models[object.modelIndex].meshlets;
+		job.pDrawList = NULL;
+		SetupMeshletCullView(
+			viewProjection,
+			BuildModelMatrix(
+				object.scaleXYZ,
+				object.XrotationDegrees,
+				object.YrotationDegrees,
+				object.ZrotationDegrees,
+				object.positionXYZ),
+			m_viewPosition,
+			(bPerspective) && (!object.bTransparent),
+			job.view);
+		m_meshletJobs.push_back(job);
+	}
+
+	if (m_meshletJobs.empty())
+	{
+		return;
+	}
+
+	// the lists only grow, so they are pointed to once they
+	// are all in place
+	if (m_meshletDrawLists.size() < m_meshletJobs.size())
+	{
+		m_meshletDrawLists.resize(m_meshletJobs.size());
+	}
+	for (size_t i = 0; i < m_meshletJobs.size(); i++)
+	{
+		m_meshletJobs[i].pDrawList = &m_meshletDrawLists[i];
+	}
+	CullMeshlets(m_meshletJobs);
+}
+
+/***********************************************************
+ *  SelectLodLevel()
+ *
+ *  This method is used for choosing the level of detail of
+ *  an object from the projected size of its bounding sphere
+ *  as a share of the screen height. The level only moves
+ *  once the size is clearly past a threshold, so an object
+ *  resting near one does not switch back and forth.
+ ***********************************************************/
+int SceneManager::SelectLodLevel(const SCENE_OBJECT& object, float viewDistance) const
+{
+	int lodCount = ((object.modelIndex >= 0) ? 1 : m_meshLodCounts[object.mesh]);
+	if (lodCount <= 1)
+	{
+		return(0);
+	}
+
+	float scale = glm::max(
+		glm::abs(object.scaleXYZ.x),
+		glm::max(glm::abs(object.scaleXYZ.y), glm::abs(object.scaleXYZ.z)));
+	float radius = m_meshRadii[object.mesh] * scale;
+
+	// [1][1] is the cotangent of half the field of view, or one
+	// over the half height for an orthographic projection,
+	// which has no perspective divide
+	float coverage = radius * m_projectionMatrix[1][1];
+	if (m_projectionMatrix[2][3] != 0.0f)
+	{
+		coverage /= glm::max(viewDistance, radius);
+	}
+
+	int lod = glm::clamp(object.lodLevel, 0, lodCount - 1);
+	while ((lod > 0) &&
+		(coverage > LOD_COVERAGE[lod - 1] * (1.0f + LOD_HYSTERESIS)))
+	{
+		lod--;
+	}
+	while ((lod < lodCount - 1) &&
+		(coverage < LOD_COVERAGE[lod] * (1.0f - LOD_HYSTERESIS)))
+	{
+		lod++;
+	}
+
+	return(lod);
+}
+
+/***********************************************************
+ *  DrawRenderQueue()
+ *
+ *  This method is used for drawing the queued objects.
+ ***********************************************************/
+void SceneManager::DrawRenderQueue(const RenderQueue& queue, bool bBakedLighting)
+{
+	for (const DRAW_ITEM& item : queue.GetItems())
+	{
+		DrawSceneObject(m_sceneObjects[item.objectIndex], bBakedLighting);
+	}
+}
+
+/***********************************************************
+ *  BuildStaticBatches()
+ *
+ *  This method is used for grouping the opaque static
+ *  objects that share a texture, or a color when they have
+ *  none, and their lighting, and whose centers lie in the
+ *  same cell of space. Groups of one object are left to be
+ *  drawn alone so they keep their level of detail.
+ ***********************************************************/
+void SceneManager::BuildStaticBatches()
+{
+	DestroyStaticBatches();
+
+	// first object of each appearance, and the batch of each
+	// appearance and cell
+	std::vector<int> appearances;
+	std::map<std::tuple<int, int, int, int>, int> cellBatches;
+
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		SCENE_OBJECT& object = m_sceneObjects[i];
+		object.batchIndex = -1;
+		// the models have no lightmap UVs to merge
+		if ((!object.bStatic) || (object.bTransparent) || (object.modelIndex >= 0))
+		{
+			continue;
+		}
+
+		int appearance = -1;
+		for (size_t a = 0; a < appearances.size(); a++)
+		{
+			const SCENE_OBJECT& shared = m_sceneObjects[appearances[a]];
+			if ((shared.textureTag == object.textureTag) &&
+				(shared.bUseLighting == object.bUseLighting) &&
+				((!object.textureTag.empty()) || (shared.color == object.color)))
+			{
+				appearance = static_cast<int>(a);
+				break;
+			}
+		}
+		if (appearance < 0)
+		{
+			appearance = static_cast<int>(appearances.size());
+			appearances.push_back(static_cast<int>(i));
+		}
+
+		// the cells are centered on the origin, so the room of
+		// the scene fits into one
+		glm::vec3 center = glm::vec3(BuildModelMatrix(
+			object.scaleXYZ,
+			object.XrotationDegrees,
+			object.YrotationDegrees,
+			object.ZrotationDegrees,
+			object.positionXYZ) * glm::vec4(GetObjectMeshCenter(object), 1.0f));
+		std::tuple<int, int, int, int> key(appearance,
+			static_cast<int>(floor(center.x / STATIC_BATCH_CELL_SIZE + 0.5f)),
+			static_cast<int>(floor(center.y / STATIC_BATCH_CELL_SIZE + 0.5f)),
+			static_cast<int>(floor(center.z / STATIC_BATCH_CELL_SIZE + 0.5f)));
+
+		std::map<std::tuple<int, int, int, int>, int>::const_iterator found = cellBatches.find(key);
+		if (found != cellBatches.end())
+		{
+			object.batchIndex = found->second;
+		}
+		else
+		{
+			STATIC_BATCH batch;
+			batch.object = object;
+			batch.object.tag = "Static Batch";
+			batch.object.scaleXYZ = glm::vec3(1.0f);
+			batch.object.XrotationDegrees = 0.0f;
+			batch.object.YrotationDegrees = 0.0f;
+			batch.object.ZrotationDegrees = 0.0f;
+			batch.object.positionXYZ = glm::vec3(0.0f);
+			batch.object.lodLevel = 0;
+			batch.boundsMin = glm::vec3(0.0f);
+			batch.boundsMax = glm::vec3(0.0f);
+			batch.bOccluder = false;
+			batch.bDirty = true;
+			m_staticBatches.push_back(batch);
+			object.batchIndex = static_cast<int>(m_staticBatches.size() - 1);
+			cellBatches[key] = object.batchIndex;
+		}
+		m_staticBatches[object.batchIndex].objectIndices.push_back(static_cast<int>(i));
+	}
+
+	// drop the groups of one object and renumber the others
+	std::vector<STATIC_BATCH> batches;
+	for (STATIC_BATCH& batch : m_staticBatches)
+	{
+		for (int index : batch.objectIndices)
+		{
+			m_sceneObjects[index].batchIndex =
+				((batch.objectIndices.size() > 1) ? static_cast<int>(batches.size()) : -1);
+		}
+		if (batch.objectIndices.size() > 1)
+		{
+			batches.push_back(batch);
+		}
+	}
+	m_staticBatches.swap(batches);
+	m_bGPUSceneDirty = true;
+}
+
+/***********************************************************
+ *  UpdateStaticBatches()
+ *
+ *  This method is used for merging the objects of each
+ *  changed batch into one mesh in world space. The lightmap
+ *  UVs are moved into the tiles of the objects, so one draw
+ *  covers every tile of the batch.
+ ***********************************************************/
+void SceneManager::UpdateStaticBatches()
+{
+	for (STATIC_BATCH& batch : m_staticBatches)
+	{
+		if (!batch.bDirty)
+		{
+			continue;
+		}
+		PrepareMeshData();
+
+		MESH_DATA merged;
+		bool bLightmapped = true;
+		batch.boundsMin = glm::vec3(FLT_MAX);
+		batch.boundsMax = glm::vec3(-FLT_MAX);
+		for (int index : batch.objectIndices)
+		{
+			const SCENE_OBJECT& object = m_sceneObjects[index];
+			glm::vec3 corners[8];
+			GetObjectCorners(object, corners);
+			for (int c = 0; c < 8; c++)
+			{
+				batch.boundsMin = glm::min(batch.boundsMin, corners[c]);
+				batch.boundsMax = glm::max(batch.boundsMax, corners[c]);
+			}
+			glm::vec4 lightmapScaleOffset(1.0f, 1.0f, 0.0f, 0.0f);
+			if ((m_bLightmapReady) && (object.lightmapIndex >= 0))
+			{
+				lightmapScaleOffset = m_lightmapBaker.GetScaleOffset(object.lightmapIndex);
+			}
+			else
+			{
+				bLightmapped = false;
+			}
+
+			AppendTransformedMesh(
+				GetMeshView(GetObjectMeshData(object)),
+				BuildModelMatrix(
+					object.scaleXYZ,
+					object.XrotationDegrees,
+					object.YrotationDegrees,
+					object.ZrotationDegrees,
+					object.positionXYZ),
+				lightmapScaleOffset,
+				merged);
+		}
+
+		// the tiles are already applied, the flag only enables
+		// the lightmap when baked lighting is active
+		batch.object.lightmapIndex = (bLightmapped ? 0 : -1);
+		UploadGLMesh(GetMeshView(merged), batch.glMesh, m_bCompactMeshes);
+		batch.bDirty = false;
+	}
+}
+
+/***********************************************************
+ *  DrawStaticBatches()
+ *
+ *  This method is used for drawing the merged static
+ *  objects, one draw for each batch in view that is not
+ *  hidden behind the occluders of a recent frame.
+ ***********************************************************/
+void SceneManager::DrawStaticBatches(bool bBakedLighting)
+{
+	if (!g_RenderSettings.bUseStaticBatching)
+	{
+		return;
+	}
+
+	glm::mat4 viewProjection = m_projectionMatrix * m_viewMatrix;
+	for (const STATIC_BATCH& batch : m_staticBatches)
+	{
+		if (IsBoxOutsideFrustum(viewProjection, batch.boundsMin, batch.boundsMax))
+		{
+			continue;
+		}
+		if ((m_bOcclusionCulling) && (!batch.bOccluder))
+		{
+			glm::vec3 corners[8];
+			GetBoxCorners(batch.boundsMin, batch.boundsMax, corners);
+			if (m_hiZBuffer.IsBoxHidden(corners))
+			{
+				continue;
+			}
+		}
+		bool bLightmapped = ((bBakedLighting) && (batch.object.lightmapIndex >= 0));
+		DrawObjectMesh(batch.object, batch.glMesh, bLightmapped, glm::vec4(1.0f, 1.0f, 0.0f, 0.0f));
+	}
+}
+
+/***********************************************************
+ *  DestroyStaticBatches()
+ *
+ *  This method is used for freeing the merged meshes.
+ ***********************************************************/
+void SceneManager::DestroyStaticBatches()
+{
+	for (STATIC_BATCH& batch : m_staticBatches)
+	{
+		DestroyGLMesh(batch.glMesh);
+	}
+	m_staticBatches.clear();
+}
+
+/***********************************************************
+ *  SetObjectTransform()
+ *
+ *  This method is used for moving a scene object. Only the
+ *  static batch holding the object is merged again.
+ ***********************************************************/
+void SceneManager::SetObjectTransform(
+	int objectIndex,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	if ((objectIndex < 0) || (objectIndex >= static_cast<int>(m_sceneObjects.size())))
+	{
+		return;
+	}
+
+	SCENE_OBJECT& object = m_sceneObjects[objectIndex];
+	object.scaleXYZ = scaleXYZ;
+	object.XrotationDegrees = XrotationDegrees;
+	object.YrotationDegrees = YrotationDegrees;
+	object.ZrotationDegrees = ZrotationDegrees;
+	object.positionXYZ = positionXYZ;
+
+	if (object.batchIndex >= 0)
+	{
+		m_staticBatches[object.batchIndex].bDirty = true;
+	}
+	if ((m_bGPUCullingReady) && (object.gpuRecord >= 0) && (!m_bGPUSceneDirty))
+	{
+		m_gpuCuller.UpdateObject(static_cast<uint32_t>(object.gpuRecord), BuildGPUObject(object));
+	}
+}
+
+/***********************************************************
+ *  PrepareGPUCulling()
+ *
+ *  This method is used for loading the culling shader the
+ *  first time it is needed. The level thresholds are the
+ *  same ones the CPU selection uses.
+ ***********************************************************/
+bool SceneManager::PrepareGPUCulling()
+{
+	if (m_bGPUCullingReady)
+	{
+		return(true);
+	}
+	if (m_bGPUCullingFailed)
+	{
+		return(false);
+	}
+
+	if (!m_gpuCuller.Initialize())
+	{
+		m_bGPUCullingFailed = true;
+		g_GLState.UseProgram(m_pShaderManager->m_programID);
+		return(false);
+	}
+	m_gpuCuller.SetLodThresholds(LOD_COVERAGE, MESH_LOD_COUNT - 1, LOD_HYSTERESIS);
+
+	g_GLState.UseProgram(m_pShaderManager->m_programID);
+	m_bGPUSceneDirty = true;
+	m_bGPUCullingReady = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  BuildGPUScene()
+ *
+ *  This method is used for uploading the opaque objects
+ *  that are not drawn with a static batch. Objects that
+ *  share a mesh, a texture, their lighting and whether they
+ *  are lightmapped go into the same draw groups, one group
+ *  for each level of detail of the mesh.
+ ***********************************************************/
+void SceneManager::BuildGPUScene()
+{
+	m_indirectGroups.clear();
+	m_cpuDrawnObjects.clear();
+	std::vector<GPU_OBJECT> records;
+	std::vector<GPU_DRAW_GROUP> groups;
+
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		SCENE_OBJECT& object = m_sceneObjects[i];
+		object.gpuRecord = -1;
+		object.gpuGroup = -1;
+		// blended objects keep their sorted order on the CPU
+		if (object.bTransparent)
+		{
+			m_cpuDrawnObjects.push_back(static_cast<int>(i));
+			continue;
+		}
+		if ((g_RenderSettings.bUseStaticBatching) && (object.batchIndex >= 0))
+		{
+			continue;
+		}
+
+		int lodCount = ((object.modelIndex >= 0) ? 1 : m_meshLodCounts[object.mesh]);
+		if (lodCount < 1)
+		{
+			continue;
+		}
+
+		for (size_t g = 0; g < m_indirectGroups.size(); g++)
+		{
+			const INDIRECT_GROUP& group = m_indirectGroups[g];
+			const SCENE_OBJECT& shared = group.object;
+			if ((group.lod == 0) &&
+				(shared.modelIndex == object.modelIndex) &&
+				(shared.mesh == object.mesh) &&
+				(shared.textureTag == object.textureTag) &&
+				(shared.bUseLighting == object.bUseLighting) &&
+				((shared.lightmapIndex >= 0) == (object.lightmapIndex >= 0)))
+			{
+				object.gpuGroup = static_cast<int>(g);
+				break;
+			}
+		}
+
+		if (object.gpuGroup < 0)
+		{
+			object.gpuGroup = static_cast<int>(m_indirectGroups.size());
+			for (int lod = 0; lod < lodCount; lod++)
+			{
+				INDIRECT_GROUP group;
+				group.object = object;
+				group.object.tag = "Indirect Group";
+				group.lod = lod;
+				m_indirectGroups.push_back(group);
+
+				GPU_DRAW_GROUP drawGroup;
+				drawGroup.indexCount = static_cast<uint32_t>(GetObjectGLMesh(object, lod).nIndices);
+				drawGroup.firstCommand = 0;
+				groups.push_back(drawGroup);
+			}
+		}
+
+		// the first command of each group counts its objects
+		// until the slots are laid out below
+		for (int lod = 0; lod < lodCount; lod++)
+		{
+			groups[object.gpuGroup + lod].firstCommand++;
+		}
+		object.gpuRecord = static_cast<int>(records.size());
+		records.push_back(BuildGPUObject(object));
+	}
+
+	// every object has a slot in the group of each of its
+	// levels, so no group can run out of room
+	uint32_t commandCount = 0;
+	for (GPU_DRAW_GROUP& drawGroup : groups)
+	{
+		uint32_t slotCount = drawGroup.firstCommand;
+		drawGroup.firstCommand = commandCount;
+		commandCount += slotCount;
+	}
+
+	m_gpuCuller.SetScene(records, groups, commandCount);
+	m_bGPUSceneBatched = g_RenderSettings.bUseStaticBatching;
+	m_bGPUSceneDirty = false;
+
+	std::cout << "GPU culling holds " << records.size() << " objects in "
+		<< groups.size() << " draw groups" << std::endl;
+}
+
+/***********************************************************
+ *  BuildGPUObject()
+ *
+ *  This method is used for getting the values of an object
+ *  that the culling and scene shaders read from storage.
+ ***********************************************************/
+GPU_OBJECT SceneManager::BuildGPUObject(const SCENE_OBJECT& object) const
+{
+	glm::mat4 model = BuildModelMatrix(
+		object.scaleXYZ,
+		object.XrotationDegrees,
+		object.YrotationDegrees,
+		object.ZrotationDegrees,
+		object.positionXYZ);
+
+	GPU_OBJECT record;
+	record.model = model;
+	record.normalMatrix = glm::transpose(glm::inverse(model));
+	record.color = object.color;
+	record.lightmapScaleOffset = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+	if ((m_bLightmapReady) && (object.lightmapIndex >= 0))
+	{
+		record.lightmapScaleOffset = m_lightmapBaker.GetScaleOffset(object.lightmapIndex);
+	}
+	record.bounds = glm::vec4(
+		glm::vec3(model * glm::vec4(GetObjectMeshCenter(object), 1.0f)), GetObjectRadius(object));
+	record.boxCenter = glm::vec4(GetObjectMeshCenter(object), 0.0f);
+	record.boxExtents = glm::vec4(GetObjectMeshExtents(object), 0.0f);
+	record.firstGroup = static_cast<uint32_t>(object.gpuGroup);
+	record.lodCount = static_cast<uint32_t>((object.modelIndex >= 0) ? 1 : m_meshLodCounts[object.mesh]);
+	record.lodLevel = 0;
+	record.padding = 0;
+
+	return(record);
+}
+
+/***********************************************************
+ *  DrawIndirectGroups()
+ *
+ *  This method is used for drawing the commands that the
+ *  culling shader wrote, one indirect call for each group.
+ *  The shaders read the transform, color and lightmap tile
+ *  of every object from storage.
+ ***********************************************************/
+void SceneManager::DrawIndirectGroups(bool bBakedLighting)
+{
+	for (size_t i = 0; i < m_indirectGroups.size(); i++)
+	{
+		const INDIRECT_GROUP& group = m_indirectGroups[i];
+		const SCENE_OBJECT& object = group.object;
+		const GL_MESH& glMesh = GetObjectGLMesh(object, group.lod);
+		if (glMesh.vao == 0)
+		{
+			continue;
+		}
+		bool bLightmapped = ((bBakedLighting) && (object.lightmapIndex >= 0));
+
+		if (m_bSelectVariants)
+		{
+			SelectObjectVariant(object, bLightmapped);
+		}
+		m_pShaderManager->setBoolValue(g_UseLightingName, object.bUseLighting);
+		m_pShaderManager->setBoolValue(g_UseOITName, false);
+		m_pShaderManager->setBoolValue(g_UseObjectStorageName, true);
+
+		if (!object.textureTag.empty())
+		{
+			SetShaderTexture(object.textureTag);
+		}
+		else
+		{
+			m_pShaderManager->setBoolValue(g_UseTextureName, false);
+		}
+
+		m_pShaderManager->setVec3Value(g_PositionDecodeOffsetName, glMesh.decodeOffset);
+		m_pShaderManager->setVec3Value(g_PositionDecodeScaleName, glMesh.decodeScale);
+		m_pShaderManager->setBoolValue(g_UseLightmapName, bLightmapped);
+
+		g_GLState.BindVertexArray(glMesh.vao);
+		m_gpuCuller.DrawGroup(static_cast<uint32_t>(i));
+
+		m_pShaderManager->setBoolValue(g_UseLightmapName, false);
+		m_pShaderManager->setBoolValue(g_UseObjectStorageName, false);
+	}
+}
+
+/***********************************************************
+ *  PrepareOcclusionCulling()
+ *
+ *  This method is used for creating the occluder target and
+ *  the depth pyramid the first time they are needed.
+ ***********************************************************/
+bool SceneManager::PrepareOcclusionCulling()
+{
+	if (m_bHiZReady)
+	{
+		return(true);
+	}
+	if (m_bHiZFailed)
+	{
+		return(false);
+	}
+
+	if (!m_hiZBuffer.Initialize())
+	{
+		m_bHiZFailed = true;
+		g_GLState.UseProgram(m_pShaderManager->m_programID);
+		return(false);
+	}
+
+	g_GLState.UseProgram(m_pShaderManager->m_programID);
+	m_bHiZReady = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsObjectOccluded()
+ *
+ *  This method is used for testing one object against the
+ *  depth pyramid copied back from a recent frame, the same
+ *  way the render queues are built.
+ ***********************************************************/
+bool SceneManager::IsObjectOccluded(const std::string& tag) const
+{
+	if (!m_bOcclusionCulling)
+	{
+		return(false);
+	}
+
+	for (const SCENE_OBJECT& object : m_sceneObjects)
+	{
+		if (object.tag == tag)
+		{
+			glm::vec3 corners[8];
+			GetObjectCorners(object, corners);
+			return(m_hiZBuffer.IsBoxHidden(corners));
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  DrawOccluders()
+ *
+ *  This method is used for drawing the depth of the nearest
+ *  large static batches in view with the camera of this
+ *  frame and building the pyramid from it. The merged meshes
+ *  are drawn with one call each, and at most a fixed number
+ *  of them, so the pass costs the same however many objects
+ *  the scene holds. The objects drawn alone are never
+ *  occluders, since they are the ones tested.
+ ***********************************************************/
+void SceneManager::DrawOccluders()
+{
+	// the merged meshes are also needed when the objects
+	// themselves are drawn one by one
+	UpdateStaticBatches();
+
+	glm::mat4 viewProjection = m_projectionMatrix * m_viewMatrix;
+	m_occluderBatches.clear();
+	for (size_t b = 0; b < m_staticBatches.size(); b++)
+	{
+		STATIC_BATCH& batch = m_staticBatches[b];
+		batch.bOccluder = false;
+		if ((glm::length(batch.boundsMax - batch.boundsMin) * 0.5f < OCCLUDER_MIN_RADIUS) ||
+			(IsBoxOutsideFrustum(viewProjection, batch.boundsMin, batch.boundsMax)))
+		{
+			continue;
+		}
+
+		// distance from the camera to the nearest point of the box
+		glm::vec3 nearest = glm::max(batch.boundsMin, glm::min(m_viewPosition, batch.boundsMax));
+		m_occluderBatches.push_back(std::make_pair(glm::length(nearest - m_viewPosition), static_cast<int>(b)));
+	}
+	if (m_occluderBatches.size() > OCCLUDER_BUDGET)
+	{
+		std::partial_sort(m_occluderBatches.begin(),
+			m_occluderBatches.begin() + OCCLUDER_BUDGET, m_occluderBatches.end());
+		m_occluderBatches.resize(OCCLUDER_BUDGET);
+	}
+
+	ShaderManager* pShader = m_hiZBuffer.GetOccluderShader();
+	m_hiZBuffer.BeginOccluderPass();
+	// the merged meshes are already in world space
+	pShader->setMat4Value(g_ModelName, glm::mat4(1.0f));
+	for (const std::pair<float, int>& occluder : m_occluderBatches)
+	{
+		STATIC_BATCH& batch = m_staticBatches[occluder.second];
+		batch.bOccluder = true;
+		pShader->setVec3Value(g_PositionDecodeOffsetName, batch.glMesh.decodeOffset);
+		pShader->setVec3Value(g_PositionDecodeScaleName, batch.glMesh.decodeScale);
+		DrawGLMesh(batch.glMesh);
+	}
+	m_hiZBuffer.EndOccluderPass(m_projectionMatrix * m_viewMatrix, m_pShaderManager->m_programID);
+}
+
+/***********************************************************
+ *  DrawTransparentPass()
+ *
+ *  This method is used for blending the sorted transparent
+ *  objects over the scene. They are tested against the
+ *  depth of the opaque objects but do not write depth, so
+ *  they never hide each other.
+ ***********************************************************/
+void SceneManager::DrawTransparentPass(bool bBakedLighting)
+{
+	if (m_transparentQueue.IsEmpty())
+	{
+		return;
+	}
+
+	if (g_RenderSettings.bUseOIT)
+	{
+		if ((PrepareOIT()) && (m_oitRenderer.BeginTransparentPass()))
+		{
+			m_bOITPass = true;
+			DrawRenderQueue(m_transparentQueue, bBakedLighting);
+			m_bOITPass = false;
+
+			// the composite changes the active shader
+			m_oitRenderer.Composite();
+			m_pShaderManager = m_pForwardShader;
+			g_GLState.UseProgram(m_pShaderManager->m_programID);
+			return;
+		}
+		// the queue is unsorted this frame, sort it now
+		g_RenderSettings.bUseOIT = false;
+		m_transparentQueue.Sort(RenderQueue::SORT_BACK_TO_FRONT);
+	}
+
+	g_GLState.Enable(GL_BLEND);
+	g_GLState.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	g_GLState.DepthMask(GL_FALSE);
+	DrawRenderQueue(m_transparentQueue, bBakedLighting);
+	g_GLState.DepthMask(GL_TRUE);
+}
+
+/***********************************************************
+ *  PrepareOIT()
+ *
+ *  This method is used for loading the weighted blended
+ *  transparency resources the first time they are needed.
+ ***********************************************************/
+bool SceneManager::PrepareOIT()
+{
+	if (m_bOITReady)
+	{
+		return(true);
+	}
+	if (m_bOITFailed)
+	{
+		return(false);
+	}
+
+	if (!m_oitRenderer.Initialize())
+	{
+		m_bOITFailed = true;
+		g_GLState.UseProgram(m_pShaderManager->m_programID);
+		return(false);
+	}
+
+	g_GLState.UseProgram(m_pShaderManager->m_programID);
+	m_bOITReady = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  PrepareMeshes()
+ *
+ *  This method is used for uploading the basic shapes. They
+ *  come straight from the mapped mesh cache, so the shapes
+ *  are only generated when the cache is missing or was
+ *  written by other generator settings.
+ ***********************************************************/
+void SceneManager::PrepareMeshes()
+{
+	const int meshCount = MESH_TYPE_COUNT * MESH_LOD_COUNT;
+	if ((!m_meshCache.Open(g_MeshCacheFile, MESH_GENERATOR_KEY)) ||
+		(m_meshCache.GetMeshCount() != meshCount))
+	{
+		m_meshCache.Close();
+		PrepareMeshData();
+		MeshCache::Write(g_MeshCacheFile, MESH_GENERATOR_KEY, &m_meshData[0][0], meshCount);
+	}
+
+	UploadMeshes();
+}
+
+/***********************************************************
+ *  UploadMeshes()
+ *
+ *  This method is used for uploading every level of the
+ *  basic shapes in the vertex layout of the settings. It is
+ *  called again whenever the layout is switched, which
+ *  replaces the buffers of the other layout.
+ ***********************************************************/
+void SceneManager::UploadMeshes()
+{
+	m_bCompactMeshes = g_RenderSettings.bUseCompactVertices;
+	GLsizeiptr vertexBytes = 0;
+
+	for (STATIC_BATCH& batch : m_staticBatches)
+	{
+		batch.bDirty = true;
+	}
+	// the levels of the shapes size the draw groups
+	m_bGPUSceneDirty = true;
+
+	for (int i = 0; i < MESH_TYPE_COUNT; i++)
+	{
+		m_meshLodCounts[i] = 0;
+		for (int lod = 0; lod < MESH_LOD_COUNT; lod++)
+		{
+			MESH_VIEW view;
+			if (!m_meshCache.GetMesh(i * MESH_LOD_COUNT + lod, view))
+			{
+				view = GetMeshView(m_meshData[i][lod]);
+			}
+			// the levels are used from the first up to the
+			// first one that is missing
+			if (!UploadGLMesh(view, m_glMeshes[i][lod], m_bCompactMeshes))
+			{
+				break;
+			}
+			m_meshLodCounts[i]++;
+			vertexBytes += m_glMeshes[i][lod].vertexBytes;
+
+			if (lod == 0)
+			{
+				glm::vec3 boundsMin;
+				glm::vec3 boundsMax;
+				ComputeMeshBounds(view, boundsMin, boundsMax);
+				m_meshCenters[i] = (boundsMin + boundsMax) * 0.5f;
+				m_meshRadii[i] = glm::length(boundsMax - boundsMin) * 0.5f;
+				m_meshExtents[i] = (boundsMax - boundsMin) * 0.5f;
+			}
+		}
+	}
+
+	for (IMPORTED_MODEL& model : m_models)
+	{
+		UploadGLMesh(GetMeshView(model.meshData), model.glMesh, m_bCompactMeshes);
+		vertexBytes += model.glMesh.vertexBytes;
+	}
+
+	std::cout << "Uploaded meshes: " << (vertexBytes / 1024) << " KB of vertices in the "
+		<< (m_bCompactMeshes ? "compact" : "float") << " layout" << std::endl;
+}
+
+/***********************************************************
+ *  PrepareMeshData()
+ *
+ *  This method is used for filling the CPU copies of the
+ *  basic shapes that the lighting bakers and the static
+ *  batches read, copied from the mapped cache or generated
+ *  when there is none.
+ ***********************************************************/
+void SceneManager::PrepareMeshData()
+{
+	if (m_bMeshDataReady)
+	{
+		return;
+	}
+
+	if (m_meshCache.GetMeshCount() == MESH_TYPE_COUNT * MESH_LOD_COUNT)
+	{
+		for (int i = 0; i < MESH_TYPE_COUNT; i++)
+		{
+			for (int lod = 0; lod < MESH_LOD_COUNT; lod++)
+			{
+				MESH_VIEW view;
+				m_meshCache.GetMesh(i * MESH_LOD_COUNT + lod, view);
+				CopyMeshView(view, m_meshData[i][lod]);
+			}
+		}
+	}
+	else
+	{
+		BuildPlaneMesh(m_meshData[MESH_PLANE][0]);
+		BuildBoxMesh(m_meshData[MESH_BOX][0]);
+		for (int lod = 0; lod < MESH_LOD_COUNT; lod++)
+		{
+			BuildCylinderMesh(m_meshData[MESH_CYLINDER][lod], LOD_SLICES[lod]);
+			BuildTorusMesh(m_meshData[MESH_TORUS][lod], LOD_TORUS_SEGMENTS[lod], LOD_TORUS_SEGMENTS[lod]);
+			BuildSphereMesh(m_meshData[MESH_SPHERE][lod], LOD_STACKS[lod], LOD_SLICES[lod]);
+			BuildHalfSphereMesh(m_meshData[MESH_HALF_SPHERE][lod], LOD_HALF_STACKS[lod], LOD_SLICES[lod]);
+		}
+
+		// the generators emit the triangles ring by ring, so they
+		// are reordered once here and the cache keeps the result
+		for (int i = 0; i < MESH_TYPE_COUNT; i++)
+		{
+			for (int lod = 0; lod < MESH_LOD_COUNT; lod++)
+			{
+				if (m_meshData[i][lod].indices.empty())
+				{
+					continue;
+				}
+				VERTEX_CACHE_STATS before;
+				VERTEX_CACHE_STATS after;
+				OptimizeMesh(m_meshData[i][lod], before, after);
+				std::cout << "Optimized mesh " << g_MeshTypeNames[i] << " level " << lod
+					<< ": ACMR " << before.acmr << " -> " << after.acmr
+					<< ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+			}
+		}
+	}
+
+	m_bMeshDataReady = true;
+}
+
+/***********************************************************
+ *  PrepareBakedLighting()
+ *
+ *  This method is used for preparing the lightmaps of the
+ *  static objects. The lightmaps are read from the cache
+ *  file when it matches the scene, otherwise they are baked
+ *  on all CPU cores and written back to the cache.
+ ***********************************************************/
+bool SceneManager::PrepareBakedLighting()
+{
+	if (m_bLightmapReady)
+	{
+		return(true);
+	}
+	if (m_bLightmapFailed)
+	{
+		return(false);
+	}
+
+	PrepareMeshData();
+	m_lightmapBaker.Clear();
+	m_lightmapBaker.SetSettings(BAKE_SETTINGS());
+
+	for (const LIGHT_SOURCE& light : m_sceneLights)
+	{
+		BAKE_LIGHT bakeLight;
+		bakeLight.position = light.position;
+		bakeLight.ambientColor = light.ambientColor;
+		bakeLight.diffuseColor = light.diffuseColor;
+		m_lightmapBaker.AddLight(bakeLight);
+	}
+
+	for (SCENE_OBJECT& object : m_sceneObjects)
+	{
+		object.lightmapIndex = -1;
+		if (!object.bStatic)
+		{
+			continue;
+		}
+
+		const MESH_DATA& meshData = GetObjectMeshData(object);
+		object.lightmapIndex = m_lightmapBaker.AddObject(
+			&meshData,
+			BuildModelMatrix(
+				object.scaleXYZ,
+				object.XrotationDegrees,
+				object.YrotationDegrees,
+				object.ZrotationDegrees,
+				object.positionXYZ),
+			GetObjectAlbedo(object),
+			object.bCastsShadows);
+		// a mesh without lightmap UVs still shadows the others
+		// but is lit dynamically itself
+		if (meshData.lightmapUVs.size() != meshData.vertices.size())
+		{
+			object.lightmapIndex = -1;
+		}
+	}
+
+	if (!m_lightmapBaker.LoadCache(g_LightmapCacheFile))
+	{
+		if (!m_lightmapBaker.Bake())
+		{
+			std::cout << "Could not bake the scene lightmaps" << std::endl;
+			m_bLightmapFailed = true;
+			return(false);
+		}
+		m_lightmapBaker.SaveCache(g_LightmapCacheFile);
+	}
+
+	glGenTextures(1, &m_lightmapTextureID);
+	g_GLState.BindTexture(LIGHTMAP_TEXTURE_UNIT, GL_TEXTURE_2D, m_lightmapTextureID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(
+		GL_TEXTURE_2D,
+		0,
+		GL_RGB16F,
+		m_lightmapBaker.GetWidth(),
+		m_lightmapBaker.GetHeight(),
+		0,
+		GL_RGB,
+		GL_FLOAT,
+		m_lightmapBaker.GetTexels().data());
+
+	m_pShaderManager->setSampler2DValue(g_LightmapTextureName, LIGHTMAP_TEXTURE_UNIT);
+	m_pShaderManager->setBoolValue(g_UseLightmapName, false);
+
+	// the batches carry the lightmap tiles in their UVs and
+	// the objects on the GPU in their values
+	for (STATIC_BATCH& batch : m_staticBatches)
+	{
+		batch.bDirty = true;
+	}
+	m_bGPUSceneDirty = true;
+
+	m_bLightmapReady = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyBakedLighting()
+ *
+ *  This method is used for freeing the lightmap texture.
+ ***********************************************************/
+void SceneManager::DestroyBakedLighting()
+{
+	if (m_lightmapTextureID != 0)
+	{
+		g_GLState.DeleteTextures(1, &m_lightmapTextureID);
+		m_lightmapTextureID = 0;
+	}
+	m_bLightmapReady = false;
+}
+
+/***********************************************************
+ *  PrepareProbeLighting()
+ *
+ *  This method is used for baking the irradiance probe grid
+ *  over the static objects and uploading it as a 3D texture.
+ *  The probes replace the flat ambient term of the lights
+ *  for every object, moving or not.
+ ***********************************************************/
+bool SceneManager::PrepareProbeLighting()
+{
+	if (m_bProbesReady)
+	{
+		return(true);
+	}
+	if (m_bProbesFailed)
+	{
+		return(false);
+	}
+
+	PrepareMeshData();
+	m_irradianceVolume.Clear();
+	m_irradianceVolume.SetSettings(PROBE_SETTINGS());
+
+	for (const LIGHT_SOURCE& light : m_sceneLights)
+	{
+		BAKE_LIGHT bakeLight;
+		bakeLight.position = light.position;
+		bakeLight.ambientColor = light.ambientColor;
+		bakeLight.diffuseColor = light.diffuseColor;
+		m_irradianceVolume.AddLight(bakeLight);
+	}
+
+	for (const SCENE_OBJECT& object : m_sceneObjects)
+	{
+		if (!object.bStatic)
+		{
+			continue;
+		}
+
+		m_irradianceVolume.AddObject(
+			&GetObjectMeshData(object),
+			BuildModelMatrix(
+				object.scaleXYZ,
+				object.XrotationDegrees,
+				object.YrotationDegrees,
+				object.ZrotationDegrees,
+				object.positionXYZ),
+			GetObjectAlbedo(object),
+			object.bCastsShadows);
+	}
+
+	if (!m_irradianceVolume.Bake())
+	{
+		std::cout << "Could not bake the irradiance probes" << std::endl;
+		m_bProbesFailed = true;
+		return(false);
+	}
+
+	std::vector<float> texels;
+	m_irradianceVolume.GetTextureData(texels);
+	glm::ivec3 dimensions = m_irradianceVolume.GetDimensions();
+
+	glGenTextures(1, &m_probeTextureID);
+	g_GLState.BindTexture(PROBE_TEXTURE_UNIT, GL_TEXTURE_3D, m_probeTextureID);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage3D(
+		GL_TEXTURE_3D,
+		0,
+		GL_RGBA16F,
+		dimensions.x,
+		dimensions.y,
+		dimensions.z * IrradianceVolume::TEXTURE_SLABS,
+		0,
+		GL_RGBA,
+		GL_FLOAT,
+		texels.data());
+
+	m_bProbesReady = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyProbeLighting()
+ *
+ *  This method is used for freeing the probe texture.
+ ***********************************************************/
+void SceneManager::DestroyProbeLighting()
+{
+	if (m_probeTextureID != 0)
+	{
+		g_GLState.DeleteTextures(1, &m_probeTextureID);
+		m_probeTextureID = 0;
+	}
+	m_bProbesReady = false;
+}
+
+/***********************************************************
+ *  GetForwardLightCount()
+ *
+ *  This method is used for getting the number of scene
+ *  lights the forward shader takes, from the first one.
+ ***********************************************************/
+int SceneManager::GetForwardLightCount() const
+{
+	return(std::min(static_cast<int>(m_sceneLights.size()), MAX_FORWARD_LIGHTS));
+}
+
+/***********************************************************
+ *  ApplyLightUniforms()
+ *
+ *  This method is used for setting the scene lights into
+ *  the given shader, which must be the active one.
+ ***********************************************************/
+void SceneManager::ApplyLightUniforms(ShaderManager* pShader)
+{
+	int lightCount = GetForwardLightCount();
+	pShader->setIntValue("lightCount", lightCount);
+
+	for (int i = 0; i < lightCount; i++)
+	{
+		std::string name = "lightSources[" + std::to_string(i) + "].";
+		pShader->setVec3Value(name + "position", m_sceneLights[i].position);
+		pShader->setVec3Value(name + "ambientColor", m_sceneLights[i].ambientColor);
+		pShader->setVec3Value(name + "diffuseColor", m_sceneLights[i].diffuseColor);
+		pShader->setVec3Value(name + "specularColor", m_sceneLights[i].specularColor);
+		pShader->setFloatValue(name + "focalStrength", m_sceneLights[i].focalStrength);
+		pShader->setFloatValue(name + "specularIntensity", m_sceneLights[i].specularIntensity);
+	}
+}
+
+/***********************************************************
+ *  ApplyProbeUniforms()
+ *
+ *  This method is used for setting the probe grid into the
+ *  given shader, which must be the active one.
+ ***********************************************************/
+void SceneManager::ApplyProbeUniforms(ShaderManager* pShader, bool bProbeLighting)
+{
+	pShader->setBoolValue(g_UseProbeLightingName, bProbeLighting);
+	if (!bProbeLighting)
+	{
+		return;
+	}
+
+	pShader->setIntValue(g_ProbeTextureName, PROBE_TEXTURE_UNIT);
+	pShader->setVec3Value(g_ProbeGridMinName, m_irradianceVolume.GetBoundsMin());
+	pShader->setVec3Value(g_ProbeGridMaxName, m_irradianceVolume.GetBoundsMax());
+	pShader->setVec3Value(g_ProbeGridDimsName, glm::vec3(m_irradianceVolume.GetDimensions()));
+}
+
+/***********************************************************
+ *  PrepareShaderPermutations()
+ *
+ *  This method is used for reading the forward shader
+ *  sources that the variants are compiled from. The light
+ *  loop of the variants is unrolled for the scene lights.
+ ***********************************************************/
+bool SceneManager::PrepareShaderPermutations()
+{
+	if (m_bPermutationsReady)
+	{
+		return(true);
+	}
+	if (m_bPermutationsFailed)
+	{
+		return(false);
+	}
+
+	if (!m_shaderPermutations.Initialize(g_VertexShaderFile, g_FragmentShaderFile))
+	{
+		m_bPermutationsFailed = true;
+		return(false);
+	}
+	m_shaderPermutations.SetLightCount(GetForwardLightCount());
+
+	m_bPermutationsReady = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  SelectShaderVariant()
+ *
+ *  This method is used for switching to the shader variant
+ *  for the feature bits. The program is only changed when
+ *  it differs from the last object, and the values shared
+ *  by the whole frame are set once per variant and frame.
+ *  The uniform-driven shader is used if a variant fails.
+ ***********************************************************/
+void SceneManager::SelectShaderVariant(unsigned int features)
+{
+	SHADER_VARIANT* pVariant = m_shaderPermutations.GetVariant(features);
+	ShaderManager* pShader = (NULL != pVariant) ? pVariant->pShader : m_pForwardShader;
+
+	if (pShader != m_pShaderManager)
+	{
+		g_GLState.UseProgram(pShader->m_programID);
+		m_pShaderManager = pShader;
+	}
+
+	if (NULL == pVariant)
+	{
+		return;
+	}
+
+	if (!pVariant->bStaticApplied)
+	{
+		ApplyLightUniforms(pShader);
+		pShader->setSampler2DValue(g_LightmapTextureName, LIGHTMAP_TEXTURE_UNIT);
+		pVariant->bStaticApplied = true;
+	}
+
+	if (pVariant->frameApplied != m_frameIndex)
+	{
+		ApplyProbeUniforms(pShader, (features & FEATURE_PROBES) != 0);
+		pShader->setBoolValue(g_UseObjectBufferName, m_bUseObjectBuffer);
+		pVariant->frameApplied = m_frameIndex;
+	}
+}
+
+/***********************************************************
+ *  PrepareDeferredShading()
+ *
+ *  This method is used for loading the deferred shaders the
+ *  first time they are needed. The values that never change
+ *  are set into them here.
+ ***********************************************************/
+bool SceneManager::PrepareDeferredShading()
+{
+	if (m_bDeferredReady)
+	{
+		return(true);
+	}
+	if (m_bDeferredFailed)
+	{
+		return(false);
+	}
+
+	if (!m_deferredRenderer.Initialize())
+	{
+		m_bDeferredFailed = true;
+		g_GLState.UseProgram(m_pShaderManager->m_programID);
+		return(false);
+	}
+
+	ShaderManager* pGeometryShader = m_deferredRenderer.GetGeometryShader();
+	g_GLState.UseProgram(pGeometryShader->m_programID);
+	pGeometryShader->setBoolValue(g_UseLightingName, true);
+	pGeometryShader->setBoolValue(g_UseLightmapName, false);
+	pGeometryShader->setSampler2DValue(g_LightmapTextureName, LIGHTMAP_TEXTURE_UNIT);
+
+	// the lighting pass takes every scene light
+	std::vector<DEFERRED_LIGHT> lights(m_sceneLights.size());
+	for (size_t i = 0; i < m_sceneLights.size(); i++)
+	{
+		lights[i].position = glm::vec4(m_sceneLights[i].position, 1.0f);
+		lights[i].ambientColor = glm::vec4(m_sceneLights[i].ambientColor, 0.0f);
+		lights[i].diffuseColor = glm::vec4(m_sceneLights[i].diffuseColor, 0.0f);
+		lights[i].specularColor = glm::vec4(m_sceneLights[i].specularColor, 0.0f);
+		lights[i].focalStrength = m_sceneLights[i].focalStrength;
+		lights[i].specularIntensity = m_sceneLights[i].specularIntensity;
+		lights[i].padding[0] = 0.0f;
+		lights[i].padding[1] = 0.0f;
+	}
+	m_deferredRenderer.SetLights(lights);
+
+	g_GLState.UseProgram(m_pShaderManager->m_programID);
+	m_bDeferredReady = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  RenderDeferred()
+ *
+ *  This method is used for drawing the opaque objects into
+ *  the G-buffer, lighting them once per pixel and then
+ *  blending the transparent objects over the result with
+ *  the forward shader.
+ ***********************************************************/
+void SceneManager::RenderDeferred(bool bBakedLighting, bool bProbeLighting)
+{
+	bool bSelectVariants = m_bSelectVariants;
+
+	// the object drawing methods set their values into
+	// whichever shader is held here
+	m_deferredRenderer.BeginGeometryPass();
+	m_pShaderManager = m_deferredRenderer.GetGeometryShader();
+	m_bSelectVariants = false;
+	m_pShaderManager->setBoolValue(g_UseObjectBufferName, m_bUseObjectBuffer);
+	DrawStaticBatches(bBakedLighting);
+	if (m_bIndirectDraws)
+	{
+		DrawIndirectGroups(bBakedLighting);
+	}
+	DrawRenderQueue(m_opaqueQueue, bBakedLighting);
+
+	ShaderManager* pLightingShader = m_deferredRenderer.GetLightingShader();
+	g_GLState.UseProgram(pLightingShader->m_programID);
+	ApplyProbeUniforms(pLightingShader, bProbeLighting);
+	m_deferredRenderer.RenderLightingPass();
+
+	m_pShaderManager = m_pForwardShader;
+	g_GLState.UseProgram(m_pShaderManager->m_programID);
+	m_bSelectVariants = bSelectVariants;
+	DrawTransparentPass(bBakedLighting);
+}
+
+/***********************************************************
+ *  SetViewTransform()
+ *
+ *  This method is used for keeping the camera of the frame
+ *  for sorting the objects. The shaders read the camera
+ *  from the block written by the view manager.
+ ***********************************************************/
+void SceneManager::SetViewTransform(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	const glm::vec3& viewPosition)
+{
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
+	m_viewPosition = viewPosition;
+}
+
+/**************************************************************/
+/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
+/*** preparing and rendering their own 3D replicated scenes.***/
+/*** Please refer to the code in the OpenGL sample project  ***/
+/*** for assistance.                                        ***/
+/**************************************************************/
+
+/***********************************************************
+  *  LoadSceneTextures()
+  *
+  *  This method is used for preparing the 3D scene by loading
+  *  the shapes, textures in memory to support the 3D scene
+  *  rendering
+  ***********************************************************/
+void SceneManager::LoadSceneTextures()
+{
+	/*** STUDENTS - add the code BELOW for loading the textures that ***/
+	/*** will be used for mapping to objects in the 3D scene. Up to  ***/
+	/*** 16 textures can be loaded per scene. Refer to the code in   ***/
+	/*** the OpenGL Sample for help.                                 ***/
+
+	bool bReturn = false;
+
+	// Keyboard
+	bReturn = CreateGLTexture(
+		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/keyboard_black.jpg", "keyboard"
+	);
+
+	// Background 1
+	bReturn = CreateGLTexture(
+		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/background.jpg", "screen"
+	);
+
+	// Background 2
+	bReturn = CreateGLTexture(
+		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/Background-1.jpg", "screen1"
+	);
+
+	// Background 3
+	bReturn = CreateGLTexture(
+		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/Background-2.jpg", "screen2"
+	);
+
+	// Desktop
+	bReturn = CreateGLTexture(
+		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/wood.jpeg", "desk"
+	);
+
+	// Outside
+	bReturn = CreateGLTexture(
+		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/Garden3.jpg", "outside"
+	);
+
+	// Cube
+	bReturn = CreateGLTexture(
+		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/Cube3.jpg", "Cube3"
+	);
+	// Cube
+	bReturn = CreateGLTexture(
+		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/Cube2.jpg", "Cube2"
+	);
+
+	// MousePad
+	bReturn = CreateGLTexture(
+		"C:/CS330Content/Projects/7-1_FinalProjectMilestones/Images/Garden2.jpeg", "Pad"
+	);
+
+	BindGLTextures();
+}
+
+
+/***********************************************************
+ *  PrepareScene()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void SceneManager::PrepareScene()
+{
+	// only one instance of a particular mesh needs to be
+	// loaded in memory no matter how many times it is drawn
+	// in the rendered 3D scene
+	PrepareMeshes();
+
+	LoadSceneTextures();
+	SetupSceneLights();
+	// the benchmarks can replace the room with a grid of desks
+	if (g_RenderSettings.stressObjects > 0)
+	{
+		DefineStressScene(g_RenderSettings.stressObjects,
+			g_RenderSettings.stressLights, g_RenderSettings.stressSeed);
+	}
+	else
+	{
+		DefineSceneObjects();
+	}
+	BuildStaticBatches();
+}
+
+/***********************************************************
+ *  SetupSceneLights()
+ *
+ *  This method is used for setting up the scene lights
+ ***********************************************************/
+void SceneManager::SetupSceneLights()
+{
+	LIGHT_SOURCE light;
+
+	// Lighting Main
+	light.position = glm::vec3(-5.0f, 14.0f, 20.0f);
+	light.ambientColor = glm::vec3(0.30f, 0.30f, 0.30f);
+	light.diffuseColor = glm::vec3(0.60f, 0.60f, 0.60f);
+	light.specularColor = glm::vec3(0.30f, 0.30f, 0.30f);
+	light.focalStrength = 64.0f;
+	light.specularIntensity = 0.2f;
+	m_sceneLights.push_back(light);
+	 
+	// Lighting Lamp
+	light.position = glm::vec3(17.0f, 8.8f, 1.5f);
+	light.ambientColor = glm::vec3(0.03f, 0.025f, 0.015f);
+	light.diffuseColor = glm::vec3(0.7f, 0.6f, 0.2f);
+	light.specularColor = glm::vec3(0.7f, 0.6f, 0.3f);
+	light.focalStrength = 0.5f;
+	light.specularIntensity = 0.3f;
+	m_sceneLights.push_back(light);
+
+	// Lighting Garden
+	light.position = glm::vec3(-25.0f, 50.0f, -14.0f);
+	light.ambientColor = glm::vec3(0.0f, 0.0f, 0.0f);
+	light.diffuseColor = glm::vec3(0.3f, 0.3f, 0.3f);
+	light.specularColor = glm::vec3(1.0f, 0.5f, 0.2f);
+	light.focalStrength = 12.0f;
+	light.specularIntensity = 0.5f;
+	m_sceneLights.push_back(light);
+
+	m_pShaderManager->setBoolValue("bUseLighting", true);
+
+	ApplyLightUniforms(m_pShaderManager);
+}
+
+/***********************************************************
+ *  DefineSceneObjects()
+ *
+ *  This method is used for defining the transformations and
+ *  the appearance of every object in the 3D scene. The
+ *  render queues decide the drawing order, so the objects
+ *  can be added in any order.
+ ***********************************************************/
+void SceneManager::DefineSceneObjects()
+{
+	int index = 0;
+
+	// ===== Desk Top =====
+	AddSceneObject("Desk Top", MESH_BOX,
+		glm::vec3(40.0f, 1.0f, 12.0f),         // size of the box
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(0.0f, 0.0f, 4.0f),
+		glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "desk");
+
+	// ===== Plate =====
+	AddSceneObject("Plate", MESH_CYLINDER,
+		glm::vec3(3.0f, 0.3f, 3.0f),           // size of the plate
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(-14.0f, 0.5f, 6.0f),
+		glm::vec4(1.0f, 1.0f, 1.0f, 0.5f));
+
+	// ===== Donut =====
+	AddSceneObject("Donut", MESH_TORUS,
+		glm::vec3(1.3f, 1.2f, 1.3f),           // size of the donut
+		90.0f, 0.0f, 0.0f,
+		glm::vec3(-14.0f, 1.3f, 6.0f),
+		glm::vec4(0.80f, 0.80f, 0.0f, 1.0f));
+
+	// ===== Monitor 1 (L) =====
+	AddSceneObject("Monitor 1", MESH_BOX,
+		glm::vec3(13.0f, 8.0f, 0.5f),          // size of monitor
+		0.0f, 10.0f, 0.0f,
+		glm::vec3(-7.0f, 8.0f, 2.0f),
+		glm::vec4(0.2f, 0.2f, 0.2f, 1.0f));
+
+	// ===== Screen 1 (L) =====
+	AddSceneObject("Screen 1", MESH_BOX,
+		glm::vec3(12.0f, 7.0f, 0.2f),          // size of screen
+		0.0f, 10.0f, 0.0f,
+		glm::vec3(-6.8f, 8.0f, 2.3f),
+		glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "screen1");
+
+	// ===== Monitor 2 (R) =====
+	AddSceneObject("Monitor 2", MESH_BOX,
+		glm::vec3(13.0f, 8.0f, 0.5f),          // size of monitor
+		0.0f, -10.0f, 0.0f,
+		glm::vec3(7.0f, 8.0f, 2.0f),
+		glm::vec4(0.2f, 0.2f, 0.2f, 1.0f));
+
+	// ===== Screen 2 (R) =====
+	AddSceneObject("Screen 2", MESH_BOX,
+		glm::vec3(12.0f, 7.0f, 0.2f),          // size of screen
+		0.0f, -10.0f, 0.0f,
+		glm::vec3(6.8f, 8.0f, 2.3f),
+		glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "screen2");
+
+	// ===== Stand 1 (L) =====
+	AddSceneObject("Stand 1", MESH_CYLINDER,
+		glm::vec3(1.0f, 10.0f, 1.0f),          // size of the stand
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(-8.0f, 0.0f, 1.0f),
+		glm::vec4(0.9f, 0.9f, 0.9f, 1.0f));
+
+	// ===== Stand 2 (R) =====
+	AddSceneObject("Stand 2", MESH_CYLINDER,
+		glm::vec3(1.0f, 10.0f, 1.0f),          // size of the stand
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(8.0f, 0.0f, 1.0f),
+		glm::vec4(0.9f, 0.9f, 0.9f, 1.0f));
+
+	// ===== Keyboard =====
+	AddSceneObject("Keyboard", MESH_BOX,
+		glm::vec3(13.0f, 1.0f, 6.0f),          // size of keyboard
+		15.0f, 0.0f, 0.0f,
+		glm::vec3(1.5f, 1.0f, 6.5f),
+		glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "keyboard");
+
+	// ===== Mouse Pad =====
+	AddSceneObject("Mouse Pad", MESH_BOX,
+		glm::vec3(5.0f, 0.5f, 5.0f),           // size of mouse pad
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(11.8f, 0.8f, 7.0f),
+		glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "Pad");
+
+	// ===== Mouse =====
+	// a half sphere unless the mouse model can be loaded
+	int mouseModel = LoadModel(g_MouseModelFile);
+	if (mouseModel >= 0)
+	{
+		AddModelObject("Mouse", mouseModel,
+			glm::vec3(1.2f, 1.0f, 2.0f),       // size of the mouse
+			0.0f, 0.0f, 0.0f,
+			glm::vec3(11.8f, 1.05f, 7.0f),
+			glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+	}
+	else
+	{
+		AddSceneObject("Mouse", MESH_HALF_SPHERE,
+			glm::vec3(1.2f, 1.0f, 2.0f),       // size of the mouse
+			0.0f, 0.0f, 0.0f,
+			glm::vec3(11.8f, 1.05f, 7.0f),
+			glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+	}
+
+	// ===== Coffee =====
+	AddSceneObject("Coffee", MESH_CYLINDER,
+		glm::vec3(1.0f, 2.5f, 1.0f),           // size of the coffee
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(-7.2f, 0.7f, 7.0f),
+		glm::vec4(0.23f, 0.16f, 0.05f, 1.0f));
+
+	// ===== Coffee Cup =====
+	AddSceneObject("Coffee Cup", MESH_CYLINDER,
+		glm::vec3(1.2f, 3.0f, 1.2f),           // size of the coffee cup
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(-7.2f, 0.5f, 7.0f),
+		glm::vec4(1.0f, 1.0f, 1.0f, 0.3f));
+
+	// ===== Outside =====
+	// the garden backdrop behind the window
+	AddSceneObject("Outside", MESH_BOX,
+		glm::vec3(100.0f, 58.0f, 0.5f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(0.0f, 20.0f, -25.0f),
+		glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "outside");
+
+	// ===== Light Base =====
+	AddSceneObject("Light Base", MESH_HALF_SPHERE,
+		glm::vec3(1.5f, 8.0f, 1.5f),           // size light base
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(17.5f, 0.5f, 2.0f),
+		glm::vec4(0.2f, 0.2f, 0.2f, 1.0f));
+
+	// ===== Light Bulb =====
+	index = AddSceneObject("Light Bulb", MESH_SPHERE,
+		glm::vec3(1.4f, 1.1f, 1.4f),           // size of the light bulb
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(17.5f, 8.5f, 2.0f),
+		glm::vec4(1.0f, 0.9f, 0.2f, 1.0f));
+	// the lamp light sits inside the bulb
+	m_sceneObjects[index].bCastsShadows = false;
+
+	// ===== Window =====
+	AddSceneObject("Window", MESH_BOX,
+		glm::vec3(52.0f, 30.0f, 1.0f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(0.0f, 20.0f, -12.0f),
+		glm::vec4(1.0f, 1.0f, 1.0f, 0.1f));
+
+	// ===== Wall 1 =====
+	// the wall segment lower
+	AddSceneObject("Wall 1", MESH_BOX,
+		glm::vec3(100.0f, 15.0f, 2.5f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(0.0f, -1.5f, -12.0f),
+		glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "Cube3");
+
+	// ===== Wall 2 =====
+	// the wall segment upper
+	AddSceneObject("Wall 2", MESH_BOX,
+		glm::vec3(100.0f, 15.0f, 2.5f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(0.0f, 41.5f, -12.0f),
+		glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "Cube3");
+
+	// ===== Wall 3 =====
+	// the wall segment left
+	AddSceneObject("Wall 3", MESH_BOX,
+		glm::vec3(25.0f, 28.0f, 2.5f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(-37.5f, 20.0f, -12.0f),
+		glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "Cube2");
+
+	// ===== Wall 4 =====
+	// the wall segment right
+	AddSceneObject("Wall 4", MESH_BOX,
+		glm::vec3(25.0f, 28.0f, 2.5f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(37.5f, 20.0f, -12.0f),
+		glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "Cube2");
+}
+
+/***********************************************************
+ *  DefineStressScene()
+ *
+ *  This method is used for filling the scene with copies of
+ *  the desk on a grid, for measuring how the rendering scales
+ *  with the number of objects and lights. Each desk is moved,
+ *  turned and scaled a little and its plain colored parts are
+ *  tinted, all drawn from the seed so a run can be repeated.
+ *  The middle desk of the front row stays where the desk of
+ *  the scene is, under the lamp light of the scene. The lamps
+ *  of the other desks add the given number of lights, the
+ *  nearest first, or one for each desk when it is negative,
+ *  and the objects do not depend on how many are lit.
+ ***********************************************************/
+void SceneManager::DefineStressScene(int objectCount, int lightCount, uint32_t seed)
+{
+	int deskCount = std::max(1, (objectCount + STRESS_DESK_PART_COUNT - 1) / STRESS_DESK_PART_COUNT);
+	int columns = static_cast<int>(ceil(sqrt(static_cast<double>(deskCount))));
+	int rows = (deskCount + columns - 1) / columns;
+	int homeDesk = columns / 2;
+
+	m_sceneObjects.reserve(m_sceneObjects.size() + static_cast<size_t>(deskCount) * STRESS_DESK_PART_COUNT);
+	m_sceneLights.reserve(m_sceneLights.size() + deskCount - 1);
+	size_t firstDeskLight = m_sceneLights.size();
+	const LIGHT_SOURCE lampLight = m_sceneLights[1];
+
+	// a half sphere unless the mouse model can be loaded
+	int mouseModel = LoadModel(g_MouseModelFile);
+
+	// xorshift never leaves a zero state
+	uint32_t state = (seed != 0) ? seed : 1;
+
+	for (int desk = 0; desk < deskCount; desk++)
+	{
+		int column = desk % columns;
+		int row = desk / columns;
+
+		// the rows go back from the desk of the scene
+		glm::vec3 offset(
+			(column - homeDesk) * STRESS_DESK_SPACING_X,
+			0.0f,
+			-row * STRESS_DESK_SPACING_Z);
+		float yaw = 0.0f;
+		float scale = 1.0f;
+		if (desk != homeDesk)
+		{
+			offset.x += (NextRandom(state) * 2.0f - 1.0f) * STRESS_MAX_OFFSET;
+			offset.z += (NextRandom(state) * 2.0f - 1.0f) * STRESS_MAX_OFFSET;
+			yaw = (NextRandom(state) * 2.0f - 1.0f) * STRESS_MAX_YAW_DEGREES;
+			scale = 1.0f + (NextRandom(state) * 2.0f - 1.0f) * STRESS_MAX_SCALE_CHANGE;
+		}
+		bool bSwapScreens = (NextRandom(state) < 0.5f);
+
+		// the desk turns around the center of its top, and the
+		// tilt of the keyboard stays around the X axis
+		const glm::vec3 deskCenter = g_StressDeskParts[0].positionXYZ;
+		glm::mat4 placement =
+			glm::translate(deskCenter + offset) *
+			glm::rotate(glm::radians(yaw), glm::vec3(0.0f, 1.0f, 0.0f)) *
+			glm::scale(glm::vec3(scale)) *
+			glm::translate(-deskCenter);
+
+		for (int i = 0; i < STRESS_DESK_PART_COUNT; i++)
+		{
+			const STRESS_PART& part = g_StressDeskParts[i];
+
+			glm::vec3 position = glm::vec3(placement * glm::vec4(part.positionXYZ, 1.0f));
+			std::string textureTag = part.textureTag;
+			if (bSwapScreens && (textureTag == "screen1"))
+			{
+				textureTag = "screen2";
+			}
+			else if (bSwapScreens && (textureTag == "screen2"))
+			{
+				textureTag = "screen1";
+			}
+			glm::vec4 color = part.color;
+			if (textureTag.empty())
+			{
+				color *= STRESS_TINTS[static_cast<int>(NextRandom(state) * STRESS_TINT_COUNT)];
+			}
+
+			int index = 0;
+			if ((i == STRESS_MOUSE_PART) && (mouseModel >= 0))
+			{
+				index = AddModelObject(part.tag, mouseModel,
+					part.scaleXYZ * scale,
+					part.XrotationDegrees, part.YrotationDegrees + yaw, part.ZrotationDegrees,
+					position, color, textureTag);
+			}
+			else
+			{
+				index = AddSceneObject(part.tag, part.mesh,
+					part.scaleXYZ * scale,
+					part.XrotationDegrees, part.YrotationDegrees + yaw, part.ZrotationDegrees,
+					position, color, textureTag);
+			}
+			// the lamp light sits inside the bulb
+			if (i == STRESS_BULB_PART)
+			{
+				m_sceneObjects[index].bCastsShadows = false;
+			}
+		}
+
+		if (desk != homeDesk)
+		{
+			LIGHT_SOURCE light = lampLight;
+			light.position = glm::vec3(placement * glm::vec4(STRESS_LAMP_POSITION, 1.0f));
+			light.diffuseColor *= 0.8f + NextRandom(state) * 0.4f;
+			m_sceneLights.push_back(light);
+		}
+	}
+
+	// the forward shader only takes the first lights, which
+	// should be the lamps of the desks nearest the desk of the
+	// scene, and the lit lamps are the nearest ones
+	std::sort(m_sceneLights.begin() + firstDeskLight, m_sceneLights.end(),
+		[](const LIGHT_SOURCE& a, const LIGHT_SOURCE& b)
+		{
+			return(glm::length(a.position - STRESS_LAMP_POSITION) < glm::length(b.position - STRESS_LAMP_POSITION));
+		});
+	if ((lightCount >= 0) && (firstDeskLight + static_cast<size_t>(lightCount) < m_sceneLights.size()))
+	{
+		m_sceneLights.resize(firstDeskLight + static_cast<size_t>(lightCount));
+	}
+	ApplyLightUniforms(m_pShaderManager);
+
+	std::cout << "Stress scene: " << columns << " x " << rows << " grid of " << deskCount
+		<< " desks, " << m_sceneObjects.size() << " objects, " << m_sceneLights.size()
+		<< " lights (seed " << seed << ")" << std::endl;
+}
+
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene by 
+ *  transforming and drawing the basic 3D shapes
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	if (g_RenderSettings.bUseCompactVertices != m_bCompactMeshes)
+	{
+		UploadMeshes();
+	}
+
+	// baked lighting replaces the per-fragment light loop
+	// for all the static objects
+	bool bBakedLighting = false;
+	if (g_RenderSettings.bUseBakedLighting)
+	{
+		bBakedLighting = PrepareBakedLighting();
+		if (!bBakedLighting)
+		{
+			g_RenderSettings.bUseBakedLighting = false;
+		}
+	}
+
+	// the probe grid replaces the flat ambient light
+	bool bProbeLighting = false;
+	if (g_RenderSettings.bUseProbeLighting)
+	{
+		bProbeLighting = PrepareProbeLighting();
+		if (!bProbeLighting)
+		{
+			g_RenderSettings.bUseProbeLighting = false;
+		}
+	}
+	ApplyProbeUniforms(m_pShaderManager, bProbeLighting);
+
+	if (g_RenderSettings.bUseStaticBatching)
+	{
+		UpdateStaticBatches();
+	}
+
+	// the object values of this frame are written into the
+	// next region of the upload ring
+	m_bUseObjectBuffer = false;
+	if (g_RenderSettings.bUseUploadRing)
+	{
+		m_bUseObjectBuffer = PrepareUploadRing();
+		if (!m_bUseObjectBuffer)
+		{
+			g_RenderSettings.bUseUploadRing = false;
+		}
+	}
+	if (m_bUseObjectBuffer)
+	{
+		m_uploadRing.BeginFrame();
+	}
+	m_pShaderManager->setBoolValue(g_UseObjectBufferName, m_bUseObjectBuffer);
+
+	// each forward object picks the shader variant that only
+	// contains the features it uses
+	m_frameIndex++;
+	m_frameFeatures = (bProbeLighting ? FEATURE_PROBES : 0);
+	m_bSelectVariants = false;
+	if (g_RenderSettings.bUseShaderPermutations)
+	{
+		m_bSelectVariants = PrepareShaderPermutations();
+		if (!m_bSelectVariants)
+		{
+			g_RenderSettings.bUseShaderPermutations = false;
+		}
+	}
+
+	// deferred shading lights each pixel once instead of
+	// every drawn fragment
+	bool bDeferred = false;
+	if (g_RenderSettings.bUseDeferredShading)
+	{
+		bDeferred = PrepareDeferredShading();
+		if (!bDeferred)
+		{
+			g_RenderSettings.bUseDeferredShading = false;
+		}
+	}
+
+	// the nearest large batches are drawn into a depth pyramid
+	// that the objects behind them are tested against
+	m_bOcclusionCulling = false;
+	if (g_RenderSettings.bUseOcclusionCulling)
+	{
+		m_bOcclusionCulling = PrepareOcclusionCulling();
+		if (!m_bOcclusionCulling)
+		{
+			g_RenderSettings.bUseOcclusionCulling = false;
+		}
+	}
+	if (m_bOcclusionCulling)
+	{
+		DrawOccluders();
+	}
+	else if (m_bHiZReady)
+	{
+		m_hiZBuffer.InvalidateReadback();
+	}
+
+	// the GPU culls the opaque objects and writes their draws,
+	// the queues only hold the transparent ones
+	m_bIndirectDraws = false;
+	if (g_RenderSettings.bUseGPUCulling)
+	{
+		m_bIndirectDraws = PrepareGPUCulling();
+		if (!m_bIndirectDraws)
+		{
+			g_RenderSettings.bUseGPUCulling = false;
+		}
+	}
+	if (m_bIndirectDraws)
+	{
+		if ((m_bGPUSceneDirty) || (m_bGPUSceneBatched != g_RenderSettings.bUseStaticBatching))
+		{
+			BuildGPUScene();
+		}
+		// the GPU tests against the pyramid of this frame
+		m_gpuCuller.SetOcclusionPyramid(
+			(m_bOcclusionCulling ? m_hiZBuffer.GetPyramidTexture() : 0),
+			m_hiZBuffer.GetPyramidWidth(),
+			m_hiZBuffer.GetPyramidHeight(),
+			m_hiZBuffer.GetLevelCount());
+		m_gpuCuller.Cull(g_RenderSettings.bUseLod, m_pShaderManager->m_programID);
+	}
+
+	BuildRenderQueues();
+
+	if (bDeferred)
+	{
+		RenderDeferred(bBakedLighting, bProbeLighting);
+	}
+	else
+	{
+		// opaque objects replace what is behind them
+		g_GLState.Disable(GL_BLEND);
+		DrawStaticBatches(bBakedLighting);
+		if (m_bIndirectDraws)
+		{
+			DrawIndirectGroups(bBakedLighting);
+		}
+		DrawRenderQueue(m_opaqueQueue, bBakedLighting);
+		DrawTransparentPass(bBakedLighting);
+	}
+
+	if (m_bUseObjectBuffer)
+	{
+		m_uploadRing.EndFrame();
+	}
+
+	// the view manager sets the next frame into the forward shader
+	if (m_pShaderManager != m_pForwardShader)
+	{
+		m_pShaderManager = m_pForwardShader;
+		g_GLState.UseProgram(m_pShaderManager->m_programID);
+	}
+}
@@ -1,108 +1,492 @@
-///////////////////////////////////////////////////////////////////////////////
-// shadermanager.h
-// ============
-// manage the loading and rendering of 3D scenes
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#pragma once
-
-#include "ShaderManager.h"
-#include "ShapeMeshes.h"
-
-#include <string>
-#include <vector>
-
-/***********************************************************
- *  SceneManager
- *
- *  This class contains the code for preparing and rendering
- *  3D scenes, including the shader settings.
- ***********************************************************/
-class SceneManager
-{
-public:
-	// constructor
-	SceneManager(ShaderManager *pShaderManager);
-	// destructor
-	~SceneManager();
-
-	struct TEXTURE_INFO
-	{
-		std::string tag;
-		uint32_t ID;
-	};
-
-	struct OBJECT_MATERIAL
-	{
-		float ambientStrength;
-		glm::vec3 ambientColor;
-		glm::vec3 diffuseColor;
-		glm::vec3 specularColor;
-		float shininess;
-		std::string tag;
-	};
-
-private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// pointer to basic shapes object
-	ShapeMeshes* m_basicMeshes;
-	// total number of loaded textures
-	int m_loadedTextures;
-	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
-	// defined object materials
-	std::vector<OBJECT_MATERIAL> m_objectMaterials;
-
-	// load texture images and convert to OpenGL texture data
-	bool CreateGLTexture(const char* filename, std::string tag);
-	// bind loaded OpenGL textures to slots in memory
-	void BindGLTextures();
-	// free the loaded OpenGL textures
-	void DestroyGLTextures();
-	// find a loaded texture by tag
-	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
-	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
-
-	// set the transformation values 
-	// into the transform buffer
-	void SetTransformations(
-		glm::vec3 scaleXYZ,
-		float XrotationDegrees,
-		float YrotationDegrees,
-		float ZrotationDegrees,
-		glm::vec3 positionXYZ);
-
-	// set the color values into the shader
-	void SetShaderColor(
-		float redColorValue,
-		float greenColorValue,
-		float blueColorValue,
-		float alphaValue);
-
-	// set the texture data into the shader
-	void SetShaderTexture(
-		std::string textureTag);
-
-	// set the UV scale for the texture mapping
-	void SetTextureUVScale(
-		float u, float v);
-
-	// set the object material into the shader
-	void SetShaderMaterial(
-		std::string materialTag);
-
-public:
-
-	// The following methods are for the students to 
-	// customize for their own 3D scene
-	void PrepareScene();
-	void RenderScene();
-	void LoadSceneTextures();
-	void SetupSceneLights();
+///////////////////////////////////////////////////////////////////////////////
+// shadermanager.h
+// ============
+// manage the loading and rendering of 3D scenes
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "MeshBuilder.h"
+#include "MeshCache.h"
+#include "Meshlets.h"
+#include "GPUCuller.h"
+#include "HiZBuffer.h"
+#include "LightmapBaker.h"
+#include "IrradianceVolume.h"
+#include "DeferredRenderer.h"
+#include "ShaderPermutations.h"
+#include "RenderQueue.h"
+#include "OITRenderer.h"
+#include "UploadRing.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/***********************************************************
+ *  SceneManager
+ *
+ *  This class contains the code for preparing and rendering
+ *  3D scenes, including the shader settings.
+ ***********************************************************/
+class SceneManager
+{
+public:
+	// constructor
+	SceneManager(ShaderManager *pShaderManager);
+	// destructor
+	~SceneManager();
+
+	struct TEXTURE_INFO
+	{
+		std::string tag;
+		uint32_t ID;
+		// mean color of the image, used as the albedo when baking
+		glm::vec3 averageColor;
+	};
+
+	struct OBJECT_MATERIAL
+	{
+		float ambientStrength;
+		glm::vec3 ambientColor;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+		std::string tag;
+	};
+
+	// basic shapes that scene objects can be drawn with
+	enum MESH_TYPE
+	{
+		MESH_PLANE,
+		MESH_BOX,
+		MESH_CYLINDER,
+		MESH_TORUS,
+		MESH_SPHERE,
+		MESH_HALF_SPHERE,
+		MESH_TYPE_COUNT
+	};
+
+	// levels of detail generated for each shape, the plane and
+	// the box only have the first
+	static const int MESH_LOD_COUNT = 4;
+
+	struct SCENE_OBJECT
+	{
+		std::string tag;
+		MESH_TYPE mesh;
+		glm::vec3 scaleXYZ;
+		float XrotationDegrees;
+		float YrotationDegrees;
+		float ZrotationDegrees;
+		glm::vec3 positionXYZ;
+		// used when no texture tag is set
+		glm::vec4 color;
+		std::string textureTag;
+		// static objects never move and can use baked lighting
+		bool bStatic;
+		bool bCastsShadows;
+		// blended objects are drawn after the opaque ones
+		bool bTransparent;
+		// unlit objects show their plain color or texture
+		bool bUseLighting;
+		// tile of the object in the lightmap atlas
+		int lightmapIndex;
+		// level of detail chosen in the last frame
+		int lodLevel;
+		// static batch the object is merged into, -1 when it is
+		// drawn on its own
+		int batchIndex;
+		// imported model drawn instead of the basic shape, -1
+		// for the basic shapes
+		int modelIndex;
+		// visible meshlets of the model in this frame, -1 when
+		// the whole mesh is drawn
+		int meshletList;
+		// values of the object in the storage buffer of the GPU
+		// culling and its first draw group, -1 when it is drawn
+		// through the render queues
+		int gpuRecord;
+		int gpuGroup;
+	};
+
+	// mesh read from a model file, fitted into the extents of
+	// the basic shapes, which has a single level of detail
+	struct IMPORTED_MODEL
+	{
+		std::string filename;
+		MESH_DATA meshData;
+		GL_MESH glMesh;
+		glm::vec3 center;
+		float radius;
+		// half the size of the box around the fitted mesh
+		glm::vec3 extents;
+		// clusters of the triangles, only built for large models
+		std::vector<MESHLET> meshlets;
+	};
+
+	// opaque static objects of the same appearance and in the
+	// same cell of space merged into one mesh in world space
+	struct STATIC_BATCH
+	{
+		// the shared appearance, with an identity transform
+		SCENE_OBJECT object;
+		std::vector<int> objectIndices;
+		GL_MESH glMesh;
+		// world space box around the merged mesh
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		// drawn into the depth pyramid of this frame, so it is
+		// not tested against it
+		bool bOccluder;
+		// the merged mesh has to be built again
+		bool bDirty;
+	};
+
+	// objects of the same mesh, level and appearance that are
+	// drawn by one indirect call
+	struct INDIRECT_GROUP
+	{
+		// the shared appearance
+		SCENE_OBJECT object;
+		int lod;
+	};
+
+	// per-object values in the std140 layout of the ObjectBlock
+	// in the scene shaders
+	struct OBJECT_BLOCK
+	{
+		glm::mat4 model;
+		glm::mat4 normalMatrix;
+		glm::vec4 color;
+		glm::vec4 lightmapScaleOffset;
+	};
+
+	struct LIGHT_SOURCE
+	{
+		glm::vec3 position;
+		glm::vec3 ambientColor;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float focalStrength;
+		float specularIntensity;
+	};
+
+private:
+	// pointer to shader manager object, which is the shader
+	// that the drawing methods currently write to
+	ShaderManager* m_pShaderManager;
+	// the uniform-driven shader loaded at startup
+	ShaderManager* m_pForwardShader;
+	// total number of loaded textures
+	int m_loadedTextures;
+	// loaded textures info
+	TEXTURE_INFO m_textureIDs[16];
+	// defined object materials
+	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// objects drawn in the rendered scene
+	std::vector<SCENE_OBJECT> m_sceneObjects;
+	// lights of the rendered scene
+	std::vector<LIGHT_SOURCE> m_sceneLights;
+	// mapped file the basic shapes are uploaded from
+	MeshCache m_meshCache;
+	// CPU copies of the levels of the basic shapes, only filled
+	// for baking and batching, and their OpenGL buffers,
+	// including the lightmap UVs
+	MESH_DATA m_meshData[MESH_TYPE_COUNT][MESH_LOD_COUNT];
+	bool m_bMeshDataReady;
+	GL_MESH m_glMeshes[MESH_TYPE_COUNT][MESH_LOD_COUNT];
+	// layout the meshes were last uploaded in
+	bool m_bCompactMeshes;
+	int m_meshLodCounts[MESH_TYPE_COUNT];
+	// center of each shape, used to sort the objects by depth,
+	// the radius around it for the levels of detail and half
+	// the size of the box around it for the culling
+	glm::vec3 m_meshCenters[MESH_TYPE_COUNT];
+	float m_meshRadii[MESH_TYPE_COUNT];
+	glm::vec3 m_meshExtents[MESH_TYPE_COUNT];
+	// imported models, kept on the CPU for baking
+	std::vector<IMPORTED_MODEL> m_models;
+	// visible meshlets of the drawn models, and the culling
+	// work of the frame, kept to reuse their memory
+	std::vector<MESHLET_DRAW_LIST> m_meshletDrawLists;
+	std::vector<MESHLET_CULL_JOB> m_meshletJobs;
+	// merged draws of the static objects
+	std::vector<STATIC_BATCH> m_staticBatches;
+	// culling of the opaque objects in a compute shader
+	GPUCuller m_gpuCuller;
+	bool m_bGPUCullingReady;
+	bool m_bGPUCullingFailed;
+	// the objects or their appearance changed since they were
+	// last uploaded, or the batching was switched
+	bool m_bGPUSceneDirty;
+	bool m_bGPUSceneBatched;
+	std::vector<INDIRECT_GROUP> m_indirectGroups;
+	// objects that still go through the render queues
+	std::vector<int> m_cpuDrawnObjects;
+	// the opaque objects of this frame are drawn indirectly
+	bool m_bIndirectDraws;
+	// depth pyramid of the large objects that hide the others
+	HiZBuffer m_hiZBuffer;
+	bool m_bHiZReady;
+	bool m_bHiZFailed;
+	// distance and index of the static batches drawn into the
+	// pyramid in this frame
+	std::vector<std::pair<float, int> > m_occluderBatches;
+	// the queued objects of this frame are tested against it
+	bool m_bOcclusionCulling;
+	// opaque objects front to back and blended objects back to
+	// front, rebuilt every frame
+	RenderQueue m_opaqueQueue;
+	RenderQueue m_transparentQueue;
+	// weighted blended transparency instead of sorting
+	OITRenderer m_oitRenderer;
+	bool m_bOITReady;
+	bool m_bOITFailed;
+	// the objects being drawn go to the transparency targets
+	bool m_bOITPass;
+	// per-frame regions that the object values are written to
+	UploadRing m_uploadRing;
+	bool m_bUploadRingReady;
+	bool m_bUploadRingFailed;
+	// the object values of this frame go through the ring
+	bool m_bUseObjectBuffer;
+	// baked lighting for the static objects
+	LightmapBaker m_lightmapBaker;
+	GLuint m_lightmapTextureID;
+	bool m_bLightmapReady;
+	bool m_bLightmapFailed;
+	// baked irradiance probes for the ambient light
+	IrradianceVolume m_irradianceVolume;
+	GLuint m_probeTextureID;
+	bool m_bProbesReady;
+	bool m_bProbesFailed;
+	// G-buffer and lighting pass for deferred shading
+	DeferredRenderer m_deferredRenderer;
+	bool m_bDeferredReady;
+	bool m_bDeferredFailed;
+	// specialized forward shaders selected per drawn object
+	ShaderPermutations m_shaderPermutations;
+	bool m_bPermutationsReady;
+	bool m_bPermutationsFailed;
+	// pick a variant in DrawSceneObject for the current pass
+	bool m_bSelectVariants;
+	// feature bits shared by all objects of the frame
+	unsigned int m_frameFeatures;
+	int m_frameIndex;
+	// camera of the frame being rendered
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	glm::vec3 m_viewPosition;
+
+	// load texture images and convert to OpenGL texture data
+	bool CreateGLTexture(const char* filename, std::string tag);
+	// bind loaded OpenGL textures to slots in memory
+	void BindGLTextures();
+	// free the loaded OpenGL textures
+	void DestroyGLTextures();
+	// find a loaded texture by tag
+	int FindTextureID(std::string tag);
+	int FindTextureSlot(std::string tag);
+	// find a defined material by tag
+	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+
+	// set the transformation values 
+	// into the transform buffer
+	void SetTransformations(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// set the color values into the shader
+	void SetShaderColor(
+		float redColorValue,
+		float greenColorValue,
+		float blueColorValue,
+		float alphaValue);
+
+	// set the texture data into the shader
+	void SetShaderTexture(
+		std::string textureTag);
+
+	// set the UV scale for the texture mapping
+	void SetTextureUVScale(
+		float u, float v);
+
+	// set the object material into the shader
+	void SetShaderMaterial(
+		std::string materialTag);
+
+	// add an object to the list of drawn scene objects
+	int AddSceneObject(
+		std::string tag,
+		MESH_TYPE mesh,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ,
+		glm::vec4 color,
+		std::string textureTag = "");
+	// add an object drawn with an imported model
+	int AddModelObject(
+		std::string tag,
+		int modelIndex,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ,
+		glm::vec4 color,
+		std::string textureTag = "");
+	// import a model file and upload it, returns its index or
+	// -1 when it could not be loaded
+	int LoadModel(const char* filename);
+	// free the imported models
+	void DestroyModels();
+	// the CPU mesh, the level of the OpenGL mesh and the center
+	// of the shape or model of an object
+	const MESH_DATA& GetObjectMeshData(const SCENE_OBJECT& object) const;
+	const GL_MESH& GetObjectGLMesh(const SCENE_OBJECT& object, int lod) const;
+	glm::vec3 GetObjectMeshCenter(const SCENE_OBJECT& object) const;
+	// half the size of the box around the shape or model of an
+	// object before it is transformed
+	glm::vec3 GetObjectMeshExtents(const SCENE_OBJECT& object) const;
+	// radius of the bounding sphere of an object in world space
+	float GetObjectRadius(const SCENE_OBJECT& object) const;
+	// world positions of the corners of the box around the mesh
+	// of an object
+	void GetObjectCorners(const SCENE_OBJECT& object, glm::vec3 corners[8]) const;
+	// draw one scene object with its transformations and appearance
+	void DrawSceneObject(const SCENE_OBJECT& object, bool bBakedLighting);
+	// draw a mesh with the transformations and appearance of an
+	// object, or only the listed meshlets of the mesh
+	void DrawObjectMesh(
+		const SCENE_OBJECT& object,
+		const GL_MESH& glMesh,
+		bool bLightmapped,
+		const glm::vec4& lightmapScaleOffset,
+		const MESHLET_DRAW_LIST* pMeshlets = NULL);
+	// select the shader variant for the appearance of an object
+	void SelectObjectVariant(const SCENE_OBJECT& object, bool bLightmapped);
+	// write the values of an object into the upload ring and
+	// bind them, returns false when the region is full
+	bool WriteObjectBlock(const SCENE_OBJECT& object, const glm::vec4& lightmapScaleOffset);
+	// create the upload ring with room for all the objects
+	bool PrepareUploadRing();
+
+	// sort the scene objects into the opaque and transparent queues
+	void BuildRenderQueues();
+	// find the visible meshlets of the models in the view
+	void CullModelMeshlets();
+	// draw the objects of a queue in its order
+	void DrawRenderQueue(const RenderQueue& queue, bool bBakedLighting);
+	// pick the level of detail of an object from the share of
+	// the screen it covers
+	int SelectLodLevel(const SCENE_OBJECT& object, float viewDistance) const;
+	// group the opaque static objects by their appearance
+	void BuildStaticBatches();
+	// merge the objects of the batches that changed
+	void UpdateStaticBatches();
+	// draw every static batch
+	void DrawStaticBatches(bool bBakedLighting);
+	// free the merged meshes
+	void DestroyStaticBatches();
+	// load the culling shader the first time it is needed
+	bool PrepareGPUCulling();
+	// upload the opaque objects and their draw groups
+	void BuildGPUScene();
+	// get the storage values of an object
+	GPU_OBJECT BuildGPUObject(const SCENE_OBJECT& object) const;
+	// draw the objects of every group that passed the culling
+	void DrawIndirectGroups(bool bBakedLighting);
+	// create the depth pyramid the first time it is needed
+	bool PrepareOcclusionCulling();
+	// draw the large opaque objects into the depth pyramid
+	void DrawOccluders();
+	// blend the transparent objects over the drawn scene
+	void DrawTransparentPass(bool bBakedLighting);
+	// load the transparency composite shader
+	bool PrepareOIT();
+
+	// color of the light reflected by an object when baking
+	glm::vec3 GetObjectAlbedo(const SCENE_OBJECT& object);
+
+	// upload the basic shapes from the mesh cache, generating
+	// and caching them when the cache cannot be used
+	void PrepareMeshes();
+	// upload the basic shapes in the selected vertex layout
+	void UploadMeshes();
+	// fill the CPU copies of the basic shapes
+	void PrepareMeshData();
+
+	// load or bake the lightmaps of the static objects
+	bool PrepareBakedLighting();
+	// free the baked lighting resources
+	void DestroyBakedLighting();
+	// bake the irradiance probe grid
+	bool PrepareProbeLighting();
+	// free the irradiance probe resources
+	void DestroyProbeLighting();
+	// set the scene lights into a shader
+	void ApplyLightUniforms(ShaderManager* pShader);
+	// set the probe grid values into a shader
+	void ApplyProbeUniforms(ShaderManager* pShader, bool bProbeLighting);
+
+	// read the shader sources used for the variants
+	bool PrepareShaderPermutations();
+	// make the variant for the feature bits the active shader
+	// and bring its uniforms up to date for this frame
+	void SelectShaderVariant(unsigned int features);
+
+	// load the deferred shaders and set their fixed values
+	bool PrepareDeferredShading();
+	// draw the opaque objects through the G-buffer and the
+	// transparent objects forward on top
+	void RenderDeferred(bool bBakedLighting, bool bProbeLighting);
+
+public:
+
+	// move an object, which only rebuilds the static batch that
+	// holds it, the baked lighting stays as it was
+	void SetObjectTransform(
+		int objectIndex,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// size of the scene for the benchmark report
+	size_t GetObjectCount() const { return m_sceneObjects.size(); }
+	size_t GetLightCount() const { return m_sceneLights.size(); }
+	// lights shaded by the forward shader, the first ones
+	int GetForwardLightCount() const;
+	// whether the first object with the tag is hidden behind the
+	// occluders of a recent frame, for the occlusion check
+	bool IsObjectOccluded(const std::string& tag) const;
+
+	// set the camera used for ordering the objects of the frame
+	void SetViewTransform(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		const glm::vec3& viewPosition);
+
+	// The following methods are for the students to 
+	// customize for their own 3D scene
+	void PrepareScene();
+	void RenderScene();
+	void LoadSceneTextures();
+	void SetupSceneLights();
+	void DefineSceneObjects();
+	// replace the desk scene with copies of the desk on a grid,
+	// about the given number of objects drawn from the seed and
+	// the given number of lamp lights, -1 for every desk
+	void DefineStressScene(int objectCount, int lightCount, uint32_t seed);
 };
\ No newline at end of file
@@ -0,0 +1,383 @@
+///////////////////////////////////////////////////////////////////////////////
+// sceneraytracer.cpp
+// ============
+// CPU ray queries against the static scene geometry
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneRayTracer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// leaves hold at most this many triangles
+	const int MAX_LEAF_TRIANGLES = 4;
+	// fixed traversal stack depth - enough for millions of triangles
+	const int MAX_STACK_DEPTH = 64;
+
+	/***********************************************************
+	 *  IntersectBounds()
+	 *
+	 *  Slab test of a ray against an axis aligned box. The
+	 *  entry distance is returned when the box is hit.
+	 ***********************************************************/
+	bool IntersectBounds(
+		const glm::vec3& origin,
+		const glm::vec3& inverseDirection,
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax,
+		float maxDistance,
+		float& entryDistance)
+	{
+		float tMin = 0.0f;
+		float tMax = maxDistance;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float t0 = (boundsMin[axis] - origin[axis]) * inverseDirection[axis];
+			float t1 = (boundsMax[axis] - origin[axis]) * inverseDirection[axis];
+			if (t0 > t1)
+			{
+				std::swap(t0, t1);
+			}
+			tMin = std::max(tMin, t0);
+			tMax = std::min(tMax, t1);
+			if (tMin > tMax)
+			{
+				return(false);
+			}
+		}
+
+		entryDistance = tMin;
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  SceneRayTracer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneRayTracer::SceneRayTracer()
+{
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all the triangles.
+ ***********************************************************/
+void SceneRayTracer::Clear()
+{
+	m_triangles.clear();
+	m_nodes.clear();
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for adding the triangles of a mesh
+ *  to the scene after transforming them into world space.
+ ***********************************************************/
+void SceneRayTracer::AddMesh(const MESH_DATA& mesh, const glm::mat4& model, int objectIndex)
+{
+	glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+
+	for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+	{
+		glm::vec3 positions[3];
+		TRIANGLE triangle;
+
+		for (int corner = 0; corner < 3; corner++)
+		{
+			const MESH_VERTEX& vertex = mesh.vertices[mesh.indices[i + corner]];
+			positions[corner] = glm::vec3(model * glm::vec4(vertex.position, 1.0f));
+			triangle.normals[corner] = glm::normalize(normalMatrix * vertex.normal);
+		}
+
+		triangle.v0 = positions[0];
+		triangle.edge1 = positions[1] - positions[0];
+		triangle.edge2 = positions[2] - positions[0];
+		triangle.centroid = (positions[0] + positions[1] + positions[2]) / 3.0f;
+		triangle.objectIndex = objectIndex;
+
+		// skip degenerate triangles
+		if (glm::length(glm::cross(triangle.edge1, triangle.edge2)) > 1e-12f)
+		{
+			m_triangles.push_back(triangle);
+		}
+	}
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for building the bounding volume
+ *  hierarchy over all of the added triangles.
+ ***********************************************************/
+void SceneRayTracer::Build()
+{
+	m_nodes.clear();
+	if (m_triangles.empty())
+	{
+		return;
+	}
+
+	m_nodes.reserve(2 * m_triangles.size() / MAX_LEAF_TRIANGLES + 1);
+	m_nodes.push_back(BVH_NODE());
+	Subdivide(0, 0, static_cast<int>(m_triangles.size()));
+}
+
+/***********************************************************
+ *  Subdivide()
+ *
+ *  This method is used for computing the bounds of a node
+ *  and splitting it at the centroid median of its longest
+ *  axis until the leaves are small enough.
+ ***********************************************************/
+void SceneRayTracer::Subdivide(int nodeIndex, int first, int count)
+{
+	glm::vec3 boundsMin(FLT_MAX);
+	glm::vec3 boundsMax(-FLT_MAX);
+	glm::vec3 centroidMin(FLT_MAX);
+	glm::vec3 centroidMax(-FLT_MAX);
+
+	for (int i = first; i < first + count; i++)
+	{
+		const TRIANGLE& triangle = m_triangles[i];
+		glm::vec3 v1 = triangle.v0 + triangle.edge1;
+		glm::vec3 v2 = triangle.v0 + triangle.edge2;
+		boundsMin = glm::min(boundsMin, glm::min(triangle.v0, glm::min(v1, v2)));
+		boundsMax = glm::max(boundsMax, glm::max(triangle.v0, glm::max(v1, v2)));
+		centroidMin = glm::min(centroidMin, triangle.centroid);
+		centroidMax = glm::max(centroidMax, triangle.centroid);
+	}
+
+	m_nodes[nodeIndex].boundsMin = boundsMin;
+	m_nodes[nodeIndex].boundsMax = boundsMax;
+
+	glm::vec3 extent = centroidMax - centroidMin;
+	int axis = 0;
+	if (extent.y > extent.x) axis = 1;
+	if (extent.z > extent[axis]) axis = 2;
+
+	if ((count <= MAX_LEAF_TRIANGLES) || (extent[axis] <= 0.0f))
+	{
+		m_nodes[nodeIndex].firstOrChild = first;
+		m_nodes[nodeIndex].count = count;
+		return;
+	}
+
+	int half = count / 2;
+	std::nth_element(
+		m_triangles.begin() + first,
+		m_triangles.begin() + first + half,
+		m_triangles.begin() + first + count,
+		[axis](const TRIANGLE& a, const TRIANGLE& b)
+		{
+			return(a.centroid[axis] < b.centroid[axis]);
+		});
+
+	// the left child always directly follows its parent
+	int leftChild = static_cast<int>(m_nodes.size());
+	m_nodes.push_back(BVH_NODE());
+	Subdivide(leftChild, first, half);
+
+	int rightChild = static_cast<int>(m_nodes.size());
+	m_nodes.push_back(BVH_NODE());
+	Subdivide(rightChild, first + half, count - half);
+
+	m_nodes[nodeIndex].firstOrChild = rightChild;
+	m_nodes[nodeIndex].count = 0;
+}
+
+/***********************************************************
+ *  Intersect()
+ *
+ *  This method is used for finding the closest hit.
+ ***********************************************************/
+bool SceneRayTracer::Intersect(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance,
+	RAY_HIT& hit) const
+{
+	return(Traverse(origin, direction, maxDistance, false, &hit));
+}
+
+/***********************************************************
+ *  IsOccluded()
+ *
+ *  This method is used for shadow queries, which can stop
+ *  at the first hit that is found.
+ ***********************************************************/
+bool SceneRayTracer::IsOccluded(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance) const
+{
+	return(Traverse(origin, direction, maxDistance, true, NULL));
+}
+
+/***********************************************************
+ *  Traverse()
+ *
+ *  This method is used for walking the hierarchy front to
+ *  back and testing the triangles of the visited leaves.
+ ***********************************************************/
+bool SceneRayTracer::Traverse(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance,
+	bool bAnyHit,
+	RAY_HIT* pHit) const
+{
+	if (m_nodes.empty())
+	{
+		return(false);
+	}
+
+	glm::vec3 inverseDirection(
+		1.0f / (direction.x != 0.0f ? direction.x : 1e-20f),
+		1.0f / (direction.y != 0.0f ? direction.y : 1e-20f),
+		1.0f / (direction.z != 0.0f ? direction.z : 1e-20f));
+
+	int stack[MAX_STACK_DEPTH];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	float closest = maxDistance;
+	int hitTriangle = -1;
+	float hitU = 0.0f;
+	float hitV = 0.0f;
+
+	while (stackSize > 0)
+	{
+		const BVH_NODE& node = m_nodes[stack[--stackSize]];
+		float entry = 0.0f;
+
+		if (!IntersectBounds(origin, inverseDirection, node.boundsMin, node.boundsMax, closest, entry))
+		{
+			continue;
+		}
+
+		if (node.count > 0)
+		{
+			for (int i = node.firstOrChild; i < node.firstOrChild + node.count; i++)
+			{
+				// Moller-Trumbore ray/triangle test
+				const TRIANGLE& triangle = m_triangles[i];
+				glm::vec3 p = glm::cross(direction, triangle.edge2);
+				float determinant = glm::dot(triangle.edge1, p);
+				if (fabs(determinant) < 1e-12f)
+				{
+					continue;
+				}
+
+				float inverseDeterminant = 1.0f / determinant;
+				glm::vec3 t = origin - triangle.v0;
+				float u = glm::dot(t, p) * inverseDeterminant;
+				if ((u < 0.0f) || (u > 1.0f))
+				{
+					continue;
+				}
+
+				glm::vec3 q = glm::cross(t, triangle.edge1);
+				float v = glm::dot(direction, q) * inverseDeterminant;
+				if ((v < 0.0f) || (u + v > 1.0f))
+				{
+					continue;
+				}
+
+				float distance = glm::dot(triangle.edge2, q) * inverseDeterminant;
+				if ((distance > 1e-4f) && (distance < closest))
+				{
+					if (bAnyHit)
+					{
+						return(true);
+					}
+					closest = distance;
+					hitTriangle = i;
+					hitU = u;
+					hitV = v;
+				}
+			}
+		}
+		else if (stackSize + 2 <= MAX_STACK_DEPTH)
+		{
+			int leftChild = static_cast<int>(&node - &m_nodes[0]) + 1;
+			int rightChild = node.firstOrChild;
+
+			// visit the nearer child first
+			int axis = 0;
+			if (fabs(direction.y) > fabs(direction.x)) axis = 1;
+			if (fabs(direction.z) > fabs(direction[axis])) axis = 2;
+			if (direction[axis] < 0.0f)
+			{
+				std::swap(leftChild, rightChild);
+			}
+			stack[stackSize++] = rightChild;
+			stack[stackSize++] = leftChild;
+		}
+	}
+
+	if (hitTriangle < 0)
+	{
+		return(false);
+	}
+
+	if (NULL != pHit)
+	{
+		const TRIANGLE& triangle = m_triangles[hitTriangle];
+		pHit->distance = closest;
+		pHit->objectIndex = triangle.objectIndex;
+		pHit->position = origin + direction * closest;
+		pHit->normal = glm::normalize(
+			triangle.normals[0] * (1.0f - hitU - hitV)
+			+ triangle.normals[1] * hitU
+			+ triangle.normals[2] * hitV);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetBoundsMin()
+ *
+ *  This method is used for getting the lower scene corner.
+ ***********************************************************/
+glm::vec3 SceneRayTracer::GetBoundsMin() const
+{
+	if (m_nodes.empty())
+	{
+		return(glm::vec3(0.0f));
+	}
+	return(m_nodes[0].boundsMin);
+}
+
+/***********************************************************
+ *  GetBoundsMax()
+ *
+ *  This method is used for getting the upper scene corner.
+ ***********************************************************/
+glm::vec3 SceneRayTracer::GetBoundsMax() const
+{
+	if (m_nodes.empty())
+	{
+		return(glm::vec3(0.0f));
+	}
+	return(m_nodes[0].boundsMax);
+}
+
+/***********************************************************
+ *  GetTriangleCount()
+ *
+ *  This method is used for getting the number of triangles.
+ ***********************************************************/
+int SceneRayTracer::GetTriangleCount() const
+{
+	return(static_cast<int>(m_triangles.size()));
+}
@@ -0,0 +1,91 @@
+///////////////////////////////////////////////////////////////////////////////
+// sceneraytracer.h
+// ============
+// CPU ray queries against the static scene geometry
+//
+// The triangles of all the added meshes are transformed into world space
+// and sorted into a bounding volume hierarchy. Once built, the tracer is
+// read-only and can be queried from any number of threads at once.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshBuilder.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// result of a closest-hit query
+struct RAY_HIT
+{
+	float distance;
+	int objectIndex;
+	glm::vec3 position;
+	glm::vec3 normal;
+};
+
+class SceneRayTracer
+{
+public:
+	// constructor
+	SceneRayTracer();
+
+	// remove all the triangles and the hierarchy
+	void Clear();
+	// add the triangles of a mesh placed with the model transform
+	void AddMesh(const MESH_DATA& mesh, const glm::mat4& model, int objectIndex);
+	// build the hierarchy - must be called after the meshes are added
+	void Build();
+
+	// find the closest triangle hit along the ray
+	bool Intersect(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		RAY_HIT& hit) const;
+	// check whether anything is hit along the ray
+	bool IsOccluded(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance) const;
+
+	// get the bounds of all the added geometry
+	glm::vec3 GetBoundsMin() const;
+	glm::vec3 GetBoundsMax() const;
+	int GetTriangleCount() const;
+
+private:
+	struct TRIANGLE
+	{
+		glm::vec3 v0;
+		glm::vec3 edge1;
+		glm::vec3 edge2;
+		glm::vec3 normals[3];
+		glm::vec3 centroid;
+		int objectIndex;
+	};
+
+	struct BVH_NODE
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		// first triangle for leaves, right child for inner nodes
+		int firstOrChild;
+		// number of triangles, zero for inner nodes
+		int count;
+	};
+
+	std::vector<TRIANGLE> m_triangles;
+	std::vector<BVH_NODE> m_nodes;
+
+	// split the triangle range into child nodes
+	void Subdivide(int nodeIndex, int first, int count);
+	// query the hierarchy, stopping at the first hit if requested
+	bool Traverse(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		bool bAnyHit,
+		RAY_HIT* pHit) const;
+};
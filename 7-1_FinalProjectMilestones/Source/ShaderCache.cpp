@@ -0,0 +1,415 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadercache.cpp
+// ============
+// build shader programs and keep their linked binaries on disk
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderCache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#define MAKE_DIRECTORY(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define MAKE_DIRECTORY(path) mkdir(path, 0755)
+#endif
+
+// declaration of global variables
+namespace
+{
+	// the program binaries are kept next to the lightmap cache
+	const char* g_ShaderCacheDirectory = "C:/CS330Content/Projects/7-1_FinalProjectMilestones/ShaderCache";
+
+	const char SHADER_CACHE_MAGIC[4] = { 'P', 'B', 'I', 'N' };
+	const uint32_t SHADER_CACHE_VERSION = 1;
+
+	struct SHADER_CACHE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t key;
+		uint32_t format;
+		uint32_t length;
+	};
+
+	int g_CacheHits = 0;
+	int g_CacheMisses = 0;
+
+	/***********************************************************
+	 *  HashString()
+	 *
+	 *  Add a string and its terminator to a 64-bit FNV-1a hash.
+	 ***********************************************************/
+	uint64_t HashString(uint64_t hash, const char* text)
+	{
+		if (NULL == text)
+		{
+			text = "";
+		}
+		size_t length = strlen(text) + 1;
+		for (size_t i = 0; i < length; i++)
+		{
+			hash ^= static_cast<unsigned char>(text[i]);
+			hash *= 1099511628211ULL;
+		}
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  ComputeCacheKey()
+	 *
+	 *  Hash the sources together with the driver strings.
+	 ***********************************************************/
+	uint64_t ComputeCacheKey(const std::string& vertexSource, const std::string& fragmentSource)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		hash = HashString(hash, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+		hash = HashString(hash, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+		hash = HashString(hash, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+		hash = HashString(hash, vertexSource.c_str());
+		hash = HashString(hash, fragmentSource.c_str());
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  GetCacheFilename()
+	 *
+	 *  Build the name of the cache file for a key.
+	 ***********************************************************/
+	std::string GetCacheFilename(uint64_t key)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "/%016llx.bin", static_cast<unsigned long long>(key));
+		return(std::string(g_ShaderCacheDirectory) + name);
+	}
+
+	/***********************************************************
+	 *  IsProgramLinked()
+	 *
+	 *  Check the link status and print the log on failure.
+	 ***********************************************************/
+	bool IsProgramLinked(GLuint programID, bool bPrintLog)
+	{
+		GLint success = 0;
+		glGetProgramiv(programID, GL_LINK_STATUS, &success);
+		if ((!success) && (bPrintLog))
+		{
+			GLint logLength = 0;
+			glGetProgramiv(programID, GL_INFO_LOG_LENGTH, &logLength);
+			std::vector<char> log(logLength + 1, 0);
+			glGetProgramInfoLog(programID, logLength, NULL, log.data());
+			std::cout << "Shader program link error:\n" << log.data() << std::endl;
+		}
+		return(success != 0);
+	}
+
+	/***********************************************************
+	 *  CompileStage()
+	 *
+	 *  Compile one shader stage and print the log on failure.
+	 ***********************************************************/
+	GLuint CompileStage(GLenum type, const std::string& source)
+	{
+		GLuint shader = glCreateShader(type);
+		const char* pSource = source.c_str();
+		glShaderSource(shader, 1, &pSource, NULL);
+		glCompileShader(shader);
+
+		GLint success = 0;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			GLint logLength = 0;
+			glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+			std::vector<char> log(logLength + 1, 0);
+			glGetShaderInfoLog(shader, logLength, NULL, log.data());
+			std::cout << "Shader compile error:\n" << log.data() << std::endl;
+			glDeleteShader(shader);
+			return(0);
+		}
+
+		return(shader);
+	}
+
+	/***********************************************************
+	 *  IsBinaryCacheSupported()
+	 *
+	 *  The driver has to offer at least one binary format.
+	 ***********************************************************/
+	bool IsBinaryCacheSupported()
+	{
+		GLint formatCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+		return(formatCount > 0);
+	}
+
+	/***********************************************************
+	 *  LoadProgramBinary()
+	 *
+	 *  Create a program from a cached binary, returns 0 if the
+	 *  file is missing or the driver rejects the binary.
+	 ***********************************************************/
+	GLuint LoadProgramBinary(uint64_t key)
+	{
+		std::ifstream file(GetCacheFilename(key), std::ios::binary);
+		if (!file.is_open())
+		{
+			return(0);
+		}
+
+		SHADER_CACHE_HEADER header;
+		file.read(reinterpret_cast<char*>(&header), sizeof(header));
+		if ((!file) ||
+			(memcmp(header.magic, SHADER_CACHE_MAGIC, sizeof(header.magic)) != 0) ||
+			(header.version != SHADER_CACHE_VERSION) ||
+			(header.key != key) ||
+			(header.length == 0))
+		{
+			return(0);
+		}
+
+		std::vector<char> binary(header.length);
+		file.read(binary.data(), header.length);
+		if (!file)
+		{
+			return(0);
+		}
+
+		GLuint programID = glCreateProgram();
+		glProgramBinary(programID, header.format, binary.data(), header.length);
+		if (!IsProgramLinked(programID, false))
+		{
+			glDeleteProgram(programID);
+			return(0);
+		}
+
+		return(programID);
+	}
+
+	/***********************************************************
+	 *  SaveProgramBinary()
+	 *
+	 *  Write the binary of a linked program to the cache.
+	 ***********************************************************/
+	void SaveProgramBinary(GLuint programID, uint64_t key)
+	{
+		GLint length = 0;
+		glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0)
+		{
+			return;
+		}
+
+		std::vector<char> binary(length);
+		GLenum format = 0;
+		glGetProgramBinary(programID, length, NULL, &format, binary.data());
+
+		MAKE_DIRECTORY(g_ShaderCacheDirectory);
+		std::ofstream file(GetCacheFilename(key), std::ios::binary);
+		if (!file.is_open())
+		{
+			return;
+		}
+
+		SHADER_CACHE_HEADER header;
+		memcpy(header.magic, SHADER_CACHE_MAGIC, sizeof(header.magic));
+		header.version = SHADER_CACHE_VERSION;
+		header.key = key;
+		header.format = format;
+		header.length = static_cast<uint32_t>(length);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(binary.data(), length);
+	}
+}
+
+/***********************************************************
+ *  ReadShaderFile()
+ *
+ *  This function is used for reading a shader source file.
+ ***********************************************************/
+bool ReadShaderFile(const char* filename, std::string& text)
+{
+	std::ifstream file(filename);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open shader file " << filename << std::endl;
+		return(false);
+	}
+
+	std::stringstream stream;
+	stream << file.rdbuf();
+	text = stream.str();
+
+	return(true);
+}
+
+/***********************************************************
+ *  BuildShaderProgram()
+ *
+ *  This function is used for getting a linked program for
+ *  the shader sources. A cached binary is used when one
+ *  matches, otherwise the sources are compiled and the new
+ *  binary is written to the cache for the next launch.
+ ***********************************************************/
+GLuint BuildShaderProgram(const std::string& vertexSource, const std::string& fragmentSource)
+{
+	bool bUseCache = IsBinaryCacheSupported();
+	uint64_t key = 0;
+
+	if (bUseCache)
+	{
+		key = ComputeCacheKey(vertexSource, fragmentSource);
+		GLuint programID = LoadProgramBinary(key);
+		if (programID != 0)
+		{
+			g_CacheHits++;
+			return(programID);
+		}
+	}
+	g_CacheMisses++;
+
+	GLuint vertexShader = CompileStage(GL_VERTEX_SHADER, vertexSource);
+	GLuint fragmentShader = CompileStage(GL_FRAGMENT_SHADER, fragmentSource);
+	if ((vertexShader == 0) || (fragmentShader == 0))
+	{
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	if (bUseCache)
+	{
+		glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	glAttachShader(programID, vertexShader);
+	glAttachShader(programID, fragmentShader);
+	glLinkProgram(programID);
+	glDetachShader(programID, vertexShader);
+	glDetachShader(programID, fragmentShader);
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+	if (!IsProgramLinked(programID, true))
+	{
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	if (bUseCache)
+	{
+		SaveProgramBinary(programID, key);
+	}
+
+	return(programID);
+}
+
+/***********************************************************
+ *  LoadShaderProgram()
+ *
+ *  This function is used for building the program of two
+ *  shader files.
+ ***********************************************************/
+GLuint LoadShaderProgram(const char* vertexShaderFile, const char* fragmentShaderFile)
+{
+	std::string vertexSource;
+	std::string fragmentSource;
+	if (!ReadShaderFile(vertexShaderFile, vertexSource) ||
+		!ReadShaderFile(fragmentShaderFile, fragmentSource))
+	{
+		return(0);
+	}
+
+	return(BuildShaderProgram(vertexSource, fragmentSource));
+}
+
+/***********************************************************
+ *  BuildComputeProgram()
+ *
+ *  This function is used for getting a linked program for
+ *  a compute shader source. It shares the binary cache, an
+ *  empty fragment source keeps its key apart from the keys
+ *  of the drawing programs.
+ ***********************************************************/
+GLuint BuildComputeProgram(const std::string& computeSource)
+{
+	bool bUseCache = IsBinaryCacheSupported();
+	uint64_t key = 0;
+
+	if (bUseCache)
+	{
+		key = ComputeCacheKey(computeSource, std::string());
+		GLuint programID = LoadProgramBinary(key);
+		if (programID != 0)
+		{
+			g_CacheHits++;
+			return(programID);
+		}
+	}
+	g_CacheMisses++;
+
+	GLuint computeShader = CompileStage(GL_COMPUTE_SHADER, computeSource);
+	if (computeShader == 0)
+	{
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	if (bUseCache)
+	{
+		glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	glAttachShader(programID, computeShader);
+	glLinkProgram(programID);
+	glDetachShader(programID, computeShader);
+	glDeleteShader(computeShader);
+
+	if (!IsProgramLinked(programID, true))
+	{
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	if (bUseCache)
+	{
+		SaveProgramBinary(programID, key);
+	}
+
+	return(programID);
+}
+
+/***********************************************************
+ *  LoadComputeProgram()
+ *
+ *  This function is used for building the program of a
+ *  compute shader file.
+ ***********************************************************/
+GLuint LoadComputeProgram(const char* computeShaderFile)
+{
+	std::string computeSource;
+	if (!ReadShaderFile(computeShaderFile, computeSource))
+	{
+		return(0);
+	}
+
+	return(BuildComputeProgram(computeSource));
+}
+
+/***********************************************************
+ *  GetShaderCacheCounts()
+ *
+ *  This function is used for getting the cache statistics.
+ ***********************************************************/
+void GetShaderCacheCounts(int& hits, int& misses)
+{
+	hits = g_CacheHits;
+	misses = g_CacheMisses;
+}
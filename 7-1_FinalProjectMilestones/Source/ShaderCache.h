@@ -0,0 +1,36 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadercache.h
+// ============
+// build shader programs and keep their linked binaries on disk
+//
+// Linked programs are saved with glGetProgramBinary and loaded back with
+// glProgramBinary on the next launch, which skips compiling and linking.
+// The cache files are named after a hash of both shader sources and the
+// driver vendor, renderer and version strings, so editing a shader or
+// updating the driver simply misses the cache. A binary that the driver
+// rejects falls back to compiling the sources.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+
+// read a whole shader file into a string
+bool ReadShaderFile(const char* filename, std::string& text);
+
+// get the linked program for the sources from the cache, or compile,
+// link and cache it, returns 0 if the sources do not compile
+GLuint BuildShaderProgram(const std::string& vertexSource, const std::string& fragmentSource);
+
+// read both shader files and build their program
+GLuint LoadShaderProgram(const char* vertexShaderFile, const char* fragmentShaderFile);
+
+// get the linked compute program for the source, cached like the others
+GLuint BuildComputeProgram(const std::string& computeSource);
+// read a compute shader file and build its program
+GLuint LoadComputeProgram(const char* computeShaderFile);
+
+// number of programs loaded from and missed in the cache so far
+void GetShaderCacheCounts(int& hits, int& misses);
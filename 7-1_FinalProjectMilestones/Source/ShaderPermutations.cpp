@@ -0,0 +1,189 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderpermutations.cpp
+// ============
+// compile specialized variants of the scene shaders on demand
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderPermutations.h"
+#include "ShaderCache.h"
+
+// declaration of global variables
+namespace
+{
+	/***********************************************************
+	 *  InjectDefines()
+	 *
+	 *  Insert the defines right after the #version line, which
+	 *  has to stay the first statement of the shader.
+	 ***********************************************************/
+	std::string InjectDefines(const std::string& source, const std::string& defines)
+	{
+		size_t position = source.find("#version");
+		if (position == std::string::npos)
+		{
+			return(defines + source);
+		}
+
+		size_t lineEnd = source.find('\n', position);
+		if (lineEnd == std::string::npos)
+		{
+			return(source + "\n" + defines);
+		}
+
+		return(source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1));
+	}
+}
+
+/***********************************************************
+ *  ShaderPermutations()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderPermutations::ShaderPermutations()
+{
+	m_lightCount = 0;
+}
+
+/***********************************************************
+ *  ~ShaderPermutations()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderPermutations::~ShaderPermutations()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for reading the shader sources.
+ ***********************************************************/
+bool ShaderPermutations::Initialize(const char* vertexShaderFile, const char* fragmentShaderFile)
+{
+	Destroy();
+
+	if (!ReadShaderFile(vertexShaderFile, m_vertexSource) ||
+		!ReadShaderFile(fragmentShaderFile, m_fragmentSource))
+	{
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the compiled variants.
+ ***********************************************************/
+void ShaderPermutations::Destroy()
+{
+	for (auto& entry : m_variants)
+	{
+		ShaderManager* pShader = entry.second.pShader;
+		if (NULL != pShader)
+		{
+			glDeleteProgram(pShader->m_programID);
+			pShader->m_programID = 0;
+			delete pShader;
+		}
+	}
+	m_variants.clear();
+}
+
+/***********************************************************
+ *  SetLightCount()
+ *
+ *  This method is used for setting the number of lights
+ *  that the variants are compiled for.
+ ***********************************************************/
+void ShaderPermutations::SetLightCount(int lightCount)
+{
+	if (lightCount != m_lightCount)
+	{
+		Destroy();
+		m_lightCount = lightCount;
+	}
+}
+
+/***********************************************************
+ *  BuildDefines()
+ *
+ *  This method is used for building the #define lines that
+ *  select the features of a variant.
+ ***********************************************************/
+std::string ShaderPermutations::BuildDefines(unsigned int features) const
+{
+	std::string defines = "#define PERMUTATION\n";
+	defines += "#define LIGHT_COUNT " + std::to_string(m_lightCount) + "\n";
+
+	if (features & FEATURE_TEXTURE)
+	{
+		defines += "#define USE_TEXTURE\n";
+	}
+	if (features & FEATURE_LIGHTING)
+	{
+		defines += "#define USE_LIGHTING\n";
+	}
+	if (features & FEATURE_LIGHTMAP)
+	{
+		defines += "#define USE_LIGHTMAP\n";
+	}
+	if (features & FEATURE_PROBES)
+	{
+		defines += "#define USE_PROBES\n";
+	}
+	if (features & FEATURE_OIT)
+	{
+		defines += "#define USE_OIT\n";
+	}
+
+	return(defines);
+}
+
+/***********************************************************
+ *  CompileProgram()
+ *
+ *  This method is used for building the shader program of
+ *  one variant, which comes from the program binary cache
+ *  after the first launch.
+ ***********************************************************/
+GLuint ShaderPermutations::CompileProgram(unsigned int features) const
+{
+	std::string defines = BuildDefines(features);
+
+	return(BuildShaderProgram(
+		InjectDefines(m_vertexSource, defines),
+		InjectDefines(m_fragmentSource, defines)));
+}
+
+/***********************************************************
+ *  GetVariant()
+ *
+ *  This method is used for getting the variant for a set of
+ *  feature bits. A variant that failed to compile is kept
+ *  without a shader so it is not compiled again every frame.
+ ***********************************************************/
+SHADER_VARIANT* ShaderPermutations::GetVariant(unsigned int features)
+{
+	auto found = m_variants.find(features);
+	if (found != m_variants.end())
+	{
+		return((NULL != found->second.pShader) ? &found->second : NULL);
+	}
+
+	SHADER_VARIANT& variant = m_variants[features];
+	variant.features = features;
+
+	GLuint programID = CompileProgram(features);
+	if (programID == 0)
+	{
+		return(NULL);
+	}
+
+	variant.pShader = new ShaderManager();
+	variant.pShader->m_programID = programID;
+
+	return(&variant);
+}
@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderpermutations.h
+// ============
+// compile specialized variants of the scene shaders on demand
+//
+// Each variant is the same GLSL source with a #define injected for every
+// enabled feature, so the switches that the shader would otherwise read
+// from uniforms become constants and their branches are compiled out.
+// Variants are keyed by their feature bits, built the first time they are
+// requested and kept for the rest of the run. Every variant is wrapped in
+// its own ShaderManager so that the usual uniform setters work with it.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+#include <map>
+#include <string>
+
+// features that select a shader variant
+enum SHADER_FEATURE
+{
+	FEATURE_TEXTURE = 1 << 0,
+	FEATURE_LIGHTING = 1 << 1,
+	FEATURE_LIGHTMAP = 1 << 2,
+	FEATURE_PROBES = 1 << 3,
+	FEATURE_OIT = 1 << 4
+};
+
+// one compiled variant and the bookkeeping of its uniforms
+struct SHADER_VARIANT
+{
+	unsigned int features = 0;
+	ShaderManager* pShader = NULL;
+	// frame whose per-frame values were last set into it
+	int frameApplied = -1;
+	// the values that never change have been set
+	bool bStaticApplied = false;
+};
+
+class ShaderPermutations
+{
+public:
+	// constructor
+	ShaderPermutations();
+	// destructor
+	~ShaderPermutations();
+
+	// read the shader sources that all variants are built from
+	bool Initialize(const char* vertexShaderFile, const char* fragmentShaderFile);
+	// free all the compiled variants
+	void Destroy();
+
+	// the light loop is unrolled for this many lights, changing
+	// it drops the variants that were already built
+	void SetLightCount(int lightCount);
+
+	// get the variant for the feature bits, compiling it the
+	// first time, returns NULL if it does not compile
+	SHADER_VARIANT* GetVariant(unsigned int features);
+
+	int GetVariantCount() const { return static_cast<int>(m_variants.size()); }
+
+private:
+	std::string m_vertexSource;
+	std::string m_fragmentSource;
+	int m_lightCount;
+	std::map<unsigned int, SHADER_VARIANT> m_variants;
+
+	// build the #define lines for a variant
+	std::string BuildDefines(unsigned int features) const;
+	// build the program of one variant, returns 0 on failure
+	GLuint CompileProgram(unsigned int features) const;
+};
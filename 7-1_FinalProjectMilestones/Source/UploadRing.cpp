@@ -0,0 +1,222 @@
+///////////////////////////////////////////////////////////////////////////////
+// uploadring.cpp
+// ============
+// persistently mapped buffer for the data written every frame
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UploadRing.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// longest single wait on a fence before it is checked again
+	const GLuint64 FENCE_WAIT_TIMEOUT_NS = 1000000;
+}
+
+/***********************************************************
+ *  UploadRing()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+UploadRing::UploadRing()
+{
+	m_buffer = 0;
+	m_pMapped = NULL;
+	m_regionSize = 0;
+	m_alignment = 256;
+	m_region = 0;
+	m_writeOffset = 0;
+	for (int i = 0; i < REGION_COUNT; i++)
+	{
+		m_fences[i] = 0;
+	}
+	m_stallCount = 0;
+}
+
+/***********************************************************
+ *  ~UploadRing()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+UploadRing::~UploadRing()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the buffer and mapping
+ *  it once. The regions start on the uniform buffer offset
+ *  alignment so that any allocation can be bound directly.
+ ***********************************************************/
+bool UploadRing::Initialize(GLsizeiptr regionSize)
+{
+	Destroy();
+
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &m_alignment);
+	if (m_alignment < 1)
+	{
+		m_alignment = 256;
+	}
+	m_regionSize = GetAlignedSize(regionSize);
+
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+	glBufferStorage(GL_UNIFORM_BUFFER, m_regionSize * REGION_COUNT, NULL, flags);
+	m_pMapped = static_cast<unsigned char*>(
+		glMapBufferRange(GL_UNIFORM_BUFFER, 0, m_regionSize * REGION_COUNT, flags));
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	if (NULL == m_pMapped)
+	{
+		std::cout << "Could not map the per-frame upload buffer" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	m_region = 0;
+	m_writeOffset = 0;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the buffer and fences.
+ ***********************************************************/
+void UploadRing::Destroy()
+{
+	for (int i = 0; i < REGION_COUNT; i++)
+	{
+		if (m_fences[i] != 0)
+		{
+			glDeleteSync(m_fences[i]);
+			m_fences[i] = 0;
+		}
+	}
+
+	if (m_buffer != 0)
+	{
+		if (NULL != m_pMapped)
+		{
+			glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+			glUnmapBuffer(GL_UNIFORM_BUFFER);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = 0;
+	}
+	m_pMapped = NULL;
+	m_regionSize = 0;
+}
+
+/***********************************************************
+ *  Reserve()
+ *
+ *  This method is used for making sure that one region can
+ *  hold the bytes of a frame. The storage of the buffer is
+ *  immutable, so a larger one replaces it once the GPU is
+ *  done with all the regions.
+ ***********************************************************/
+bool UploadRing::Reserve(GLsizeiptr regionSize)
+{
+	if ((m_buffer != 0) && (regionSize <= m_regionSize))
+	{
+		return(true);
+	}
+
+	glFinish();
+	return(Initialize(regionSize));
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for moving to the next region. The
+ *  fence of the frame that last used it is normally signaled
+ *  already, two frames later, so the wait is rare.
+ ***********************************************************/
+void UploadRing::BeginFrame()
+{
+	m_region = (m_region + 1) % REGION_COUNT;
+	m_writeOffset = 0;
+
+	GLsync fence = m_fences[m_region];
+	if (fence == 0)
+	{
+		return;
+	}
+
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		m_stallCount++;
+		// flush once so that the fence can be reached at all
+		GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		do
+		{
+			result = glClientWaitSync(fence, waitFlags, FENCE_WAIT_TIMEOUT_NS);
+			waitFlags = 0;
+		} while (result == GL_TIMEOUT_EXPIRED);
+	}
+
+	glDeleteSync(fence);
+	m_fences[m_region] = 0;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for fencing the commands that read
+ *  the region of this frame.
+ ***********************************************************/
+void UploadRing::EndFrame()
+{
+	if (m_buffer == 0)
+	{
+		return;
+	}
+
+	if (m_fences[m_region] != 0)
+	{
+		glDeleteSync(m_fences[m_region]);
+	}
+	m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for taking space from the region of
+ *  this frame. The returned pointer is written directly and
+ *  the offset is used to bind the range.
+ ***********************************************************/
+void* UploadRing::Allocate(GLsizeiptr size, GLintptr& offset)
+{
+	GLsizeiptr alignedSize = GetAlignedSize(size);
+	if ((NULL == m_pMapped) || (m_writeOffset + alignedSize > m_regionSize))
+	{
+		return(NULL);
+	}
+
+	offset = m_region * m_regionSize + m_writeOffset;
+	m_writeOffset += alignedSize;
+
+	return(m_pMapped + offset);
+}
+
+/***********************************************************
+ *  GetAlignedSize()
+ *
+ *  This method is used for rounding a size up to the offset
+ *  alignment of the uniform buffer bindings.
+ ***********************************************************/
+GLsizeiptr UploadRing::GetAlignedSize(GLsizeiptr size) const
+{
+	return(((size + m_alignment - 1) / m_alignment) * m_alignment);
+}
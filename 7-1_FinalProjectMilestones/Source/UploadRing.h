@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// uploadring.h
+// ============
+// persistently mapped buffer for the data written every frame
+//
+// The buffer is created once with immutable storage and stays mapped for the
+// whole run. It is split into three regions that are used in turn, one per
+// frame, so the CPU fills the region of the next frame while the GPU still
+// reads the previous ones. A fence placed at the end of each frame tells
+// when its region may be written again. Writing through the mapping avoids
+// the driver copies and implicit waits of glBufferSubData and glUniform*.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+class UploadRing
+{
+public:
+	// constructor
+	UploadRing();
+	// destructor
+	~UploadRing();
+
+	// create and map the buffer with room for the bytes of one frame
+	bool Initialize(GLsizeiptr regionSize);
+	// unmap and free the buffer and the fences
+	void Destroy();
+	// grow the regions when a frame needs more bytes, which waits
+	// for the GPU to finish with the old buffer
+	bool Reserve(GLsizeiptr regionSize);
+
+	// move to the region of the next frame, waiting for the GPU
+	// only if it still reads that region
+	void BeginFrame();
+	// fence the region written by this frame
+	void EndFrame();
+
+	// get aligned space in the region of this frame, returns NULL
+	// when the region is full
+	void* Allocate(GLsizeiptr size, GLintptr& offset);
+	// space that an allocation of the size takes up
+	GLsizeiptr GetAlignedSize(GLsizeiptr size) const;
+
+	GLuint GetBuffer() const { return m_buffer; }
+	// number of frames that had to wait for the GPU
+	int GetStallCount() const { return m_stallCount; }
+
+private:
+	static const int REGION_COUNT = 3;
+
+	GLuint m_buffer;
+	unsigned char* m_pMapped;
+	GLsizeiptr m_regionSize;
+	GLint m_alignment;
+	int m_region;
+	GLsizeiptr m_writeOffset;
+	GLsync m_fences[REGION_COUNT];
+	int m_stallCount;
+};
@@ -0,0 +1,166 @@
+#version 460 core
+layout (local_size_x = 64) in;
+
+// camera matrices written by the view manager, shared by all programs
+layout (std140, binding = 0) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    mat4 inverseView;
+    mat4 inverseProjection;
+    mat4 inverseViewProjection;
+    vec3 viewPosition;                       // camera position (world space)
+};
+
+struct ObjectRecord {
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color;
+    vec4 lightmapScaleOffset;
+    vec4 bounds;                             // world space sphere, radius in w
+    vec4 boxCenter;                          // mesh space box around the mesh
+    vec4 boxExtents;                         // half the size of the box
+    uvec4 drawInfo;                          // first group, levels, last level
+};
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int  baseVertex;
+    uint baseInstance;
+};
+
+layout (std430, binding = 2) buffer ObjectStorage {
+    ObjectRecord objects[];
+};
+layout (std430, binding = 3) readonly buffer DrawGroups {
+    uvec2 groups[];                          // index count, first command slot
+};
+layout (std430, binding = 4) writeonly buffer DrawCommands {
+    DrawCommand commands[];
+};
+layout (std430, binding = 5) buffer DrawCounts {
+    uint drawCounts[];
+};
+
+uniform int   objectCount;
+uniform bool  bSelectLod;
+uniform float lodCoverage[3];               // screen share below which the next level is used
+uniform float lodHysteresis;                // how far past a threshold a level changes
+
+// farthest occluder depth of each texel, halved with every level
+uniform bool      bOcclusion;
+uniform sampler2D hiZTexture;
+uniform vec2      hiZSize;                  // texels of the first level
+uniform int       hiZLevelCount;
+
+// Pick the level of detail from the share of the screen height covered by
+// the bounding sphere, moving away from the last level only once the share
+// is clearly past a threshold
+uint SelectLod(vec4 bounds, uint lodCount, uint lastLod)
+{
+    float coverage = bounds.w * projection[1][1];
+    if (projection[2][3] != 0.0) {
+        coverage /= max(length(bounds.xyz - viewPosition), bounds.w);
+    }
+
+    uint lod = min(lastLod, lodCount - 1u);
+    while ((lod > 0u) && (coverage > lodCoverage[lod - 1u] * (1.0 + lodHysteresis))) {
+        lod--;
+    }
+    while ((lod < lodCount - 1u) && (coverage < lodCoverage[lod] * (1.0 - lodHysteresis))) {
+        lod++;
+    }
+    return lod;
+}
+
+// Find the screen rectangle and nearest depth of the transformed mesh box,
+// then compare with the farthest occluder depth of the level on which the
+// rectangle covers at most 2x2 texels
+bool IsOccluded(mat4 model, vec3 boxCenter, vec3 boxExtents)
+{
+    vec2 uvMin = vec2(1.0);
+    vec2 uvMax = vec2(0.0);
+    float nearest = 1.0;
+    for (int i = 0; i < 8; i++) {
+        vec3 corner = boxCenter + boxExtents * vec3(
+            ((i & 1) != 0) ? 1.0 : -1.0,
+            ((i & 2) != 0) ? 1.0 : -1.0,
+            ((i & 4) != 0) ? 1.0 : -1.0);
+        vec4 clip = viewProjection * (model * vec4(corner, 1.0));
+        // bounds reaching behind the camera are never hidden
+        if (clip.w <= 0.0) {
+            return false;
+        }
+        vec3 ndc = clip.xyz / clip.w;
+        uvMin = min(uvMin, ndc.xy * 0.5 + 0.5);
+        uvMax = max(uvMax, ndc.xy * 0.5 + 0.5);
+        nearest = min(nearest, ndc.z * 0.5 + 0.5);
+    }
+    if (nearest <= 0.0) {
+        return false;
+    }
+
+    uvMin = clamp(uvMin, 0.0, 1.0);
+    uvMax = clamp(uvMax, 0.0, 1.0);
+    vec2 extent = (uvMax - uvMin) * hiZSize;
+    int level = clamp(int(ceil(log2(max(max(extent.x, extent.y), 1.0)))), 0, hiZLevelCount - 1);
+
+    ivec2 levelMax = textureSize(hiZTexture, level) - 1;
+    ivec2 texelMin = clamp(ivec2(uvMin * vec2(levelMax + 1)), ivec2(0), levelMax);
+    ivec2 texelMax = clamp(ivec2(uvMax * vec2(levelMax + 1)), ivec2(0), levelMax);
+    float farthest = max(
+        max(texelFetch(hiZTexture, texelMin, level).r,
+            texelFetch(hiZTexture, ivec2(texelMax.x, texelMin.y), level).r),
+        max(texelFetch(hiZTexture, ivec2(texelMin.x, texelMax.y), level).r,
+            texelFetch(hiZTexture, texelMax, level).r));
+
+    return nearest > farthest;
+}
+
+// Test one object against the frustum and the occluders and append a draw
+// command for it to the group of its level of detail
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= uint(objectCount)) {
+        return;
+    }
+
+    vec4 bounds = objects[index].bounds;
+
+    // The planes are the sums and differences of the rows of the
+    // view-projection matrix, which are the columns of its transpose
+    mat4 rows = transpose(viewProjection);
+    vec4 planes[6] = vec4[6](
+        rows[3] + rows[0], rows[3] - rows[0],
+        rows[3] + rows[1], rows[3] - rows[1],
+        rows[3] + rows[2], rows[3] - rows[2]);
+    for (int i = 0; i < 6; i++) {
+        if (dot(planes[i].xyz, bounds.xyz) + planes[i].w < -bounds.w * length(planes[i].xyz)) {
+            return;
+        }
+    }
+    if (bOcclusion && IsOccluded(objects[index].model, objects[index].boxCenter.xyz, objects[index].boxExtents.xyz)) {
+        return;
+    }
+
+    uvec4 drawInfo = objects[index].drawInfo;
+    uint lod = 0u;
+    if (bSelectLod && (drawInfo.y > 1u)) {
+        lod = SelectLod(bounds, drawInfo.y, drawInfo.z);
+        objects[index].drawInfo.z = lod;
+    }
+
+    uint group = drawInfo.x + lod;
+    uint slot = atomicAdd(drawCounts[group], 1u);
+
+    DrawCommand command;
+    command.count = groups[group].x;
+    command.instanceCount = 1u;
+    command.firstIndex = 0u;
+    command.baseVertex = 0;
+    command.baseInstance = index;
+    commands[groups[group].y + slot] = command;
+}
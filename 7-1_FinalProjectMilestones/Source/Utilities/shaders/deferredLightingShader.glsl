@@ -0,0 +1,138 @@
+#version 460 core
+out vec4 FragColor;
+
+in vec2 vScreenUV;
+
+// ------------------------------
+// UNIFORMS
+// ------------------------------
+struct Light {
+    vec4  position;           // xyz used
+    vec4  ambientColor;       // rgb used
+    vec4  diffuseColor;       // rgb used
+    vec4  specularColor;      // rgb used
+    float focalStrength;      // shininess
+    float specularIntensity;  // scales specular term
+};
+
+uniform int   lightCount;                 // number of lights in the storage block
+layout (std430, binding = 6) readonly buffer LightStorage {
+    Light lightSources[];                 // every light of the scene
+};
+
+uniform sampler2D   gAlbedo;              // rgb = base color
+uniform sampler2D   gNormal;              // xyz = world normal, w = 1 when already lit
+uniform sampler2D   gDepth;               // window-space depth
+
+// camera matrices written by the view manager, shared by all programs
+layout (std140, binding = 0) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    mat4 inverseView;
+    mat4 inverseProjection;
+    mat4 inverseViewProjection;
+    vec3 viewPosition;                       // camera position (world space)
+};
+
+uniform bool        bUseProbeLighting;    // ambient from the irradiance probes
+uniform sampler3D   probeTexture;         // 7 RGBA slabs of SH coefficients along Z
+uniform vec3        probeGridMin;         // world position of the first probe
+uniform vec3        probeGridMax;         // world position of the last probe
+uniform vec3        probeGridDims;        // probes per axis
+
+// ------------------------------
+// IRRADIANCE PROBES
+// ------------------------------
+// Same evaluation as in fragmentShader.glsl
+vec3 EvaluateProbeIrradiance(vec3 worldPos, vec3 n)
+{
+    vec3 local = clamp((worldPos - probeGridMin) / max(probeGridMax - probeGridMin, vec3(0.0001)), 0.0, 1.0);
+    vec3 texel = (local * (probeGridDims - 1.0) + 0.5) / probeGridDims;
+
+    float c[28];
+    for (int s = 0; s < 7; ++s) {
+        vec4 v = texture(probeTexture, vec3(texel.xy, (float(s) + texel.z) / 7.0));
+        c[s * 4 + 0] = v.x;
+        c[s * 4 + 1] = v.y;
+        c[s * 4 + 2] = v.z;
+        c[s * 4 + 3] = v.w;
+    }
+
+    vec3 sh[9];
+    for (int i = 0; i < 9; ++i) {
+        sh[i] = vec3(c[i * 3 + 0], c[i * 3 + 1], c[i * 3 + 2]);
+    }
+
+    vec3 irradiance = sh[0] * 0.282095
+                    + sh[1] * 0.488603 * n.y
+                    + sh[2] * 0.488603 * n.z
+                    + sh[3] * 0.488603 * n.x
+                    + sh[4] * 1.092548 * n.x * n.y
+                    + sh[5] * 1.092548 * n.y * n.z
+                    + sh[6] * 0.315392 * (3.0 * n.z * n.z - 1.0)
+                    + sh[7] * 1.092548 * n.x * n.z
+                    + sh[8] * 0.546274 * (n.x * n.x - n.y * n.y);
+
+    return max(irradiance, vec3(0.0));
+}
+
+// ------------------------------
+// MAIN
+// ------------------------------
+void main()
+{
+    float depth = texture(gDepth, vScreenUV).r;
+
+    // Nothing was drawn here, keep the clear color
+    if (depth >= 1.0) {
+        discard;
+    }
+    gl_FragDepth = depth;
+
+    vec3 base = texture(gAlbedo, vScreenUV).rgb;
+    vec4 normalData = texture(gNormal, vScreenUV);
+
+    if (normalData.w > 0.5) {
+        FragColor = vec4(base, 1.0);
+        return;
+    }
+
+    // Rebuild the world position from the depth
+    vec4 clipPos  = vec4(vScreenUV * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec4 worldPos = inverseViewProjection * clipPos;
+    vec3 P = worldPos.xyz / worldPos.w;
+
+    vec3 N = normalize(normalData.xyz);
+    vec3 V = normalize(viewPosition - P);
+
+    vec3 ambientAccum  = vec3(0.0);
+    vec3 diffuseAccum  = vec3(0.0);
+    vec3 specularAccum = vec3(0.0);
+
+    // Accumulate contribution from each active light
+    for (int i = 0; i < lightCount; ++i) {
+        vec3 L = normalize(lightSources[i].position.xyz - P);
+        float NdotL = max(dot(N, L), 0.0);
+
+        // Ambient + Diffuse
+        if (!bUseProbeLighting) {
+            ambientAccum += lightSources[i].ambientColor.rgb * base;
+        }
+        diffuseAccum += lightSources[i].diffuseColor.rgb * base * NdotL;
+
+        // Specular (Phong)
+        vec3 R = reflect(-L, N);
+        float specPow   = max(dot(R, V), 0.0);
+        float shininess = max(lightSources[i].focalStrength, 1.0);
+        specularAccum  += lightSources[i].specularColor.rgb
+                        *  lightSources[i].specularIntensity
+                        *  pow(specPow, shininess);
+    }
+
+    if (bUseProbeLighting) {
+        ambientAccum = EvaluateProbeIrradiance(P, N) * base;
+    }
+
+    FragColor = vec4(ambientAccum + diffuseAccum + specularAccum, 1.0);
+}
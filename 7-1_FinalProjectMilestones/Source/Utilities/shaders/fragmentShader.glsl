@@ -1,76 +1,227 @@
-#version 460 core
-out vec4 FragColor;
-
-in vec3 vWorldPos;
-in vec3 vWorldNormal;
-in vec2 vUV;
-
-// ------------------------------
-// CONFIG
-// ------------------------------
-#define MAX_LIGHTS 8
-
-// ------------------------------
-// UNIFORMS
-// ------------------------------
-struct Light {
-    vec3  position;
-    vec3  ambientColor;
-    vec3  diffuseColor;
-    vec3  specularColor;
-    float focalStrength;      // shininess
-    float specularIntensity;  // scales specular term
-};
-
-uniform int   lightCount;                 // <-- number of active lights [0..MAX_LIGHTS]
-uniform Light lightSources[MAX_LIGHTS];   // <-- array of lights
-
-uniform bool        bUseLighting;
-
-uniform bool        bUseTexture;
-uniform sampler2D   objectTexture;
-uniform vec4        objectColor;          // RGBA
-uniform vec3        viewPosition;         // camera position (world space)
-
-// ------------------------------
-// MAIN
-// ------------------------------
-void main()
-{
-    // Base color (with alpha)
-    vec4 base = bUseTexture ? texture(objectTexture, vUV) : objectColor;
-
-    if (!bUseLighting) {
-        FragColor = base;
-        return;
-    }
-
-    vec3 N = normalize(vWorldNormal);
-    vec3 V = normalize(viewPosition - vWorldPos);
-
-    vec3 ambientAccum  = vec3(0.0);
-    vec3 diffuseAccum  = vec3(0.0);
-    vec3 specularAccum = vec3(0.0);
-
-    // Accumulate contribution from each active light
-    for (int i = 0; i < lightCount && i < MAX_LIGHTS; ++i) {
-        vec3 L = normalize(lightSources[i].position - vWorldPos);
-        float NdotL = max(dot(N, L), 0.0);
-
-        // Ambient + Diffuse
-        ambientAccum += lightSources[i].ambientColor * base.rgb;
-        diffuseAccum += lightSources[i].diffuseColor * base.rgb * NdotL;
-
-        // Specular (Phong)
-        vec3 R = reflect(-L, N);
-        float specPow   = max(dot(R, V), 0.0);
-        float shininess = max(lightSources[i].focalStrength, 1.0);
-        specularAccum  += lightSources[i].specularColor
-                        *  lightSources[i].specularIntensity
-                        *  pow(specPow, shininess);
-    }
-
-    vec3 lighting = ambientAccum + diffuseAccum + specularAccum;
-
-    FragColor = vec4(lighting, base.a);
-}
+#version 460 core
+layout (location = 0) out vec4 FragColor;   // color, or weighted accumulation for OIT
+layout (location = 1) out vec4 RevealOut;   // OIT revealage, ignored otherwise
+
+in vec3 vWorldPos;
+in vec3 vWorldNormal;
+in vec2 vUV;
+in vec2 vLightmapUV;
+flat in vec4 vObjectColor;
+
+// ------------------------------
+// CONFIG
+// ------------------------------
+#define MAX_LIGHTS 8
+
+// ------------------------------
+// UNIFORMS
+// ------------------------------
+struct Light {
+    vec3  position;
+    vec3  ambientColor;
+    vec3  diffuseColor;
+    vec3  specularColor;
+    float focalStrength;      // shininess
+    float specularIntensity;  // scales specular term
+};
+
+uniform int   lightCount;                 // <-- number of active lights [0..MAX_LIGHTS]
+uniform Light lightSources[MAX_LIGHTS];   // <-- array of lights
+
+uniform bool        bUseLighting;
+
+uniform bool        bUseTexture;
+uniform sampler2D   objectTexture;
+uniform vec4        objectColor;          // RGBA
+
+// camera matrices written by the view manager, shared by all programs
+layout (std140, binding = 0) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    mat4 inverseView;
+    mat4 inverseProjection;
+    mat4 inverseViewProjection;
+    vec3 viewPosition;                       // camera position (world space)
+};
+
+// per-object values written into the upload ring
+uniform bool        bUseObjectBuffer;
+layout (std140, binding = 1) uniform ObjectBlock {
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color;
+    vec4 lightmapScaleOffset;
+} objectBlock;
+
+// per-object color of the objects drawn by the GPU culling
+uniform bool        bUseObjectStorage;
+
+uniform bool        bUseLightmap;         // static object with baked lighting
+uniform sampler2D   lightmapTexture;      // baked ambient + diffuse irradiance
+
+uniform bool        bUseProbeLighting;    // ambient from the irradiance probes
+uniform bool        bUseOIT;              // weighted blended transparency pass
+uniform sampler3D   probeTexture;         // 7 RGBA slabs of SH coefficients along Z
+uniform vec3        probeGridMin;         // world position of the first probe
+uniform vec3        probeGridMax;         // world position of the last probe
+uniform vec3        probeGridDims;        // probes per axis
+
+// ------------------------------
+// FEATURE SWITCHES
+// ------------------------------
+// The permutation compiler defines PERMUTATION, LIGHT_COUNT and a USE_*
+// symbol for each enabled feature, which turns the switches into constants
+// so that every variant only keeps its own code. Without it the switches
+// are read from the uniforms above.
+#ifdef PERMUTATION
+    #ifdef USE_TEXTURE
+        #define FEATURE_TEXTURE true
+    #else
+        #define FEATURE_TEXTURE false
+    #endif
+    #ifdef USE_LIGHTING
+        #define FEATURE_LIGHTING true
+    #else
+        #define FEATURE_LIGHTING false
+    #endif
+    #ifdef USE_LIGHTMAP
+        #define FEATURE_LIGHTMAP true
+    #else
+        #define FEATURE_LIGHTMAP false
+    #endif
+    #ifdef USE_PROBES
+        #define FEATURE_PROBES true
+    #else
+        #define FEATURE_PROBES false
+    #endif
+    #ifdef USE_OIT
+        #define FEATURE_OIT true
+    #else
+        #define FEATURE_OIT false
+    #endif
+    #define ACTIVE_LIGHTS LIGHT_COUNT
+#else
+    #define FEATURE_TEXTURE  bUseTexture
+    #define FEATURE_LIGHTING bUseLighting
+    #define FEATURE_LIGHTMAP bUseLightmap
+    #define FEATURE_PROBES   bUseProbeLighting
+    #define FEATURE_OIT      bUseOIT
+    #define ACTIVE_LIGHTS    lightCount
+#endif
+
+// ------------------------------
+// IRRADIANCE PROBES
+// ------------------------------
+// Blend the eight nearest probes and evaluate the L2 spherical harmonic
+// irradiance for the normal. The basis order matches IrradianceVolume.cpp.
+vec3 EvaluateProbeIrradiance(vec3 worldPos, vec3 n)
+{
+    vec3 local = clamp((worldPos - probeGridMin) / max(probeGridMax - probeGridMin, vec3(0.0001)), 0.0, 1.0);
+    // keep the lookup between the first and last texel centers
+    // so that the filtering never crosses into the next slab
+    vec3 texel = (local * (probeGridDims - 1.0) + 0.5) / probeGridDims;
+
+    float c[28];
+    for (int s = 0; s < 7; ++s) {
+        vec4 v = texture(probeTexture, vec3(texel.xy, (float(s) + texel.z) / 7.0));
+        c[s * 4 + 0] = v.x;
+        c[s * 4 + 1] = v.y;
+        c[s * 4 + 2] = v.z;
+        c[s * 4 + 3] = v.w;
+    }
+
+    vec3 sh[9];
+    for (int i = 0; i < 9; ++i) {
+        sh[i] = vec3(c[i * 3 + 0], c[i * 3 + 1], c[i * 3 + 2]);
+    }
+
+    vec3 irradiance = sh[0] * 0.282095
+                    + sh[1] * 0.488603 * n.y
+                    + sh[2] * 0.488603 * n.z
+                    + sh[3] * 0.488603 * n.x
+                    + sh[4] * 1.092548 * n.x * n.y
+                    + sh[5] * 1.092548 * n.y * n.z
+                    + sh[6] * 0.315392 * (3.0 * n.z * n.z - 1.0)
+                    + sh[7] * 1.092548 * n.x * n.z
+                    + sh[8] * 0.546274 * (n.x * n.x - n.y * n.y);
+
+    return max(irradiance, vec3(0.0));
+}
+
+// ------------------------------
+// OUTPUT
+// ------------------------------
+// In the transparency pass every fragment is added to the accumulation
+// target with a weight that favors fragments close to the camera, and
+// multiplies the revealage by its transparency (McGuire and Bavoil 2013).
+void WriteColor(vec3 color, float alpha)
+{
+    if (FEATURE_OIT) {
+        float weight = clamp(alpha * max(1e-2, 3e3 * pow(1.0 - gl_FragCoord.z, 3.0)), 1e-2, 3e3);
+        FragColor = vec4(color * alpha, alpha) * weight;
+        RevealOut = vec4(alpha);
+    }
+    else {
+        FragColor = vec4(color, alpha);
+    }
+}
+
+// ------------------------------
+// MAIN
+// ------------------------------
+void main()
+{
+    // Base color (with alpha)
+    vec4 color = bUseObjectStorage ? vObjectColor :
+        (bUseObjectBuffer ? objectBlock.color : objectColor);
+    vec4 base = FEATURE_TEXTURE ? texture(objectTexture, vUV) : color;
+
+    if (!FEATURE_LIGHTING) {
+        WriteColor(base.rgb, base.a);
+        return;
+    }
+
+    // Baked lighting: one lookup instead of the light loop
+    if (FEATURE_LIGHTMAP) {
+        WriteColor(base.rgb * texture(lightmapTexture, vLightmapUV).rgb, base.a);
+        return;
+    }
+
+    vec3 N = normalize(vWorldNormal);
+    vec3 V = normalize(viewPosition - vWorldPos);
+
+    vec3 ambientAccum  = vec3(0.0);
+    vec3 diffuseAccum  = vec3(0.0);
+    vec3 specularAccum = vec3(0.0);
+
+    // Accumulate contribution from each active light
+    for (int i = 0; i < ACTIVE_LIGHTS && i < MAX_LIGHTS; ++i) {
+        vec3 L = normalize(lightSources[i].position - vWorldPos);
+        float NdotL = max(dot(N, L), 0.0);
+
+        // Ambient + Diffuse
+        if (!FEATURE_PROBES) {
+            ambientAccum += lightSources[i].ambientColor * base.rgb;
+        }
+        diffuseAccum += lightSources[i].diffuseColor * base.rgb * NdotL;
+
+        // Specular (Phong)
+        vec3 R = reflect(-L, N);
+        float specPow   = max(dot(R, V), 0.0);
+        float shininess = max(lightSources[i].focalStrength, 1.0);
+        specularAccum  += lightSources[i].specularColor
+                        *  lightSources[i].specularIntensity
+                        *  pow(specPow, shininess);
+    }
+
+    // The probes already contain the ambient light of all lights,
+    // shadowed and tinted by the surrounding objects
+    if (FEATURE_PROBES) {
+        ambientAccum = EvaluateProbeIrradiance(vWorldPos, N) * base.rgb;
+    }
+
+    vec3 lighting = ambientAccum + diffuseAccum + specularAccum;
+
+    WriteColor(lighting, base.a);
+}
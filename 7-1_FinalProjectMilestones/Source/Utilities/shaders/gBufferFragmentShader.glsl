@@ -0,0 +1,61 @@
+#version 460 core
+layout (location = 0) out vec4 gAlbedo;   // rgb = base color
+layout (location = 1) out vec4 gNormal;   // xyz = world normal, w = 1 when already lit
+
+in vec3 vWorldPos;
+in vec3 vWorldNormal;
+in vec2 vUV;
+in vec2 vLightmapUV;
+flat in vec4 vObjectColor;
+
+// ------------------------------
+// UNIFORMS
+// ------------------------------
+uniform bool        bUseLighting;
+
+uniform bool        bUseTexture;
+uniform sampler2D   objectTexture;
+uniform vec4        objectColor;          // RGBA
+
+// per-object values written into the upload ring
+uniform bool        bUseObjectBuffer;
+layout (std140, binding = 1) uniform ObjectBlock {
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color;
+    vec4 lightmapScaleOffset;
+} objectBlock;
+
+// per-object color of the objects drawn by the GPU culling
+uniform bool        bUseObjectStorage;
+
+uniform bool        bUseLightmap;         // static object with baked lighting
+uniform sampler2D   lightmapTexture;      // baked ambient + diffuse irradiance
+
+// ------------------------------
+// MAIN
+// ------------------------------
+void main()
+{
+    vec4 color = bUseObjectStorage ? vObjectColor :
+        (bUseObjectBuffer ? objectBlock.color : objectColor);
+    vec4 base = bUseTexture ? texture(objectTexture, vUV) : color;
+    vec3 N = normalize(vWorldNormal);
+
+    // Unlit and baked surfaces store their final color and
+    // are passed through by the lighting pass
+    if (!bUseLighting) {
+        gAlbedo = vec4(base.rgb, 1.0);
+        gNormal = vec4(N, 1.0);
+        return;
+    }
+
+    if (bUseLightmap) {
+        gAlbedo = vec4(base.rgb * texture(lightmapTexture, vLightmapUV).rgb, 1.0);
+        gNormal = vec4(N, 1.0);
+        return;
+    }
+
+    gAlbedo = vec4(base.rgb, 1.0);
+    gNormal = vec4(N, 0.0);
+}
@@ -0,0 +1,27 @@
+#version 460 core
+layout (local_size_x = 8, local_size_y = 8) in;
+
+uniform sampler2D sourceDepth;              // occluder depth or the level above
+uniform int sourceLevel;
+layout (r32f, binding = 0) uniform writeonly image2D pyramidLevel;
+
+// Keep the farthest of the 2x2 source texels under each texel of the level,
+// so an object nearer than a texel is in front of everything it covers
+void main()
+{
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(texel, imageSize(pyramidLevel)))) {
+        return;
+    }
+
+    // the last levels of a wide pyramid are one texel high
+    ivec2 sourceMax = textureSize(sourceDepth, sourceLevel) - 1;
+    ivec2 source = texel * 2;
+    float farthest = max(
+        max(texelFetch(sourceDepth, min(source, sourceMax), sourceLevel).r,
+            texelFetch(sourceDepth, min(source + ivec2(1, 0), sourceMax), sourceLevel).r),
+        max(texelFetch(sourceDepth, min(source + ivec2(0, 1), sourceMax), sourceLevel).r,
+            texelFetch(sourceDepth, min(source + ivec2(1, 1), sourceMax), sourceLevel).r));
+
+    imageStore(pyramidLevel, texel, vec4(farthest));
+}
@@ -0,0 +1,6 @@
+#version 460 core
+
+// The occluder target has no color, the depth is written by the fixed
+// function stage
+void main() {
+}
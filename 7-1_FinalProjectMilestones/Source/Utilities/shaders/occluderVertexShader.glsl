@@ -0,0 +1,26 @@
+#version 460 core
+layout (location = 0) in vec3 aPos;
+
+// camera matrices written by the view manager, shared by all programs
+layout (std140, binding = 0) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    mat4 inverseView;
+    mat4 inverseProjection;
+    mat4 inverseViewProjection;
+    vec3 viewPosition;                       // camera position (world space)
+};
+
+uniform mat4 model;
+
+// the compact vertex layout stores positions as fractions of the mesh
+// bounds, the float layout uses a zero offset and a unit scale
+uniform vec3 positionDecodeOffset;
+uniform vec3 positionDecodeScale;
+
+// Only the depth of the occluders is written, so only the position is read
+void main() {
+    vec3 position = aPos * positionDecodeScale + positionDecodeOffset;
+    gl_Position   = viewProjection * model * vec4(position, 1.0);
+}
@@ -0,0 +1,29 @@
+#version 460 core
+out vec4 FragColor;
+
+in vec2 vScreenUV;
+
+uniform sampler2D accumTexture;   // sum of weighted premultiplied colors
+uniform sampler2D revealTexture;  // product of the transparencies
+
+// Resolve the weighted blended transparency targets into one color that
+// is blended over the opaque scene
+void main()
+{
+    float reveal = texture(revealTexture, vScreenUV).r;
+
+    // No transparent surface covers this pixel
+    if (reveal >= 1.0) {
+        discard;
+    }
+
+    vec4 accum = texture(accumTexture, vScreenUV);
+
+    // Guard against overflow of the half float sums
+    if (isinf(max(max(abs(accum.r), abs(accum.g)), abs(accum.b)))) {
+        accum.rgb = vec3(accum.a);
+    }
+
+    vec3 average = accum.rgb / max(accum.a, 1e-5);
+    FragColor = vec4(average, 1.0 - reveal);
+}
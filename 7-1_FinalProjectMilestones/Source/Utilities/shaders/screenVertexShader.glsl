@@ -0,0 +1,10 @@
+#version 460 core
+out vec2 vScreenUV;
+
+// One triangle that covers the whole screen, built from the vertex index
+// so that no vertex buffer is needed
+void main() {
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    vScreenUV   = corner;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
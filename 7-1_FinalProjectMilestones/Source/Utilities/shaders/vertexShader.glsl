@@ -1,20 +1,88 @@
-#version 460 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTex;
-
-out vec3 vWorldPos;
-out vec3 vWorldNormal;
-out vec2 vUV;
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
-void main() {
-    vec4 worldPos  = model * vec4(aPos, 1.0);
-    vWorldPos      = worldPos.xyz;
-    vWorldNormal   = mat3(transpose(inverse(model))) * aNormal;
-    vUV            = aTex;
-    gl_Position    = projection * view * worldPos;
-}
+#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTex;
+layout (location = 3) in vec2 aLightmapUV;   // only set for baked meshes
+
+out vec3 vWorldPos;
+out vec3 vWorldNormal;
+out vec2 vUV;
+out vec2 vLightmapUV;
+flat out vec4 vObjectColor;                  // color of an object drawn from storage
+
+// camera matrices written by the view manager, shared by all programs
+layout (std140, binding = 0) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    mat4 inverseView;
+    mat4 inverseProjection;
+    mat4 inverseViewProjection;
+    vec3 viewPosition;                       // camera position (world space)
+};
+
+uniform mat4 model;
+uniform vec4 lightmapScaleOffset;            // object tile in the lightmap atlas
+
+// the compact vertex layout stores positions as fractions of the mesh
+// bounds, the float layout uses a zero offset and a unit scale
+uniform vec3 positionDecodeOffset;
+uniform vec3 positionDecodeScale;
+
+// per-object values written into the upload ring, replacing the
+// uniforms above when bUseObjectBuffer is set
+uniform bool bUseObjectBuffer;
+layout (std140, binding = 1) uniform ObjectBlock {
+    mat4 model;
+    mat4 normalMatrix;                       // inverse transpose of the model
+    vec4 color;
+    vec4 lightmapScaleOffset;
+} objectBlock;
+
+// all the objects of the scene, read through the base instance of the
+// indirect draws of the GPU culling when bUseObjectStorage is set
+uniform bool bUseObjectStorage;
+struct ObjectRecord {
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color;
+    vec4 lightmapScaleOffset;
+    vec4 bounds;
+    vec4 boxCenter;
+    vec4 boxExtents;
+    uvec4 drawInfo;
+};
+layout (std430, binding = 2) readonly buffer ObjectStorage {
+    ObjectRecord objects[];
+};
+
+void main() {
+    mat4 objectModel;
+    mat3 normalMatrix;
+    vec4 scaleOffset;
+    vObjectColor = vec4(1.0);
+    if (bUseObjectStorage) {
+        objectModel  = objects[gl_BaseInstance].model;
+        normalMatrix = mat3(objects[gl_BaseInstance].normalMatrix);
+        scaleOffset  = objects[gl_BaseInstance].lightmapScaleOffset;
+        vObjectColor = objects[gl_BaseInstance].color;
+    }
+    else if (bUseObjectBuffer) {
+        objectModel  = objectBlock.model;
+        normalMatrix = mat3(objectBlock.normalMatrix);
+        scaleOffset  = objectBlock.lightmapScaleOffset;
+    }
+    else {
+        objectModel  = model;
+        normalMatrix = mat3(transpose(inverse(model)));
+        scaleOffset  = lightmapScaleOffset;
+    }
+
+    vec3 position  = aPos * positionDecodeScale + positionDecodeOffset;
+    vec4 worldPos  = objectModel * vec4(position, 1.0);
+    vWorldPos      = worldPos.xyz;
+    vWorldNormal   = normalMatrix * aNormal;
+    vUV            = aTex;
+    vLightmapUV    = aLightmapUV * scaleOffset.xy + scaleOffset.zw;
+    gl_Position    = viewProjection * worldPos;
+}
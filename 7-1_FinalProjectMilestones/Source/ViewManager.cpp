@@ -1,339 +1,702 @@
-///////////////////////////////////////////////////////////////////////////////
-// viewmanager.h
-// ============
-// manage the viewing of 3D objects within the viewport
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include "ViewManager.h"
-
-// GLM Math Header inclusions
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>    
-#include <glm/gtc/matrix_transform.hpp>
-
-
-float gSpeedScale = 5.0f;
-float gLookSpeed = 500.0f;
-
-// declaration of the global variables and defines
-namespace
-{
-	// Variables for window width and height
-	const int WINDOW_WIDTH = 1000;
-	const int WINDOW_HEIGHT = 800;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
-
-	// camera object used for viewing and interacting with
-	// the 3D scene
-	Camera* g_pCamera = nullptr;
-
-	// these variables are used for mouse movement processing
-	float gLastX = WINDOW_WIDTH / 2.0f;
-	float gLastY = WINDOW_HEIGHT / 2.0f;
-	bool gFirstMouse = true;
-
-	// time between current frame and last frame
-	float gDeltaTime = 0.0f; 
-	float gLastFrame = 0.0f;
-
-	// the following variable is false when orthographic projection
-	// is off and true when it is on
-	bool bOrthographicProjection = false;
-}
-
-/***********************************************************
- *  ViewManager()
- *
- *  The constructor for the class
- ***********************************************************/
-ViewManager::ViewManager(
-	ShaderManager *pShaderManager)
-{
-	// initialize the member variables
-	m_pShaderManager = pShaderManager;
-	m_pWindow = NULL;
-	g_pCamera = new Camera();
-	// default camera view parameters
-	g_pCamera->Position = glm::vec3(0.0f, 12.0f, 25.0f);
-	g_pCamera->Front = glm::vec3(0.0f, -0.2f, -2.0f);
-	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-	g_pCamera->Zoom = 80;
-}
-
-/***********************************************************
- *  ~ViewManager()
- *
- *  The destructor for the class
- ***********************************************************/
-ViewManager::~ViewManager()
-{
-	// free up allocated memory
-	m_pShaderManager = NULL;
-	m_pWindow = NULL;
-	if (NULL != g_pCamera)
-	{
-		delete g_pCamera;
-		g_pCamera = NULL;
-	}
-}
-
-/***********************************************************
- *  CreateDisplayWindow()
- *
- *  This method is used to create the main display window.
- ***********************************************************/
-GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
-{
-	GLFWwindow* window = nullptr;
-
-	// try to create the displayed OpenGL window
-	window = glfwCreateWindow(
-		WINDOW_WIDTH,
-		WINDOW_HEIGHT,
-		windowTitle,
-		NULL, NULL);
-	if (window == NULL)
-	{
-		std::cout << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
-		return NULL;
-	}
-	glfwMakeContextCurrent(window);
-
-	// tell GLFW to capture all mouse events
-	//glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-
-	// this callback is used to receive mouse moving events
-	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
-
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	m_pWindow = window;
-
-	return(window);
-}
-
-/***********************************************************
- *  Mouse_Position_Callback()
- *
- *  This method is automatically called from GLFW whenever
- *  the mouse is moved within the active GLFW display window.
- ***********************************************************/
-void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
-{
-	// when the first mouse move event is received, this needs to be recorded so that
-	// all subsequent mouse moves can correctly calculate the X position offset and Y
-	// position offset for proper operation
-	if (gFirstMouse)
-	{
-		gLastX = xMousePos;
-		gLastY = yMousePos;
-		gFirstMouse = false;
-	}
-
-	// calculate the X offset and Y offset values for moving the 3D camera accordingly
-	float xOffset = xMousePos - gLastX;
-	float yOffset = gLastY - yMousePos; // reversed since y-coordinates go from bottom to top
-
-	// set the current positions into the last position variables
-	gLastX = xMousePos;
-	gLastY = yMousePos;
-
-	// move the 3D camera according to the calculated offsets
-	g_pCamera->ProcessMouseMovement(xOffset, yOffset);
-
-	glfwSetCursorPosCallback(window, ViewManager::Mouse_Position_Callback);
-	glfwSetScrollCallback(window, ViewManager::Mouse_Scroll_Callback);
-
-}
-
-/***********************************************************
- *  Mouse_Scroll_Callback()
- *
- *  This method is used for adjusting the speed of the
- * scene movement based on the mouse scroll function
- ***********************************************************/
-void ViewManager::Mouse_Scroll_Callback(GLFWwindow* /*window*/, double /*xOffset*/, double yOffset)
-{
-	// Each scroll "notch" changes speed by ~15%
-	constexpr float STEP = 0.50f;       // fixed amount to change per scroll
-	constexpr float MIN_SPEED = 0.05f;
-	constexpr float MAX_SPEED = 20.0f;
-
-	if (yOffset > 0.0) {
-		gSpeedScale += STEP * static_cast<float>(yOffset);
-	}
-	else if (yOffset < 0.0) {
-		gSpeedScale += STEP * static_cast<float>(yOffset);  // yOffset is negative, so this subtracts
-	}
-
-	// Clamp
-	if (gSpeedScale < MIN_SPEED) gSpeedScale = MIN_SPEED;
-	if (gSpeedScale > MAX_SPEED) gSpeedScale = MAX_SPEED;
-}
-
-/***********************************************************
- *  ProcessKeyboardEvents()
- *
- *  This method is called to process any keyboard events
- *  that may be waiting in the event queue.
- ***********************************************************/
-void ViewManager::ProcessKeyboardEvents()
-{
-	// sets the rotation speed of the camera for the arrows
-	float rotationSpeed = 50.0f;
-
-	// close the window if the escape key has been pressed
-	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-	{
-		glfwSetWindowShouldClose(m_pWindow, true);
-	}
-
-	// process camera zooming in and out
-	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime * gSpeedScale);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime * gSpeedScale);
-	}
-
-	// process camera panning left and right
-	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime * gSpeedScale);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime * gSpeedScale);
-	}
-
-	// process camera panning up and down
-	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime * gSpeedScale);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(UP, gDeltaTime * gSpeedScale);
-	}
-
-	float dx = 0.0f, dy = 0.0f;
-
-	if (glfwGetKey(m_pWindow, GLFW_KEY_LEFT) == GLFW_PRESS) dx -= gLookSpeed * gDeltaTime * gSpeedScale; // look left
-	if (glfwGetKey(m_pWindow, GLFW_KEY_RIGHT) == GLFW_PRESS) dx += gLookSpeed * gDeltaTime * gSpeedScale; // look right
-
-	// optional: look up/down with arrows
-	if (glfwGetKey(m_pWindow, GLFW_KEY_DOWN) == GLFW_PRESS) dy += gLookSpeed * gDeltaTime * gSpeedScale; // look down
-	if (glfwGetKey(m_pWindow, GLFW_KEY_UP) == GLFW_PRESS) dy -= gLookSpeed * gDeltaTime * gSpeedScale; // look up
-
-	if (dx != 0.0f || dy != 0.0f) {
-		g_pCamera->ProcessMouseMovement(dx, dy);
-	}
-
-	// Orth - Persp View
-	bool tDown = (glfwGetKey(m_pWindow, GLFW_KEY_T) == GLFW_PRESS);
-	bool gDown = (glfwGetKey(m_pWindow, GLFW_KEY_G) == GLFW_PRESS);
-
-	// Change mode on press, and only print when the mode actually changes
-	static bool lastOrtho = bOrthographicProjection;
-
-	if (tDown) bOrthographicProjection = true;   // ORTHO
-	if (gDown) bOrthographicProjection = false;  // PERSPECTIVE
-
-	if (bOrthographicProjection != lastOrtho) {
-		std::cout << (bOrthographicProjection ? "View Set to Orthographic (2D)\n"
-			: "View Set to Perspective (3D)\n");
-		lastOrtho = bOrthographicProjection;
-		
-	}
-
-	if (glfwGetKey(m_pWindow, GLFW_KEY_1) == GLFW_PRESS) {
-		// Front view
-		g_pCamera->Position = glm::vec3(0.0f, 12.0f, 25.0f);
-		g_pCamera->Front = glm::normalize(glm::vec3(0.0f, -0.2f, -1.0f));
-	}
-
-	if (glfwGetKey(m_pWindow, GLFW_KEY_2) == GLFW_PRESS) {
-		// Window view
-		g_pCamera->Position = glm::vec3(0.0f, 22.0f, 12.0f);
-		g_pCamera->Front = glm::normalize(glm::vec3(0.0f, -0.1f, -1.0f));
-	}
-
-	if (glfwGetKey(m_pWindow, GLFW_KEY_3) == GLFW_PRESS) {
-		// Overview
-		g_pCamera->Position = glm::vec3(15.0f, 21.0f, 25.0f);  
-		g_pCamera->Front = glm::normalize(glm::vec3(-0.3f, -0.4f, -1.0f));  
-		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-	}
-
-}
-
-/***********************************************************
- *  PrepareSceneView()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
- ***********************************************************/
-void ViewManager::PrepareSceneView()
-{
-	glm::mat4 view;
-	glm::mat4 projection;
-
-	// per-frame timing
-	float currentFrame = glfwGetTime();
-	gDeltaTime = currentFrame - gLastFrame;
-	gLastFrame = currentFrame;
-
-	// process any keyboard events that may be waiting in the 
-	// event queue
-	ProcessKeyboardEvents();
-
-	// get the current view matrix from the camera
-	view = g_pCamera->GetViewMatrix();
-
-	float aspect = static_cast<float>(WINDOW_WIDTH) / static_cast<float>(WINDOW_HEIGHT);
-
-	if (!bOrthographicProjection) {
-		// Perspective
-		projection = glm::perspective(glm::radians(g_pCamera->Zoom),
-			aspect,
-			0.1f, 100.0f);
-	}
-	else {
-		// Orthographic
-		const float halfHeight = 25.0f;       // tune to your scene scale
-		const float halfWidth = halfHeight * aspect;
-		projection = glm::ortho(-halfWidth, halfWidth,
-			-halfHeight, halfHeight,
-			1.0f, 100.0f);
-	}
-
-	// define the current projection matrix
-	//projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
-
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
-	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
-	}
-	m_pShaderManager->setMat4Value("view", view);
-	m_pShaderManager->setMat4Value("projection", projection);
-	m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
-
-
+///////////////////////////////////////////////////////////////////////////////
+// viewmanager.h
+// ============
+// manage the viewing of 3D objects within the viewport
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ViewManager.h"
+#include "RenderSettings.h"
+#include "GLStateCache.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>    
+#include <glm/gtc/matrix_transform.hpp>
+
+
+float gSpeedScale = 5.0f;
+float gLookSpeed = 500.0f;
+
+// declaration of the global variables and defines
+namespace
+{
+	// Variables for window width and height
+	const int WINDOW_WIDTH = 1000;
+	const int WINDOW_HEIGHT = 800;
+
+	// camera object used for viewing and interacting with
+	// the 3D scene
+	Camera* g_pCamera = nullptr;
+
+	// these variables are used for mouse movement processing
+	float gLastX = WINDOW_WIDTH / 2.0f;
+	float gLastY = WINDOW_HEIGHT / 2.0f;
+	bool gFirstMouse = true;
+
+	// length of the current fixed update step
+	float gDeltaTime = 0.0f; 
+
+	// events written by the GLFW callbacks and read by the
+	// update step
+	InputQueue g_InputQueue;
+
+	// key that starts each action, and whether holding the key
+	// keeps changing the view on every update step
+	struct KEY_BINDING
+	{
+		int key;
+		ViewManager::INPUT_ACTION action;
+		bool bContinuous;
+	};
+
+	const KEY_BINDING g_KeyBindings[] =
+	{
+		{ GLFW_KEY_ESCAPE, ViewManager::ACTION_QUIT, false },
+		{ GLFW_KEY_W, ViewManager::ACTION_MOVE_FORWARD, true },
+		{ GLFW_KEY_S, ViewManager::ACTION_MOVE_BACKWARD, true },
+		{ GLFW_KEY_A, ViewManager::ACTION_MOVE_LEFT, true },
+		{ GLFW_KEY_D, ViewManager::ACTION_MOVE_RIGHT, true },
+		{ GLFW_KEY_Q, ViewManager::ACTION_MOVE_DOWN, true },
+		{ GLFW_KEY_E, ViewManager::ACTION_MOVE_UP, true },
+		{ GLFW_KEY_LEFT, ViewManager::ACTION_LOOK_LEFT, true },
+		{ GLFW_KEY_RIGHT, ViewManager::ACTION_LOOK_RIGHT, true },
+		{ GLFW_KEY_UP, ViewManager::ACTION_LOOK_UP, true },
+		{ GLFW_KEY_DOWN, ViewManager::ACTION_LOOK_DOWN, true },
+		{ GLFW_KEY_T, ViewManager::ACTION_ORTHOGRAPHIC, false },
+		{ GLFW_KEY_G, ViewManager::ACTION_PERSPECTIVE, false },
+		{ GLFW_KEY_L, ViewManager::ACTION_TOGGLE_BAKED_LIGHTING, false },
+		{ GLFW_KEY_I, ViewManager::ACTION_TOGGLE_PROBE_LIGHTING, false },
+		{ GLFW_KEY_R, ViewManager::ACTION_TOGGLE_DEFERRED, false },
+		{ GLFW_KEY_P, ViewManager::ACTION_TOGGLE_PERMUTATIONS, false },
+		{ GLFW_KEY_O, ViewManager::ACTION_TOGGLE_OIT, false },
+		{ GLFW_KEY_F, ViewManager::ACTION_TOGGLE_RENDER_ON_DEMAND, false },
+		{ GLFW_KEY_U, ViewManager::ACTION_TOGGLE_UPLOAD_RING, false },
+		{ GLFW_KEY_K, ViewManager::ACTION_TOGGLE_LOD, false },
+		{ GLFW_KEY_C, ViewManager::ACTION_TOGGLE_COMPACT_VERTICES, false },
+		{ GLFW_KEY_B, ViewManager::ACTION_TOGGLE_STATIC_BATCHING, false },
+		{ GLFW_KEY_M, ViewManager::ACTION_TOGGLE_MESHLET_CULLING, false },
+		{ GLFW_KEY_X, ViewManager::ACTION_TOGGLE_GPU_CULLING, false },
+		{ GLFW_KEY_Z, ViewManager::ACTION_TOGGLE_OCCLUSION_CULLING, false },
+		{ GLFW_KEY_H, ViewManager::ACTION_TOGGLE_DYNAMIC_RESOLUTION, false },
+		{ GLFW_KEY_V, ViewManager::ACTION_CYCLE_VSYNC, false },
+		{ GLFW_KEY_1, ViewManager::ACTION_VIEW_FRONT, false },
+		{ GLFW_KEY_2, ViewManager::ACTION_VIEW_WINDOW, false },
+		{ GLFW_KEY_3, ViewManager::ACTION_VIEW_OVERVIEW, false }
+	};
+
+	/***********************************************************
+	 *  FindKeyAction()
+	 *
+	 *  Look up the action bound to a key.
+	 ***********************************************************/
+	ViewManager::INPUT_ACTION FindKeyAction(int key)
+	{
+		for (const KEY_BINDING& binding : g_KeyBindings)
+		{
+			if (binding.key == key)
+			{
+				return(binding.action);
+			}
+		}
+		return(ViewManager::ACTION_NONE);
+	}
+
+	// the following variable is false when orthographic projection
+	// is off and true when it is on
+	bool bOrthographicProjection = false;
+}
+
+/***********************************************************
+ *  ViewManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ViewManager::ViewManager(
+	ShaderManager *pShaderManager)
+{
+	// initialize the member variables
+	m_pShaderManager = pShaderManager;
+	m_pWindow = NULL;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	g_pCamera = new Camera();
+	// default camera view parameters
+	g_pCamera->Position = glm::vec3(0.0f, 12.0f, 25.0f);
+	g_pCamera->Front = glm::vec3(0.0f, -0.2f, -2.0f);
+	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+	g_pCamera->Zoom = 80;
+
+	// start both update steps from the same camera
+	m_previousCamera.position = g_pCamera->Position;
+	m_previousCamera.front = g_pCamera->Front;
+	m_previousCamera.up = g_pCamera->Up;
+	m_previousCamera.zoom = g_pCamera->Zoom;
+	m_viewPosition = g_pCamera->Position;
+	m_viewCamera = m_previousCamera;
+	m_bViewValid = false;
+	m_bProjectionValid = false;
+	m_bProjectionOrthographic = false;
+
+	for (int i = 0; i < ACTION_COUNT; i++)
+	{
+		m_actionHeld[i] = false;
+	}
+	m_redrawReasons = 0;
+}
+
+/***********************************************************
+ *  ~ViewManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ViewManager::~ViewManager()
+{
+	// free up allocated memory
+	m_pShaderManager = NULL;
+	m_pWindow = NULL;
+	if (NULL != g_pCamera)
+	{
+		delete g_pCamera;
+		g_pCamera = NULL;
+	}
+}
+
+/***********************************************************
+ *  CreateDisplayWindow()
+ *
+ *  This method is used to create the main display window.
+ ***********************************************************/
+GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
+{
+	GLFWwindow* window = nullptr;
+
+	// try to create the displayed OpenGL window
+	window = glfwCreateWindow(
+		WINDOW_WIDTH,
+		WINDOW_HEIGHT,
+		windowTitle,
+		NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return NULL;
+	}
+	glfwMakeContextCurrent(window);
+
+	// tell GLFW to capture all mouse events
+	//glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	// these callbacks queue the keyboard and mouse events
+	glfwSetKeyCallback(window, &ViewManager::Key_Callback);
+	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
+	glfwSetScrollCallback(window, &ViewManager::Mouse_Scroll_Callback);
+
+	// enable blending for supporting tranparent rendering
+	g_GLState.Enable(GL_BLEND);
+	g_GLState.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	m_pWindow = window;
+
+	return(window);
+}
+
+/***********************************************************
+ *  Key_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  a key is pressed or released. The event is queued for
+ *  the next update step.
+ ***********************************************************/
+void ViewManager::Key_Callback(GLFWwindow* /*window*/, int key, int /*scanCode*/, int action, int /*mods*/)
+{
+	// held keys are tracked from the press and release events
+	if (action == GLFW_REPEAT)
+	{
+		return;
+	}
+
+	INPUT_EVENT event;
+	event.type = INPUT_KEY;
+	event.key = key;
+	event.action = action;
+	event.x = 0.0;
+	event.y = 0.0;
+	event.time = glfwGetTime();
+	g_InputQueue.Push(event);
+}
+
+/***********************************************************
+ *  Mouse_Position_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the mouse is moved within the active GLFW display window.
+ *  The position is queued for the next update step.
+ ***********************************************************/
+void ViewManager::Mouse_Position_Callback(GLFWwindow* /*window*/, double xMousePos, double yMousePos)
+{
+	INPUT_EVENT event;
+	event.type = INPUT_MOUSE_MOVE;
+	event.key = 0;
+	event.action = 0;
+	event.x = xMousePos;
+	event.y = yMousePos;
+	event.time = glfwGetTime();
+	g_InputQueue.Push(event);
+}
+
+/***********************************************************
+ *  Mouse_Scroll_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the mouse wheel is scrolled. The offset is queued for
+ *  the next update step.
+ ***********************************************************/
+void ViewManager::Mouse_Scroll_Callback(GLFWwindow* /*window*/, double xOffset, double yOffset)
+{
+	INPUT_EVENT event;
+	event.type = INPUT_SCROLL;
+	event.key = 0;
+	event.action = 0;
+	event.x = xOffset;
+	event.y = yOffset;
+	event.time = glfwGetTime();
+	g_InputQueue.Push(event);
+}
+
+/***********************************************************
+ *  ProcessMouseMove()
+ *
+ *  This method is used for turning a queued cursor position
+ *  into camera movement.
+ ***********************************************************/
+void ViewManager::ProcessMouseMove(double xMousePos, double yMousePos)
+{
+	// when the first mouse move event is received, this needs to be recorded so that
+	// all subsequent mouse moves can correctly calculate the X position offset and Y
+	// position offset for proper operation
+	if (gFirstMouse)
+	{
+		gLastX = xMousePos;
+		gLastY = yMousePos;
+		gFirstMouse = false;
+	}
+
+	// calculate the X offset and Y offset values for moving the 3D camera accordingly
+	float xOffset = xMousePos - gLastX;
+	float yOffset = gLastY - yMousePos; // reversed since y-coordinates go from bottom to top
+
+	// set the current positions into the last position variables
+	gLastX = xMousePos;
+	gLastY = yMousePos;
+
+	// move the 3D camera according to the calculated offsets
+	g_pCamera->ProcessMouseMovement(xOffset, yOffset);
+}
+
+/***********************************************************
+ *  ProcessScroll()
+ *
+ *  This method is used for adjusting the speed of the
+ * scene movement based on the mouse scroll function
+ ***********************************************************/
+void ViewManager::ProcessScroll(double yOffset)
+{
+	// Each scroll "notch" changes speed by ~15%
+	constexpr float STEP = 0.50f;       // fixed amount to change per scroll
+	constexpr float MIN_SPEED = 0.05f;
+	constexpr float MAX_SPEED = 20.0f;
+
+	if (yOffset > 0.0) {
+		gSpeedScale += STEP * static_cast<float>(yOffset);
+	}
+	else if (yOffset < 0.0) {
+		gSpeedScale += STEP * static_cast<float>(yOffset);  // yOffset is negative, so this subtracts
+	}
+
+	// Clamp
+	if (gSpeedScale < MIN_SPEED) gSpeedScale = MIN_SPEED;
+	if (gSpeedScale > MAX_SPEED) gSpeedScale = MAX_SPEED;
+}
+
+/***********************************************************
+ *  TriggerAction()
+ *
+ *  This method is used for running an action that happens
+ *  once when its key is pressed.
+ ***********************************************************/
+void ViewManager::TriggerAction(INPUT_ACTION action)
+{
+	// every action except quitting changes the picture
+	if ((action == ACTION_ORTHOGRAPHIC) || (action == ACTION_PERSPECTIVE))
+	{
+		m_redrawReasons |= (1u << REDRAW_CAMERA);
+	}
+	else if (action != ACTION_QUIT)
+	{
+		m_redrawReasons |= (1u << REDRAW_SETTINGS);
+	}
+
+	switch (action)
+	{
+	case ACTION_QUIT:
+		// close the window when the escape key has been pressed
+		glfwSetWindowShouldClose(m_pWindow, true);
+		break;
+
+	// Orth - Persp View, only print when the mode actually changes
+	case ACTION_ORTHOGRAPHIC:
+		if (!bOrthographicProjection) {
+			bOrthographicProjection = true;
+			std::cout << "View Set to Orthographic (2D)\n";
+		}
+		break;
+	case ACTION_PERSPECTIVE:
+		if (bOrthographicProjection) {
+			bOrthographicProjection = false;
+			std::cout << "View Set to Perspective (3D)\n";
+		}
+		break;
+
+	case ACTION_TOGGLE_BAKED_LIGHTING:
+		g_RenderSettings.bUseBakedLighting = !g_RenderSettings.bUseBakedLighting;
+		std::cout << (g_RenderSettings.bUseBakedLighting ? "Baked Lighting On\n"
+			: "Baked Lighting Off\n");
+		break;
+	case ACTION_TOGGLE_PROBE_LIGHTING:
+		g_RenderSettings.bUseProbeLighting = !g_RenderSettings.bUseProbeLighting;
+		std::cout << (g_RenderSettings.bUseProbeLighting ? "Probe Lighting On\n"
+			: "Probe Lighting Off\n");
+		break;
+	case ACTION_TOGGLE_DEFERRED:
+		g_RenderSettings.bUseDeferredShading = !g_RenderSettings.bUseDeferredShading;
+		std::cout << (g_RenderSettings.bUseDeferredShading ? "Deferred Shading On\n"
+			: "Deferred Shading Off\n");
+		break;
+	case ACTION_TOGGLE_PERMUTATIONS:
+		g_RenderSettings.bUseShaderPermutations = !g_RenderSettings.bUseShaderPermutations;
+		std::cout << (g_RenderSettings.bUseShaderPermutations ? "Shader Permutations On\n"
+			: "Shader Permutations Off\n");
+		break;
+	case ACTION_TOGGLE_OIT:
+		g_RenderSettings.bUseOIT = !g_RenderSettings.bUseOIT;
+		std::cout << (g_RenderSettings.bUseOIT ? "Order-Independent Transparency On\n"
+			: "Order-Independent Transparency Off\n");
+		break;
+	case ACTION_TOGGLE_RENDER_ON_DEMAND:
+		g_RenderSettings.bRenderOnDemand = !g_RenderSettings.bRenderOnDemand;
+		std::cout << (g_RenderSettings.bRenderOnDemand ? "Render On Demand On\n"
+			: "Render On Demand Off\n");
+		break;
+	case ACTION_TOGGLE_UPLOAD_RING:
+		g_RenderSettings.bUseUploadRing = !g_RenderSettings.bUseUploadRing;
+		std::cout << (g_RenderSettings.bUseUploadRing ? "Upload Ring On\n"
+			: "Upload Ring Off\n");
+		break;
+	case ACTION_TOGGLE_LOD:
+		g_RenderSettings.bUseLod = !g_RenderSettings.bUseLod;
+		std::cout << (g_RenderSettings.bUseLod ? "Mesh LOD On\n"
+			: "Mesh LOD Off\n");
+		break;
+	case ACTION_TOGGLE_COMPACT_VERTICES:
+		g_RenderSettings.bUseCompactVertices = !g_RenderSettings.bUseCompactVertices;
+		std::cout << (g_RenderSettings.bUseCompactVertices ? "Compact Vertices On\n"
+			: "Compact Vertices Off\n");
+		break;
+	case ACTION_TOGGLE_STATIC_BATCHING:
+		g_RenderSettings.bUseStaticBatching = !g_RenderSettings.bUseStaticBatching;
+		std::cout << (g_RenderSettings.bUseStaticBatching ? "Static Batching On\n"
+			: "Static Batching Off\n");
+		break;
+	case ACTION_TOGGLE_MESHLET_CULLING:
+		g_RenderSettings.bUseMeshletCulling = !g_RenderSettings.bUseMeshletCulling;
+		std::cout << (g_RenderSettings.bUseMeshletCulling ? "Meshlet Culling On\n"
+			: "Meshlet Culling Off\n");
+		break;
+	case ACTION_TOGGLE_GPU_CULLING:
+		g_RenderSettings.bUseGPUCulling = !g_RenderSettings.bUseGPUCulling;
+		std::cout << (g_RenderSettings.bUseGPUCulling ? "GPU Culling On\n"
+			: "GPU Culling Off\n");
+		break;
+	case ACTION_TOGGLE_OCCLUSION_CULLING:
+		g_RenderSettings.bUseOcclusionCulling = !g_RenderSettings.bUseOcclusionCulling;
+		std::cout << (g_RenderSettings.bUseOcclusionCulling ? "Occlusion Culling On\n"
+			: "Occlusion Culling Off\n");
+		break;
+	case ACTION_TOGGLE_DYNAMIC_RESOLUTION:
+		g_RenderSettings.bUseDynamicResolution = !g_RenderSettings.bUseDynamicResolution;
+		std::cout << (g_RenderSettings.bUseDynamicResolution ? "Dynamic Resolution On\n"
+			: "Dynamic Resolution Off\n");
+		break;
+	case ACTION_CYCLE_VSYNC:
+		// on, off, adaptive and back to on
+		if (g_RenderSettings.swapInterval == 1) {
+			g_RenderSettings.swapInterval = 0;
+			std::cout << "Vsync Off\n";
+		}
+		else if (g_RenderSettings.swapInterval == 0) {
+			g_RenderSettings.swapInterval = -1;
+			std::cout << "Vsync Adaptive\n";
+		}
+		else {
+			g_RenderSettings.swapInterval = 1;
+			std::cout << "Vsync On\n";
+		}
+		break;
+
+	case ACTION_VIEW_FRONT:
+		// Front view
+		g_pCamera->Position = glm::vec3(0.0f, 12.0f, 25.0f);
+		g_pCamera->Front = glm::normalize(glm::vec3(0.0f, -0.2f, -1.0f));
+		break;
+	case ACTION_VIEW_WINDOW:
+		// Window view
+		g_pCamera->Position = glm::vec3(0.0f, 22.0f, 12.0f);
+		g_pCamera->Front = glm::normalize(glm::vec3(0.0f, -0.1f, -1.0f));
+		break;
+	case ACTION_VIEW_OVERVIEW:
+		// Overview
+		g_pCamera->Position = glm::vec3(15.0f, 21.0f, 25.0f);  
+		g_pCamera->Front = glm::normalize(glm::vec3(-0.3f, -0.4f, -1.0f));  
+		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+		break;
+
+	default:
+		break;
+	}
+}
+
+/***********************************************************
+ *  ProcessInputEvents()
+ *
+ *  This method is called to drain the input events queued
+ *  by the callbacks since the last update step. Keys are
+ *  mapped to actions, which either run once per press or
+ *  stay held until the key is released. Held movement is
+ *  then applied for the length of the step.
+ ***********************************************************/
+void ViewManager::ProcessInputEvents()
+{
+	INPUT_EVENT event;
+	while (g_InputQueue.Pop(event))
+	{
+		if (event.type == INPUT_MOUSE_MOVE)
+		{
+			ProcessMouseMove(event.x, event.y);
+		}
+		else if (event.type == INPUT_SCROLL)
+		{
+			ProcessScroll(event.y);
+		}
+		else
+		{
+			INPUT_ACTION action = FindKeyAction(event.key);
+			if (action == ACTION_NONE)
+			{
+				continue;
+			}
+
+			bool bPressed = (event.action == GLFW_PRESS);
+			if (bPressed && !m_actionHeld[action])
+			{
+				TriggerAction(action);
+			}
+			m_actionHeld[action] = bPressed;
+		}
+	}
+
+	float moveDistance = gDeltaTime * gSpeedScale;
+
+	// process camera zooming in and out
+	if (m_actionHeld[ACTION_MOVE_FORWARD]) g_pCamera->ProcessKeyboard(FORWARD, moveDistance);
+	if (m_actionHeld[ACTION_MOVE_BACKWARD]) g_pCamera->ProcessKeyboard(BACKWARD, moveDistance);
+
+	// process camera panning left and right
+	if (m_actionHeld[ACTION_MOVE_LEFT]) g_pCamera->ProcessKeyboard(LEFT, moveDistance);
+	if (m_actionHeld[ACTION_MOVE_RIGHT]) g_pCamera->ProcessKeyboard(RIGHT, moveDistance);
+
+	// process camera panning up and down
+	if (m_actionHeld[ACTION_MOVE_DOWN]) g_pCamera->ProcessKeyboard(DOWN, moveDistance);
+	if (m_actionHeld[ACTION_MOVE_UP]) g_pCamera->ProcessKeyboard(UP, moveDistance);
+
+	float dx = 0.0f, dy = 0.0f;
+
+	if (m_actionHeld[ACTION_LOOK_LEFT]) dx -= gLookSpeed * moveDistance; // look left
+	if (m_actionHeld[ACTION_LOOK_RIGHT]) dx += gLookSpeed * moveDistance; // look right
+
+	// optional: look up/down with arrows
+	if (m_actionHeld[ACTION_LOOK_DOWN]) dy += gLookSpeed * moveDistance; // look down
+	if (m_actionHeld[ACTION_LOOK_UP]) dy -= gLookSpeed * moveDistance; // look up
+
+	if (dx != 0.0f || dy != 0.0f) {
+		g_pCamera->ProcessMouseMovement(dx, dy);
+	}
+}
+
+/***********************************************************
+ *  HasPendingInput()
+ *
+ *  This method is used for checking whether input events
+ *  are waiting for the next update step.
+ ***********************************************************/
+bool ViewManager::HasPendingInput() const
+{
+	return(!g_InputQueue.IsEmpty());
+}
+
+/***********************************************************
+ *  IsAnyActionHeld()
+ *
+ *  This method is used for checking whether a held key
+ *  keeps changing the view without sending new events.
+ *  Only the movement and look keys count, since holding a
+ *  toggle does nothing past its first press.
+ ***********************************************************/
+bool ViewManager::IsAnyActionHeld() const
+{
+	for (const KEY_BINDING& binding : g_KeyBindings)
+	{
+		if ((binding.bContinuous) && (m_actionHeld[binding.action]))
+		{
+			return(true);
+		}
+	}
+	return(false);
+}
+
+/***********************************************************
+ *  UpdateView()
+ *
+ *  This method is used for advancing the camera by one fixed
+ *  update step. The camera of the previous step is kept so
+ *  that rendering can blend between the two. Returns the
+ *  redraw reasons for anything the step changed.
+ ***********************************************************/
+unsigned int ViewManager::UpdateView(float deltaTime)
+{
+	m_redrawReasons = 0;
+
+	m_previousCamera.position = g_pCamera->Position;
+	m_previousCamera.front = g_pCamera->Front;
+	m_previousCamera.up = g_pCamera->Up;
+	m_previousCamera.zoom = g_pCamera->Zoom;
+
+	gDeltaTime = deltaTime;
+
+	// process any keyboard and mouse events that may be waiting
+	// in the event queue
+	ProcessInputEvents();
+
+	if ((g_pCamera->Position != m_previousCamera.position) ||
+		(g_pCamera->Front != m_previousCamera.front) ||
+		(g_pCamera->Up != m_previousCamera.up) ||
+		(g_pCamera->Zoom != m_previousCamera.zoom))
+	{
+		m_redrawReasons |= (1u << REDRAW_CAMERA);
+	}
+
+	return(m_redrawReasons);
+}
+
+/***********************************************************
+ *  PrepareSceneView()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering. The camera is placed between the last two
+ *  update steps by the interpolation factor, so movement
+ *  stays smooth at any frame rate. The view and projection
+ *  are only rebuilt, and the camera block only written,
+ *  when the values they come from have changed.
+ ***********************************************************/
+void ViewManager::PrepareSceneView(float interpolation)
+{
+	if ((!m_cameraBuffer.IsReady()) && (!m_cameraBuffer.Initialize()))
+	{
+		return;
+	}
+
+	// blend the camera of the previous and current steps
+	glm::vec3 position = glm::mix(m_previousCamera.position, g_pCamera->Position, interpolation);
+	glm::vec3 front = glm::normalize(glm::mix(m_previousCamera.front, g_pCamera->Front, interpolation));
+	glm::vec3 up = glm::normalize(glm::mix(m_previousCamera.up, g_pCamera->Up, interpolation));
+	float zoom = m_previousCamera.zoom + (g_pCamera->Zoom - m_previousCamera.zoom) * interpolation;
+	m_viewPosition = position;
+
+	bool bViewChanged = (!m_bViewValid) ||
+		(position != m_viewCamera.position) ||
+		(front != m_viewCamera.front) ||
+		(up != m_viewCamera.up);
+	if (bViewChanged)
+	{
+		// get the current view matrix from the camera
+		m_viewMatrix = glm::lookAt(position, position + front, up);
+		m_viewCamera.position = position;
+		m_viewCamera.front = front;
+		m_viewCamera.up = up;
+		m_bViewValid = true;
+	}
+
+	// the zoom only shapes the perspective projection
+	bool bProjectionChanged = (!m_bProjectionValid) ||
+		(bOrthographicProjection != m_bProjectionOrthographic) ||
+		((!bOrthographicProjection) && (zoom != m_viewCamera.zoom));
+	if (bProjectionChanged)
+	{
+		float aspect = static_cast<float>(WINDOW_WIDTH) / static_cast<float>(WINDOW_HEIGHT);
+
+		if (!bOrthographicProjection) {
+			// Perspective
+			m_projectionMatrix = glm::perspective(glm::radians(zoom),
+				aspect,
+				0.1f, 100.0f);
+		}
+		else {
+			// Orthographic
+			const float halfHeight = 25.0f;       // tune to your scene scale
+			const float halfWidth = halfHeight * aspect;
+			m_projectionMatrix = glm::ortho(-halfWidth, halfWidth,
+				-halfHeight, halfHeight,
+				1.0f, 100.0f);
+		}
+		m_viewCamera.zoom = zoom;
+		m_bProjectionOrthographic = bOrthographicProjection;
+		m_bProjectionValid = true;
+	}
+
+	// every shader program reads the camera from the block
+	if (bViewChanged || bProjectionChanged)
+	{
+		m_cameraBuffer.Update(m_viewMatrix, m_projectionMatrix, position);
+	}
+}
+
+/***********************************************************
+ *  GetViewPosition()
+ *
+ *  This method is used for getting the camera position of
+ *  the last prepared view.
+ ***********************************************************/
+glm::vec3 ViewManager::GetViewPosition() const
+{
+	return(m_viewPosition);
+}
+
+/***********************************************************
+ *  SetCamera()
+ *
+ *  This method is used for placing the camera at a fixed
+ *  position and direction. The previous update step is set
+ *  to the same values, so the next frame does not blend.
+ ***********************************************************/
+void ViewManager::SetCamera(const glm::vec3& position, const glm::vec3& front)
+{
+	g_pCamera->Position = position;
+	g_pCamera->Front = glm::normalize(front);
+	m_previousCamera.position = g_pCamera->Position;
+	m_previousCamera.front = g_pCamera->Front;
 }
\ No newline at end of file
@@ -1,46 +1,133 @@
-///////////////////////////////////////////////////////////////////////////////
-// viewmanager.h
-// ============
-// manage the viewing of 3D objects within the viewport
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#pragma once
-
-#include "ShaderManager.h"
-#include "camera.h"
-
-// GLFW library
-#include "GLFW/glfw3.h" 
-
-class ViewManager
-{
-public:
-	// constructor
-	ViewManager(
-		ShaderManager* pShaderManager);
-	// destructor
-	~ViewManager();
-
-	// mouse position callback for mouse interaction with the 3D scene
-	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
-	static void Mouse_Scroll_Callback(GLFWwindow* window, double xOffset, double yOffset);
-
-private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// active OpenGL display window
-	GLFWwindow* m_pWindow;
-
-	// process keyboard events for interaction with the 3D scene
-	void ProcessKeyboardEvents();
-
-public:
-	// create the initial OpenGL display window
-	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
-	
-	// prepare the conversion from 3D object display to 2D scene display
-	void PrepareSceneView();
+///////////////////////////////////////////////////////////////////////////////
+// viewmanager.h
+// ============
+// manage the viewing of 3D objects within the viewport
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "InputQueue.h"
+#include "CameraBuffer.h"
+#include "camera.h"
+
+// GLFW library
+#include "GLFW/glfw3.h" 
+
+class ViewManager
+{
+public:
+	// constructor
+	ViewManager(
+		ShaderManager* pShaderManager);
+	// destructor
+	~ViewManager();
+
+	// actions that keys are mapped onto
+	enum INPUT_ACTION
+	{
+		ACTION_NONE,
+		ACTION_QUIT,
+		ACTION_MOVE_FORWARD,
+		ACTION_MOVE_BACKWARD,
+		ACTION_MOVE_LEFT,
+		ACTION_MOVE_RIGHT,
+		ACTION_MOVE_DOWN,
+		ACTION_MOVE_UP,
+		ACTION_LOOK_LEFT,
+		ACTION_LOOK_RIGHT,
+		ACTION_LOOK_UP,
+		ACTION_LOOK_DOWN,
+		ACTION_ORTHOGRAPHIC,
+		ACTION_PERSPECTIVE,
+		ACTION_TOGGLE_BAKED_LIGHTING,
+		ACTION_TOGGLE_PROBE_LIGHTING,
+		ACTION_TOGGLE_DEFERRED,
+		ACTION_TOGGLE_PERMUTATIONS,
+		ACTION_TOGGLE_OIT,
+		ACTION_TOGGLE_RENDER_ON_DEMAND,
+		ACTION_TOGGLE_UPLOAD_RING,
+		ACTION_TOGGLE_LOD,
+		ACTION_TOGGLE_COMPACT_VERTICES,
+		ACTION_TOGGLE_STATIC_BATCHING,
+		ACTION_TOGGLE_MESHLET_CULLING,
+		ACTION_TOGGLE_GPU_CULLING,
+		ACTION_TOGGLE_OCCLUSION_CULLING,
+		ACTION_TOGGLE_DYNAMIC_RESOLUTION,
+		ACTION_CYCLE_VSYNC,
+		ACTION_VIEW_FRONT,
+		ACTION_VIEW_WINDOW,
+		ACTION_VIEW_OVERVIEW,
+		ACTION_COUNT
+	};
+
+	// input callbacks, which queue the events for the update step
+	static void Key_Callback(GLFWwindow* window, int key, int scanCode, int action, int mods);
+	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
+	static void Mouse_Scroll_Callback(GLFWwindow* window, double xOffset, double yOffset);
+
+private:
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// active OpenGL display window
+	GLFWwindow* m_pWindow;
+	// matrices of the last prepared view
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	glm::vec3 m_viewPosition;
+
+	// camera values at the end of the previous update step
+	struct CAMERA_STATE
+	{
+		glm::vec3 position;
+		glm::vec3 front;
+		glm::vec3 up;
+		float zoom;
+	};
+	CAMERA_STATE m_previousCamera;
+
+	// camera block shared by all the shader programs
+	CameraBuffer m_cameraBuffer;
+	// camera values the current matrices were built from, so
+	// that each matrix is only rebuilt when its inputs change
+	CAMERA_STATE m_viewCamera;
+	bool m_bViewValid;
+	bool m_bProjectionValid;
+	bool m_bProjectionOrthographic;
+
+	// actions whose keys are currently held down
+	bool m_actionHeld[ACTION_COUNT];
+	// redraw reasons raised by actions in the current update step
+	unsigned int m_redrawReasons;
+
+	// process queued input events for interaction with the 3D scene
+	void ProcessInputEvents();
+	void ProcessMouseMove(double xMousePos, double yMousePos);
+	void ProcessScroll(double yOffset);
+	void TriggerAction(INPUT_ACTION action);
+
+public:
+	// create the initial OpenGL display window
+	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
+	
+	// advance input and camera by one fixed update step, returns
+	// the mask of redraw reasons for what changed
+	unsigned int UpdateView(float deltaTime);
+	// prepare the conversion from 3D object display to 2D scene display,
+	// blending the last two update steps by the interpolation factor
+	void PrepareSceneView(float interpolation);
+	// whether input events are waiting for the next update step
+	bool HasPendingInput() const;
+	// whether any key bound to an action is held down
+	bool IsAnyActionHeld() const;
+
+	// camera values used by the last prepared view
+	glm::mat4 GetViewMatrix() const { return m_viewMatrix; }
+	glm::mat4 GetProjectionMatrix() const { return m_projectionMatrix; }
+	glm::vec3 GetViewPosition() const;
+	// place the camera without blending from where it was
+	void SetCamera(const glm::vec3& position, const glm::vec3& front);
 };
\ No newline at end of file